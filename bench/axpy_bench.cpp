@@ -0,0 +1,44 @@
+#include "bench_utils.h"
+#include "operations/operations.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+void axpyBench(benchmark::State& state, DType dtype, Layout2D layout)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    gTensor x = makeTensor(elements, dtype, layout, 1);
+    gTensor y = makeTensor(elements, dtype, layout, 2);
+    gTensor out = makeTensor(elements, dtype, layout, 3);
+    Operations ops;
+    for (auto _ : state)
+    {
+        if (ops.axpy(0.5, x, y, out) != gStatus::gBLAS_PASS)
+        {
+            state.SkipWithError("axpy failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    // x and y are read, out is written
+    setThroughput(state, 3.0 * elements * getSingleElementSizeInBytes(dtype), 2.0 * elements);
+}
+
+const bool registered = []()
+{
+    for (DType dtype : {DType::fp32, DType::fp64, DType::bf16, DType::fp16, DType::tf32, DType::fp8_152,
+                        DType::fp8_143, DType::int8, DType::int32})
+    {
+        for (Layout2D layout : {Layout2D::Dense, Layout2D::Strided, Layout2D::Transposed})
+        {
+            const std::string name = std::string("axpy/") + getName(dtype) + "/" + getName(layout);
+            benchmark::RegisterBenchmark(name.c_str(), axpyBench, dtype, layout)->ArgsProduct({kSizes})->UseRealTime();
+        }
+    }
+    return true;
+}();
+
+} // anonymous namespace
@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// runs like benchmark_main, and unless told otherwise also writes the results as JSON to gBLAS_bench.json
+// so runs of different releases can be compared with benchmark's compare.py
+int main(int argc, char** argv)
+{
+    std::vector<char*> args(argv, argv + argc);
+    bool hasOut = false;
+    for (int i = 1; i < argc; ++i) hasOut |= std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+    std::string out = "--benchmark_out=gBLAS_bench.json";
+    std::string format = "--benchmark_out_format=json";
+    if (!hasOut)
+    {
+        args.push_back(out.data());
+        args.push_back(format.data());
+    }
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
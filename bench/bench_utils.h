@@ -0,0 +1,122 @@
+#ifndef GBLAS_BENCH_UTILS_H
+#define GBLAS_BENCH_UTILS_H
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include "common.h"
+#include "data_types/conversions.h"
+#include "gTensor/gTensor.h"
+
+namespace gblas::bench {
+
+/// element counts from L1 resident to well past the last level cache
+inline const std::vector<int64_t> kSizes = {1 << 12, 1 << 15, 1 << 18, 1 << 21, 1 << 24};
+
+/// how the benchmarked tensors are laid out
+enum class Layout2D
+{
+    Dense,
+    Strided,    // every other element along dim 0
+    Transposed, // dim 0 walks the rows
+};
+
+inline const char* getName(DType dtype)
+{
+    switch (dtype)
+    {
+        case DType::int8: return "int8";
+        case DType::fp8_152: return "fp8_152";
+        case DType::fp8_143: return "fp8_143";
+        case DType::int16: return "int16";
+        case DType::fp16: return "fp16";
+        case DType::bf16: return "bf16";
+        case DType::int32: return "int32";
+        case DType::fp32: return "fp32";
+        case DType::tf32: return "tf32";
+        case DType::int64: return "int64";
+        case DType::fp64: return "fp64";
+        case DType::uint8: return "uint8";
+        default: return "unknown";
+    }
+}
+
+inline const char* getName(Layout2D layout)
+{
+    switch (layout)
+    {
+        case Layout2D::Dense: return "dense";
+        case Layout2D::Strided: return "strided";
+        default: return "transposed";
+    }
+}
+
+/// small values that stay representable in every dtype, random so the conversions see every path
+inline void fillRandom(byte* data, uint64_t count, DType dtype, uint32_t seed = 1)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const float value = distribution(generator);
+        switch (dtype)
+        {
+            case DType::int8: reinterpret_cast<int8_t*>(data)[i] = static_cast<int8_t>(value); break;
+            case DType::uint8: reinterpret_cast<uint8_t*>(data)[i] = static_cast<uint8_t>(value + 4.0f); break;
+            case DType::int16: reinterpret_cast<int16_t*>(data)[i] = static_cast<int16_t>(value); break;
+            case DType::int32: reinterpret_cast<int32_t*>(data)[i] = static_cast<int32_t>(value); break;
+            case DType::int64: reinterpret_cast<int64_t*>(data)[i] = static_cast<int64_t>(value); break;
+            case DType::fp32: reinterpret_cast<float*>(data)[i] = value; break;
+            case DType::fp64: reinterpret_cast<double*>(data)[i] = value; break;
+            case DType::bf16:
+                reinterpret_cast<uint16_t*>(data)[i] = Conversions::fp32_to_bf16(value, RoundingMode::NearestEven);
+                break;
+            case DType::fp16:
+                reinterpret_cast<uint16_t*>(data)[i] = Conversions::fp32_to_fp16(value, RoundingMode::NearestEven);
+                break;
+            case DType::tf32:
+                reinterpret_cast<uint32_t*>(data)[i] = Conversions::fp32_to_tf32(value, RoundingMode::NearestEven);
+                break;
+            case DType::fp8_152:
+                data[i] = Conversions::fp32_to_fp8_152(value, RoundingMode::NearestEven);
+                break;
+            case DType::fp8_143:
+                data[i] = Conversions::fp32_to_fp8_143(value, RoundingMode::NearestEven);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/// a 2D tensor of `elements` elements in the given layout, allocated and filled. the strided layout
+/// allocates twice the elements and views every other one.
+inline gTensor makeTensor(uint64_t elements, DType dtype, Layout2D layout, uint32_t seed = 1)
+{
+    const uint64_t cols = elements >= 1024 ? 1024 : elements;
+    const uint64_t rows = elements / cols;
+    const uint64_t width = layout == Layout2D::Strided ? 2 * cols : cols;
+    gTensor tensor({width, rows, 1, 1, 1}, {1, (int64_t)width, (int64_t)(width * rows), (int64_t)(width * rows),
+                   (int64_t)(width * rows)}, 2, dtype, Layout::RowMajor);
+    tensor.allocateData();
+    fillRandom(tensor.data(), width * rows, dtype, seed);
+    if (layout == Layout2D::Strided) return tensor.slice(0, 0, width, 2);
+    if (layout == Layout2D::Transposed) return tensor.transpose(0, 1);
+    return tensor;
+}
+
+/// GB/s and GFLOP/s over the whole run, next to the per iteration time
+inline void setThroughput(benchmark::State& state, double bytesPerIteration, double flopsPerIteration = 0)
+{
+    const double iterations = static_cast<double>(state.iterations());
+    state.counters["GB/s"] = benchmark::Counter(bytesPerIteration * iterations / 1e9, benchmark::Counter::kIsRate);
+    if (flopsPerIteration > 0)
+    {
+        state.counters["GFLOP/s"] = benchmark::Counter(flopsPerIteration * iterations / 1e9,
+                                                       benchmark::Counter::kIsRate);
+    }
+}
+
+} // namespace gblas::bench
+
+#endif //GBLAS_BENCH_UTILS_H
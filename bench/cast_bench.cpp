@@ -0,0 +1,53 @@
+#include "bench_utils.h"
+#include "operations/operations.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// cast a tensor in the given layout into a dense one of another dtype, the transposed layout changes the
+// contiguous dim on the way. the GB/s counter counts one read of the source and one write of the result
+void castBench(benchmark::State& state, DType srcType, DType dstType, Layout2D layout)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    const gTensor src = makeTensor(elements, srcType, layout);
+    const int64_t ld = static_cast<int64_t>(src.getSize(0));
+    const int64_t size = ld * static_cast<int64_t>(src.getSize(1));
+    gTensor dst({src.getSize(0), src.getSize(1), 1, 1, 1}, {1, ld, size, size, size}, 2, dstType);
+    dst.allocateData();
+    Operations ops;
+    for (auto _ : state)
+    {
+        if (ops.cast(src, dst) != gStatus::gBLAS_PASS)
+        {
+            state.SkipWithError("cast failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(elements * (getSingleElementSizeInBytes(srcType) +
+                                                         getSingleElementSizeInBytes(dstType))));
+}
+
+const bool registered = []()
+{
+    const std::pair<DType, DType> pairs[] = {{DType::fp32, DType::bf16}, {DType::bf16, DType::fp32},
+                                             {DType::fp32, DType::fp8_143}, {DType::fp64, DType::fp32},
+                                             {DType::fp32, DType::int8}};
+    for (const auto& [srcType, dstType] : pairs)
+    {
+        for (Layout2D layout : {Layout2D::Dense, Layout2D::Transposed})
+        {
+            const std::string name = std::string("cast/") + getName(srcType) + "_to_" + getName(dstType) + "/" +
+                                     getName(layout);
+            benchmark::RegisterBenchmark(name.c_str(), castBench, srcType, dstType, layout)
+                ->ArgsProduct({kSizes})
+                ->UseRealTime();
+        }
+    }
+    return true;
+}();
+
+} // anonymous namespace
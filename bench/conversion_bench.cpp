@@ -0,0 +1,103 @@
+#include "bench_utils.h"
+#include <string>
+#include <vector>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// one conversion routine in its scalar and its bulk form
+template<typename Narrow>
+struct Routine
+{
+    const char* name;
+    DType dtype;
+    Narrow (*scalarNarrow)(const float&, RoundingMode);
+    float (*scalarWiden)(const Narrow&);
+    void (*bulkNarrow)(const float*, Narrow*, size_t, RoundingMode);
+    void (*bulkWiden)(const Narrow*, float*, size_t);
+};
+
+template<typename Narrow>
+void narrowBench(benchmark::State& state, Routine<Narrow> routine, bool bulk, RoundingMode rounding)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    std::vector<float> src(elements);
+    std::vector<Narrow> dst(elements);
+    fillRandom(reinterpret_cast<byte*>(src.data()), elements, DType::fp32);
+    for (auto _ : state)
+    {
+        if (bulk)
+        {
+            routine.bulkNarrow(src.data(), dst.data(), elements, rounding);
+        }
+        else
+        {
+            for (uint64_t i = 0; i < elements; ++i) dst[i] = routine.scalarNarrow(src[i], rounding);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(elements) * (sizeof(float) + sizeof(Narrow)));
+}
+
+template<typename Narrow>
+void widenBench(benchmark::State& state, Routine<Narrow> routine, bool bulk)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    std::vector<Narrow> src(elements);
+    std::vector<float> dst(elements);
+    fillRandom(reinterpret_cast<byte*>(src.data()), elements, routine.dtype);
+    for (auto _ : state)
+    {
+        if (bulk)
+        {
+            routine.bulkWiden(src.data(), dst.data(), elements);
+        }
+        else
+        {
+            for (uint64_t i = 0; i < elements; ++i) dst[i] = routine.scalarWiden(src[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(elements) * (sizeof(float) + sizeof(Narrow)));
+}
+
+template<typename Narrow>
+void registerRoutine(const Routine<Narrow>& routine)
+{
+    for (bool bulk : {false, true})
+    {
+        const std::string form = bulk ? "/bulk" : "/scalar";
+        for (RoundingMode rounding : {RoundingMode::NearestEven, RoundingMode::RoundTowardsZero})
+        {
+            const std::string mode = rounding == RoundingMode::NearestEven ? "/nearest_even" : "/towards_zero";
+            const std::string name = std::string("convert/fp32_to_") + routine.name + form + mode;
+            benchmark::RegisterBenchmark(name.c_str(), narrowBench<Narrow>, routine, bulk, rounding)
+                ->ArgsProduct({kSizes});
+        }
+        const std::string name = std::string("convert/") + routine.name + "_to_fp32" + form;
+        benchmark::RegisterBenchmark(name.c_str(), widenBench<Narrow>, routine, bulk)->ArgsProduct({kSizes});
+    }
+}
+
+const bool registered = []()
+{
+    registerRoutine<uint16_t>({"bf16", DType::bf16, &Conversions::fp32_to_bf16, &Conversions::bf16_to_fp32,
+                               &Conversions::fp32_to_bf16, &Conversions::bf16_to_fp32});
+    registerRoutine<uint16_t>({"fp16", DType::fp16, &Conversions::fp32_to_fp16, &Conversions::fp16_to_fp32,
+                               &Conversions::fp32_to_fp16, &Conversions::fp16_to_fp32});
+    registerRoutine<uint32_t>({"tf32", DType::tf32, &Conversions::fp32_to_tf32, &Conversions::tf32_to_fp32,
+                               &Conversions::fp32_to_tf32, &Conversions::tf32_to_fp32});
+    registerRoutine<uint8_t>({"fp8_152", DType::fp8_152, &Conversions::fp32_to_fp8_152,
+                              &Conversions::fp8_152_to_fp32, &Conversions::fp32_to_fp8_152,
+                              &Conversions::fp8_152_to_fp32});
+    registerRoutine<uint8_t>({"fp8_143", DType::fp8_143, &Conversions::fp32_to_fp8_143,
+                              &Conversions::fp8_143_to_fp32, &Conversions::fp32_to_fp8_143,
+                              &Conversions::fp8_143_to_fp32});
+    return true;
+}();
+
+} // anonymous namespace
@@ -0,0 +1,59 @@
+#include "bench_utils.h"
+#include "operations/expression.h"
+#include "operations/operations.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// out = bf16(0.5 * (a*x + z)): as a fused expression, and as the axpy, scal and copy calls it replaces
+// when every step makes its own pass. the GB/s counter counts the minimal traffic of the fused form.
+void expressionBench(benchmark::State& state, DType dtype, bool fused)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    gTensor x = makeTensor(elements, dtype, Layout2D::Dense, 1);
+    gTensor z = makeTensor(elements, dtype, Layout2D::Dense, 2);
+    gTensor tmp = makeTensor(elements, dtype, Layout2D::Dense, 3);
+    gTensor out = makeTensor(elements, DType::bf16, Layout2D::Dense, 4);
+    Operations ops;
+    for (auto _ : state)
+    {
+        gStatus status = gStatus::gBLAS_PASS;
+        if (fused)
+        {
+            status = expr::evaluate(out, 0.5f * (1.5f * expr::ref(x) + expr::ref(z)));
+        }
+        else if (ops.axpy(1.5, x, z, tmp) != gStatus::gBLAS_PASS || ops.scal(0.5, tmp) != gStatus::gBLAS_PASS ||
+                 expr::evaluate(out, expr::ref(tmp)) != gStatus::gBLAS_PASS)
+        {
+            status = gStatus::gBLAS_FAIL;
+        }
+        if (status != gStatus::gBLAS_PASS)
+        {
+            state.SkipWithError("expression failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(elements * (2 * getSingleElementSizeInBytes(dtype) + 2)),
+                  3.0 * elements);
+}
+
+const bool registered = []()
+{
+    for (DType dtype : {DType::fp32, DType::bf16})
+    {
+        for (bool fused : {true, false})
+        {
+            const std::string name = std::string("expression/") + getName(dtype) + (fused ? "/fused" : "/passes");
+            benchmark::RegisterBenchmark(name.c_str(), expressionBench, dtype, fused)
+                ->ArgsProduct({kSizes})
+                ->UseRealTime();
+        }
+    }
+    return true;
+}();
+
+} // anonymous namespace
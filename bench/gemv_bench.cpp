@@ -0,0 +1,57 @@
+#include "bench_utils.h"
+#include "operations/operations.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// decode shaped products: a square weight matrix against a handful of fp32 vectors.
+// the GB/s counter counts the weights only, which is what bounds these shapes.
+void gemvBench(benchmark::State& state, DType dtype, bool transpose)
+{
+    const uint64_t n = static_cast<uint64_t>(state.range(0));
+    const uint64_t batch = static_cast<uint64_t>(state.range(1));
+    gTensor a({n, n, 1, 1, 1}, {1, (int64_t)n, (int64_t)(n * n), (int64_t)(n * n), (int64_t)(n * n)}, 2, dtype);
+    a.allocateData();
+    fillRandom(a.data(), n * n, dtype);
+    const unsigned rank = batch > 1 ? 2 : 1;
+    const TStrideArr strides = {1, (int64_t)n, (int64_t)(n * batch), (int64_t)(n * batch), (int64_t)(n * batch)};
+    gTensor x({n, batch, 1, 1, 1}, strides, rank, DType::fp32);
+    gTensor y({n, batch, 1, 1, 1}, strides, rank, DType::fp32);
+    x.allocateData();
+    y.allocateData();
+    fillRandom(x.data(), n * batch, DType::fp32, 2);
+    Operations ops;
+    for (auto _ : state)
+    {
+        const gStatus status = batch > 1 ? ops.gemvBatched(a, x, y, 1.0, 0.0, transpose)
+                                         : ops.gemv(a, x, y, 1.0, 0.0, transpose);
+        if (status != gStatus::gBLAS_PASS)
+        {
+            state.SkipWithError("gemv failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(n * n * getSingleElementSizeInBytes(dtype)),
+                  2.0 * static_cast<double>(n * n * batch));
+}
+
+const bool registered = []()
+{
+    for (DType dtype : {DType::fp32, DType::bf16, DType::fp16, DType::fp8_152, DType::fp8_143})
+    {
+        for (bool transpose : {false, true})
+        {
+            const std::string name = std::string("gemv/") + getName(dtype) + (transpose ? "/transposed" : "/rows");
+            benchmark::RegisterBenchmark(name.c_str(), gemvBench, dtype, transpose)
+                ->ArgsProduct({{1024, 4096}, {1, 4, 16}})
+                ->UseRealTime();
+        }
+    }
+    return true;
+}();
+
+} // anonymous namespace
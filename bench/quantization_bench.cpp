@@ -0,0 +1,57 @@
+#include "bench_utils.h"
+#include "operations/operations.h"
+#include "operations/quantization.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// quantize a bf16 activation with fresh scales (the per layer requantization) and dequantize it back to
+// bf16. the GB/s counter counts one read and one write of the tensor, the amax pass reads it once more.
+void quantizationBench(benchmark::State& state, DType dtype, ScaleGranularity granularity, bool forward)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    gTensor x = makeTensor(elements, DType::bf16, Layout2D::Dense, 1);
+    const QuantizationScheme scheme{granularity, 0, 32};
+    QuantizedTensor q = makeQuantizedTensor(x, dtype, scheme);
+    Operations ops;
+    if (ops.quantize(x, q) != gStatus::gBLAS_PASS)
+    {
+        state.SkipWithError("quantize failed");
+        return;
+    }
+    for (auto _ : state)
+    {
+        const gStatus status = forward ? ops.quantize(x, q) : ops.dequantize(q, x);
+        if (status != gStatus::gBLAS_PASS)
+        {
+            state.SkipWithError("quantization failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(elements * 3));
+}
+
+const bool registered = []()
+{
+    for (DType dtype : {DType::int8, DType::fp8_143})
+    {
+        for (ScaleGranularity granularity : {ScaleGranularity::PerTensor, ScaleGranularity::PerBlock})
+        {
+            for (bool forward : {true, false})
+            {
+                const std::string name = std::string(forward ? "quantize/" : "dequantize/") + getName(dtype) +
+                                         (granularity == ScaleGranularity::PerTensor ? "/tensor" : "/block32");
+                benchmark::RegisterBenchmark(name.c_str(), quantizationBench, dtype, granularity, forward)
+                    ->ArgsProduct({kSizes})
+                    ->UseRealTime();
+            }
+        }
+    }
+    return true;
+}();
+
+} // anonymous namespace
@@ -0,0 +1,90 @@
+#include "bench_utils.h"
+#include "gTensor/gTensorIterator.h"
+#include "gTensor/TensorView.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// sum every element through operator[](Coordinates)
+void coordinateAccessBench(benchmark::State& state, Layout2D layout)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    gTensor view = makeTensor(elements, DType::fp32, layout);
+    // the coordinate lookup takes rank 5 tensors, the extra dims have size 1
+    gTensor tensor({view.getSize(0), view.getSize(1), 1, 1, 1}, view.getAllStridesInElements(), 5, DType::fp32);
+    tensor.initData(view.data());
+    for (auto _ : state)
+    {
+        float sum = 0.0f;
+        Coordinates coords = {};
+        for (coords[1] = 0; coords[1] < tensor.getSize(1); ++coords[1])
+        {
+            for (coords[0] = 0; coords[0] < tensor.getSize(0); ++coords[0])
+            {
+                sum += *reinterpret_cast<const float*>(tensor[coords]);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    setThroughput(state, static_cast<double>(elements) * sizeof(float), static_cast<double>(elements));
+}
+
+// sum every element through the chunks of the iterator
+void iteratorBench(benchmark::State& state, Layout2D layout)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    gTensor tensor = makeTensor(elements, DType::fp32, layout);
+    gTensorIterator iterator(tensor);
+    for (auto _ : state)
+    {
+        float sum = 0.0f;
+        iterator.forEachChunk([&](const gTensorIterator::Chunk& chunk)
+        {
+            const float* data = chunk.get<const float>(0);
+            const int64_t stride = chunk.strides[0];
+            for (uint64_t i = 0; i < chunk.length; ++i) sum += data[i * stride];
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    setThroughput(state, static_cast<double>(elements) * sizeof(float), static_cast<double>(elements));
+}
+
+// sum every element through a typed view, instantiated for the layout the tensor turns out to have
+void typedViewBench(benchmark::State& state, Layout2D layout)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    const gTensor tensor = makeTensor(elements, DType::fp32, layout);
+    for (auto _ : state)
+    {
+        const float sum = visitTensorView<const float, 2>(tensor, [](const auto& view)
+        {
+            float total = 0.0f;
+            for (uint64_t r = 0; r < view.getSize(1); ++r)
+            {
+                for (uint64_t c = 0; c < view.getSize(0); ++c) total += view(c, r);
+            }
+            return total;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    setThroughput(state, static_cast<double>(elements) * sizeof(float), static_cast<double>(elements));
+}
+
+const bool registered = []()
+{
+    for (Layout2D layout : {Layout2D::Dense, Layout2D::Strided, Layout2D::Transposed})
+    {
+        std::string name = std::string("tensor/coordinate_access/") + getName(layout);
+        benchmark::RegisterBenchmark(name.c_str(), coordinateAccessBench, layout)->ArgsProduct({kSizes});
+        name = std::string("tensor/iterator/") + getName(layout);
+        benchmark::RegisterBenchmark(name.c_str(), iteratorBench, layout)->ArgsProduct({kSizes});
+        name = std::string("tensor/typed_view/") + getName(layout);
+        benchmark::RegisterBenchmark(name.c_str(), typedViewBench, layout)->ArgsProduct({kSizes});
+    }
+    return true;
+}();
+
+} // anonymous namespace
@@ -0,0 +1,43 @@
+#include "bench_utils.h"
+#include "operations/operations.h"
+#include <string>
+
+using namespace gblas;
+using namespace gblas::bench;
+
+namespace {
+
+// exchange the two dims of a dense matrix into a dense result, the layout change between a row major and a
+// col major tensor. the GB/s counter counts one read of the source and one write of the result
+void permuteBench(benchmark::State& state, DType dtype)
+{
+    const uint64_t elements = static_cast<uint64_t>(state.range(0));
+    const gTensor src = makeTensor(elements, dtype, Layout2D::Dense);
+    const int64_t ld = static_cast<int64_t>(src.getSize(1));
+    const int64_t size = ld * static_cast<int64_t>(src.getSize(0));
+    gTensor dst({src.getSize(1), src.getSize(0), 1, 1, 1}, {1, ld, size, size, size}, 2, dtype);
+    dst.allocateData();
+    Operations ops;
+    for (auto _ : state)
+    {
+        if (ops.permute(src, dst, {1, 0, 2, 3, 4}) != gStatus::gBLAS_PASS)
+        {
+            state.SkipWithError("permute failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    setThroughput(state, static_cast<double>(2 * elements * getSingleElementSizeInBytes(dtype)));
+}
+
+const bool registered = []()
+{
+    for (DType dtype : {DType::int8, DType::bf16, DType::fp32, DType::fp64})
+    {
+        const std::string name = std::string("permute/") + getName(dtype);
+        benchmark::RegisterBenchmark(name.c_str(), permuteBench, dtype)->ArgsProduct({kSizes})->UseRealTime();
+    }
+    return true;
+}();
+
+} // anonymous namespace
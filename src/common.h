@@ -1,6 +1,7 @@
 #ifndef GBLAS_COMMON_H
 #define GBLAS_COMMON_H
 
+#include <array>
 #include <cassert>
 #include <cstdint>
 
@@ -29,6 +30,8 @@ enum class DType
     tf32,
     int64,
     fp64,
+    // appended so the values of the other dtypes stay what tensor files store
+    uint8,
     dtypeNR
 };
 
@@ -38,6 +41,7 @@ inline unsigned getSingleElementSizeInBytes(DType dtype)
     {
 
         case DType::int8:
+        case DType::uint8:
         case DType::fp8_152:
         case DType::fp8_143:
             return 1;
@@ -70,6 +74,15 @@ enum class Layout
 
 using Coordinates = std::array<unsigned, MAX_DIM>;
 
+enum class RoundingMode
+{
+    NearestEven,
+    RoundUp,
+    RoundDown,
+    RoundAwayFromZero,
+    RoundTowardsZero
+};
+
 
 } // namespace gblas
 
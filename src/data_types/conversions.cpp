@@ -0,0 +1,59 @@
+#include "conversions.h"
+#include "kernels/kernels.h"
+
+namespace gblas {
+
+constexpr std::array<uint32_t, 65536> kFp16DecodeTable = makeDecodeTable<5, 10>();
+
+void Conversions::fp32_to_bf16(const float* src, uint16_t* dst, size_t n, RoundingMode rounding)
+{
+    kernels::getKernelTable().f32ToBf16(n, src, dst, rounding);
+}
+
+void Conversions::bf16_to_fp32(const uint16_t* src, float* dst, size_t n)
+{
+    kernels::getKernelTable().bf16ToF32(n, src, dst);
+}
+
+void Conversions::fp32_to_fp16(const float* src, uint16_t* dst, size_t n, RoundingMode rounding)
+{
+    kernels::getKernelTable().f32ToFp16(n, src, dst, rounding);
+}
+
+void Conversions::fp16_to_fp32(const uint16_t* src, float* dst, size_t n)
+{
+    kernels::getKernelTable().fp16ToF32(n, src, dst);
+}
+
+void Conversions::fp32_to_tf32(const float* src, uint32_t* dst, size_t n, RoundingMode rounding)
+{
+    kernels::getKernelTable().f32ToTf32(n, src, dst, rounding);
+}
+
+void Conversions::tf32_to_fp32(const uint32_t* src, float* dst, size_t n)
+{
+    // tf32 is stored in the fp32 layout, decoding is a plain copy
+    std::memcpy(dst, src, n * sizeof(float));
+}
+
+void Conversions::fp32_to_fp8_152(const float* src, uint8_t* dst, size_t n, RoundingMode rounding)
+{
+    kernels::getKernelTable().f32ToFp8_152(n, src, dst, rounding);
+}
+
+void Conversions::fp8_152_to_fp32(const uint8_t* src, float* dst, size_t n)
+{
+    kernels::getKernelTable().fp8_152ToF32(n, src, dst);
+}
+
+void Conversions::fp32_to_fp8_143(const float* src, uint8_t* dst, size_t n, RoundingMode rounding)
+{
+    kernels::getKernelTable().f32ToFp8_143(n, src, dst, rounding);
+}
+
+void Conversions::fp8_143_to_fp32(const uint8_t* src, float* dst, size_t n)
+{
+    kernels::getKernelTable().fp8_143ToF32(n, src, dst);
+}
+
+} // namespace gblas
@@ -3,21 +3,67 @@
 #define GBLAS_CONVERSIONS_H
 
 #include <stdint.h>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
+#include "common.h"
 
 namespace gblas {
-template<typename T, typename U>
-concept reinterpretRestriction = requires {sizeof(T) == sizeof(U) && std::is_const<T>() == std::is_const<U>();};
+// decodes an IEEE like float with E exponent and M mantissa bits to fp32 bits. the all ones exponent is
+// inf or NaN, every NaN decodes to the same positive quiet NaN.
+template<unsigned E, unsigned M>
+constexpr uint32_t decodeMinifloat(uint32_t valAsBits)
+{
+    constexpr uint32_t bias = (1u << (E - 1)) - 1;
+    constexpr uint32_t maxExponent = (1u << E) - 1;
+    constexpr uint32_t mantissaMask = (1u << M) - 1;
+    uint32_t sign = (valAsBits >> (E + M)) & 1;
+    uint32_t exponent = (valAsBits >> M) & maxExponent;
+    uint32_t mantissa = valAsBits & mantissaMask;
+    if (exponent == maxExponent)
+    {
+        return mantissa == 0 ? (sign << 31) | 0x7F800000 : 0x7FC00000;
+    }
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            return sign << 31;
+        }
+        // subnormal, renormalize so the leading one becomes implicit
+        int32_t adjusted = 1;
+        while (!(mantissa & (1u << M)))
+        {
+            mantissa <<= 1;
+            adjusted--;
+        }
+        return (sign << 31) | (static_cast<uint32_t>(adjusted - static_cast<int32_t>(bias) + 127) << 23) |
+               ((mantissa & mantissaMask) << (23 - M));
+    }
+    return (sign << 31) | ((exponent - bias + 127) << 23) | (mantissa << (23 - M));
+}
 
-enum class RoundingMode
+// fp32 bits of every encoding, a decode is one lookup
+template<unsigned E, unsigned M>
+constexpr std::array<uint32_t, (1u << (1 + E + M))> makeDecodeTable()
 {
-    NearestEven,
-    RoundUp,
-    RoundDown,
-    RoundAwayFromZero,
-    RoundTowardsZero
-};
+    std::array<uint32_t, (1u << (1 + E + M))> table{};
+    for (uint32_t bits = 0; bits < table.size(); ++bits)
+    {
+        table[bits] = decodeMinifloat<E, M>(bits);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint32_t, 256> kFp8_152DecodeTable = makeDecodeTable<5, 2>();
+inline constexpr std::array<uint32_t, 256> kFp8_143DecodeTable = makeDecodeTable<4, 3>();
+// 256KB, so it is built once in conversions.cpp instead of in every translation unit
+extern const std::array<uint32_t, 65536> kFp16DecodeTable;
+
+template<typename T, typename U>
+concept reinterpretRestriction = requires {sizeof(T) == sizeof(U) && std::is_const<T>() == std::is_const<U>();};
 
 class Conversions
 {
@@ -34,6 +80,11 @@ public:
         auto floatInBits = reinterpret_ptr<const uint32_t>(&val);
         // need to extract the first 16 bits , and round
         result = static_cast<uint16_t>(floatInBits >> 16);
+        if ((floatInBits & 0x7FFFFFFF) > 0x7F800000)
+        {
+            // NaN, truncation could drop the whole payload and produce inf, so keep it quiet
+            return result | 0x0040;
+        }
         uint32_t lowerBits = floatInBits & 0xFFFF;
         bool isPositive = (floatInBits & 0x80000000) == 0;
         switch (rounding)
@@ -42,6 +93,7 @@ public:
                 if (lowerBits > 0x8000) result++;
                 // tiebreaker - check if value is odd\even
                 if (lowerBits == 0x8000 && (result & 1)) result++;
+                break;
             case RoundingMode::RoundUp:
                 if (lowerBits != 0 && isPositive)
                 {
@@ -56,12 +108,8 @@ public:
                 }
                 break;
             case RoundingMode::RoundAwayFromZero:
-                if (lowerBits != 0)
-                {
-                    if (isPositive) result++;
-                    // check we don't increment -0 case.
-                    if (result != 0x8000) result++;
-                }
+                // incrementing the magnitude moves away from zero for both signs
+                if (lowerBits != 0) result++;
                 break;
             case RoundingMode::RoundTowardsZero:
                 // truncation is enough
@@ -123,10 +171,11 @@ public:
             mantissa >>= 13;
         } else {  // Subnormal number
             mantissa |= 0x800000;  // Add implicit leading 1
+            // the value is mantissa * 2^(adjustedExponent - 14 - 23) and a subnormal fp16 counts units of 2^-24
             int32_t shift = 14 - adjustedExponent;
-            roundBit = (mantissa >> shift) & 1;
-            stickyBit = (mantissa & ((1 << shift) - 1)) != 0;
-            mantissa >>= (shift + 1);
+            roundBit = (mantissa >> (shift - 1)) & 1;
+            stickyBit = (mantissa & ((1u << (shift - 1)) - 1)) != 0;
+            mantissa >>= shift;
             adjustedExponent = 0;
         }
 
@@ -170,76 +219,29 @@ public:
     }
     static float fp16_to_fp32(const uint16_t& valAsBits)
     {
-        // Extract components of fp16
-        uint32_t sign = valAsBits >> 15;
-        uint32_t exponent = (valAsBits >> 10) & 0x1F;
-        uint32_t mantissa = valAsBits & 0x3FF;
-
-        uint32_t floatInBits;
-
-        if (exponent == 0)
-        {  // Zero or subnormal number
-            if (mantissa == 0)
-            {
-                // Zero
-                return sign ? -0.0f : 0.0f;
-            }
-            else
-            {
-                // Subnormal number -- renormalize
-                while (!(mantissa & 0x400))
-                {
-                    mantissa <<= 1;
-                    exponent -= 1;
-                }
-                exponent += 1;
-                mantissa &= ~0x400;
-            }
-        }
-        else if (exponent == 31)
-        {
-            if (mantissa == 0)
-            {
-                // Infinity
-                return sign ? -INFINITY : INFINITY;
-            }
-            else
-            {
-                return NAN;
-            }
-        }
-        // Convert to fp32 and adjust exponent
-        floatInBits = (sign << 31) | ((exponent + 112) << 23) | (mantissa << 13);
-
-        return reinterpret_ptr<float>(&floatInBits);
+        return std::bit_cast<float>(kFp16DecodeTable[valAsBits]);
     }
     static uint32_t fp32_to_tf32(const float& val, RoundingMode rounding)
     {
+        // tf32 keeps the fp32 layout with the 13 low mantissa bits cleared
         auto floatInBits = reinterpret_ptr<const uint32_t>(&val);
-
-        // Extract components of fp32
         uint32_t sign = floatInBits >> 31;
-        uint32_t exponent = (floatInBits >> 23) & 0xFF;
-        uint32_t mantissa = floatInBits & 0x7FFFFF;
 
-        uint32_t result;
-
-        // Handle special cases: ±0, ±inf, NaN
-        if (exponent == 0 || exponent == 0x7F800000)
+        // Handle special cases: NaN stays a quiet NaN, inf and zero have no bits to round
+        if ((floatInBits & 0x7FFFFFFF) > 0x7F800000)
         {
-            result = floatInBits; // These cases are identical in tf32
-            return result;
+            return (floatInBits & 0xFFFFE000) | 0x00400000;
         }
 
         // Round the mantissa
-        uint32_t roundBit = (mantissa >> 13) & 1;
-        uint32_t stickyBit = (mantissa & 0x1FFF) != 0;
+        uint32_t roundBit = (floatInBits >> 12) & 1;
+        uint32_t stickyBit = (floatInBits & 0xFFF) != 0;
 
         bool shouldRoundUp = false;
         switch (rounding)
         {
             case RoundingMode::NearestEven:
-                shouldRoundUp = roundBit && (stickyBit || ((mantissa >> 14) & 1));
+                shouldRoundUp = roundBit && (stickyBit || ((floatInBits >> 13) & 1));
                 break;
             case RoundingMode::RoundUp:
                 shouldRoundUp = (sign == 0) && (roundBit || stickyBit);
@@ -255,19 +257,12 @@ public:
                 break;
         }
 
-        mantissa >>= 13; // keep top 10 bits of mantissa for tf32
+        // Compose the tf32, a mantissa overflow carries into the exponent (and up to inf)
+        uint32_t result = floatInBits & 0xFFFFE000;
         if (shouldRoundUp)
         {
-            mantissa++;
-            if (mantissa == 0x400)
-            { // Mantissa overflow
-                mantissa = 0;
-                exponent += 0x00800000;
-            }
+            result += 0x2000;
         }
-
-        // Compose the tf32
-        result = sign | exponent | mantissa;
         return result;
     }
     static float tf32_to_fp32(const uint32_t& valAsBits)
@@ -306,13 +301,13 @@ public:
         }
         if (adjustedExponent > 30)
         {
-            result = (sign << 7) | 0x7F;  // Overflow to ±inf
+            result = (sign << 7) | 0x7C;  // Overflow to ±inf
             return result;
         }
 
         // Prepare mantissa for rounding (keep top 2 bits for fp8)
         uint32_t roundBit = (mantissa >> 20) & 1;
-        uint32_t stickyBit = (mantissa & 0x1FFFFF) != 0;
+        uint32_t stickyBit = (mantissa & 0xFFFFF) != 0;
         mantissa >>= 21;  // Keep top 2 bits for fp8 mantissa
 
         // Apply rounding
@@ -342,7 +337,7 @@ public:
                 mantissa = 0;
                 adjustedExponent++;
                 if (adjustedExponent > 30) {
-                    result = (sign << 7) | 0x7F;  // Overflow to ±inf
+                    result = (sign << 7) | 0x7C;  // Overflow to ±inf
                     return result;
                 }
             }
@@ -384,13 +379,13 @@ public:
         }
         if (adjustedExponent > 14)
         {
-            result = (sign << 7) | 0x7F;  // Overflow to ±inf
+            result = (sign << 7) | 0x78;  // Overflow to ±inf
             return result;
         }
 
         // Prepare mantissa for rounding (keep top 3 bits for fp8)
         uint32_t roundBit = (mantissa >> 19) & 1;
-        uint32_t stickyBit = (mantissa & 0xFFFFF) != 0;
+        uint32_t stickyBit = (mantissa & 0x7FFFF) != 0;
         // Keep 3 leading bits
         mantissa >>= 20;
 
@@ -422,7 +417,7 @@ public:
                 mantissa = 0;
                 adjustedExponent++;
                 if (adjustedExponent > 14) {
-                    result = (sign << 7) | 0x7F;  // Overflow to ±inf
+                    result = (sign << 7) | 0x78;  // Overflow to ±inf
                     return result;
                 }
             }
@@ -434,94 +429,25 @@ public:
     }
     static float fp8_152_to_fp32(const uint8_t& valAsBits)
     {
-        uint32_t sign = valAsBits >> 7;
-        uint32_t exponent = (valAsBits >> 2) & 0x1F;
-        uint32_t mantissa = valAsBits & 0x3;
-        uint32_t floatInBits;
-        if (exponent == 0)
-        {
-            if (mantissa == 0)
-            {
-                // Zero
-                return sign ? -0.0f : 0.0f;
-            }
-            else
-            {
-                // Subnormal number
-                exponent = 1;
-                while (!(mantissa & 0x4)) {
-                    mantissa <<= 1;
-                    exponent--;
-                }
-                mantissa &= 0x3;
-                floatInBits = (sign << 31) | ((exponent + 112) << 23) | (mantissa << 21);
-            }
-        }
-        else if (exponent == 31)
-        {
-            if (mantissa == 0)
-            {
-                // Infinity
-                return sign ? -INFINITY : INFINITY;
-            }
-            else
-            {
-                // NaN
-                return NAN;
-            }
-        }
-        else
-        {
-            // Normal number
-            floatInBits = (sign << 31) | ((exponent + 112) << 23) | (mantissa << 21);
-        }
-        return reinterpret_ptr<float>(&floatInBits);
+        return std::bit_cast<float>(kFp8_152DecodeTable[valAsBits]);
     }
     static float fp8_143_to_fp32(const uint8_t& valAsBits)
     {
-        uint32_t sign = valAsBits >> 7;
-        uint32_t exponent = (valAsBits >> 3) & 0xF;
-        uint32_t mantissa = valAsBits & 0x7;
-        uint32_t floatInBits;
-
-        if (exponent == 0)
-        {
-            if (mantissa == 0)
-            {
-                // Zero
-                return sign ? -0.0f : 0.0f;
-            }
-            else
-            {
-                // Subnormal number
-                exponent = 1;
-                while (!(mantissa & 0x8)) {
-                    mantissa <<= 1;
-                    exponent--;
-                }
-                mantissa &= 0x7;
-                floatInBits = (sign << 31) | ((exponent + 120) << 23) | (mantissa << 20);
-            }
-        }
-        else if (exponent == 0xF)
-        {
-            if (mantissa == 0)
-            {
-                // Infinity
-                return sign ? -INFINITY : INFINITY;
-            } else {
-                // NaN
-                return NAN;
-            }
-        }
-        else
-        {
-            // Normal number
-            floatInBits = (sign << 31) | ((exponent + 120) << 23) | (mantissa << 20);
-        }
-        return reinterpret_ptr<float>(&floatInBits);
+        return std::bit_cast<float>(kFp8_143DecodeTable[valAsBits]);
     }
 
+    // bulk conversions of contiguous arrays, vectorized for the host cpu and bit identical to the
+    // scalar conversions above for every input and rounding mode. src and dst must not overlap.
+    static void fp32_to_bf16(const float* src, uint16_t* dst, size_t n, RoundingMode rounding);
+    static void bf16_to_fp32(const uint16_t* src, float* dst, size_t n);
+    static void fp32_to_fp16(const float* src, uint16_t* dst, size_t n, RoundingMode rounding);
+    static void fp16_to_fp32(const uint16_t* src, float* dst, size_t n);
+    static void fp32_to_tf32(const float* src, uint32_t* dst, size_t n, RoundingMode rounding);
+    static void tf32_to_fp32(const uint32_t* src, float* dst, size_t n);
+    static void fp32_to_fp8_152(const float* src, uint8_t* dst, size_t n, RoundingMode rounding);
+    static void fp8_152_to_fp32(const uint8_t* src, float* dst, size_t n);
+    static void fp32_to_fp8_143(const float* src, uint8_t* dst, size_t n, RoundingMode rounding);
+    static void fp8_143_to_fp32(const uint8_t* src, float* dst, size_t n);
 };
 
 
@@ -1,86 +1,52 @@
-#include "DataBuffer.h"
-#include <iostream>
-#include <cassert>
-
-namespace gblas {
-
-DataBuffer::DataBuffer(uint64_t size)
-{
-    m_buffer = new byte[size];
-    m_size = size;
-    shouldFreeOnDtor = true;
-}
-
-DataBuffer::DataBuffer(uint64_t size, byte* data)
-{
-    m_buffer = data;
-    m_size = size;
-    shouldFreeOnDtor = true;
-}
-
-DataBuffer::~DataBuffer()
-{
-    if (shouldFreeOnDtor && m_buffer)
-    {
-        delete[](m_buffer);
-    }
-}
-
-DataBuffer::DataBuffer(const DataBuffer &other) : m_size(other.m_size)
-{
-    if (other.m_buffer)
-    {
-        m_buffer = new byte[m_size];
-        assert(m_buffer);
-        std::memcpy(m_buffer, other.m_buffer, m_size);
-        shouldFreeOnDtor = true;
-    }
-}
-
-DataBuffer &DataBuffer::operator=(const DataBuffer &other)
-{
-    if (this != &other)
-    {
-        if (shouldFreeOnDtor && m_buffer)
-        {
-            delete[](m_buffer);
-        }
-        m_buffer = nullptr;
-        m_size = other.m_size;
-        if (other.m_buffer)
-        {
-            m_buffer = new byte[m_size];
-            assert(m_buffer);
-            std::memcpy(m_buffer, other.m_buffer, m_size);
-            shouldFreeOnDtor = true;
-        }
-    }
-    return *this;
-}
-
-DataBuffer::DataBuffer(DataBuffer &&other) noexcept: m_buffer(other.m_buffer), m_size(other.m_size), shouldFreeOnDtor(other.shouldFreeOnDtor)
-{
-    other.m_buffer = nullptr;
-    other.m_size = 0;
-}
-
-DataBuffer &DataBuffer::operator=(DataBuffer &&other) noexcept
-{
-    if (this != &other)
-    {
-        if (shouldFreeOnDtor && m_buffer)
-        {
-            free(m_buffer);
-        }
-
-        m_buffer = other.m_buffer;
-        m_size = other.m_size;
-        shouldFreeOnDtor = other.shouldFreeOnDtor;
-
-        other.m_buffer = nullptr;
-        other.m_size = 0;
-    }
-    return *this;
-}
-
-} // gblas
\ No newline at end of file
+#include "DataBuffer.h"
+#include "runtime/Allocator.h"
+#include <utility>
+
+namespace gblas {
+
+DataBuffer::DataBuffer(uint64_t size) : DataBuffer(size, getDefaultAllocator())
+{
+}
+
+DataBuffer::DataBuffer(uint64_t size, Allocator& allocator) : m_size(size), m_allocator(&allocator)
+{
+    Allocator* source = &allocator;
+    m_storage = std::shared_ptr<byte>(allocator.allocate(size), [source, size](byte* ptr) {source->deallocate(ptr, size);});
+}
+
+DataBuffer::DataBuffer(uint64_t size, byte* data) : m_size(size)
+{
+    // aliasing an empty owner keeps the pointer without a control block, nothing is ever freed
+    m_storage = std::shared_ptr<byte>(std::shared_ptr<byte>(), data);
+}
+
+DataBuffer::DataBuffer(uint64_t size, std::shared_ptr<byte> storage) : m_storage(std::move(storage)), m_size(size)
+{
+}
+
+DataBuffer::DataBuffer(DataBuffer &&other) noexcept
+    : m_storage(std::move(other.m_storage)), m_size(std::exchange(other.m_size, 0)),
+      m_allocator(std::exchange(other.m_allocator, nullptr))
+{
+}
+
+DataBuffer &DataBuffer::operator=(DataBuffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        m_storage = std::move(other.m_storage);
+        m_size = std::exchange(other.m_size, 0);
+        m_allocator = std::exchange(other.m_allocator, nullptr);
+    }
+    return *this;
+}
+
+DataBuffer DataBuffer::clone() const
+{
+    if (!data()) return DataBuffer();
+    DataBuffer copy(m_size, m_allocator ? *m_allocator : getDefaultAllocator());
+    std::memcpy(copy.data(), data(), m_size);
+    return copy;
+}
+
+} // gblas
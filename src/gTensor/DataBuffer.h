@@ -1,40 +1,62 @@
-#ifndef GBLAS_DATABUFFER_H
-#define GBLAS_DATABUFFER_H
-#include <cstdint>
-#include <cstring>
-
-namespace gblas {
-using byte = uint8_t;
-
-class DataBuffer {
-public:
-    DataBuffer() = default;
-    explicit DataBuffer(uint64_t sizeInBytes);
-    DataBuffer(uint64_t sizeInBytes, byte* data);
-    ~DataBuffer();
-    DataBuffer(const DataBuffer& other);
-    DataBuffer& operator=(const DataBuffer& other);
-    DataBuffer(DataBuffer&& other) noexcept;
-    DataBuffer& operator=(DataBuffer&& other) noexcept;
-    bool operator==(const DataBuffer& other) const
-    {
-        return (m_size == other.m_size) && (std::memcmp(m_buffer, other.m_buffer, m_size) == 0);
-    }
-    bool operator!=(const DataBuffer& other) const
-    {
-        return !operator==(other);
-    }
-    byte* operator[](unsigned i) {return &m_buffer[i];}
-    const byte* operator[](unsigned i) const {return &m_buffer[i];}
-private:
-    bool shouldFreeOnDtor = false;
-    byte* m_buffer = nullptr;
-    unsigned m_size = 0;
-};
-
-
-
-
-} // gblas
-
-#endif //GBLAS_DATABUFFER_H
+#ifndef GBLAS_DATABUFFER_H
+#define GBLAS_DATABUFFER_H
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace gblas {
+using byte = uint8_t;
+class Allocator;
+
+/// the bytes of a tensor. copies share the storage, a copy of the contents is an explicit clone().
+/// a buffer either owns its storage together with the other buffers sharing it (allocated from an
+/// Allocator, or handed in as a shared_ptr) or is a view of memory owned by someone else.
+class DataBuffer {
+public:
+    DataBuffer() = default;
+    /// owning, allocated from the default allocator
+    explicit DataBuffer(uint64_t sizeInBytes);
+    /// owning, allocated from the given allocator, which must outlive the storage
+    DataBuffer(uint64_t sizeInBytes, Allocator& allocator);
+    /// non owning view, the caller keeps data alive and frees it
+    DataBuffer(uint64_t sizeInBytes, byte* data);
+    /// shares ownership of storage owned elsewhere
+    DataBuffer(uint64_t sizeInBytes, std::shared_ptr<byte> storage);
+    ~DataBuffer() = default;
+    DataBuffer(const DataBuffer& other) = default;
+    DataBuffer& operator=(const DataBuffer& other) = default;
+    DataBuffer(DataBuffer&& other) noexcept;
+    DataBuffer& operator=(DataBuffer&& other) noexcept;
+    bool operator==(const DataBuffer& other) const
+    {
+        return (m_size == other.m_size) && (std::memcmp(data(), other.data(), m_size) == 0);
+    }
+    bool operator!=(const DataBuffer& other) const
+    {
+        return !operator==(other);
+    }
+    byte* operator[](uint64_t i) {return data() + i;}
+    const byte* operator[](uint64_t i) const {return data() + i;}
+    byte* data() {return m_storage.get();}
+    const byte* data() const {return m_storage.get();}
+    uint64_t size() const {return m_size;}
+    /// an owning copy of the contents, from the same allocator when this buffer has one
+    DataBuffer clone() const;
+    /// false for views, which keep nothing alive
+    bool isOwning() const {return m_storage.use_count() > 0;}
+    /// number of buffers sharing the storage, 0 for views
+    long getUseCount() const {return m_storage.use_count();}
+    /// the allocator the storage came from, nullptr for views and storage handed in
+    Allocator* getAllocator() const {return m_allocator;}
+private:
+    std::shared_ptr<byte> m_storage;
+    uint64_t m_size = 0;
+    Allocator* m_allocator = nullptr;
+};
+
+
+
+
+} // gblas
+
+#endif //GBLAS_DATABUFFER_H
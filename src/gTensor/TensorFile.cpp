@@ -0,0 +1,291 @@
+#include "TensorFile.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GBLAS_HAS_MMAP 1
+#endif
+
+namespace gblas {
+
+namespace {
+
+constexpr char kMagic[8] = {'g', 'B', 'L', 'A', 'S', 'T', 'F', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numOfTensors;
+    uint64_t alignment;
+    uint64_t fileSize;
+};
+static_assert(sizeof(FileHeader) == 32, "the file header layout is part of the format");
+
+// followed by nameLength bytes of name, padded to 8 bytes
+struct TensorRecord
+{
+    uint64_t sizes[MAX_DIM];
+    int64_t strides[MAX_DIM];
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint32_t rank;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t nameLength;
+};
+static_assert(sizeof(TensorRecord) == 112, "the tensor record layout is part of the format");
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t getRecordSize(const std::string& name)
+{
+    return sizeof(TensorRecord) + alignUp(name.size(), 8);
+}
+
+// the bytes spanned by the tensor of a record, the sum of getMemorySizeInBytes() with every step checked since
+// the sizes and strides come from the file. false when it does not fit 64 bits
+bool getRecordExtent(const TensorRecord& record, uint64_t& extent)
+{
+    const uint64_t elementSize = getSingleElementSizeInBytes(static_cast<DType>(record.dtype));
+    extent = 0;
+    if (std::find(record.sizes, record.sizes + record.rank, 0) != record.sizes + record.rank) return true;
+    uint64_t maxOffset = 0;
+    for (unsigned dim = 0; dim < record.rank; ++dim)
+    {
+        if (record.strides[dim] == std::numeric_limits<int64_t>::min()) return false;
+        const uint64_t stride = static_cast<uint64_t>(std::abs(record.strides[dim]));
+        const uint64_t steps = record.sizes[dim] - 1;
+        if (stride && steps > std::numeric_limits<uint64_t>::max() / stride) return false;
+        if (steps * stride > std::numeric_limits<uint64_t>::max() - maxOffset) return false;
+        maxOffset += steps * stride;
+    }
+    if (maxOffset >= std::numeric_limits<uint64_t>::max() / elementSize) return false;
+    extent = (maxOffset + 1) * elementSize;
+    return true;
+}
+
+} // anonymous namespace
+
+void saveTensorFile(const std::string& path, const std::vector<TensorFileEntry>& entries, uint64_t alignment)
+{
+    if (alignment < kCacheLineSize || !std::has_single_bit(alignment))
+    {
+        throw std::invalid_argument("tensor file alignment must be a power of two of at least a cache line");
+    }
+    std::unordered_set<std::string> names;
+    uint64_t offset = sizeof(FileHeader);
+    for (const TensorFileEntry& entry : entries)
+    {
+        if (!names.insert(entry.name).second) throw std::invalid_argument("tensor file names must be unique");
+        if (entry.tensor.getTotalSizeInElements() && !entry.tensor.data())
+        {
+            throw std::invalid_argument("tensor file entry has no data");
+        }
+        offset += getRecordSize(entry.name);
+    }
+
+    // lay the data out after the records
+    std::vector<TensorRecord> records(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const gTensor& tensor = entries[i].tensor;
+        TensorRecord& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        for (unsigned dim = 0; dim < MAX_DIM; ++dim)
+        {
+            record.sizes[dim] = tensor.getSize(dim);
+            record.strides[dim] = tensor.getStride(dim);
+        }
+        record.rank = tensor.getRank();
+        record.dtype = static_cast<uint32_t>(tensor.getDType());
+        record.layout = static_cast<uint32_t>(tensor.getLayout());
+        record.nameLength = static_cast<uint32_t>(entries[i].name.size());
+        record.dataSize = tensor.getMemorySizeInBytes();
+        offset = alignUp(offset, alignment);
+        record.dataOffset = offset;
+        offset += record.dataSize;
+    }
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.numOfTensors = static_cast<uint32_t>(entries.size());
+    header.alignment = alignment;
+    header.fileSize = offset;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("cannot open " + path + " for writing");
+    const char padding[8] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const std::string& name = entries[i].name;
+        file.write(reinterpret_cast<const char*>(&records[i]), sizeof(TensorRecord));
+        file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        file.write(padding, static_cast<std::streamsize>(alignUp(name.size(), 8) - name.size()));
+    }
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const uint64_t position = static_cast<uint64_t>(file.tellp());
+        for (uint64_t gap = records[i].dataOffset - position; gap > 0;)
+        {
+            const uint64_t count = std::min<uint64_t>(gap, sizeof(padding));
+            file.write(padding, static_cast<std::streamsize>(count));
+            gap -= count;
+        }
+        file.write(reinterpret_cast<const char*>(entries[i].tensor.data()),
+                   static_cast<std::streamsize>(records[i].dataSize));
+    }
+    file.flush();
+    if (!file) throw std::runtime_error("failed writing " + path);
+}
+
+/// the mapped file, or a heap copy of it where mmap is not available
+struct MappedTensorFile::Mapping
+{
+    byte* data = nullptr;
+    uint64_t size = 0;
+    DataBuffer copy;
+
+    ~Mapping()
+    {
+#if defined(GBLAS_HAS_MMAP)
+        if (data && !copy.data()) munmap(data, size);
+#endif
+    }
+};
+
+MappedTensorFile::MappedTensorFile(const std::string& path, MapHint hint) : m_mapping(std::make_shared<Mapping>())
+{
+#if defined(GBLAS_HAS_MMAP)
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("cannot open " + path);
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+        close(fd);
+        throw std::runtime_error(path + " is not a tensor file");
+    }
+    m_size = static_cast<uint64_t>(info.st_size);
+    int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+    if (hint == MapHint::Populate) flags |= MAP_POPULATE;
+#endif
+    // private and writable: pages stay shared with the page cache until a tensor is written to
+    void* address = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+    m_mapping->data = static_cast<byte*>(address);
+    m_mapping->size = m_size;
+    switch (hint)
+    {
+        case MapHint::Sequential: madvise(address, m_size, MADV_SEQUENTIAL); break;
+        case MapHint::Random: madvise(address, m_size, MADV_RANDOM); break;
+        case MapHint::WillNeed: madvise(address, m_size, MADV_WILLNEED); break;
+        default: break;
+    }
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    m_size = static_cast<uint64_t>(file.tellg());
+    if (m_size < sizeof(FileHeader)) throw std::runtime_error(path + " is not a tensor file");
+    m_mapping->copy = DataBuffer(m_size);
+    m_mapping->data = m_mapping->copy.data();
+    m_mapping->size = m_size;
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_mapping->data), static_cast<std::streamsize>(m_size));
+    if (!file) throw std::runtime_error("failed reading " + path);
+#endif
+
+    // every field is checked against the file before a tensor is built on it
+    const byte* base = m_mapping->data;
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.fileSize != m_size)
+    {
+        throw std::runtime_error(path + " is not a tensor file of this version");
+    }
+    if (header.alignment < kCacheLineSize || !std::has_single_bit(header.alignment))
+    {
+        throw std::runtime_error(path + " has an invalid alignment");
+    }
+    uint64_t offset = sizeof(FileHeader);
+    m_entries.reserve(header.numOfTensors);
+    for (uint32_t i = 0; i < header.numOfTensors; ++i)
+    {
+        TensorRecord record;
+        if (offset + sizeof(record) > m_size) throw std::runtime_error(path + " is truncated");
+        std::memcpy(&record, base + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.nameLength > m_size - offset) throw std::runtime_error(path + " is truncated");
+        std::string name(reinterpret_cast<const char*>(base + offset), record.nameLength);
+        offset += alignUp(record.nameLength, 8);
+        if (record.rank == 0 || record.rank > MAX_DIM || record.dtype >= static_cast<uint32_t>(DType::dtypeNR) ||
+            record.layout >= static_cast<uint32_t>(Layout::LayoutNR))
+        {
+            throw std::runtime_error(path + " has an invalid record for " + name);
+        }
+        uint64_t extent = 0;
+        if (!getRecordExtent(record, extent) || extent != record.dataSize || record.dataOffset > m_size ||
+            record.dataSize > m_size - record.dataOffset || record.dataOffset % header.alignment != 0)
+        {
+            throw std::runtime_error(path + " has an invalid extent for " + name);
+        }
+        TSizeArr sizes;
+        TStrideArr strides;
+        std::copy(record.sizes, record.sizes + MAX_DIM, sizes.begin());
+        std::copy(record.strides, record.strides + MAX_DIM, strides.begin());
+        gTensor tensor(sizes, strides, record.rank, static_cast<DType>(record.dtype),
+                       static_cast<Layout>(record.layout));
+        if (record.dataSize)
+        {
+            // aliases the mapping: the tensor keeps it alive without owning a buffer of its own
+            tensor.initData(std::shared_ptr<byte>(m_mapping, m_mapping->data + record.dataOffset));
+        }
+        m_entries.push_back({std::move(name), std::move(tensor)});
+    }
+}
+
+bool MappedTensorFile::contains(const std::string& name) const
+{
+    return std::any_of(m_entries.begin(), m_entries.end(), [&](const TensorFileEntry& e) {return e.name == name;});
+}
+
+const gTensor& MappedTensorFile::getTensor(const std::string& name) const
+{
+    for (const TensorFileEntry& entry : m_entries)
+    {
+        if (entry.name == name) return entry.tensor;
+    }
+    throw std::out_of_range("no tensor named " + name);
+}
+
+void MappedTensorFile::prefetch(uint64_t index) const
+{
+    const gTensor& tensor = getTensor(index);
+#if defined(GBLAS_HAS_MMAP)
+    if (!tensor.data()) return;
+    // madvise wants a page aligned start
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(tensor.data()) & ~(static_cast<uintptr_t>(kPageSize) - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(tensor.data()) + tensor.getMemorySizeInBytes();
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#else
+    (void)tensor;
+#endif
+}
+
+} // namespace gblas
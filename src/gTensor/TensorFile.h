@@ -0,0 +1,73 @@
+#ifndef GBLAS_TENSORFILE_H
+#define GBLAS_TENSORFILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gTensor.h"
+#include "runtime/Allocator.h"
+
+namespace gblas {
+
+/// a gBLAS tensor file holds named tensors ready to be mapped into memory:
+///   a header (magic "gBLASTF", version, number of tensors, data alignment, file size),
+///   a record per tensor (sizes, strides, rank, dtype, layout, offset and size of its data, then its name),
+///   the data of every tensor, each starting on a multiple of the alignment.
+/// the data is the tensor's memory extent as it is in memory, so strides and views survive the trip.
+/// fields are stored in the host byte order.
+struct TensorFileEntry
+{
+    std::string name;
+    gTensor tensor;
+};
+
+/// write the tensors to path, replacing the file. alignment is a power of two of at least a cache line, page
+/// alignment lets every tensor be advised on its own. throws std::invalid_argument for a bad alignment, a
+/// tensor without data or a repeated name, and std::runtime_error when the file cannot be written.
+void saveTensorFile(const std::string& path, const std::vector<TensorFileEntry>& entries,
+                    uint64_t alignment = kPageSize);
+
+/// how the mapping will be read, passed on to the kernel with madvise
+enum class MapHint
+{
+    None,
+    /// read front to back once, read ahead aggressively and drop pages behind
+    Sequential,
+    /// read in no particular order, no read ahead
+    Random,
+    /// start reading the whole file in the background now
+    WillNeed,
+    /// read the whole file before the constructor returns, no page faults afterwards
+    Populate,
+};
+
+/// a tensor file mapped into memory. the tensors it hands out point straight into the mapping: loading
+/// copies nothing and costs no more than the page faults on the data that is touched. the mapping is
+/// private, writing to a tensor changes the process's copy of the page and never the file. every tensor
+/// shares ownership of the mapping, so tensors stay valid after the file object is gone.
+class MappedTensorFile
+{
+public:
+    /// throws std::runtime_error when the file cannot be mapped or is not a valid tensor file
+    explicit MappedTensorFile(const std::string& path, MapHint hint = MapHint::None);
+
+    uint64_t getNumOfTensors() const {return m_entries.size();}
+    const std::string& getName(uint64_t index) const {return m_entries.at(index).name;}
+    bool contains(const std::string& name) const;
+    /// throws std::out_of_range for an unknown index or name
+    const gTensor& getTensor(uint64_t index) const {return m_entries.at(index).tensor;}
+    const gTensor& getTensor(const std::string& name) const;
+    /// ask the kernel to start reading the tensor's pages in the background
+    void prefetch(uint64_t index) const;
+    uint64_t getFileSize() const {return m_size;}
+private:
+    struct Mapping;
+    std::shared_ptr<Mapping> m_mapping;
+    uint64_t m_size = 0;
+    std::vector<TensorFileEntry> m_entries;
+};
+
+} // namespace gblas
+
+#endif //GBLAS_TENSORFILE_H
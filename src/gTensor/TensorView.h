@@ -0,0 +1,141 @@
+#ifndef GBLAS_TENSORVIEW_H
+#define GBLAS_TENSORVIEW_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "gTensor.h"
+#include "data_types/bfloat16.h"
+#include "data_types/float16.h"
+#include "data_types/float8.h"
+
+namespace gblas {
+
+/// whether the elements of dtype can be accessed as T: the element classes of data_types, the fundamental
+/// types, and the unsigned integers the kernels keep low precision bits in
+template<typename T>
+constexpr bool isStorageOf(DType dtype)
+{
+    using U = std::remove_const_t<T>;
+    switch (dtype)
+    {
+        case DType::int8: return std::is_same_v<U, int8_t>;
+        case DType::uint8: return std::is_same_v<U, uint8_t>;
+        case DType::fp8_152: return std::is_same_v<U, fp8_152> || std::is_same_v<U, uint8_t>;
+        case DType::fp8_143: return std::is_same_v<U, fp8_143> || std::is_same_v<U, uint8_t>;
+        case DType::int16: return std::is_same_v<U, int16_t>;
+        case DType::fp16: return std::is_same_v<U, Float16> || std::is_same_v<U, uint16_t>;
+        case DType::bf16: return std::is_same_v<U, Bfloat16> || std::is_same_v<U, uint16_t>;
+        case DType::int32: return std::is_same_v<U, int32_t>;
+        case DType::fp32: return std::is_same_v<U, float>;
+        case DType::tf32: return std::is_same_v<U, uint32_t>;
+        case DType::int64: return std::is_same_v<U, int64_t>;
+        case DType::fp64: return std::is_same_v<U, double>;
+        default: return false;
+    }
+}
+
+/// a typed view of a gTensor, with the element type, the rank and whether dim 0 has a unit stride fixed at
+/// compile time. the tensor is checked once when the view is made; element access is then index math on a
+/// T*, with a constant trip count the compiler unrolls and no dtype switch or bounds check.
+/// the view does not own the data. a view of const T reads a const gTensor.
+template<typename T, unsigned Rank, bool Contiguous = false>
+class TensorView
+{
+    static_assert(Rank >= 1 && Rank <= MAX_DIM, "views have rank 1 to MAX_DIM");
+public:
+    using Tensor = std::conditional_t<std::is_const_v<T>, const gTensor, gTensor>;
+    static constexpr unsigned kRank = Rank;
+    static constexpr bool kContiguous = Contiguous;
+
+    TensorView() = default;
+    /// throws std::invalid_argument when the tensor does not fit, see fits()
+    explicit TensorView(Tensor& tensor)
+    {
+        if (tensor.getRank() != Rank) throw std::invalid_argument("view rank differs from the tensor rank");
+        if (!isStorageOf<T>(tensor.getDType())) throw std::invalid_argument("view type does not store the dtype");
+        if (Contiguous && !hasUnitStride(tensor)) throw std::invalid_argument("contiguous view of a strided dim 0");
+        if (tensor.getTotalSizeInElements() && !tensor.data()) throw std::invalid_argument("view of a tensor without data");
+        m_data = reinterpret_cast<T*>(tensor.data());
+        for (unsigned dim = 0; dim < Rank; ++dim)
+        {
+            m_sizes[dim] = tensor.getSize(dim);
+            m_strides[dim] = tensor.getStride(dim);
+        }
+    }
+
+    /// rank, dtype and (for contiguous views) dim 0 match, the constructor would not throw
+    static bool fits(const gTensor& tensor)
+    {
+        return tensor.getRank() == Rank && isStorageOf<T>(tensor.getDType()) && (!Contiguous || hasUnitStride(tensor)) &&
+               (tensor.getTotalSizeInElements() == 0 || tensor.data());
+    }
+    /// elements of dim 0 follow each other in memory, a single element counts as well
+    static bool hasUnitStride(const gTensor& tensor) {return tensor.getStride(0) == 1 || tensor.getSize(0) == 1;}
+
+    T* data() const {return m_data;}
+    uint64_t getSize(unsigned dim) const {return m_sizes[dim];}
+    int64_t getStride(unsigned dim) const {return Contiguous && dim == 0 ? 1 : m_strides[dim];}
+    uint64_t getTotalSizeInElements() const
+    {
+        uint64_t total = 1;
+        for (unsigned dim = 0; dim < Rank; ++dim) total *= m_sizes[dim];
+        return total;
+    }
+
+    /// distance in elements from data() to the element at the given indices, dim 0 first
+    template<typename... Index> requires (sizeof...(Index) == Rank)
+    int64_t offset(Index... index) const
+    {
+        const std::array<int64_t, Rank> at = {static_cast<int64_t>(index)...};
+        int64_t result = Contiguous ? at[0] : at[0] * m_strides[0];
+        for (unsigned dim = 1; dim < Rank; ++dim) result += at[dim] * m_strides[dim];
+        return result;
+    }
+    template<typename... Index> requires (sizeof...(Index) == Rank)
+    T& operator()(Index... index) const {return m_data[offset(index...)];}
+    T& operator[](const std::array<uint64_t, Rank>& index) const
+    {
+        return [&]<size_t... Dim>(std::index_sequence<Dim...>) -> T& {return (*this)(index[Dim]...);}
+               (std::make_index_sequence<Rank>());
+    }
+    /// first element of the run along dim 0 at the given outer indices, its elements are getStride(0) apart
+    template<typename... Index> requires (sizeof...(Index) == Rank - 1)
+    T* row(Index... outer) const {return &(*this)(0, outer...);}
+private:
+    T* m_data = nullptr;
+    std::array<uint64_t, Rank> m_sizes = {};
+    std::array<int64_t, Rank> m_strides = {};
+};
+
+/// calls fn with the TensorView<T, Rank, contiguous> that fits the tensor: a kernel written against a view is
+/// instantiated for both kinds of dim 0 and the choice is made once per call.
+/// throws std::invalid_argument when no view fits.
+template<typename T, unsigned Rank, typename Tensor, typename Fn>
+decltype(auto) visitTensorView(Tensor& tensor, Fn&& fn)
+{
+    if (TensorView<T, Rank, true>::hasUnitStride(tensor)) return fn(TensorView<T, Rank, true>(tensor));
+    return fn(TensorView<T, Rank>(tensor));
+}
+
+/// the same over every rank, fn must accept a view of any rank
+template<typename T, typename Tensor, typename Fn>
+decltype(auto) visitTensorView(Tensor& tensor, Fn&& fn)
+{
+    switch (tensor.getRank())
+    {
+        case 1: return visitTensorView<T, 1>(tensor, fn);
+        case 2: return visitTensorView<T, 2>(tensor, fn);
+        case 3: return visitTensorView<T, 3>(tensor, fn);
+        case 4: return visitTensorView<T, 4>(tensor, fn);
+        case 5: return visitTensorView<T, 5>(tensor, fn);
+        default: break;
+    }
+    throw std::invalid_argument("no view fits the tensor rank");
+}
+
+} // namespace gblas
+
+#endif //GBLAS_TENSORVIEW_H
@@ -1,71 +1,242 @@
-#include "gTensor.h"
-#include "gTensorIterator.h"
-#include "common.h"
-#include <cmath>
-
-namespace gblas {
-
-gTensor::gTensor(TSizeArr sizes, TStrideArr strides, unsigned int rank, DType dtype, Layout layout, byte* data)
-       : m_sizes(sizes), m_strides(strides), m_rank(rank), m_dtype(dtype), m_layout(layout)
-{
-    if (data)
-    {
-        initData(data);
-    }
-}
-
-void gTensor::initData(void* data)
-{
-    m_buffer = {getMemorySizeInBytes(), (byte*)data};
-}
-
-uint64_t gTensor::getTotalSizeInElements() const
-{
-    uint64_t totalSize = 1;
-    for (unsigned i = 0; i < getRank(); i++)
-    {
-        totalSize *= getSize(i);
-    }
-    return totalSize;
-}
-
-uint64_t gTensor::getMemorySizeInBytes() const
-{
-    if (m_sizes.empty()) return 0;
-    // calculate the max offset available
-    uint64_t max_offset = 0;
-    for (unsigned i = 0; i < m_rank; ++i)
-    {
-        max_offset += (getSize(i) - 1) * std::abs(getStride(i));
-    }
-    // add the element in the max offset and move from elements to bytes
-    return (max_offset + 1) * getSingleElementSizeInBytes(getDType());
-}
-
-gTensorIterator gTensor::getIterator()
-{
-    return gTensorIterator(*this);
-}
-
-byte *gTensor::operator[](int offset)
-{
-    uint64_t offsetInBytes = offset * getSingleElementSizeInBytes(getDType());
-    return m_buffer[offsetInBytes];
-}
-
-byte *gTensor::operator[](Coordinates coords)
-{
-    uint64_t offsetInElements = 0;
-    if (coords.size() != getRank()) throw std::invalid_argument("Coordinates should have the same rank as the tensor");
-    for(unsigned idx = 0; idx < coords.size(); ++idx)
-    {
-        if (coords[idx] >= getSize(idx)) throw std::out_of_range("coordinate is out of bound");
-        offsetInElements += coords[idx] * getStride(idx);
-    }
-    return m_buffer[offsetInElements * getSingleElementSizeInBytes(getDType())];
-}
-
-
-
-
+#include "gTensor.h"
+#include "gTensorIterator.h"
+#include "common.h"
+#include "runtime/Allocator.h"
+#include <cmath>
+
+namespace gblas {
+
+gTensor::gTensor(TSizeArr sizes, TStrideArr strides, unsigned int rank, DType dtype, Layout layout, byte* data)
+       : m_sizes(sizes), m_strides(strides), m_rank(rank), m_dtype(dtype), m_layout(layout)
+{
+    if (data)
+    {
+        initData(data);
+    }
+}
+
+void gTensor::initData(void* data)
+{
+    m_buffer = {getMemorySizeInBytes(), (byte*)data};
+}
+
+void gTensor::initData(std::shared_ptr<byte> data)
+{
+    m_buffer = {getMemorySizeInBytes(), std::move(data)};
+}
+
+gTensor gTensor::clone() const
+{
+    gTensor copy(*this);
+    copy.m_offset = 0;
+    copy.m_buffer = DataBuffer();
+    if (data())
+    {
+        const uint64_t size = getMemorySizeInBytes();
+        Allocator* allocator = m_buffer.getAllocator();
+        copy.m_buffer = DataBuffer(size, allocator ? *allocator : getDefaultAllocator());
+        std::memcpy(copy.m_buffer.data(), data(), size);
+    }
+    return copy;
+}
+
+byte* gTensor::data()
+{
+    return m_buffer.data() ? m_buffer[m_offset * getSingleElementSizeInBytes(m_dtype)] : nullptr;
+}
+
+const byte* gTensor::data() const
+{
+    return m_buffer.data() ? m_buffer[m_offset * getSingleElementSizeInBytes(m_dtype)] : nullptr;
+}
+
+void gTensor::allocateData()
+{
+    allocateData(getDefaultAllocator());
+}
+
+void gTensor::allocateData(Allocator& allocator)
+{
+    m_buffer = DataBuffer(getMemorySizeInBytes(), allocator);
+    std::memset(m_buffer.data(), 0, m_buffer.size());
+}
+
+uint64_t gTensor::getTotalSizeInElements() const
+{
+    uint64_t totalSize = 1;
+    for (unsigned i = 0; i < getRank(); i++)
+    {
+        totalSize *= getSize(i);
+    }
+    return totalSize;
+}
+
+uint64_t gTensor::getMemorySizeInBytes() const
+{
+    if (m_sizes.empty() || getTotalSizeInElements() == 0) return 0;
+    // calculate the max offset available
+    uint64_t max_offset = 0;
+    for (unsigned i = 0; i < m_rank; ++i)
+    {
+        max_offset += (getSize(i) - 1) * std::abs(getStride(i));
+    }
+    // add the element in the max offset and move from elements to bytes
+    return (max_offset + 1) * getSingleElementSizeInBytes(getDType());
+}
+
+bool gTensor::isDense() const
+{
+    // dense means the elements are packed with dim 0 as the fastest changing dimension
+    int64_t expectedStride = 1;
+    for (unsigned i = 0; i < m_rank; ++i)
+    {
+        if (getSize(i) != 1 && getStride(i) != expectedStride) return false;
+        expectedStride *= static_cast<int64_t>(getSize(i));
+    }
+    return true;
+}
+
+gTensorIterator gTensor::getIterator() const
+{
+    return gTensorIterator(*this);
+}
+
+byte *gTensor::operator[](int offset)
+{
+    uint64_t offsetInBytes = (m_offset + offset) * getSingleElementSizeInBytes(getDType());
+    return m_buffer[offsetInBytes];
+}
+
+byte *gTensor::operator[](Coordinates coords)
+{
+    uint64_t offsetInElements = 0;
+    if (coords.size() != getRank()) throw std::invalid_argument("Coordinates should have the same rank as the tensor");
+    for(unsigned idx = 0; idx < coords.size(); ++idx)
+    {
+        if (coords[idx] >= getSize(idx)) throw std::out_of_range("coordinate is out of bound");
+        offsetInElements += coords[idx] * getStride(idx);
+    }
+    return m_buffer[(m_offset + offsetInElements) * getSingleElementSizeInBytes(getDType())];
+}
+
+gTensor gTensor::slice(unsigned dim, uint64_t begin, uint64_t end, uint64_t step) const
+{
+    if (dim >= m_rank) throw std::out_of_range("slice dim is out of bound");
+    if (step == 0) throw std::invalid_argument("slice step must be positive");
+    if (begin > end || end > getSize(dim)) throw std::out_of_range("slice range is out of bound");
+    gTensor view(*this);
+    if (begin < end) view.m_offset += begin * getStride(dim);
+    view.m_sizes[dim] = (end - begin + step - 1) / step;
+    view.m_strides[dim] = getStride(dim) * static_cast<int64_t>(step);
+    return view;
+}
+
+gTensor gTensor::transpose(const Coordinates& perm) const
+{
+    std::array<bool, MAX_DIM> used = {};
+    gTensor view(*this);
+    for (unsigned i = 0; i < m_rank; ++i)
+    {
+        if (perm[i] >= m_rank || used[perm[i]]) throw std::invalid_argument("transpose needs a permutation of the dims");
+        used[perm[i]] = true;
+        view.m_sizes[i] = getSize(perm[i]);
+        view.m_strides[i] = getStride(perm[i]);
+    }
+    return view;
+}
+
+gTensor gTensor::transpose(unsigned dim0, unsigned dim1) const
+{
+    Coordinates perm = {0, 1, 2, 3, 4};
+    if (dim0 >= m_rank || dim1 >= m_rank) throw std::out_of_range("transpose dim is out of bound");
+    std::swap(perm[dim0], perm[dim1]);
+    return transpose(perm);
+}
+
+gTensor gTensor::reshape(const TSizeArr& sizes, unsigned rank) const
+{
+    if (rank == 0 || rank > MAX_DIM) throw std::invalid_argument("reshape rank is out of bound");
+    uint64_t total = 1;
+    for (unsigned i = 0; i < rank; ++i) total *= sizes[i];
+    if (total != getTotalSizeInElements()) throw std::invalid_argument("reshape must keep the number of elements");
+
+    gTensor view(*this);
+    view.m_rank = rank;
+    view.m_sizes = {1, 1, 1, 1, 1};
+    for (unsigned i = 0; i < rank; ++i) view.m_sizes[i] = sizes[i];
+    if (total == 0 || isDense())
+    {
+        int64_t stride = 1;
+        for (unsigned i = 0; i < MAX_DIM; ++i)
+        {
+            view.m_strides[i] = stride;
+            stride *= static_cast<int64_t>(view.m_sizes[i]);
+        }
+        return view;
+    }
+
+    // size 1 dims carry no stride information
+    std::array<uint64_t, MAX_DIM> oldSizes{};
+    std::array<int64_t, MAX_DIM> oldStrides{};
+    unsigned oldRank = 0;
+    for (unsigned i = 0; i < m_rank; ++i)
+    {
+        if (getSize(i) == 1) continue;
+        oldSizes[oldRank] = getSize(i);
+        oldStrides[oldRank++] = getStride(i);
+    }
+    // match groups of old and new dims with the same element count, the old dims of a group must be
+    // contiguous with each other so the new dims can split them with strides
+    unsigned oi = 0, ni = 0;
+    while (ni < rank && oi < oldRank)
+    {
+        uint64_t newCount = sizes[ni], oldCount = oldSizes[oi];
+        unsigned nj = ni + 1, oj = oi + 1;
+        while (newCount != oldCount)
+        {
+            if (newCount < oldCount) newCount *= sizes[nj++];
+            else oldCount *= oldSizes[oj++];
+        }
+        for (unsigned k = oi; k + 1 < oj; ++k)
+        {
+            if (oldStrides[k + 1] != oldStrides[k] * static_cast<int64_t>(oldSizes[k]))
+            {
+                throw std::invalid_argument("reshape is not expressible with strides, the tensor needs a copy");
+            }
+        }
+        view.m_strides[ni] = oldStrides[oi];
+        for (unsigned k = ni + 1; k < nj; ++k)
+        {
+            view.m_strides[k] = view.m_strides[k - 1] * static_cast<int64_t>(sizes[k - 1]);
+        }
+        ni = nj;
+        oi = oj;
+    }
+    // trailing size 1 dims and the unused ones continue past the last element
+    for (unsigned i = ni; i < MAX_DIM; ++i)
+    {
+        view.m_strides[i] = i == 0 ? 1 : view.m_strides[i - 1] * static_cast<int64_t>(view.m_sizes[i - 1]);
+    }
+    return view;
+}
+
+gTensor gTensor::broadcast(const TSizeArr& sizes, unsigned rank) const
+{
+    if (rank < m_rank || rank > MAX_DIM) throw std::invalid_argument("broadcast can not drop dims");
+    gTensor view(*this);
+    view.m_rank = rank;
+    for (unsigned i = 0; i < rank; ++i)
+    {
+        const uint64_t current = i < m_rank ? getSize(i) : 1;
+        if (current == sizes[i]) continue;
+        if (current != 1) throw std::invalid_argument("only dims of size 1 can be broadcast");
+        view.m_sizes[i] = sizes[i];
+        view.m_strides[i] = 0;
+    }
+    return view;
+}
+
+
+
+
 } // gblas
\ No newline at end of file
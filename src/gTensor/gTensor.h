@@ -1,49 +1,79 @@
-#ifndef GBLAS_GTENSOR_H
-#define GBLAS_GTENSOR_H
-
-#include <array>
-#include <stdexcept>
-#include "DataBuffer.h"
-#include "common.h"
-
-namespace gblas {
-class gTensorIterator;
-
-class gTensor
-{
-public:
-    gTensor() = default;
-    gTensor(TSizeArr sizes, TStrideArr strides, unsigned rank, DType dtype, Layout layout = Layout::RowMajor, byte* data = nullptr);
-    ~gTensor() = default;
-    gTensor(const gTensor& other) = default;
-    bool operator==(const gTensor& other) const = default;
-    bool operator!=(const gTensor& other) const = default;
-    byte* operator[](int offset);
-    byte* operator[](Coordinates coords);
-    void initData(void* data);
-    /// get tensor traits
-    DType getDType() const {return m_dtype;}
-    const TSizeArr& getAllSizesInElements() const {return m_sizes;}
-    uint64_t getSize(unsigned idx) const {return m_sizes[idx];}
-    uint64_t getTotalSizeInElements() const;
-    uint64_t getMemorySizeInBytes() const;
-    const TStrideArr& getAllStridesInElements() const {return m_strides;}
-    int64_t getStride(unsigned idx) const {return m_strides[idx];}
-    unsigned getRank() const {return m_rank;}
-    Layout getLayout() const {return m_layout;}
-    /// get data
-    const DataBuffer* getDataBuffer() const {return &m_buffer;}
-    DataBuffer* getDataBuffer() {return &m_buffer;}
-    gTensorIterator getIterator();
-private:
-    TSizeArr m_sizes = {1, 1, 1, 1, 1};
-    TStrideArr m_strides = {1, 1, 1, 1, 1};
-    unsigned m_rank = 1;
-    DType m_dtype = DType::dtypeNR;
-    Layout m_layout = Layout::LayoutNR;
-    DataBuffer m_buffer;
-};
-
-} // gblas
-
-#endif //GBLAS_GTESNOR_H
+#ifndef GBLAS_GTENSOR_H
+#define GBLAS_GTENSOR_H
+
+#include <array>
+#include <stdexcept>
+#include "DataBuffer.h"
+#include "common.h"
+
+namespace gblas {
+class gTensorIterator;
+
+class gTensor
+{
+public:
+    gTensor() = default;
+    gTensor(TSizeArr sizes, TStrideArr strides, unsigned rank, DType dtype, Layout layout = Layout::RowMajor, byte* data = nullptr);
+    ~gTensor() = default;
+    /// copies share the data, see clone() for a copy of the contents
+    gTensor(const gTensor& other) = default;
+    gTensor& operator=(const gTensor& other) = default;
+    bool operator==(const gTensor& other) const = default;
+    bool operator!=(const gTensor& other) const = default;
+    byte* operator[](int offset);
+    byte* operator[](Coordinates coords);
+    /// view caller owned memory, the tensor never frees it
+    void initData(void* data);
+    /// share ownership of memory owned elsewhere
+    void initData(std::shared_ptr<byte> data);
+    /// allocate zero initialized memory for the tensor's extent
+    void allocateData();
+    void allocateData(Allocator& allocator);
+    /// get tensor traits
+    DType getDType() const {return m_dtype;}
+    const TSizeArr& getAllSizesInElements() const {return m_sizes;}
+    uint64_t getSize(unsigned idx) const {return m_sizes[idx];}
+    uint64_t getTotalSizeInElements() const;
+    uint64_t getMemorySizeInBytes() const;
+    const TStrideArr& getAllStridesInElements() const {return m_strides;}
+    int64_t getStride(unsigned idx) const {return m_strides[idx];}
+    unsigned getRank() const {return m_rank;}
+    Layout getLayout() const {return m_layout;}
+    /// get data
+    const DataBuffer* getDataBuffer() const {return &m_buffer;}
+    DataBuffer* getDataBuffer() {return &m_buffer;}
+    /// first element of the tensor, the buffer may start before it when the tensor is a view
+    byte* data();
+    const byte* data() const;
+    /// position of the first element in the buffer
+    uint64_t getOffsetInElements() const {return m_offset;}
+    bool isDense() const;
+    /// a tensor with the same traits and its own copy of the elements it spans
+    gTensor clone() const;
+
+    /// views, O(1) and sharing the data buffer. invalid arguments throw std::invalid_argument or std::out_of_range.
+    /// elements [begin, end) of dim, every step-th one
+    gTensor slice(unsigned dim, uint64_t begin, uint64_t end, uint64_t step = 1) const;
+    /// dim i of the result is dim perm[i] of this tensor
+    gTensor transpose(const Coordinates& perm) const;
+    /// swap two dims
+    gTensor transpose(unsigned dim0, unsigned dim1) const;
+    /// the same elements in another shape, only when it can be expressed with strides
+    gTensor reshape(const TSizeArr& sizes, unsigned rank) const;
+    /// repeat dims of size 1 (and new outer dims) with a zero stride up to the given sizes
+    gTensor broadcast(const TSizeArr& sizes, unsigned rank) const;
+    /// chunk iterator over the elements, see gTensorIterator
+    gTensorIterator getIterator() const;
+private:
+    TSizeArr m_sizes = {1, 1, 1, 1, 1};
+    TStrideArr m_strides = {1, 1, 1, 1, 1};
+    unsigned m_rank = 1;
+    DType m_dtype = DType::dtypeNR;
+    Layout m_layout = Layout::LayoutNR;
+    DataBuffer m_buffer;
+    uint64_t m_offset = 0;
+};
+
+} // gblas
+
+#endif //GBLAS_GTESNOR_H
@@ -3,3 +3,158 @@
 //
 
 #include "gTensorIterator.h"
+#include <stdexcept>
+
+namespace gblas
+{
+
+gTensorIterator::gTensorIterator(std::initializer_list<const gTensor*> tensors)
+    : gTensorIterator(tensors.begin(), static_cast<unsigned>(tensors.size()))
+{
+}
+
+gTensorIterator::gTensorIterator(const gTensor* const* tensors, unsigned count)
+{
+    if (count == 0 || count > kMaxOperands)
+    {
+        throw std::invalid_argument("iterator takes 1 to 8 tensors");
+    }
+    const gTensor& first = **tensors;
+    for (unsigned op = 0; op < count; ++op)
+    {
+        const gTensor* tensor = tensors[op];
+        if (tensor->getRank() != first.getRank()) throw std::invalid_argument("iterated tensors differ in rank");
+        for (unsigned dim = 0; dim < first.getRank(); ++dim)
+        {
+            if (tensor->getSize(dim) != first.getSize(dim))
+            {
+                throw std::invalid_argument("iterated tensors differ in size");
+            }
+        }
+        if (first.getTotalSizeInElements() && !tensor->data())
+        {
+            throw std::invalid_argument("iterated tensor has no data");
+        }
+        m_base[m_numOfOperands] = const_cast<byte*>(tensor->data());
+        m_elementSizes[m_numOfOperands] = getSingleElementSizeInBytes(tensor->getDType());
+        ++m_numOfOperands;
+    }
+    if (first.getTotalSizeInElements() == 0) return;
+
+    // size 1 dims do not move, and a dim merges into the one below it when it continues it in every tensor
+    for (unsigned dim = 0; dim < first.getRank(); ++dim)
+    {
+        const uint64_t size = first.getSize(dim);
+        if (size == 1) continue;
+        bool merge = m_rank > 0;
+        for (unsigned op = 0; merge && op < m_numOfOperands; ++op)
+        {
+            const gTensor& tensor = *tensors[op];
+            merge = tensor.getStride(dim) == m_strides[op][m_rank - 1] * static_cast<int64_t>(m_sizes[m_rank - 1]);
+        }
+        if (merge)
+        {
+            m_sizes[m_rank - 1] *= size;
+            continue;
+        }
+        m_sizes[m_rank] = size;
+        for (unsigned op = 0; op < m_numOfOperands; ++op)
+        {
+            m_strides[op][m_rank] = tensors[op]->getStride(dim);
+        }
+        ++m_rank;
+    }
+    // a single element
+    if (m_rank == 0)
+    {
+        m_sizes[0] = 1;
+        m_rank = 1;
+    }
+    m_numOfChunks = 1;
+    for (unsigned dim = 1; dim < m_rank; ++dim) m_numOfChunks *= m_sizes[dim];
+    reset();
+}
+
+void gTensorIterator::reset()
+{
+    m_chunkIndex = 0;
+    m_current = m_base;
+    m_coords = {};
+}
+
+bool gTensorIterator::next(Chunk& chunk)
+{
+    if (m_chunkIndex == m_numOfChunks) return false;
+    chunk.data = m_current;
+    chunk.length = m_sizes[0];
+    chunk.index = m_chunkIndex * m_sizes[0];
+    for (unsigned op = 0; op < m_numOfOperands; ++op) chunk.strides[op] = m_strides[op][0];
+    ++m_chunkIndex;
+
+    // advance the outer dims like an odometer, moving the pointers along
+    for (unsigned dim = 1; dim < m_rank; ++dim)
+    {
+        const bool wrap = ++m_coords[dim] == m_sizes[dim];
+        for (unsigned op = 0; op < m_numOfOperands; ++op)
+        {
+            const int64_t steps = wrap ? 1 - static_cast<int64_t>(m_sizes[dim]) : 1;
+            m_current[op] += steps * m_strides[op][dim] * m_elementSizes[op];
+        }
+        if (!wrap) break;
+        m_coords[dim] = 0;
+    }
+    return true;
+}
+
+void gTensorIterator::getChunk(uint64_t index, Chunk& chunk) const
+{
+    chunk.data = m_base;
+    chunk.length = m_sizes[0];
+    chunk.index = index * m_sizes[0];
+    for (unsigned op = 0; op < m_numOfOperands; ++op) chunk.strides[op] = m_strides[op][0];
+    for (unsigned dim = 1; dim < m_rank; ++dim)
+    {
+        const int64_t coord = static_cast<int64_t>(index % m_sizes[dim]);
+        index /= m_sizes[dim];
+        for (unsigned op = 0; op < m_numOfOperands; ++op)
+        {
+            chunk.data[op] += coord * m_strides[op][dim] * m_elementSizes[op];
+        }
+    }
+}
+
+gTensorIterator::BlockLayout gTensorIterator::getBlockLayout(uint64_t grain) const
+{
+    BlockLayout layout;
+    const uint64_t length = getChunkLength();
+    grain = std::max<uint64_t>(grain, 1);
+    if (length >= 2 * grain)
+    {
+        layout.piecesPerChunk = (length + grain - 1) / grain;
+        layout.pieceLength = (length + layout.piecesPerChunk - 1) / layout.piecesPerChunk;
+    }
+    else if (length)
+    {
+        layout.chunksPerBlock = std::max<uint64_t>(1, grain / length);
+    }
+    return layout;
+}
+
+uint64_t gTensorIterator::getNumOfBlocks(uint64_t grain) const
+{
+    const BlockLayout layout = getBlockLayout(grain);
+    if (layout.piecesPerChunk > 1) return m_numOfChunks * layout.piecesPerChunk;
+    return (m_numOfChunks + layout.chunksPerBlock - 1) / layout.chunksPerBlock;
+}
+
+bool gTensorIterator::isContiguous() const
+{
+    if (m_rank > 1) return false;
+    for (unsigned op = 0; op < m_numOfOperands; ++op)
+    {
+        if (m_rank == 1 && m_sizes[0] > 1 && m_strides[op][0] != 1) return false;
+    }
+    return true;
+}
+
+} // namespace gblas
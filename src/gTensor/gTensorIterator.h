@@ -1,82 +1,140 @@
 #ifndef GBLAS_GTENSORITERATOR_H
 #define GBLAS_GTENSORITERATOR_H
 
-#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <initializer_list>
 #include "gTensor.h"
+#include "runtime/Parallel.h"
 
 namespace gblas
 {
 
+/// walks one or more tensors of the same shape in lockstep, a chunk at a time. a chunk is a run along the
+/// innermost dim: a pointer per tensor, a stride per tensor and a shared length. dims that follow each other
+/// in memory for every tensor are merged first, so dense tensors come out as a single chunk and a view of
+/// whole rows as one chunk per row block. the outer dims are advanced with pointer increments.
+/// chunks are visited in element order, dim 0 fastest.
 class gTensorIterator
 {
 public:
-    explicit gTensorIterator(gTensor& tensor) : m_tensor(tensor),
-                                                m_totalNumOfElements(tensor.getTotalSizeInElements()) {}
-    ~gTensorIterator() = default;
-    gTensorIterator(const gTensorIterator& other) : m_tensor(other.m_tensor)
+    static constexpr unsigned kMaxOperands = 8;
+
+    struct Chunk
+    {
+        /// first element of the run in each tensor
+        std::array<byte*, kMaxOperands> data = {};
+        /// distance between the run's elements in each tensor, in elements
+        std::array<int64_t, kMaxOperands> strides = {};
+        uint64_t length = 0;
+        /// position of the run's first element in the walk
+        uint64_t index = 0;
+
+        template<typename T>
+        T* get(unsigned operand) const {return reinterpret_cast<T*>(data[operand]);}
+        bool isContiguous(unsigned operand) const {return strides[operand] == 1 || length == 1;}
+    };
+
+    explicit gTensorIterator(const gTensor& tensor) : gTensorIterator({&tensor}) {}
+    /// the tensors must have data and the same rank and sizes, throws std::invalid_argument otherwise.
+    /// chunks point into const tensors as well, writing through them is up to the caller.
+    explicit gTensorIterator(std::initializer_list<const gTensor*> tensors);
+    /// the same over an array of `count` tensors
+    gTensorIterator(const gTensor* const* tensors, unsigned count);
+
+    /// the next chunk, false when the tensors are exhausted
+    bool next(Chunk& chunk);
+    /// start over from the first chunk
+    void reset();
+
+    template<typename ChunkFn>
+    void forEachChunk(ChunkFn&& chunkFn)
     {
-        m_totalNumOfElements = other.m_totalNumOfElements;
-        m_currentIndex = other.m_currentIndex;
+        Chunk chunk;
+        reset();
+        while (next(chunk)) chunkFn(chunk);
     }
 
-    gTensorIterator& operator++() noexcept
+    /// the chunk at position index of the walk, the position only picks the outer coordinates
+    void getChunk(uint64_t index, Chunk& chunk) const;
+
+    /// the walk cut into blocks of about `grain` elements, each block either whole chunks or a piece of one.
+    /// the cut only depends on the shape, so results kept per block combine the same way on any number of
+    /// threads.
+    uint64_t getNumOfBlocks(uint64_t grain = kParallelGrain) const;
+    /// call chunkFn on the chunks (or the piece of a chunk) of a block, in order
+    template<typename ChunkFn>
+    void forEachChunkInBlock(uint64_t block, ChunkFn&& chunkFn, uint64_t grain = kParallelGrain) const
     {
-        if (m_currentIndex != m_totalNumOfElements+1)
+        const BlockLayout layout = getBlockLayout(grain);
+        Chunk chunk;
+        if (layout.piecesPerChunk > 1)
         {
-            m_currentIndex++;
+            getChunk(block / layout.piecesPerChunk, chunk);
+            const uint64_t offset = block % layout.piecesPerChunk * layout.pieceLength;
+            chunk.length = std::min(layout.pieceLength, chunk.length - offset);
+            chunk.index += offset;
+            for (unsigned op = 0; op < m_numOfOperands; ++op)
+            {
+                chunk.data[op] += static_cast<int64_t>(offset) * chunk.strides[op] * m_elementSizes[op];
+            }
+            chunkFn(chunk);
+            return;
+        }
+        const uint64_t end = std::min(m_numOfChunks, (block + 1) * layout.chunksPerBlock);
+        for (uint64_t index = block * layout.chunksPerBlock; index < end; ++index)
+        {
+            getChunk(index, chunk);
+            chunkFn(chunk);
         }
-        return *this;
     }
 
-    const gTensorIterator operator++(int) noexcept
+    /// run blockFn(block) for every block on the library thread pool, in any order and concurrently.
+    /// a walk of a single block runs on the calling thread.
+    template<typename BlockFn>
+    void parallelForEachBlock(BlockFn&& blockFn, uint64_t grain = kParallelGrain) const
     {
-        auto tempIt = *this;
-        ++*this;
-        return tempIt;
+        parallelForRange(getNumOfBlocks(grain), 1, [&](uint64_t begin, uint64_t end, unsigned)
+        {
+            for (uint64_t block = begin; block < end; ++block) blockFn(block);
+        });
     }
 
-    bool operator==(const gTensorIterator& other) const
+    /// forEachChunk on the library thread pool, long chunks are cut into pieces of about `grain` elements
+    template<typename ChunkFn>
+    void parallelForEachChunk(ChunkFn&& chunkFn, uint64_t grain = kParallelGrain) const
     {
-        return (m_tensor == other.m_tensor ||
-                m_currentIndex == other.m_currentIndex);
+        parallelForEachBlock([&](uint64_t block) {forEachChunkInBlock(block, chunkFn, grain);}, grain);
     }
-    bool operator!=(const gTensorIterator& other) const = default;
 
-    gTensorIterator& begin()
-    {
-        m_currentIndex = 0;
-        return *this;
-    }
-     gTensorIterator& end()
-     {
-        m_currentIndex = m_totalNumOfElements + 1;
-        return *this;
-     }
-     byte* operator*() const noexcept
-     {
-        return m_tensor[m_currentIndex];
-     }
-     Coordinates getCurrentCoordinates()
-     {
-        Coordinates coords;
-        uint64_t offset = m_currentIndex;
-        auto& strides = m_tensor.getAllStridesInElements();
-        std::fill(coords.begin(), coords.end(), 1);
-        for(unsigned i = m_tensor.getRank()-1; 0 <= i; --i)
-        {
-            coords[i] = offset / strides[i];
-            offset %= strides[i];
-            if (coords[i] >= m_tensor.getSize(i)) throw std::out_of_range("Offset is out of bound");
-        }
-        if (offset != 0)
-        {
-            throw std::out_of_range("Offset is out of bound");
-        }
-     }
+    /// dims left after merging, 0 for an empty iteration
+    unsigned getNumOfDims() const {return m_rank;}
+    uint64_t getChunkLength() const {return m_rank ? m_sizes[0] : 0;}
+    uint64_t getNumOfChunks() const {return m_numOfChunks;}
+    /// every chunk is contiguous in every tensor
+    bool isContiguous() const;
+
 private:
-    gTensor& m_tensor;
-    uint64_t m_currentIndex = 0;
-    uint64_t m_totalNumOfElements = 0;
+    struct BlockLayout
+    {
+        // a chunk of at least two grains is cut into pieces, shorter chunks are grouped
+        uint64_t piecesPerChunk = 1;
+        uint64_t pieceLength = 0;
+        uint64_t chunksPerBlock = 1;
+    };
+    BlockLayout getBlockLayout(uint64_t grain) const;
+
+    unsigned m_numOfOperands = 0;
+    unsigned m_rank = 0;
+    uint64_t m_numOfChunks = 0;
+    uint64_t m_chunkIndex = 0;
+    TSizeArr m_sizes = {};
+    // strides of the merged dims in elements, per tensor
+    std::array<TStrideArr, kMaxOperands> m_strides = {};
+    std::array<unsigned, kMaxOperands> m_elementSizes = {};
+    std::array<byte*, kMaxOperands> m_base = {};
+    std::array<byte*, kMaxOperands> m_current = {};
+    Coordinates m_coords = {};
 };
 
 } // namespace gblas
@@ -0,0 +1,45 @@
+#include "kernels.h"
+
+namespace gblas::kernels {
+
+const KernelTable* getKernelTable(IsaLevel level)
+{
+    if (!isIsaLevelSupported(level)) return nullptr;
+    switch (level)
+    {
+        case IsaLevel::Scalar:
+            return &scalar::kernelTable();
+#if defined(GBLAS_X86_KERNELS)
+        case IsaLevel::AVX2:
+            return &avx2::kernelTable();
+        case IsaLevel::AVX2VNNI:
+            return &avx2vnni::kernelTable();
+        case IsaLevel::AVX512:
+            return &avx512::kernelTable();
+        case IsaLevel::AVX512VNNI:
+            return &avx512vnni::kernelTable();
+#endif
+#if defined(GBLAS_AMX_KERNELS)
+        case IsaLevel::AMX:
+            return &amx::kernelTable();
+#endif
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+const KernelTable& getKernelTable()
+{
+    static const KernelTable* table = []()
+    {
+        for (int level = static_cast<int>(getDispatchIsaLevel()); level >= 0; --level)
+        {
+            if (const KernelTable* candidate = getKernelTable(static_cast<IsaLevel>(level))) return candidate;
+        }
+        return &scalar::kernelTable();
+    }();
+    return *table;
+}
+
+} // namespace gblas::kernels
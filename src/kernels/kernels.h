@@ -0,0 +1,153 @@
+#ifndef GBLAS_KERNELS_H
+#define GBLAS_KERNELS_H
+
+#include <cstdint>
+#include "common.h"
+#include "runtime/CpuFeatures.h"
+
+namespace gblas::kernels {
+
+/// register tiled gemm micro-kernel with the blocking it was tuned for.
+/// the kernel computes an mr x nr tile from packed panels: a holds k slices of mr values, b holds k slices
+/// of nr values. the tile is written to c (row stride ldc, unit column stride) as c = alpha*a*b + beta*c,
+/// c is not read when beta is zero.
+template<typename T>
+struct GemmKernel
+{
+    // type the panels are packed in
+    using Packed = T;
+    unsigned mr = 0;
+    unsigned nr = 0;
+    // cache blocking: an mc x kc block of A stays in L2, a kc x nc panel of B in L3
+    unsigned mc = 0;
+    unsigned kc = 0;
+    unsigned nc = 0;
+    // the packed depth is zero padded to a multiple of this
+    unsigned depthAlign = 1;
+    void (*microKernel)(uint64_t k, const T* a, const T* b, T* c, int64_t ldc, T alpha, T beta) = nullptr;
+};
+
+/// integer gemm micro-kernel, unsigned bytes of A times signed bytes of B accumulated exactly in int32.
+/// the panels interleave the depth by 4: a holds k/4 slices of mr rows of 4 bytes, b holds k/4 slices of nr
+/// columns of 4 bytes, k is a multiple of depthAlign. the tile is c = a*b + colOffsets, plus c itself when
+/// accumulate is set. colOffsets (nr values, may be nullptr) is added to every row.
+/// with rowPanelA a holds the mr rows one after the other instead, each k bytes long, as tile loads want.
+struct GemmI8Kernel
+{
+    unsigned mr = 0;
+    unsigned nr = 0;
+    unsigned mc = 0;
+    unsigned kc = 0;
+    unsigned nc = 0;
+    unsigned depthAlign = 4;
+    bool rowPanelA = false;
+    void (*microKernel)(uint64_t k, const uint8_t* a, const int8_t* b, int32_t* c, int64_t ldc,
+                        const int32_t* colOffsets, bool accumulate) = nullptr;
+};
+
+/// bf16 gemm micro-kernel accumulating in fp32, for the cpus with bf16 tiles. a holds the mr rows of the
+/// sliver one after the other, each k values long; b holds k/2 slices of nr columns of 2 consecutive depth
+/// values, the pairs the bf16 dot products take. k is a multiple of depthAlign, c is written as by GemmKernel.
+struct GemmBf16Kernel
+{
+    using Packed = uint16_t;
+    unsigned mr = 0;
+    unsigned nr = 0;
+    unsigned mc = 0;
+    unsigned kc = 0;
+    unsigned nc = 0;
+    unsigned depthAlign = 2;
+    void (*microKernel)(uint64_t k, const uint16_t* a, const uint16_t* b, float* c, int64_t ldc, float alpha,
+                        float beta) = nullptr;
+};
+
+/// matrix-vector products for gemv, added to y: y[b * ldy + r] += sum over p of A(r, p) * x[b * ldx + p]
+/// for r < rows, p < k and b < batch. byRows reads A(r, p) at a[r * lda + p], byCols at a[p * lda + r].
+/// weights stored in a low precision type are decoded in registers right after they are loaded.
+template<typename Src, typename T = float>
+struct GemvKernels
+{
+    using Fn = void (*)(uint64_t rows, uint64_t k, const Src* a, int64_t lda, const T* x, int64_t ldx,
+                        unsigned batch, T* y, int64_t ldy);
+    Fn byRows = nullptr;
+    Fn byCols = nullptr;
+};
+
+/// span and tile kernels, one instance per instruction set.
+/// operations pick the table once and call through it, so no per-element dispatch is left in the loops.
+struct KernelTable
+{
+    IsaLevel isa = IsaLevel::Scalar;
+    // out = alpha * x + y, out may alias x or y
+    void (*axpyF32)(uint64_t n, float alpha, const float* x, const float* y, float* out) = nullptr;
+    void (*axpyF64)(uint64_t n, double alpha, const double* x, const double* y, double* out) = nullptr;
+    void (*axpyI32)(uint64_t n, int32_t alpha, const int32_t* x, const int32_t* y, int32_t* out) = nullptr;
+    // reductions of a block, accumulated in the element type. callers keep blocks short (a few thousand
+    // elements) and add the block results up in fp64.
+    float (*dotF32)(uint64_t n, const float* x, const float* y) = nullptr;
+    double (*dotF64)(uint64_t n, const double* x, const double* y) = nullptr;
+    float (*asumF32)(uint64_t n, const float* x) = nullptr;
+    double (*asumF64)(uint64_t n, const double* x) = nullptr;
+    // largest magnitude, NaN is skipped and an empty or all NaN block gives 0
+    float (*amaxF32)(uint64_t n, const float* x) = nullptr;
+    double (*amaxF64)(uint64_t n, const double* x) = nullptr;
+    // out = alpha * x, out may alias x
+    void (*scalF32)(uint64_t n, float alpha, const float* x, float* out) = nullptr;
+    void (*scalF64)(uint64_t n, double alpha, const double* x, double* out) = nullptr;
+    // plane rotation in place: (x, y) = (c * x + s * y, c * y - s * x)
+    void (*rotF32)(uint64_t n, float c, float s, float* x, float* y) = nullptr;
+    void (*rotF64)(uint64_t n, double c, double s, double* x, double* y) = nullptr;
+    // conversions between fp32 and the low precision types, bit identical to the scalar Conversions
+    void (*f32ToBf16)(uint64_t n, const float* src, uint16_t* dst, RoundingMode rounding) = nullptr;
+    void (*bf16ToF32)(uint64_t n, const uint16_t* src, float* dst) = nullptr;
+    void (*f32ToFp16)(uint64_t n, const float* src, uint16_t* dst, RoundingMode rounding) = nullptr;
+    void (*fp16ToF32)(uint64_t n, const uint16_t* src, float* dst) = nullptr;
+    void (*f32ToTf32)(uint64_t n, const float* src, uint32_t* dst, RoundingMode rounding) = nullptr;
+    void (*f32ToFp8_152)(uint64_t n, const float* src, uint8_t* dst, RoundingMode rounding) = nullptr;
+    void (*fp8_152ToF32)(uint64_t n, const uint8_t* src, float* dst) = nullptr;
+    void (*f32ToFp8_143)(uint64_t n, const float* src, uint8_t* dst, RoundingMode rounding) = nullptr;
+    void (*fp8_143ToF32)(uint64_t n, const uint8_t* src, float* dst) = nullptr;
+    // quantization: out = scale * x rounded to nearest even and saturated to [-127, 127], NaN gives -127
+    void (*quantizeI8)(uint64_t n, float scale, const float* x, int8_t* out) = nullptr;
+    void (*dequantizeI8)(uint64_t n, float scale, const int8_t* x, float* out) = nullptr;
+    // out = scale * x clamped to [-bound, bound], NaN stays NaN. out may alias x
+    void (*scalClampF32)(uint64_t n, float scale, float bound, const float* x, float* out) = nullptr;
+    // to[r * toStride + c] = from[c * fromStride + r] for r < rows and c < cols, strides in elements, by element
+    // size: 1, 2, 4 and 8 bytes. callers keep the block about L1 sized. with streaming the rows of `to` are
+    // written with non-temporal stores where they are 32 byte aligned, and fenced before the call returns
+    using TransposeFn = void (*)(uint64_t rows, uint64_t cols, const void* from, int64_t fromStride, void* to,
+                                 int64_t toStride, bool streaming);
+    TransposeFn transpose[4] = {};
+    GemvKernels<float> gemvF32;
+    GemvKernels<uint16_t> gemvBf16;
+    GemvKernels<uint16_t> gemvFp16;
+    GemvKernels<uint8_t> gemvFp8_152;
+    GemvKernels<uint8_t> gemvFp8_143;
+    GemvKernels<double, double> gemvF64;
+    GemmKernel<float> gemmF32;
+    GemmKernel<double> gemmF64;
+    GemmI8Kernel gemmI8;
+    // only set where bf16 products beat widening to fp32, otherwise bf16 goes through gemmF32
+    GemmBf16Kernel gemmBf16;
+};
+
+/// the table of getDispatchIsaLevel(), the best for the host cpu unless GBLAS_ISA lowers it. selected once
+/// on first use, callers may keep the function pointers.
+const KernelTable& getKernelTable();
+/// table of a specific level, nullptr if it is not compiled in or not supported by the host
+const KernelTable* getKernelTable(IsaLevel level);
+
+namespace scalar { const KernelTable& kernelTable(); }
+#if defined(GBLAS_X86_KERNELS)
+namespace avx2 { const KernelTable& kernelTable(); }
+namespace avx2vnni { const KernelTable& kernelTable(); }
+namespace avx512 { const KernelTable& kernelTable(); }
+namespace avx512vnni { const KernelTable& kernelTable(); }
+#endif
+#if defined(GBLAS_AMX_KERNELS)
+namespace amx { const KernelTable& kernelTable(); }
+#endif
+
+} // namespace gblas::kernels
+
+#endif //GBLAS_KERNELS_H
@@ -0,0 +1,19 @@
+// compiled with the AVX-512 F/BW/VL/DQ/VNNI/BF16 and AMX flags, only reached when the host reports the
+// matching features and the OS granted the tile state
+#define GBLAS_KERNEL_NAMESPACE amx
+#include "kernels_impl.h"
+
+#if !defined(__AVX512F__) || !defined(__AVX512VNNI__) || !defined(__AVX512BF16__) || !defined(__AMX_TILE__) || \
+    !defined(__AMX_INT8__) || !defined(__AMX_BF16__)
+#error "kernels_amx.cpp must be compiled with AVX-512 F/BW/VL/DQ/VNNI/BF16 and AMX TILE/INT8/BF16 enabled"
+#endif
+
+namespace gblas::kernels::amx {
+
+const KernelTable& kernelTable()
+{
+    static const KernelTable table = makeKernelTable(IsaLevel::AMX);
+    return table;
+}
+
+} // namespace gblas::kernels::amx
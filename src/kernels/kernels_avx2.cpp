@@ -0,0 +1,17 @@
+// compiled with -mavx2 -mfma -mf16c, only reached when the host reports the matching features
+#define GBLAS_KERNEL_NAMESPACE avx2
+#include "kernels_impl.h"
+
+#if !defined(__AVX2__) || !defined(__FMA__) || !defined(__F16C__)
+#error "kernels_avx2.cpp must be compiled with AVX2, FMA and F16C enabled"
+#endif
+
+namespace gblas::kernels::avx2 {
+
+const KernelTable& kernelTable()
+{
+    static const KernelTable table = makeKernelTable(IsaLevel::AVX2);
+    return table;
+}
+
+} // namespace gblas::kernels::avx2
@@ -0,0 +1,17 @@
+// compiled with -mavx2 -mfma -mf16c -mavxvnni, only reached when the host reports the matching features
+#define GBLAS_KERNEL_NAMESPACE avx2vnni
+#include "kernels_impl.h"
+
+#if !defined(__AVX2__) || !defined(__FMA__) || !defined(__F16C__) || !defined(__AVXVNNI__)
+#error "kernels_avx2vnni.cpp must be compiled with AVX2, FMA, F16C and AVX-VNNI enabled"
+#endif
+
+namespace gblas::kernels::avx2vnni {
+
+const KernelTable& kernelTable()
+{
+    static const KernelTable table = makeKernelTable(IsaLevel::AVX2VNNI);
+    return table;
+}
+
+} // namespace gblas::kernels::avx2vnni
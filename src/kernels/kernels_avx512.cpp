@@ -0,0 +1,17 @@
+// compiled with the AVX-512 F/BW/VL/DQ flags, only reached when the host reports the matching features
+#define GBLAS_KERNEL_NAMESPACE avx512
+#include "kernels_impl.h"
+
+#if !defined(__AVX512F__) || !defined(__AVX512BW__) || !defined(__AVX512VL__) || !defined(__AVX512DQ__)
+#error "kernels_avx512.cpp must be compiled with AVX-512 F/BW/VL/DQ enabled"
+#endif
+
+namespace gblas::kernels::avx512 {
+
+const KernelTable& kernelTable()
+{
+    static const KernelTable table = makeKernelTable(IsaLevel::AVX512);
+    return table;
+}
+
+} // namespace gblas::kernels::avx512
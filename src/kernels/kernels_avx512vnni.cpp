@@ -0,0 +1,18 @@
+// compiled with the AVX-512 F/BW/VL/DQ/VNNI flags, only reached when the host reports the matching features
+#define GBLAS_KERNEL_NAMESPACE avx512vnni
+#include "kernels_impl.h"
+
+#if !defined(__AVX512F__) || !defined(__AVX512BW__) || !defined(__AVX512VL__) || !defined(__AVX512DQ__) || \
+    !defined(__AVX512VNNI__)
+#error "kernels_avx512vnni.cpp must be compiled with AVX-512 F/BW/VL/DQ/VNNI enabled"
+#endif
+
+namespace gblas::kernels::avx512vnni {
+
+const KernelTable& kernelTable()
+{
+    static const KernelTable table = makeKernelTable(IsaLevel::AVX512VNNI);
+    return table;
+}
+
+} // namespace gblas::kernels::avx512vnni
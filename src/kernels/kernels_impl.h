@@ -0,0 +1,1206 @@
+#ifndef GBLAS_KERNELS_IMPL_H
+#define GBLAS_KERNELS_IMPL_H
+
+// Generic kernel bodies, written once against simd.h and instantiated by every kernels_<isa>.cpp.
+
+#include "kernels.h"
+#include "simd.h"
+#include "data_types/conversions.h"
+#include <algorithm>
+#include <cstring>
+
+namespace gblas::kernels::GBLAS_KERNEL_NAMESPACE {
+
+// run a lane-wide body over [0, n), the remainder goes through a zero padded copy so the
+// kernels below never need a scalar twin of their vector code.
+template<unsigned lanes, typename Body, typename Tail>
+inline void forEachVector(uint64_t n, Body body, Tail tail)
+{
+    uint64_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        body(i);
+    }
+    if (i < n)
+    {
+        tail(i, static_cast<unsigned>(n - i));
+    }
+}
+
+template<typename S, typename T>
+void axpy(uint64_t n, T alpha, const T* x, const T* y, T* out)
+{
+    constexpr unsigned lanes = S::lanes;
+    const typename S::V va = S::set1(alpha);
+    uint64_t i = 0;
+    // unroll by 4 to keep enough loads in flight for a memory bound loop
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+    {
+        typename S::V r0 = S::fmadd(va, S::load(x + i), S::load(y + i));
+        typename S::V r1 = S::fmadd(va, S::load(x + i + lanes), S::load(y + i + lanes));
+        typename S::V r2 = S::fmadd(va, S::load(x + i + 2 * lanes), S::load(y + i + 2 * lanes));
+        typename S::V r3 = S::fmadd(va, S::load(x + i + 3 * lanes), S::load(y + i + 3 * lanes));
+        S::store(out + i, r0);
+        S::store(out + i + lanes, r1);
+        S::store(out + i + 2 * lanes, r2);
+        S::store(out + i + 3 * lanes, r3);
+    }
+    forEachVector<lanes>(n - i,
+        [&](uint64_t j) {S::store(out + i + j, S::fmadd(va, S::load(x + i + j), S::load(y + i + j)));},
+        [&](uint64_t j, unsigned count)
+        {
+            T tx[lanes] = {}, ty[lanes] = {}, to[lanes];
+            for (unsigned l = 0; l < count; ++l) {tx[l] = x[i + j + l]; ty[l] = y[i + j + l];}
+            S::store(to, S::fmadd(va, S::load(tx), S::load(ty)));
+            for (unsigned l = 0; l < count; ++l) out[i + j + l] = to[l];
+        });
+}
+
+// the reductions below keep four vector accumulators, so a block of n elements is summed as 4 * lanes
+// interleaved partial sums that are added up at the end, close to pairwise summation in accuracy.
+// the tails are zero padded, which adds nothing to a sum and nothing to a maximum of magnitudes.
+template<typename S, typename T, typename Tail, typename Step>
+inline T reduce4(uint64_t n, Tail tail, Step step, T (*finish)(typename S::V))
+{
+    constexpr unsigned lanes = S::lanes;
+    typename S::V acc0 = S::zero(), acc1 = S::zero(), acc2 = S::zero(), acc3 = S::zero();
+    uint64_t i = 0;
+    for (; i + 4 * lanes <= n; i += 4 * lanes)
+    {
+        acc0 = step(acc0, i);
+        acc1 = step(acc1, i + lanes);
+        acc2 = step(acc2, i + 2 * lanes);
+        acc3 = step(acc3, i + 3 * lanes);
+    }
+    forEachVector<lanes>(n - i,
+        [&](uint64_t j) {acc0 = step(acc0, i + j);},
+        [&](uint64_t j, unsigned count) {acc1 = tail(acc1, i + j, count);});
+    return finish(S::add(S::add(acc0, acc1), S::add(acc2, acc3)));
+}
+
+template<typename S, typename T>
+T dot(uint64_t n, const T* x, const T* y)
+{
+    constexpr unsigned lanes = S::lanes;
+    return reduce4<S, T>(n,
+        [&](typename S::V acc, uint64_t i, unsigned count)
+        {
+            T tx[lanes] = {}, ty[lanes] = {};
+            for (unsigned l = 0; l < count; ++l) {tx[l] = x[i + l]; ty[l] = y[i + l];}
+            return S::fmadd(S::load(tx), S::load(ty), acc);
+        },
+        [&](typename S::V acc, uint64_t i) {return S::fmadd(S::load(x + i), S::load(y + i), acc);},
+        &S::reduceAdd);
+}
+
+template<typename S, typename T>
+T asum(uint64_t n, const T* x)
+{
+    constexpr unsigned lanes = S::lanes;
+    return reduce4<S, T>(n,
+        [&](typename S::V acc, uint64_t i, unsigned count)
+        {
+            T tx[lanes] = {};
+            for (unsigned l = 0; l < count; ++l) tx[l] = x[i + l];
+            return S::add(S::abs(S::load(tx)), acc);
+        },
+        [&](typename S::V acc, uint64_t i) {return S::add(S::abs(S::load(x + i)), acc);},
+        &S::reduceAdd);
+}
+
+// the largest magnitude, NaN elements are skipped since max returns its second operand for them
+template<typename S, typename T>
+T amax(uint64_t n, const T* x)
+{
+    constexpr unsigned lanes = S::lanes;
+    typename S::V acc0 = S::zero(), acc1 = S::zero();
+    uint64_t i = 0;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+    {
+        acc0 = S::max(S::abs(S::load(x + i)), acc0);
+        acc1 = S::max(S::abs(S::load(x + i + lanes)), acc1);
+    }
+    forEachVector<lanes>(n - i,
+        [&](uint64_t j) {acc0 = S::max(S::abs(S::load(x + i + j)), acc0);},
+        [&](uint64_t j, unsigned count)
+        {
+            T tx[lanes] = {};
+            for (unsigned l = 0; l < count; ++l) tx[l] = x[i + j + l];
+            acc1 = S::max(S::abs(S::load(tx)), acc1);
+        });
+    return S::reduceMax(S::max(acc0, acc1));
+}
+
+template<typename S, typename T>
+void scal(uint64_t n, T alpha, const T* x, T* out)
+{
+    constexpr unsigned lanes = S::lanes;
+    const typename S::V va = S::set1(alpha);
+    forEachVector<lanes>(n,
+        [&](uint64_t i) {S::store(out + i, S::mul(va, S::load(x + i)));},
+        [&](uint64_t i, unsigned count)
+        {
+            T tx[lanes] = {}, to[lanes];
+            for (unsigned l = 0; l < count; ++l) tx[l] = x[i + l];
+            S::store(to, S::mul(va, S::load(tx)));
+            for (unsigned l = 0; l < count; ++l) out[i + l] = to[l];
+        });
+}
+
+// (x, y) = (c * x + s * y, c * y - s * x) in place
+template<typename S, typename T>
+void rot(uint64_t n, T c, T s, T* x, T* y)
+{
+    constexpr unsigned lanes = S::lanes;
+    const typename S::V vc = S::set1(c);
+    const typename S::V vs = S::set1(s);
+    const auto rotate = [&](T* px, T* py)
+    {
+        const typename S::V vx = S::load(px);
+        const typename S::V vy = S::load(py);
+        S::store(px, S::fmadd(vc, vx, S::mul(vs, vy)));
+        S::store(py, S::sub(S::mul(vc, vy), S::mul(vs, vx)));
+    };
+    forEachVector<lanes>(n,
+        [&](uint64_t i) {rotate(x + i, y + i);},
+        [&](uint64_t i, unsigned count)
+        {
+            T tx[lanes] = {}, ty[lanes] = {};
+            for (unsigned l = 0; l < count; ++l) {tx[l] = x[i + l]; ty[l] = y[i + l];}
+            rotate(tx, ty);
+            for (unsigned l = 0; l < count; ++l) {x[i + l] = tx[l]; y[i + l] = ty[l];}
+        });
+}
+
+// converts [0, n) one vector at a time, the remainder goes through zero padded copies like forEachVector
+template<unsigned lanes, typename Src, typename Dst, typename Body>
+inline void convertSpan(uint64_t n, const Src* src, Dst* dst, Body body)
+{
+    forEachVector<lanes>(n,
+        [&](uint64_t i) {body(src + i, dst + i);},
+        [&](uint64_t i, unsigned count)
+        {
+            Src ts[lanes] = {};
+            Dst td[lanes];
+            for (unsigned l = 0; l < count; ++l) ts[l] = src[i + l];
+            body(ts, td);
+            for (unsigned l = 0; l < count; ++l) dst[i + l] = td[l];
+        });
+}
+
+// calls fn.template operator()<mode>() so the rounding switch is taken once per call instead of per element
+template<typename Fn>
+inline void withRounding(RoundingMode rounding, Fn fn)
+{
+    switch (rounding)
+    {
+        case RoundingMode::NearestEven: fn.template operator()<RoundingMode::NearestEven>(); break;
+        case RoundingMode::RoundUp: fn.template operator()<RoundingMode::RoundUp>(); break;
+        case RoundingMode::RoundDown: fn.template operator()<RoundingMode::RoundDown>(); break;
+        case RoundingMode::RoundAwayFromZero: fn.template operator()<RoundingMode::RoundAwayFromZero>(); break;
+        case RoundingMode::RoundTowardsZero: fn.template operator()<RoundingMode::RoundTowardsZero>(); break;
+    }
+}
+
+// symmetric int8 quantization: out = scale * x rounded to nearest even and saturated to [-127, 127].
+// the lower clamp comes first, a NaN lane takes its second operand and ends up as -127
+inline void quantizeI8(uint64_t n, float scale, const float* x, int8_t* out)
+{
+    const F32::V vs = F32::set1(scale);
+    const F32::V lo = F32::set1(-127.0f);
+    const F32::V hi = F32::set1(127.0f);
+    convertSpan<F32::lanes>(n, x, out, [&](const float* s, int8_t* d)
+    {
+        I32::storeI8(d, I32::fromF32(F32::min(F32::max(F32::mul(vs, F32::load(s)), lo), hi)));
+    });
+}
+
+inline void dequantizeI8(uint64_t n, float scale, const int8_t* x, float* out)
+{
+    const F32::V vs = F32::set1(scale);
+    convertSpan<F32::lanes>(n, x, out, [&](const int8_t* s, float* d) {F32::store(d, F32::mul(vs, F32::loadI8(s)));});
+}
+
+// out = scale * x clamped to [-bound, bound], the bounds go first so a NaN lane stays NaN
+inline void scalClampF32(uint64_t n, float scale, float bound, const float* x, float* out)
+{
+    const F32::V vs = F32::set1(scale);
+    const F32::V lo = F32::set1(-bound);
+    const F32::V hi = F32::set1(bound);
+    convertSpan<F32::lanes>(n, x, out, [&](const float* s, float* d)
+    {
+        F32::store(d, F32::min(hi, F32::max(lo, F32::mul(vs, F32::load(s)))));
+    });
+}
+
+inline void bf16ToF32(uint64_t n, const uint16_t* src, float* dst)
+{
+    convertSpan<F32::lanes>(n, src, dst, [](const uint16_t* s, float* d) {F32::store(d, F32::loadBf16(s));});
+}
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+// the vector conversions follow the scalar Conversions step by step, every special case is computed for
+// all lanes and selected at the end.
+
+// the increment decision of a narrowing conversion, lsb is the lowest kept bit
+template<RoundingMode R>
+inline U32::M roundUpMask(U32::M roundBit, U32::M sticky, U32::M lsb, U32::M negative)
+{
+    if constexpr (R == RoundingMode::NearestEven) return U32::maskAnd(roundBit, U32::maskOr(sticky, lsb));
+    if constexpr (R == RoundingMode::RoundUp) return U32::maskAnd(U32::maskNot(negative), U32::maskOr(roundBit, sticky));
+    if constexpr (R == RoundingMode::RoundDown) return U32::maskAnd(negative, U32::maskOr(roundBit, sticky));
+    if constexpr (R == RoundingMode::RoundAwayFromZero) return U32::maskOr(roundBit, sticky);
+    return U32::none();
+}
+
+inline U32::M isNaN(U32::V bits)
+{
+    return U32::gt(U32::bitAnd(bits, U32::set1(0x7FFFFFFF)), U32::set1(0x7F800000));
+}
+
+inline U32::M isNegative(U32::V bits)
+{
+    return U32::nonZero(U32::bitAnd(bits, U32::set1(0x80000000)));
+}
+
+inline U32::M bitSet(U32::V v, uint32_t bit)
+{
+    return U32::nonZero(U32::bitAnd(v, U32::set1(bit)));
+}
+
+// the fp32 exponent with a different bias, as a signed lane
+inline U32::V rebiasedExponent(U32::V bits, uint32_t biasDelta)
+{
+    return U32::sub(U32::bitAnd(U32::shr<23>(bits), U32::set1(0xFF)), U32::set1(biasDelta));
+}
+
+template<RoundingMode R>
+inline U32::V narrowBf16(U32::V x)
+{
+    U32::V result = U32::shr<16>(x);
+    U32::V lower = U32::bitAnd(x, U32::set1(0xFFFF));
+    U32::M up = roundUpMask<R>(bitSet(lower, 0x8000), bitSet(lower, 0x7FFF), bitSet(result, 1), isNegative(x));
+    result = U32::incrementIf(up, result);
+    // a NaN keeps its upper half and is made quiet
+    return U32::select(isNaN(x), U32::bitOr(U32::shr<16>(x), U32::set1(0x0040)), result);
+}
+
+template<RoundingMode R>
+inline U32::V narrowFp16(U32::V x)
+{
+    const U32::V exponent = rebiasedExponent(x, 127 - 15);
+    const U32::V mantissa = U32::bitAnd(x, U32::set1(0x7FFFFF));
+    const U32::M normal = U32::gt(exponent, U32::set1(0));
+    // normals drop 13 bits, subnormals add the implicit one and drop 14 - exponent bits
+    const U32::V shift = U32::select(normal, U32::set1(13), U32::sub(U32::set1(14), exponent));
+    const U32::V full = U32::select(normal, mantissa, U32::bitOr(mantissa, U32::set1(0x800000)));
+    const U32::V roundShift = U32::sub(shift, U32::set1(1));
+    const U32::V stickyMask = U32::sub(U32::shlv(U32::set1(1), roundShift), U32::set1(1));
+    // exponent and mantissa side by side, a mantissa carry moves into the exponent
+    U32::V combined = U32::bitOr(U32::select(normal, U32::shl<10>(exponent), U32::set1(0)), U32::shrv(full, shift));
+    U32::M up = roundUpMask<R>(bitSet(U32::shrv(full, roundShift), 1), U32::nonZero(U32::bitAnd(full, stickyMask)),
+                               bitSet(combined, 1), isNegative(x));
+    combined = U32::minU(U32::incrementIf(up, combined), U32::set1(0x7BFF));
+
+    // overflow and inf go to inf, underflow and zero to zero
+    U32::V result = U32::select(U32::gt(exponent, U32::set1(30)), U32::set1(0x7C00), combined);
+    result = U32::select(U32::gt(U32::set1(static_cast<uint32_t>(-14)), exponent), U32::set1(0), result);
+    result = U32::select(isNaN(x), U32::set1(0x7E00), result);
+    return U32::bitOr(result, U32::shl<15>(U32::shr<31>(x)));
+}
+
+template<RoundingMode R>
+inline U32::V narrowTf32(U32::V x)
+{
+    U32::V result = U32::bitAnd(x, U32::set1(0xFFFFE000));
+    U32::M up = roundUpMask<R>(bitSet(x, 0x1000), bitSet(x, 0xFFF), bitSet(x, 0x2000), isNegative(x));
+    result = U32::select(up, U32::add(result, U32::set1(0x2000)), result);
+    return U32::select(isNaN(x), U32::bitOr(U32::bitAnd(x, U32::set1(0xFFFFE000)), U32::set1(0x00400000)), result);
+}
+
+// fp8 with E exponent bits and M mantissa bits. the largest exponent is reserved, so a carry out of the
+// largest finite value lands exactly on the inf encoding.
+template<RoundingMode R, unsigned E, unsigned M>
+inline U32::V narrowFp8(U32::V x)
+{
+    constexpr uint32_t bias = (1u << (E - 1)) - 1;
+    constexpr uint32_t maxExponent = (1u << E) - 2;
+    constexpr uint32_t dropped = 23 - M;
+    constexpr uint32_t inf = ((1u << E) - 1) << M;
+    constexpr uint32_t nan = inf | (1u << (M - 1));
+    const U32::V exponent = rebiasedExponent(x, 127 - bias);
+    const U32::V mantissa = U32::bitAnd(x, U32::set1(0x7FFFFF));
+    U32::V combined = U32::bitOr(U32::shl<M>(exponent), U32::shr<dropped>(mantissa));
+    U32::M up = roundUpMask<R>(bitSet(mantissa, 1u << (dropped - 1)), bitSet(mantissa, (1u << (dropped - 1)) - 1),
+                               bitSet(combined, 1), isNegative(x));
+    combined = U32::incrementIf(up, combined);
+
+    U32::V result = U32::select(U32::gt(exponent, U32::set1(maxExponent)), U32::set1(inf), combined);
+    result = U32::select(U32::gt(U32::set1(1), exponent), U32::set1(0), result);
+    result = U32::select(isNaN(x), U32::set1(nan), result);
+    return U32::bitOr(result, U32::shl<7>(U32::shr<31>(x)));
+}
+
+inline void f32ToBf16(uint64_t n, const float* src, uint16_t* dst, RoundingMode rounding)
+{
+    withRounding(rounding, [&]<RoundingMode R>()
+    {
+        convertSpan<U32::lanes>(n, src, dst, [](const float* s, uint16_t* d) {U32::storeU16(d, narrowBf16<R>(U32::load(s)));});
+    });
+}
+
+inline void f32ToFp16(uint64_t n, const float* src, uint16_t* dst, RoundingMode rounding)
+{
+    withRounding(rounding, [&]<RoundingMode R>()
+    {
+        convertSpan<U32::lanes>(n, src, dst, [](const float* s, uint16_t* d) {U32::storeU16(d, narrowFp16<R>(U32::load(s)));});
+    });
+}
+
+inline void f32ToTf32(uint64_t n, const float* src, uint32_t* dst, RoundingMode rounding)
+{
+    withRounding(rounding, [&]<RoundingMode R>()
+    {
+        convertSpan<U32::lanes>(n, src, dst, [](const float* s, uint32_t* d) {U32::store(d, narrowTf32<R>(U32::load(s)));});
+    });
+}
+
+inline void f32ToFp8_152(uint64_t n, const float* src, uint8_t* dst, RoundingMode rounding)
+{
+    withRounding(rounding, [&]<RoundingMode R>()
+    {
+        convertSpan<U32::lanes>(n, src, dst, [](const float* s, uint8_t* d) {U32::storeU8(d, narrowFp8<R, 5, 2>(U32::load(s)));});
+    });
+}
+
+inline void f32ToFp8_143(uint64_t n, const float* src, uint8_t* dst, RoundingMode rounding)
+{
+    withRounding(rounding, [&]<RoundingMode R>()
+    {
+        convertSpan<U32::lanes>(n, src, dst, [](const float* s, uint8_t* d) {U32::storeU8(d, narrowFp8<R, 4, 3>(U32::load(s)));});
+    });
+}
+
+// the scalar decoders return one canonical quiet NaN whatever the payload was
+inline F32::V canonicalNaN(U32::M nan, F32::V value)
+{
+    return U32::asF32(U32::select(nan, U32::set1(0x7FC00000), U32::fromF32(value)));
+}
+
+inline void fp16ToF32(uint64_t n, const uint16_t* src, float* dst)
+{
+    convertSpan<F32::lanes>(n, src, dst, [](const uint16_t* s, float* d)
+    {
+        U32::M nan = U32::gt(U32::bitAnd(U32::loadU16(s), U32::set1(0x7FFF)), U32::set1(0x7C00));
+        F32::store(d, canonicalNaN(nan, F32::loadFp16(s)));
+    });
+}
+
+inline void fp8_152ToF32(uint64_t n, const uint8_t* src, float* dst)
+{
+    convertSpan<F32::lanes>(n, src, dst, [](const uint8_t* s, float* d)
+    {
+        U32::M nan = U32::gt(U32::bitAnd(U32::loadU8(s), U32::set1(0x7F)), U32::set1(0x7C));
+        F32::store(d, canonicalNaN(nan, F32::loadFp8_152(s)));
+    });
+}
+
+// fp8_143 has no hardware conversion, its 256 entry decode table is small enough to gather from
+inline void fp8_143ToF32(uint64_t n, const uint8_t* src, float* dst)
+{
+    convertSpan<F32::lanes>(n, src, dst, [](const uint8_t* s, float* d)
+    {
+        F32::store(d, U32::asF32(U32::gather(kFp8_143DecodeTable.data(), U32::loadU8(s))));
+    });
+}
+
+#else
+
+// the generic build shares the scalar conversions with the rest of the library
+inline void f32ToBf16(uint64_t n, const float* src, uint16_t* dst, RoundingMode rounding)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp32_to_bf16(src[i], rounding);
+}
+
+inline void f32ToFp16(uint64_t n, const float* src, uint16_t* dst, RoundingMode rounding)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp32_to_fp16(src[i], rounding);
+}
+
+inline void f32ToTf32(uint64_t n, const float* src, uint32_t* dst, RoundingMode rounding)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp32_to_tf32(src[i], rounding);
+}
+
+inline void f32ToFp8_152(uint64_t n, const float* src, uint8_t* dst, RoundingMode rounding)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp32_to_fp8_152(src[i], rounding);
+}
+
+inline void f32ToFp8_143(uint64_t n, const float* src, uint8_t* dst, RoundingMode rounding)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp32_to_fp8_143(src[i], rounding);
+}
+
+inline void fp16ToF32(uint64_t n, const uint16_t* src, float* dst)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp16_to_fp32(src[i]);
+}
+
+inline void fp8_152ToF32(uint64_t n, const uint8_t* src, float* dst)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp8_152_to_fp32(src[i]);
+}
+
+inline void fp8_143ToF32(uint64_t n, const uint8_t* src, float* dst)
+{
+    for (uint64_t i = 0; i < n; ++i) dst[i] = Conversions::fp8_143_to_fp32(src[i]);
+}
+
+#endif
+
+// in-register transposes of square micro tiles: row i of the tile is read at from + i * fromStride and
+// column i written to to + i * toStride
+#if defined(__AVX2__)
+template<typename E>
+struct TransposeTile;
+
+// 16 x 16 bytes in four rounds of interleaving, each one doubling the width of the groups
+template<>
+struct TransposeTile<uint8_t>
+{
+    static constexpr unsigned edge = 16;
+    static void run(const uint8_t* from, int64_t fromStride, uint8_t* to, int64_t toStride)
+    {
+        __m128i a[16], b[16];
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i * fromStride));
+        }
+        for (unsigned i = 0; i < 16; i += 2)
+        {
+            b[i] = _mm_unpacklo_epi8(a[i], a[i + 1]);
+            b[i + 1] = _mm_unpackhi_epi8(a[i], a[i + 1]);
+        }
+        for (unsigned i = 0; i < 16; i += 4)
+        {
+            a[i] = _mm_unpacklo_epi16(b[i], b[i + 2]);
+            a[i + 1] = _mm_unpackhi_epi16(b[i], b[i + 2]);
+            a[i + 2] = _mm_unpacklo_epi16(b[i + 1], b[i + 3]);
+            a[i + 3] = _mm_unpackhi_epi16(b[i + 1], b[i + 3]);
+        }
+        for (unsigned i = 0; i < 16; i += 8)
+        {
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                b[i + 2 * j] = _mm_unpacklo_epi32(a[i + j], a[i + 4 + j]);
+                b[i + 2 * j + 1] = _mm_unpackhi_epi32(a[i + j], a[i + 4 + j]);
+            }
+        }
+        for (unsigned j = 0; j < 8; ++j)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(to + 2 * j * toStride), _mm_unpacklo_epi64(b[j], b[8 + j]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(to + (2 * j + 1) * toStride),
+                             _mm_unpackhi_epi64(b[j], b[8 + j]));
+        }
+    }
+};
+
+// 8 x 8 of 16 bit elements, the same rounds without the byte one
+template<>
+struct TransposeTile<uint16_t>
+{
+    static constexpr unsigned edge = 8;
+    static void run(const uint16_t* from, int64_t fromStride, uint16_t* to, int64_t toStride)
+    {
+        __m128i a[8], b[8];
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i * fromStride));
+        }
+        for (unsigned i = 0; i < 8; i += 2)
+        {
+            b[i] = _mm_unpacklo_epi16(a[i], a[i + 1]);
+            b[i + 1] = _mm_unpackhi_epi16(a[i], a[i + 1]);
+        }
+        for (unsigned i = 0; i < 8; i += 4)
+        {
+            a[i] = _mm_unpacklo_epi32(b[i], b[i + 2]);
+            a[i + 1] = _mm_unpackhi_epi32(b[i], b[i + 2]);
+            a[i + 2] = _mm_unpacklo_epi32(b[i + 1], b[i + 3]);
+            a[i + 3] = _mm_unpackhi_epi32(b[i + 1], b[i + 3]);
+        }
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(to + 2 * j * toStride), _mm_unpacklo_epi64(a[j], a[4 + j]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(to + (2 * j + 1) * toStride),
+                             _mm_unpackhi_epi64(a[j], a[4 + j]));
+        }
+    }
+};
+
+// 8 x 8 of 32 bit elements: pairs, quads within the 128 bit lanes, then the lanes
+template<>
+struct TransposeTile<uint32_t>
+{
+    static constexpr unsigned edge = 8;
+    static void run(const uint32_t* from, int64_t fromStride, uint32_t* to, int64_t toStride)
+    {
+        __m256 a[8], b[8];
+        for (unsigned i = 0; i < 8; ++i) a[i] = _mm256_loadu_ps(reinterpret_cast<const float*>(from + i * fromStride));
+        for (unsigned i = 0; i < 8; i += 2)
+        {
+            b[i] = _mm256_unpacklo_ps(a[i], a[i + 1]);
+            b[i + 1] = _mm256_unpackhi_ps(a[i], a[i + 1]);
+        }
+        for (unsigned i = 0; i < 8; i += 4)
+        {
+            a[i] = _mm256_shuffle_ps(b[i], b[i + 2], 0x44);
+            a[i + 1] = _mm256_shuffle_ps(b[i], b[i + 2], 0xEE);
+            a[i + 2] = _mm256_shuffle_ps(b[i + 1], b[i + 3], 0x44);
+            a[i + 3] = _mm256_shuffle_ps(b[i + 1], b[i + 3], 0xEE);
+        }
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            _mm256_storeu_ps(reinterpret_cast<float*>(to + j * toStride), _mm256_permute2f128_ps(a[j], a[4 + j], 0x20));
+            _mm256_storeu_ps(reinterpret_cast<float*>(to + (4 + j) * toStride),
+                             _mm256_permute2f128_ps(a[j], a[4 + j], 0x31));
+        }
+    }
+};
+
+// 4 x 4 of 64 bit elements
+template<>
+struct TransposeTile<uint64_t>
+{
+    static constexpr unsigned edge = 4;
+    static void run(const uint64_t* from, int64_t fromStride, uint64_t* to, int64_t toStride)
+    {
+        __m256d a[4], b[4];
+        for (unsigned i = 0; i < 4; ++i) a[i] = _mm256_loadu_pd(reinterpret_cast<const double*>(from + i * fromStride));
+        b[0] = _mm256_unpacklo_pd(a[0], a[1]);
+        b[1] = _mm256_unpackhi_pd(a[0], a[1]);
+        b[2] = _mm256_unpacklo_pd(a[2], a[3]);
+        b[3] = _mm256_unpackhi_pd(a[2], a[3]);
+        for (unsigned j = 0; j < 2; ++j)
+        {
+            _mm256_storeu_pd(reinterpret_cast<double*>(to + j * toStride),
+                             _mm256_permute2f128_pd(b[j], b[2 + j], 0x20));
+            _mm256_storeu_pd(reinterpret_cast<double*>(to + (2 + j) * toStride),
+                             _mm256_permute2f128_pd(b[j], b[2 + j], 0x31));
+        }
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+// to[r * toStride + c] = from[c * fromStride + r] for one band of micro tile rows starting at r and the columns
+// [begin, end) of it. the columns that do not fill a micro tile are moved one element at a time
+template<typename E>
+void transposeBand(const E* src, int64_t fromStride, uint64_t r, uint64_t begin, uint64_t end, E* to,
+                   int64_t toStride)
+{
+    constexpr unsigned edge = TransposeTile<E>::edge;
+    uint64_t c = begin;
+    for (; c + edge <= end; c += edge)
+    {
+        TransposeTile<E>::run(src + static_cast<int64_t>(c) * fromStride + static_cast<int64_t>(r), fromStride,
+                              to + static_cast<int64_t>(c), toStride);
+    }
+    for (unsigned i = 0; i < edge; ++i)
+    {
+        for (uint64_t j = c; j < end; ++j)
+        {
+            to[i * toStride + static_cast<int64_t>(j)] =
+                src[static_cast<int64_t>(j) * fromStride + static_cast<int64_t>(r + i)];
+        }
+    }
+}
+
+// to = from over `bytes`, with non-temporal stores for the 32 byte aligned part
+inline void streamLine(const uint8_t* from, uint8_t* to, uint64_t bytes)
+{
+    const uint64_t head = std::min<uint64_t>(bytes, (32 - (reinterpret_cast<uintptr_t>(to) & 31)) & 31);
+    std::memcpy(to, from, head);
+    uint64_t i = head;
+    for (; i + 32 <= bytes; i += 32)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(to + i),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i)));
+    }
+    std::memcpy(to + i, from + i, bytes - i);
+}
+#endif
+
+// to[r * toStride + c] = from[c * fromStride + r], see KernelTable::transpose. the block is covered in bands of
+// micro tile rows. a streamed band goes through a small buffer first: the micro tiles write 16 or 32 bytes per
+// row, and non-temporal stores only pay off when whole lines are written back to back
+template<typename E>
+void transposeBlock(uint64_t rows, uint64_t cols, const void* from, int64_t fromStride, void* to, int64_t toStride,
+                    bool streaming)
+{
+    const E* src = static_cast<const E*>(from);
+    E* dst = static_cast<E*>(to);
+    uint64_t r = 0;
+#if defined(__AVX2__)
+    constexpr unsigned edge = TransposeTile<E>::edge;
+    constexpr uint64_t chunk = 512 / sizeof(E);
+    alignas(64) E band[edge * chunk];
+    for (; r + edge <= rows; r += edge)
+    {
+        E* line = dst + static_cast<int64_t>(r) * toStride;
+        if (!streaming)
+        {
+            transposeBand(src, fromStride, r, 0, cols, line, toStride);
+            continue;
+        }
+        for (uint64_t begin = 0; begin < cols; begin += chunk)
+        {
+            const uint64_t end = std::min(cols, begin + chunk);
+            transposeBand(src, fromStride, r, begin, end, band - static_cast<int64_t>(begin), chunk);
+            for (unsigned i = 0; i < edge; ++i)
+            {
+                streamLine(reinterpret_cast<const uint8_t*>(band + i * chunk),
+                           reinterpret_cast<uint8_t*>(line + i * toStride + static_cast<int64_t>(begin)),
+                           (end - begin) * sizeof(E));
+            }
+        }
+    }
+    // the stores above are weakly ordered, they must be visible before the caller hands the block on
+    if (streaming) _mm_sfence();
+#else
+    (void)streaming;
+#endif
+    for (; r < rows; ++r)
+    {
+        for (uint64_t c = 0; c < cols; ++c)
+        {
+            dst[static_cast<int64_t>(r) * toStride + static_cast<int64_t>(c)] =
+                src[static_cast<int64_t>(c) * fromStride + static_cast<int64_t>(r)];
+        }
+    }
+}
+
+// gemv weights are loaded through one of these, which decode lanes elements of the storage type into a
+// vector of the compute type
+template<typename S, typename T>
+struct PlainLoad
+{
+    using Src = T;
+    static typename S::V load(const T* p) {return S::load(p);}
+};
+
+struct Bf16Load
+{
+    using Src = uint16_t;
+    static F32::V load(const uint16_t* p) {return F32::loadBf16(p);}
+};
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+struct Fp16Load
+{
+    using Src = uint16_t;
+    static F32::V load(const uint16_t* p) {return F32::loadFp16(p);}
+};
+
+struct Fp8_152Load
+{
+    using Src = uint8_t;
+    static F32::V load(const uint8_t* p) {return F32::loadFp8_152(p);}
+};
+
+struct Fp8_143Load
+{
+    using Src = uint8_t;
+    static F32::V load(const uint8_t* p) {return U32::asF32(U32::gather(kFp8_143DecodeTable.data(), U32::loadU8(p)));}
+};
+
+// a tile of four rows fits the registers together with this many vectors: 4 * NB accumulators,
+// NB vectors of x and one of A
+constexpr unsigned kGemvVectors = sizeof(F32::V) == 64 ? 4 : 2;
+
+#else
+
+struct Fp16Load
+{
+    using Src = uint16_t;
+    static F32::V load(const uint16_t* p) {return Conversions::fp16_to_fp32(*p);}
+};
+
+struct Fp8_152Load
+{
+    using Src = uint8_t;
+    static F32::V load(const uint8_t* p) {return Conversions::fp8_152_to_fp32(*p);}
+};
+
+struct Fp8_143Load
+{
+    using Src = uint8_t;
+    static F32::V load(const uint8_t* p) {return Conversions::fp8_143_to_fp32(*p);}
+};
+
+constexpr unsigned kGemvVectors = 2;
+
+#endif
+
+// R rows of A against NB vectors, every decoded vector of A is used NB times
+template<typename S, typename T, typename L, unsigned R, unsigned NB>
+void gemvRowTile(uint64_t k, const typename L::Src* a, int64_t lda, const T* x, int64_t ldx, T* y, int64_t ldy)
+{
+    using Src = typename L::Src;
+    constexpr unsigned lanes = S::lanes;
+    typename S::V acc[R][NB];
+#pragma GCC unroll 4
+    for (unsigned r = 0; r < R; ++r)
+    {
+#pragma GCC unroll 4
+        for (unsigned b = 0; b < NB; ++b) acc[r][b] = S::zero();
+    }
+    const auto step = [&](const Src* const* rows, const T* const* vectors)
+    {
+        typename S::V xv[NB];
+#pragma GCC unroll 4
+        for (unsigned b = 0; b < NB; ++b) xv[b] = S::load(vectors[b]);
+#pragma GCC unroll 4
+        for (unsigned r = 0; r < R; ++r)
+        {
+            const typename S::V av = L::load(rows[r]);
+#pragma GCC unroll 4
+            for (unsigned b = 0; b < NB; ++b) acc[r][b] = S::fmadd(av, xv[b], acc[r][b]);
+        }
+    };
+    const Src* rows[R];
+    const T* vectors[NB];
+    forEachVector<lanes>(k,
+        [&](uint64_t p)
+        {
+            for (unsigned r = 0; r < R; ++r) rows[r] = a + r * lda + p;
+            for (unsigned b = 0; b < NB; ++b) vectors[b] = x + b * ldx + p;
+            step(rows, vectors);
+        },
+        [&](uint64_t p, unsigned count)
+        {
+            // zero encodes +0 in every storage type
+            Src ta[R][lanes] = {};
+            T tx[NB][lanes] = {};
+            for (unsigned r = 0; r < R; ++r)
+            {
+                for (unsigned l = 0; l < count; ++l) ta[r][l] = a[r * lda + p + l];
+                rows[r] = ta[r];
+            }
+            for (unsigned b = 0; b < NB; ++b)
+            {
+                for (unsigned l = 0; l < count; ++l) tx[b][l] = x[b * ldx + p + l];
+                vectors[b] = tx[b];
+            }
+            step(rows, vectors);
+        });
+    for (unsigned r = 0; r < R; ++r)
+    {
+        for (unsigned b = 0; b < NB; ++b) y[b * ldy + r] += S::reduceAdd(acc[r][b]);
+    }
+}
+
+template<typename S, typename T, typename L, unsigned R>
+void gemvRowTiles(uint64_t k, const typename L::Src* a, int64_t lda, const T* x, int64_t ldx, unsigned batch, T* y,
+                  int64_t ldy)
+{
+    unsigned b = 0;
+    for (; b + kGemvVectors <= batch; b += kGemvVectors)
+    {
+        gemvRowTile<S, T, L, R, kGemvVectors>(k, a, lda, x + b * ldx, ldx, y + b * ldy, ldy);
+    }
+    for (; b < batch; ++b) gemvRowTile<S, T, L, R, 1>(k, a, lda, x + b * ldx, ldx, y + b * ldy, ldy);
+}
+
+// A is walked four rows at a time and the rows of a tile stay in L1 while the vectors go past them
+template<typename S, typename T, typename L>
+void gemvByRows(uint64_t rows, uint64_t k, const typename L::Src* a, int64_t lda, const T* x, int64_t ldx,
+                unsigned batch, T* y, int64_t ldy)
+{
+    uint64_t r = 0;
+    for (; r + 4 <= rows; r += 4) gemvRowTiles<S, T, L, 4>(k, a + r * lda, lda, x, ldx, batch, y + r, ldy);
+    for (; r < rows; ++r) gemvRowTiles<S, T, L, 1>(k, a + r * lda, lda, x, ldx, batch, y + r, ldy);
+}
+
+// A is walked four columns at a time, each pass adds them to y, which the caller keeps short enough for L1
+template<typename S, typename T, typename L>
+void gemvByCols(uint64_t rows, uint64_t k, const typename L::Src* a, int64_t lda, const T* x, int64_t ldx,
+                unsigned batch, T* y, int64_t ldy)
+{
+    using Src = typename L::Src;
+    constexpr unsigned lanes = S::lanes;
+    for (uint64_t p = 0; p < k; p += 4)
+    {
+        // past the last column the weights repeat it and x is taken as zero
+        const unsigned columns = k - p < 4 ? static_cast<unsigned>(k - p) : 4;
+        const Src* col[4];
+        for (unsigned j = 0; j < 4; ++j) col[j] = a + (p + (j < columns ? j : columns - 1)) * lda;
+        const auto xAt = [&](unsigned b, unsigned j) {return S::set1(j < columns ? x[b * ldx + p + j] : T(0));};
+        const auto update = [&](const typename S::V (&av)[4], T* yb, unsigned b)
+        {
+            typename S::V yv = S::load(yb);
+            yv = S::fmadd(av[0], xAt(b, 0), yv);
+            yv = S::fmadd(av[1], xAt(b, 1), yv);
+            yv = S::fmadd(av[2], xAt(b, 2), yv);
+            yv = S::fmadd(av[3], xAt(b, 3), yv);
+            S::store(yb, yv);
+        };
+        forEachVector<lanes>(rows,
+            [&](uint64_t i)
+            {
+                const typename S::V av[4] = {L::load(col[0] + i), L::load(col[1] + i), L::load(col[2] + i),
+                                             L::load(col[3] + i)};
+                for (unsigned b = 0; b < batch; ++b) update(av, y + b * ldy + i, b);
+            },
+            [&](uint64_t i, unsigned count)
+            {
+                Src ta[4][lanes] = {};
+                for (unsigned j = 0; j < 4; ++j)
+                {
+                    for (unsigned l = 0; l < count; ++l) ta[j][l] = col[j][i + l];
+                }
+                const typename S::V av[4] = {L::load(ta[0]), L::load(ta[1]), L::load(ta[2]), L::load(ta[3])};
+                for (unsigned b = 0; b < batch; ++b)
+                {
+                    T ty[lanes] = {};
+                    for (unsigned l = 0; l < count; ++l) ty[l] = y[b * ldy + i + l];
+                    update(av, ty, b);
+                    for (unsigned l = 0; l < count; ++l) y[b * ldy + i + l] = ty[l];
+                }
+            });
+    }
+}
+
+template<typename S, typename T, typename L>
+constexpr GemvKernels<typename L::Src, T> makeGemvKernels()
+{
+    GemvKernels<typename L::Src, T> kernels;
+    kernels.byRows = &gemvByRows<S, T, L>;
+    kernels.byCols = &gemvByCols<S, T, L>;
+    return kernels;
+}
+
+// accumulates an MR x (NV * lanes) tile in registers, every k step loads NV vectors of B and
+// broadcasts MR values of A.
+template<typename S, unsigned MR, unsigned NV, typename T>
+void gemmMicroKernel(uint64_t k, const T* a, const T* b, T* c, int64_t ldc, T alpha, T beta)
+{
+    constexpr unsigned lanes = S::lanes;
+    typename S::V acc[MR][NV];
+#pragma GCC unroll 16
+    for (unsigned r = 0; r < MR; ++r)
+    {
+#pragma GCC unroll 4
+        for (unsigned v = 0; v < NV; ++v) acc[r][v] = S::zero();
+    }
+    for (uint64_t p = 0; p < k; ++p)
+    {
+        typename S::V bv[NV];
+#pragma GCC unroll 4
+        for (unsigned v = 0; v < NV; ++v) bv[v] = S::load(b + v * lanes);
+#pragma GCC unroll 16
+        for (unsigned r = 0; r < MR; ++r)
+        {
+            const typename S::V av = S::set1(a[r]);
+#pragma GCC unroll 4
+            for (unsigned v = 0; v < NV; ++v) acc[r][v] = S::fmadd(av, bv[v], acc[r][v]);
+        }
+        a += MR;
+        b += NV * lanes;
+    }
+    const typename S::V va = S::set1(alpha);
+    const typename S::V vb = S::set1(beta);
+#pragma GCC unroll 16
+    for (unsigned r = 0; r < MR; ++r)
+    {
+        T* cRow = c + r * ldc;
+#pragma GCC unroll 4
+        for (unsigned v = 0; v < NV; ++v)
+        {
+            typename S::V result = S::mul(acc[r][v], va);
+            if (beta != T(0)) result = S::fmadd(S::load(cRow + v * lanes), vb, result);
+            S::store(cRow + v * lanes, result);
+        }
+    }
+}
+
+template<typename S, unsigned MR, unsigned NV, typename T>
+constexpr GemmKernel<T> makeGemmKernel(unsigned mcRows, unsigned kc, unsigned nc)
+{
+    GemmKernel<T> kernel;
+    kernel.mr = MR;
+    kernel.nr = NV * S::lanes;
+    kernel.mc = mcRows;
+    kernel.kc = kc;
+    kernel.nc = nc;
+    kernel.microKernel = &gemmMicroKernel<S, MR, NV, T>;
+    return kernel;
+}
+
+// the integer tile: every step of 4 along the depth broadcasts 4 bytes of each row of A and takes the dot
+// products with the 4 bytes of every column of B, with VNNI in a single instruction per vector.
+template<unsigned MR, unsigned NV>
+void gemmI8MicroKernel(uint64_t k, const uint8_t* a, const int8_t* b, int32_t* c, int64_t ldc,
+                       const int32_t* colOffsets, bool accumulate)
+{
+    constexpr unsigned lanes = I32::lanes;
+    I32::V acc[MR][NV];
+#pragma GCC unroll 4
+    for (unsigned v = 0; v < NV; ++v)
+    {
+        const I32::V offset = colOffsets ? I32::load(colOffsets + v * lanes) : I32::zero();
+#pragma GCC unroll 16
+        for (unsigned r = 0; r < MR; ++r)
+        {
+            acc[r][v] = accumulate ? I32::add(I32::load(c + r * ldc + v * lanes), offset) : offset;
+        }
+    }
+    for (uint64_t p = 0; p < k; p += 4)
+    {
+        I32::V bv[NV];
+#pragma GCC unroll 4
+        for (unsigned v = 0; v < NV; ++v) bv[v] = I32::loadBytes(b + v * lanes * 4);
+#pragma GCC unroll 16
+        for (unsigned r = 0; r < MR; ++r)
+        {
+            int32_t quad;
+            __builtin_memcpy(&quad, a + r * 4, sizeof(quad));
+            const I32::V av = I32::set1(quad);
+#pragma GCC unroll 4
+            for (unsigned v = 0; v < NV; ++v) acc[r][v] = I32::dot4(acc[r][v], av, bv[v]);
+        }
+        a += MR * 4;
+        b += NV * lanes * 4;
+    }
+#pragma GCC unroll 16
+    for (unsigned r = 0; r < MR; ++r)
+    {
+#pragma GCC unroll 4
+        for (unsigned v = 0; v < NV; ++v) I32::store(c + r * ldc + v * lanes, acc[r][v]);
+    }
+}
+
+template<unsigned MR, unsigned NV>
+constexpr GemmI8Kernel makeGemmI8Kernel(unsigned mcRows, unsigned kc, unsigned nc)
+{
+    GemmI8Kernel kernel;
+    kernel.mr = MR;
+    kernel.nr = NV * I32::lanes;
+    kernel.mc = mcRows;
+    kernel.kc = kc;
+    kernel.nc = nc;
+    kernel.microKernel = &gemmI8MicroKernel<MR, NV>;
+    return kernel;
+}
+
+#if defined(__AMX_TILE__) && defined(__AMX_INT8__) && defined(__AMX_BF16__)
+// the tile kernels compute a 32 x 32 block of C held in 2 x 2 tiles of 16 x 16 fp32 or int32. every step
+// along the depth loads 2 tiles of A (16 rows of 64 bytes) and 2 of B (16 rows of the depth pairs or quads
+// of 16 columns). all 8 tiles are 16 rows of 64 bytes, so one configuration serves both kernels.
+struct alignas(64) TileConfig
+{
+    uint8_t palette;
+    uint8_t startRow;
+    uint8_t reserved[14];
+    uint16_t colsb[16];
+    uint8_t rows[16];
+};
+
+// the configuration is per thread state, the first tile kernel a thread runs loads it
+inline void configureTiles()
+{
+    thread_local bool configured = false;
+    if (configured) return;
+    TileConfig config = {};
+    config.palette = 1;
+    for (unsigned t = 0; t < 8; ++t)
+    {
+        config.colsb[t] = 64;
+        config.rows[t] = 16;
+    }
+    _tile_loadconfig(&config);
+    configured = true;
+}
+
+inline void gemmAmxBf16MicroKernel(uint64_t k, const uint16_t* a, const uint16_t* b, float* c, int64_t ldc,
+                                   float alpha, float beta)
+{
+    configureTiles();
+    _tile_zero(0);
+    _tile_zero(1);
+    _tile_zero(2);
+    _tile_zero(3);
+    const int64_t aStride = static_cast<int64_t>(k) * 2;
+    for (uint64_t p = 0; p < k; p += 32)
+    {
+        // 32 depth values of 16 rows of A, 16 pairs of the depth for 16 columns of B
+        _tile_loadd(4, a + p, aStride);
+        _tile_loadd(5, a + 16 * k + p, aStride);
+        _tile_loadd(6, b + p * 32, 128);
+        _tile_loadd(7, b + p * 32 + 32, 128);
+        _tile_dpbf16ps(0, 4, 6);
+        _tile_dpbf16ps(1, 4, 7);
+        _tile_dpbf16ps(2, 5, 6);
+        _tile_dpbf16ps(3, 5, 7);
+    }
+    alignas(64) float tile[32 * 32];
+    _tile_stored(0, tile, 128);
+    _tile_stored(1, tile + 16, 128);
+    _tile_stored(2, tile + 16 * 32, 128);
+    _tile_stored(3, tile + 16 * 32 + 16, 128);
+    const F32::V va = F32::set1(alpha);
+    const F32::V vb = F32::set1(beta);
+    for (unsigned r = 0; r < 32; ++r)
+    {
+#pragma GCC unroll 2
+        for (unsigned v = 0; v < 2; ++v)
+        {
+            F32::V result = F32::mul(F32::load(tile + r * 32 + v * 16), va);
+            if (beta != 0.0f) result = F32::fmadd(F32::load(c + r * ldc + v * 16), vb, result);
+            F32::store(c + r * ldc + v * 16, result);
+        }
+    }
+}
+
+inline void gemmAmxI8MicroKernel(uint64_t k, const uint8_t* a, const int8_t* b, int32_t* c, int64_t ldc,
+                                 const int32_t* colOffsets, bool accumulate)
+{
+    configureTiles();
+    _tile_zero(0);
+    _tile_zero(1);
+    _tile_zero(2);
+    _tile_zero(3);
+    const int64_t aStride = static_cast<int64_t>(k);
+    for (uint64_t p = 0; p < k; p += 64)
+    {
+        // 64 depth bytes of 16 rows of A, 16 quads of the depth for 16 columns of B
+        _tile_loadd(4, a + p, aStride);
+        _tile_loadd(5, a + 16 * k + p, aStride);
+        _tile_loadd(6, b + p * 32, 128);
+        _tile_loadd(7, b + p * 32 + 64, 128);
+        _tile_dpbusd(0, 4, 6);
+        _tile_dpbusd(1, 4, 7);
+        _tile_dpbusd(2, 5, 6);
+        _tile_dpbusd(3, 5, 7);
+    }
+    alignas(64) int32_t tile[32 * 32];
+    _tile_stored(0, tile, 128);
+    _tile_stored(1, tile + 16, 128);
+    _tile_stored(2, tile + 16 * 32, 128);
+    _tile_stored(3, tile + 16 * 32 + 16, 128);
+    for (unsigned v = 0; v < 2; ++v)
+    {
+        const I32::V offset = colOffsets ? I32::load(colOffsets + v * 16) : I32::zero();
+        for (unsigned r = 0; r < 32; ++r)
+        {
+            I32::V result = I32::add(I32::load(tile + r * 32 + v * 16), offset);
+            if (accumulate) result = I32::add(result, I32::load(c + r * ldc + v * 16));
+            I32::store(c + r * ldc + v * 16, result);
+        }
+    }
+}
+
+constexpr GemmBf16Kernel makeAmxBf16Kernel(unsigned mc, unsigned kc, unsigned nc)
+{
+    GemmBf16Kernel kernel;
+    kernel.mr = 32;
+    kernel.nr = 32;
+    kernel.mc = mc;
+    kernel.kc = kc;
+    kernel.nc = nc;
+    kernel.depthAlign = 32;
+    kernel.microKernel = &gemmAmxBf16MicroKernel;
+    return kernel;
+}
+
+constexpr GemmI8Kernel makeAmxI8Kernel(unsigned mc, unsigned kc, unsigned nc)
+{
+    GemmI8Kernel kernel;
+    kernel.mr = 32;
+    kernel.nr = 32;
+    kernel.mc = mc;
+    kernel.kc = kc;
+    kernel.nc = nc;
+    kernel.depthAlign = 64;
+    kernel.rowPanelA = true;
+    kernel.microKernel = &gemmAmxI8MicroKernel;
+    return kernel;
+}
+#endif
+
+inline KernelTable makeKernelTable(IsaLevel isa)
+{
+    KernelTable table;
+    table.isa = isa;
+    table.axpyF32 = &axpy<F32, float>;
+    table.axpyF64 = &axpy<F64, double>;
+    table.axpyI32 = &axpy<I32, int32_t>;
+    table.dotF32 = &dot<F32, float>;
+    table.dotF64 = &dot<F64, double>;
+    table.asumF32 = &asum<F32, float>;
+    table.asumF64 = &asum<F64, double>;
+    table.amaxF32 = &amax<F32, float>;
+    table.amaxF64 = &amax<F64, double>;
+    table.scalF32 = &scal<F32, float>;
+    table.scalF64 = &scal<F64, double>;
+    table.rotF32 = &rot<F32, float>;
+    table.rotF64 = &rot<F64, double>;
+    table.f32ToBf16 = &f32ToBf16;
+    table.bf16ToF32 = &bf16ToF32;
+    table.f32ToFp16 = &f32ToFp16;
+    table.fp16ToF32 = &fp16ToF32;
+    table.f32ToTf32 = &f32ToTf32;
+    table.f32ToFp8_152 = &f32ToFp8_152;
+    table.fp8_152ToF32 = &fp8_152ToF32;
+    table.f32ToFp8_143 = &f32ToFp8_143;
+    table.fp8_143ToF32 = &fp8_143ToF32;
+    table.quantizeI8 = &quantizeI8;
+    table.dequantizeI8 = &dequantizeI8;
+    table.scalClampF32 = &scalClampF32;
+    table.transpose[0] = &transposeBlock<uint8_t>;
+    table.transpose[1] = &transposeBlock<uint16_t>;
+    table.transpose[2] = &transposeBlock<uint32_t>;
+    table.transpose[3] = &transposeBlock<uint64_t>;
+    table.gemvF32 = makeGemvKernels<F32, float, PlainLoad<F32, float>>();
+    table.gemvBf16 = makeGemvKernels<F32, float, Bf16Load>();
+    table.gemvFp16 = makeGemvKernels<F32, float, Fp16Load>();
+    table.gemvFp8_152 = makeGemvKernels<F32, float, Fp8_152Load>();
+    table.gemvFp8_143 = makeGemvKernels<F32, float, Fp8_143Load>();
+    table.gemvF64 = makeGemvKernels<F64, double, PlainLoad<F64, double>>();
+    // register budget: MR * NV accumulators plus NV loads of B and one broadcast of A
+#if defined(__AVX512F__)
+    table.gemmF32 = makeGemmKernel<F32, 12, 2, float>(240, 384, 3072);
+    table.gemmF64 = makeGemmKernel<F64, 12, 2, double>(120, 384, 2048);
+#elif defined(__AVX2__)
+    table.gemmF32 = makeGemmKernel<F32, 6, 2, float>(144, 256, 3072);
+    table.gemmF64 = makeGemmKernel<F64, 6, 2, double>(96, 256, 2048);
+#else
+    table.gemmF32 = makeGemmKernel<F32, 4, 4, float>(64, 256, 1024);
+    table.gemmF64 = makeGemmKernel<F64, 4, 4, double>(64, 256, 1024);
+#endif
+    // the depth block is in bytes, 4 times the fp32 one for the same L1 footprint of a B sliver
+#if defined(__AVX512VNNI__)
+    table.gemmI8 = makeGemmI8Kernel<12, 2>(240, 1536, 3072);
+#elif defined(__AVX512F__)
+    // the VNNI emulation needs 4 more registers per column vector
+    table.gemmI8 = makeGemmI8Kernel<8, 2>(240, 1536, 3072);
+#elif defined(__AVXVNNI__)
+    table.gemmI8 = makeGemmI8Kernel<6, 2>(144, 1024, 3072);
+#elif defined(__AVX2__)
+    table.gemmI8 = makeGemmI8Kernel<4, 2>(144, 1024, 3072);
+#else
+    table.gemmI8 = makeGemmI8Kernel<4, 4>(64, 1024, 1024);
+#endif
+#if defined(__AMX_TILE__) && defined(__AMX_INT8__) && defined(__AMX_BF16__)
+    table.gemmBf16 = makeAmxBf16Kernel(256, 512, 2048);
+    table.gemmI8 = makeAmxI8Kernel(256, 1024, 2048);
+#endif
+    return table;
+}
+
+} // namespace gblas::kernels::GBLAS_KERNEL_NAMESPACE
+
+#endif //GBLAS_KERNELS_IMPL_H
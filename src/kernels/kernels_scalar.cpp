@@ -0,0 +1,18 @@
+#define GBLAS_KERNEL_NAMESPACE scalar
+#include "kernels_impl.h"
+
+namespace gblas::kernels::scalar {
+
+// the generic build can share the scalar conversions with the rest of the library
+F32::V F32::loadFp16(const uint16_t* p)
+{
+    return Conversions::fp16_to_fp32(*p);
+}
+
+const KernelTable& kernelTable()
+{
+    static const KernelTable table = makeKernelTable(IsaLevel::Scalar);
+    return table;
+}
+
+} // namespace gblas::kernels::scalar
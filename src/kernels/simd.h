@@ -0,0 +1,401 @@
+#ifndef GBLAS_SIMD_H
+#define GBLAS_SIMD_H
+
+// Thin vector abstraction used by the kernel implementations.
+// This header is compiled once per instruction set (see kernels_<isa>.cpp) and the width of every
+// type follows the flags of the including translation unit. All of it lives in the per-ISA
+// namespace, and kernel code must not call inline helpers shared with the rest of the library:
+// the linker is free to keep the AVX-512 copy of such a helper and hand it to generic callers.
+
+#ifndef GBLAS_KERNEL_NAMESPACE
+#error "simd.h must be included from an ISA specific kernel translation unit"
+#endif
+
+#include <cstdint>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace gblas::kernels::GBLAS_KERNEL_NAMESPACE {
+
+#if defined(__AVX512F__)
+
+struct F32
+{
+    using V = __m512;
+    static constexpr unsigned lanes = 16;
+    static V load(const float* p) {return _mm512_loadu_ps(p);}
+    static void store(float* p, V v) {_mm512_storeu_ps(p, v);}
+    static V set1(float s) {return _mm512_set1_ps(s);}
+    static V zero() {return _mm512_setzero_ps();}
+    static V add(V a, V b) {return _mm512_add_ps(a, b);}
+    static V sub(V a, V b) {return _mm512_sub_ps(a, b);}
+    static V mul(V a, V b) {return _mm512_mul_ps(a, b);}
+    // a * b + c
+    static V fmadd(V a, V b, V c) {return _mm512_fmadd_ps(a, b, c);}
+    static V abs(V a) {return _mm512_abs_ps(a);}
+    // b when either one is NaN
+    static V max(V a, V b) {return _mm512_max_ps(a, b);}
+    static V min(V a, V b) {return _mm512_min_ps(a, b);}
+    static float reduceAdd(V a) {return _mm512_reduce_add_ps(a);}
+    static float reduceMax(V a) {return _mm512_reduce_max_ps(a);}
+    static V loadI8(const int8_t* p)
+    {
+        return _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+    }
+    static V loadBf16(const uint16_t* p)
+    {
+        __m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        return _mm512_castsi512_ps(_mm512_slli_epi32(wide, 16));
+    }
+    static V loadFp16(const uint16_t* p)
+    {
+        return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    }
+    // fp8_152 is the upper byte of an fp16
+    static V loadFp8_152(const uint8_t* p)
+    {
+        __m256i half = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return _mm512_cvtph_ps(_mm256_slli_epi16(half, 8));
+    }
+};
+
+struct F64
+{
+    using V = __m512d;
+    static constexpr unsigned lanes = 8;
+    static V load(const double* p) {return _mm512_loadu_pd(p);}
+    static void store(double* p, V v) {_mm512_storeu_pd(p, v);}
+    static V set1(double s) {return _mm512_set1_pd(s);}
+    static V zero() {return _mm512_setzero_pd();}
+    static V add(V a, V b) {return _mm512_add_pd(a, b);}
+    static V sub(V a, V b) {return _mm512_sub_pd(a, b);}
+    static V mul(V a, V b) {return _mm512_mul_pd(a, b);}
+    static V fmadd(V a, V b, V c) {return _mm512_fmadd_pd(a, b, c);}
+    static V abs(V a) {return _mm512_abs_pd(a);}
+    static V max(V a, V b) {return _mm512_max_pd(a, b);}
+    static double reduceAdd(V a) {return _mm512_reduce_add_pd(a);}
+    static double reduceMax(V a) {return _mm512_reduce_max_pd(a);}
+};
+
+struct I32
+{
+    using V = __m512i;
+    static constexpr unsigned lanes = 16;
+    static V load(const int32_t* p) {return _mm512_loadu_si512(p);}
+    static void store(int32_t* p, V v) {_mm512_storeu_si512(p, v);}
+    static V set1(int32_t s) {return _mm512_set1_epi32(s);}
+    static V zero() {return _mm512_setzero_si512();}
+    static V add(V a, V b) {return _mm512_add_epi32(a, b);}
+    static V mul(V a, V b) {return _mm512_mullo_epi32(a, b);}
+    static V fmadd(V a, V b, V c) {return add(mul(a, b), c);}
+    // rounded to nearest even
+    static V fromF32(F32::V v) {return _mm512_cvtps_epi32(v);}
+    // saturated to int8
+    static void storeI8(int8_t* p, V v) {_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtsepi32_epi8(v));}
+    // 4 bytes per lane
+    static V loadBytes(const int8_t* p) {return _mm512_loadu_si512(p);}
+    // acc + the sum of the 4 products of the unsigned bytes of a with the signed bytes of b, per lane
+    static V dot4(V acc, V a, V b)
+    {
+#if defined(__AVX512VNNI__)
+        return _mm512_dpbusd_epi32(acc, a, b);
+#else
+        // widened to 16 bits first: vpmaddubsw would saturate the pair sums of large unsigned bytes
+        const V aEven = _mm512_and_si512(a, _mm512_set1_epi16(0x00FF));
+        const V aOdd = _mm512_srli_epi16(a, 8);
+        const V bEven = _mm512_srai_epi16(_mm512_slli_epi16(b, 8), 8);
+        const V bOdd = _mm512_srai_epi16(b, 8);
+        return _mm512_add_epi32(acc, _mm512_add_epi32(_mm512_madd_epi16(aEven, bEven), _mm512_madd_epi16(aOdd, bOdd)));
+#endif
+    }
+};
+
+// 32 bit lanes used for bit manipulation, M is the per lane predicate
+struct U32
+{
+    using V = __m512i;
+    using M = __mmask16;
+    static constexpr unsigned lanes = 16;
+    static V load(const uint32_t* p) {return _mm512_loadu_si512(p);}
+    static V load(const float* p) {return _mm512_castps_si512(_mm512_loadu_ps(p));}
+    static V loadU16(const uint16_t* p) {return _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));}
+    static V loadU8(const uint8_t* p) {return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));}
+    static void store(uint32_t* p, V v) {_mm512_storeu_si512(p, v);}
+    // narrowing stores keep the low bits of every lane
+    static void storeU16(uint16_t* p, V v) {_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(v));}
+    static void storeU8(uint8_t* p, V v) {_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm512_cvtepi32_epi8(v));}
+    static V set1(uint32_t s) {return _mm512_set1_epi32(static_cast<int>(s));}
+    static V add(V a, V b) {return _mm512_add_epi32(a, b);}
+    static V sub(V a, V b) {return _mm512_sub_epi32(a, b);}
+    static V bitAnd(V a, V b) {return _mm512_and_si512(a, b);}
+    static V bitOr(V a, V b) {return _mm512_or_si512(a, b);}
+    template<unsigned count> static V shr(V v) {return _mm512_srli_epi32(v, count);}
+    template<unsigned count> static V shl(V v) {return _mm512_slli_epi32(v, count);}
+    // per lane shifts, counts of 32 and above produce zero
+    static V shrv(V v, V counts) {return _mm512_srlv_epi32(v, counts);}
+    static V shlv(V v, V counts) {return _mm512_sllv_epi32(v, counts);}
+    static V minU(V a, V b) {return _mm512_min_epu32(a, b);}
+    static M eq(V a, V b) {return _mm512_cmpeq_epi32_mask(a, b);}
+    // signed compare
+    static M gt(V a, V b) {return _mm512_cmpgt_epi32_mask(a, b);}
+    static M nonZero(V v) {return _mm512_test_epi32_mask(v, v);}
+    static M none() {return 0;}
+    static M maskAnd(M a, M b) {return a & b;}
+    static M maskOr(M a, M b) {return a | b;}
+    static M maskNot(M a) {return static_cast<M>(~a);}
+    static V select(M m, V ifTrue, V ifFalse) {return _mm512_mask_blend_epi32(m, ifFalse, ifTrue);}
+    static V incrementIf(M m, V v) {return _mm512_mask_add_epi32(v, m, v, set1(1));}
+    static F32::V asF32(V v) {return _mm512_castsi512_ps(v);}
+    static V fromF32(F32::V v) {return _mm512_castps_si512(v);}
+    // signed integer to float value conversion
+    static F32::V toF32(V v) {return _mm512_cvtepi32_ps(v);}
+
+    // reads table[index] for every lane
+    static V gather(const uint32_t* table, V index) {return _mm512_i32gather_epi32(index, table, 4);}
+};
+
+#elif defined(__AVX2__)
+
+struct F32
+{
+    using V = __m256;
+    static constexpr unsigned lanes = 8;
+    static V load(const float* p) {return _mm256_loadu_ps(p);}
+    static void store(float* p, V v) {_mm256_storeu_ps(p, v);}
+    static V set1(float s) {return _mm256_set1_ps(s);}
+    static V zero() {return _mm256_setzero_ps();}
+    static V add(V a, V b) {return _mm256_add_ps(a, b);}
+    static V sub(V a, V b) {return _mm256_sub_ps(a, b);}
+    static V mul(V a, V b) {return _mm256_mul_ps(a, b);}
+    static V fmadd(V a, V b, V c) {return _mm256_fmadd_ps(a, b, c);}
+    static V abs(V a) {return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);}
+    // b when either one is NaN
+    static V max(V a, V b) {return _mm256_max_ps(a, b);}
+    static V min(V a, V b) {return _mm256_min_ps(a, b);}
+    static float reduceAdd(V a)
+    {
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehdup_ps(sum)));
+    }
+    static float reduceMax(V a)
+    {
+        __m128 result = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        result = _mm_max_ps(result, _mm_movehl_ps(result, result));
+        return _mm_cvtss_f32(_mm_max_ss(result, _mm_movehdup_ps(result)));
+    }
+    static V loadBf16(const uint16_t* p)
+    {
+        __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16));
+    }
+    static V loadFp16(const uint16_t* p)
+    {
+        return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    // fp8_152 is the upper byte of an fp16
+    static V loadFp8_152(const uint8_t* p)
+    {
+        __m128i half = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        return _mm256_cvtph_ps(_mm_slli_epi16(half, 8));
+    }
+    static V loadI8(const int8_t* p)
+    {
+        return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    }
+};
+
+struct F64
+{
+    using V = __m256d;
+    static constexpr unsigned lanes = 4;
+    static V load(const double* p) {return _mm256_loadu_pd(p);}
+    static void store(double* p, V v) {_mm256_storeu_pd(p, v);}
+    static V set1(double s) {return _mm256_set1_pd(s);}
+    static V zero() {return _mm256_setzero_pd();}
+    static V add(V a, V b) {return _mm256_add_pd(a, b);}
+    static V sub(V a, V b) {return _mm256_sub_pd(a, b);}
+    static V mul(V a, V b) {return _mm256_mul_pd(a, b);}
+    static V fmadd(V a, V b, V c) {return _mm256_fmadd_pd(a, b, c);}
+    static V abs(V a) {return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);}
+    static V max(V a, V b) {return _mm256_max_pd(a, b);}
+    static double reduceAdd(V a)
+    {
+        __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    }
+    static double reduceMax(V a)
+    {
+        __m128d result = _mm_max_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(result, _mm_unpackhi_pd(result, result)));
+    }
+};
+
+struct I32
+{
+    using V = __m256i;
+    static constexpr unsigned lanes = 8;
+    static V load(const int32_t* p) {return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));}
+    static void store(int32_t* p, V v) {_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);}
+    static V set1(int32_t s) {return _mm256_set1_epi32(s);}
+    static V zero() {return _mm256_setzero_si256();}
+    static V add(V a, V b) {return _mm256_add_epi32(a, b);}
+    static V mul(V a, V b) {return _mm256_mullo_epi32(a, b);}
+    static V fmadd(V a, V b, V c) {return add(mul(a, b), c);}
+    // rounded to nearest even
+    static V fromF32(F32::V v) {return _mm256_cvtps_epi32(v);}
+    // saturated to int8
+    static void storeI8(int8_t* p, V v)
+    {
+        __m256i words = _mm256_packs_epi32(v, v);
+        __m256i bytes = _mm256_packs_epi16(words, words);
+        bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(bytes));
+    }
+    // 4 bytes per lane
+    static V loadBytes(const int8_t* p) {return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));}
+    // acc + the sum of the 4 products of the unsigned bytes of a with the signed bytes of b, per lane
+    static V dot4(V acc, V a, V b)
+    {
+#if defined(__AVXVNNI__)
+        return _mm256_dpbusd_avx_epi32(acc, a, b);
+#else
+        // widened to 16 bits first: vpmaddubsw would saturate the pair sums of large unsigned bytes
+        const V aEven = _mm256_and_si256(a, _mm256_set1_epi16(0x00FF));
+        const V aOdd = _mm256_srli_epi16(a, 8);
+        const V bEven = _mm256_srai_epi16(_mm256_slli_epi16(b, 8), 8);
+        const V bOdd = _mm256_srai_epi16(b, 8);
+        return _mm256_add_epi32(acc, _mm256_add_epi32(_mm256_madd_epi16(aEven, bEven), _mm256_madd_epi16(aOdd, bOdd)));
+#endif
+    }
+};
+
+// 32 bit lanes used for bit manipulation, M is the per lane predicate (all ones or all zeros)
+struct U32
+{
+    using V = __m256i;
+    using M = __m256i;
+    static constexpr unsigned lanes = 8;
+    static V load(const uint32_t* p) {return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));}
+    static V load(const float* p) {return _mm256_castps_si256(_mm256_loadu_ps(p));}
+    static V loadU16(const uint16_t* p) {return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));}
+    static V loadU8(const uint8_t* p) {return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));}
+    static void store(uint32_t* p, V v) {_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);}
+    // narrowing stores keep the low bits of every lane, the packs saturate so lanes must already fit
+    static void storeU16(uint16_t* p, V v)
+    {
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+    }
+    static void storeU8(uint8_t* p, V v)
+    {
+        __m256i words = _mm256_packus_epi32(v, v);
+        __m256i bytes = _mm256_packus_epi16(words, words);
+        bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(bytes));
+    }
+    static V set1(uint32_t s) {return _mm256_set1_epi32(static_cast<int>(s));}
+    static V add(V a, V b) {return _mm256_add_epi32(a, b);}
+    static V sub(V a, V b) {return _mm256_sub_epi32(a, b);}
+    static V bitAnd(V a, V b) {return _mm256_and_si256(a, b);}
+    static V bitOr(V a, V b) {return _mm256_or_si256(a, b);}
+    template<unsigned count> static V shr(V v) {return _mm256_srli_epi32(v, count);}
+    template<unsigned count> static V shl(V v) {return _mm256_slli_epi32(v, count);}
+    // per lane shifts, counts of 32 and above produce zero
+    static V shrv(V v, V counts) {return _mm256_srlv_epi32(v, counts);}
+    static V shlv(V v, V counts) {return _mm256_sllv_epi32(v, counts);}
+    static V minU(V a, V b) {return _mm256_min_epu32(a, b);}
+    static M eq(V a, V b) {return _mm256_cmpeq_epi32(a, b);}
+    // signed compare
+    static M gt(V a, V b) {return _mm256_cmpgt_epi32(a, b);}
+    static M nonZero(V v) {return maskNot(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()));}
+    static M none() {return _mm256_setzero_si256();}
+    static M maskAnd(M a, M b) {return _mm256_and_si256(a, b);}
+    static M maskOr(M a, M b) {return _mm256_or_si256(a, b);}
+    static M maskNot(M a) {return _mm256_xor_si256(a, _mm256_set1_epi32(-1));}
+    static V select(M m, V ifTrue, V ifFalse) {return _mm256_blendv_epi8(ifFalse, ifTrue, m);}
+    // a true lane is -1, subtracting it adds one
+    static V incrementIf(M m, V v) {return _mm256_sub_epi32(v, m);}
+    static F32::V asF32(V v) {return _mm256_castsi256_ps(v);}
+    static V fromF32(F32::V v) {return _mm256_castps_si256(v);}
+    // signed integer to float value conversion
+    static F32::V toF32(V v) {return _mm256_cvtepi32_ps(v);}
+
+    // reads table[index] for every lane
+    static V gather(const uint32_t* table, V index) {return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4);}
+};
+
+#else
+
+// single lane fallback, the compiler is free to auto-vectorize the loops built on top of it
+template<typename T>
+struct ScalarVec
+{
+    using V = T;
+    static constexpr unsigned lanes = 1;
+    static V load(const T* p) {return *p;}
+    static void store(T* p, V v) {*p = v;}
+    static V set1(T s) {return s;}
+    static V zero() {return T(0);}
+    static V add(V a, V b) {return a + b;}
+    static V sub(V a, V b) {return a - b;}
+    static V mul(V a, V b) {return a * b;}
+    static V fmadd(V a, V b, V c) {return a * b + c;}
+    static V abs(V a) {return a < T(0) ? -a : a;}
+    // b when either one is NaN, like the vector max instructions
+    static V max(V a, V b) {return a > b ? a : b;}
+    static V min(V a, V b) {return a < b ? a : b;}
+    static T reduceAdd(V a) {return a;}
+    static T reduceMax(V a) {return a;}
+};
+
+struct F32 : ScalarVec<float>
+{
+    static V loadBf16(const uint16_t* p)
+    {
+        uint32_t bits = static_cast<uint32_t>(*p) << 16;
+        float result;
+        __builtin_memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+    static V loadFp16(const uint16_t* p);
+    static V loadI8(const int8_t* p) {return static_cast<float>(*p);}
+};
+using F64 = ScalarVec<double>;
+
+struct I32 : ScalarVec<int32_t>
+{
+    // rounded to nearest even, the value must fit
+    static V fromF32(float v) {return static_cast<int32_t>(__builtin_nearbyintf(v));}
+    static void storeI8(int8_t* p, V v) {*p = static_cast<int8_t>(v < -128 ? -128 : v > 127 ? 127 : v);}
+    static V loadBytes(const int8_t* p)
+    {
+        int32_t bytes;
+        __builtin_memcpy(&bytes, p, sizeof(bytes));
+        return bytes;
+    }
+    // wraps like the vector instructions
+    static V dot4(V acc, V a, V b)
+    {
+        uint32_t sum = static_cast<uint32_t>(acc);
+        for (unsigned t = 0; t < 32; t += 8)
+        {
+            sum += static_cast<uint32_t>(static_cast<int32_t>(static_cast<uint8_t>(a >> t)) *
+                                         static_cast<int32_t>(static_cast<int8_t>(b >> t)));
+        }
+        return static_cast<V>(sum);
+    }
+    // wrap like the vector instructions too, signed overflow is undefined so the arithmetic is done unsigned
+    static V add(V a, V b) {return static_cast<V>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));}
+    static V sub(V a, V b) {return static_cast<V>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));}
+    static V mul(V a, V b) {return static_cast<V>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b));}
+    static V fmadd(V a, V b, V c) {return add(mul(a, b), c);}
+    static V abs(V a) {return a < 0 ? sub(0, a) : a;}
+};
+
+#endif
+
+} // namespace gblas::kernels::GBLAS_KERNEL_NAMESPACE
+
+#endif //GBLAS_SIMD_H
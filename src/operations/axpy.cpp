@@ -2,24 +2,134 @@
 // Created by gmalino on 30/07/2024.
 //
 
-#include "axpy.h"
+#include "operations.h"
 #include "gTensor/gTensor.h"
+#include "gTensor/gTensorIterator.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "kernels/kernels.h"
+#include <algorithm>
 
 namespace gblas {
 
+namespace {
+
+// walk the tensors in chunks and call rowFn(x, y, out, length, xStride, yStride, outStride) with strides in
+// elements. dense tensors collapse into a single chunk, large walks are spread over the thread pool.
+template<typename T, typename RowFn>
+void forEachRow(const gTensor& x, const gTensor& y, gTensor& out, RowFn rowFn)
+{
+    gTensorIterator iterator({&x, &y, &out});
+    iterator.parallelForEachChunk([&](const gTensorIterator::Chunk& chunk)
+    {
+        rowFn(chunk.get<const T>(0), chunk.get<const T>(1), chunk.get<T>(2), chunk.length, chunk.strides[0],
+              chunk.strides[1], chunk.strides[2]);
+    });
+}
+
+template<typename T, typename Kernel>
+gStatus axpyNative(T alpha, const gTensor& x, const gTensor& y, gTensor& out, Kernel kernel)
+{
+    forEachRow<T>(x, y, out, [&](const T* xr, const T* yr, T* outr, uint64_t n, int64_t xs, int64_t ys, int64_t os)
+    {
+        if (xs == 1 && ys == 1 && os == 1)
+        {
+            kernel(n, alpha, xr, yr, outr);
+            return;
+        }
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            outr[i * os] = multiplyAdd(alpha, xr[i * xs], yr[i * ys]);
+        }
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+template<typename T>
+gStatus axpyScalar(T alpha, const gTensor& x, const gTensor& y, gTensor& out)
+{
+    return axpyNative<T>(alpha, x, y, out, [](uint64_t n, T a, const T* xr, const T* yr, T* outr)
+    {
+        for (uint64_t i = 0; i < n; ++i) outr[i] = multiplyAdd(a, xr[i], yr[i]);
+    });
+}
+
+// integer types use alpha truncated to the element type, an alpha that does not fit it fails
 template<typename T>
-gStatus Operations::axpy(uint64_t a, const gTensor &x, const gTensor &y, gTensor &out, bool transposeX, bool transposeY)
+gStatus axpyInteger(double alpha, const gTensor& x, const gTensor& y, gTensor& out)
 {
-    // validate inputs;
+    T factor = 0;
+    if (!toIntegerScalar(alpha, factor)) return gStatus::gBLAS_FAIL;
+    return axpyScalar<T>(factor, x, y, out);
+}
+
+template<typename Storage>
+gStatus axpyWidened(float alpha, const gTensor& x, const gTensor& y, gTensor& out, RoundingMode rounding,
+                    const FloatCodec& codec)
+{
+    const auto axpyF32 = kernels::getKernelTable().axpyF32;
+    forEachRow<Storage>(x, y, out,
+        [&](const Storage* xr, const Storage* yr, Storage* outr, uint64_t n, int64_t xs, int64_t ys, int64_t os)
+    {
+        float xBlock[kStagingElements];
+        float yBlock[kStagingElements];
+        for (uint64_t begin = 0; begin < n; begin += kStagingElements)
+        {
+            const uint64_t count = std::min(kStagingElements, n - begin);
+            codec.widen(reinterpret_cast<const byte*>(xr + begin * xs), xs, count, xBlock);
+            codec.widen(reinterpret_cast<const byte*>(yr + begin * ys), ys, count, yBlock);
+            axpyF32(count, alpha, xBlock, yBlock, xBlock);
+            codec.narrow(xBlock, reinterpret_cast<byte*>(outr + begin * os), os, count, rounding);
+        }
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+} // anonymous namespace
+
+gStatus Operations::axpy(double alpha, const gTensor& x, const gTensor& y, gTensor& out, RoundingMode rounding)
+{
+    // validate inputs
+    const DType dtype = out.getDType();
+    if (x.getDType() != dtype || y.getDType() != dtype) return gStatus::gBLAS_FAIL;
+    if (!sameShape(x, out) || !sameShape(y, out)) return gStatus::gBLAS_FAIL;
+    if (out.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+    if (!x.data() || !y.data() || !out.data()) return gStatus::gBLAS_FAIL;
+
     // perform operation
-    DataBuffer &outDBuf = *out.getDataBuffer();
-    const DataBuffer &xDBuf = *x.getDataBuffer();
-    const DataBuffer &yDBuf = *y.getDataBuffer();
-    for (unsigned i = 0; i < out.getTotalSizeInElements(); ++i)
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    switch (dtype)
     {
-        outDBuf[i] = x * reinterpret_cast<T>(xDBuf[i]) + reinterpret_cast<T>(yDBuf[i]);
+        case DType::fp32:
+            return axpyNative<float>(static_cast<float>(alpha), x, y, out, table.axpyF32);
+        case DType::fp64:
+            return axpyNative<double>(alpha, x, y, out, table.axpyF64);
+        case DType::int32:
+        {
+            int32_t factor = 0;
+            if (!toIntegerScalar(alpha, factor)) return gStatus::gBLAS_FAIL;
+            return axpyNative<int32_t>(factor, x, y, out, table.axpyI32);
+        }
+        case DType::bf16:
+        case DType::fp16:
+            return axpyWidened<uint16_t>(static_cast<float>(alpha), x, y, out, rounding, *getFloatCodec(dtype));
+        case DType::fp8_152:
+        case DType::fp8_143:
+            return axpyWidened<uint8_t>(static_cast<float>(alpha), x, y, out, rounding, *getFloatCodec(dtype));
+        case DType::tf32:
+            return axpyWidened<uint32_t>(static_cast<float>(alpha), x, y, out, rounding, *getFloatCodec(dtype));
+        case DType::int8:
+            return axpyInteger<int8_t>(alpha, x, y, out);
+        case DType::uint8:
+            return axpyInteger<uint8_t>(alpha, x, y, out);
+        case DType::int16:
+            return axpyInteger<int16_t>(alpha, x, y, out);
+        case DType::int64:
+            return axpyInteger<int64_t>(alpha, x, y, out);
+        default:
+            break;
     }
-    return gStatus::gBLAS_PASS;
+    return gStatus::gBLAS_FAIL;
 }
 
-} // namespace gblas
\ No newline at end of file
+} // namespace gblas
@@ -0,0 +1,269 @@
+#include "operations.h"
+#include "gTensor/gTensor.h"
+#include "gTensor/gTensorIterator.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "transpose.h"
+#include "runtime/Parallel.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace gblas {
+
+namespace {
+
+using Chunk = gTensorIterator::Chunk;
+
+// the type a cast converts through: fp32 between the dtypes computed in fp32, int64 between integers and
+// fp64 for the rest, which holds every value of the narrower types exactly
+enum class Via
+{
+    F32,
+    F64,
+    Integer,
+};
+
+bool isIntegerDType(DType dtype)
+{
+    return dtype == DType::int8 || dtype == DType::uint8 || dtype == DType::int16 || dtype == DType::int32 ||
+           dtype == DType::int64;
+}
+
+Via getVia(DType from, DType to)
+{
+    if (getFloatCodec(from) && getFloatCodec(to)) return Via::F32;
+    if (isIntegerDType(from) && isIntegerDType(to)) return Via::Integer;
+    return Via::F64;
+}
+
+// calls fn.template operator()<T>() with the element type of an integer dtype
+template<typename Fn>
+void withIntegerType(DType dtype, Fn fn)
+{
+    switch (dtype)
+    {
+        case DType::int8: fn.template operator()<int8_t>(); break;
+        case DType::uint8: fn.template operator()<uint8_t>(); break;
+        case DType::int16: fn.template operator()<int16_t>(); break;
+        case DType::int32: fn.template operator()<int32_t>(); break;
+        case DType::int64: fn.template operator()<int64_t>(); break;
+        default: break;
+    }
+}
+
+// fp64 to an integer with the rounding of quantize, saturated to the type and NaN to 0
+template<typename I>
+I roundToInteger(double value, RoundingMode rounding)
+{
+    if (std::isnan(value)) return 0;
+    switch (rounding)
+    {
+        case RoundingMode::RoundUp: value = std::ceil(value); break;
+        case RoundingMode::RoundDown: value = std::floor(value); break;
+        case RoundingMode::RoundAwayFromZero: value = std::round(value); break;
+        case RoundingMode::RoundTowardsZero: value = std::trunc(value); break;
+        default: value = std::nearbyint(value); break;
+    }
+    // the bounds of int64 round up to 2^63 in fp64, which is why the upper one is compared with >=
+    if (value <= static_cast<double>(std::numeric_limits<I>::min())) return std::numeric_limits<I>::min();
+    if (value >= static_cast<double>(std::numeric_limits<I>::max())) return std::numeric_limits<I>::max();
+    return static_cast<I>(value);
+}
+
+// fp64 to fp32 with the given rounding, the conversion itself rounds to nearest even
+float roundToFp32(double value, RoundingMode rounding)
+{
+    const float nearest = static_cast<float>(value);
+    const double error = static_cast<double>(nearest) - value;
+    if (std::isnan(value) || error == 0.0) return nearest;
+    const float inf = std::numeric_limits<float>::infinity();
+    switch (rounding)
+    {
+        case RoundingMode::RoundUp: return error < 0.0 ? std::nextafter(nearest, inf) : nearest;
+        case RoundingMode::RoundDown: return error > 0.0 ? std::nextafter(nearest, -inf) : nearest;
+        case RoundingMode::RoundAwayFromZero:
+            return std::abs(nearest) < std::abs(value) ? std::nextafter(nearest, std::copysign(inf, nearest)) : nearest;
+        case RoundingMode::RoundTowardsZero:
+            return std::abs(nearest) > std::abs(value) ? std::nextafter(nearest, 0.0f) : nearest;
+        default: return nearest;
+    }
+}
+
+// fp64 to fp32 rounded to odd: truncated, with the last bit set when that was inexact. narrowing the result
+// further to a type of at least 2 bits less precision rounds as narrowing the fp64 value directly would,
+// which rounding to nearest first does not (a value just above a tie would become the tie)
+float roundToOdd(double value)
+{
+    float truncated = static_cast<float>(value);
+    if (std::isnan(value)) return truncated;
+    if (std::abs(static_cast<double>(truncated)) > std::abs(value)) truncated = std::nextafter(truncated, 0.0f);
+    if (static_cast<double>(truncated) == value) return truncated;
+    return std::bit_cast<float>(std::bit_cast<uint32_t>(truncated) | 1u);
+}
+
+// count elements of dtype, stride apart, into the contiguous run of the compute type. count is at most
+// kStagingElements
+template<typename T>
+void widen(DType dtype, const byte* src, int64_t stride, uint64_t count, T* dst)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        getFloatCodec(dtype)->widen(src, stride, count, dst);
+    }
+    else
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            if (const FloatCodec* codec = getFloatCodec(dtype))
+            {
+                float staging[kStagingElements];
+                codec->widen(src, stride, count, staging);
+                for (uint64_t i = 0; i < count; ++i) dst[i] = staging[i];
+                return;
+            }
+            if (dtype == DType::fp64)
+            {
+                const double* typed = reinterpret_cast<const double*>(src);
+                for (uint64_t i = 0; i < count; ++i) dst[i] = typed[static_cast<int64_t>(i) * stride];
+                return;
+            }
+        }
+        withIntegerType(dtype, [&]<typename I>()
+        {
+            const I* typed = reinterpret_cast<const I*>(src);
+            for (uint64_t i = 0; i < count; ++i) dst[i] = static_cast<T>(typed[static_cast<int64_t>(i) * stride]);
+        });
+    }
+}
+
+// the counterpart of widen, stores a contiguous run of the compute type as count elements of dtype
+template<typename T>
+void narrow(const T* src, DType dtype, byte* dst, int64_t stride, uint64_t count, RoundingMode rounding)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        getFloatCodec(dtype)->narrow(src, dst, stride, count, rounding);
+    }
+    else if constexpr (std::is_same_v<T, double>)
+    {
+        if (dtype == DType::fp64)
+        {
+            double* typed = reinterpret_cast<double*>(dst);
+            for (uint64_t i = 0; i < count; ++i) typed[static_cast<int64_t>(i) * stride] = src[i];
+        }
+        else if (dtype == DType::fp32)
+        {
+            float* typed = reinterpret_cast<float*>(dst);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                typed[static_cast<int64_t>(i) * stride] = roundToFp32(src[i], rounding);
+            }
+        }
+        else if (const FloatCodec* codec = getFloatCodec(dtype))
+        {
+            float staging[kStagingElements];
+            for (uint64_t i = 0; i < count; ++i) staging[i] = roundToOdd(src[i]);
+            codec->narrow(staging, dst, stride, count, rounding);
+        }
+        else
+        {
+            withIntegerType(dtype, [&]<typename I>()
+            {
+                I* typed = reinterpret_cast<I*>(dst);
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    typed[static_cast<int64_t>(i) * stride] = roundToInteger<I>(src[i], rounding);
+                }
+            });
+        }
+    }
+    else
+    {
+        withIntegerType(dtype, [&]<typename I>()
+        {
+            I* typed = reinterpret_cast<I*>(dst);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const int64_t value = std::clamp<int64_t>(src[i], std::numeric_limits<I>::min(),
+                                                          std::numeric_limits<I>::max());
+                typed[static_cast<int64_t>(i) * stride] = static_cast<I>(value);
+            }
+        });
+    }
+}
+
+// one run of count elements through the compute type. fp32 on either side is converted in place of the
+// staging, which saves a pass over the run
+template<typename T>
+void castRun(DType srcType, const byte* src, int64_t srcStride, DType dstType, byte* dst, int64_t dstStride,
+             uint64_t count, RoundingMode rounding)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        if (dstType == DType::fp32 && dstStride == 1)
+        {
+            widen<float>(srcType, src, srcStride, count, reinterpret_cast<float*>(dst));
+            return;
+        }
+        if (srcType == DType::fp32 && srcStride == 1)
+        {
+            narrow<float>(reinterpret_cast<const float*>(src), dstType, dst, dstStride, count, rounding);
+            return;
+        }
+    }
+    T staging[kStagingElements];
+    widen<T>(srcType, src, srcStride, count, staging);
+    narrow<T>(staging, dstType, dst, dstStride, count, rounding);
+}
+
+bool hasData(const gTensor& tensor)
+{
+    return tensor.getTotalSizeInElements() == 0 || tensor.data();
+}
+
+} // anonymous namespace
+
+gStatus Operations::cast(const gTensor& src, gTensor& dst, RoundingMode rounding)
+{
+    // validate inputs
+    const DType srcType = src.getDType();
+    const DType dstType = dst.getDType();
+    if (srcType == DType::dtypeNR || dstType == DType::dtypeNR || !sameShape(src, dst)) return gStatus::gBLAS_FAIL;
+    if (!hasData(src) || !hasData(dst)) return gStatus::gBLAS_FAIL;
+    if (src.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+    // elements are written while others are still to be read
+    if (src.getDataBuffer()->data() == dst.getDataBuffer()->data()) return gStatus::gBLAS_FAIL;
+
+    // perform operation
+    if (srcType == dstType) return copy(src, dst);
+    const Via via = getVia(srcType, dstType);
+    const ConvertRunFn run = via == Via::F32 ? &castRun<float> : via == Via::F64 ? &castRun<double> : &castRun<int64_t>;
+    const unsigned srcDim = getContiguousDim(src);
+    const unsigned dstDim = getContiguousDim(dst);
+    if (srcDim == dstDim || srcDim == src.getRank() || dstDim == dst.getRank())
+    {
+        const unsigned srcSize = getSingleElementSizeInBytes(srcType);
+        const unsigned dstSize = getSingleElementSizeInBytes(dstType);
+        const gTensorIterator iterator({&src, &dst});
+        iterator.parallelForEachChunk([&](const Chunk& chunk)
+        {
+            for (uint64_t begin = 0; begin < chunk.length; begin += kStagingElements)
+            {
+                const uint64_t count = std::min(kStagingElements, chunk.length - begin);
+                const byte* from = chunk.data[0] + static_cast<int64_t>(begin) * chunk.strides[0] * srcSize;
+                byte* to = chunk.data[1] + static_cast<int64_t>(begin) * chunk.strides[1] * dstSize;
+                run(srcType, from, chunk.strides[0], dstType, to, chunk.strides[1], count, rounding);
+            }
+        });
+        return gStatus::gBLAS_PASS;
+    }
+
+    // the contiguous dim changes: converted in L1 tiles on the way
+    copyTransposed(src, dst, run, rounding);
+    return gStatus::gBLAS_PASS;
+}
+
+} // namespace gblas
@@ -0,0 +1,70 @@
+#include "expression.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "gTensor/gTensorIterator.h"
+#include <algorithm>
+
+namespace gblas::expr::detail {
+
+gStatus evaluate(const gTensor* const* tensors, unsigned numOfTensors, gTensor& out, RoundingMode rounding,
+                 const void* expression, BlockFn blockFn)
+{
+    // validate inputs
+    const FloatCodec* outCodec = getFloatCodec(out.getDType());
+    if (!outCodec || numOfTensors > kMaxTensors) return gStatus::gBLAS_FAIL;
+    const FloatCodec* codecs[kMaxTensors] = {};
+    for (unsigned t = 0; t < numOfTensors; ++t)
+    {
+        codecs[t] = getFloatCodec(tensors[t]->getDType());
+        if (!codecs[t] || !sameShape(*tensors[t], out)) return gStatus::gBLAS_FAIL;
+    }
+    if (out.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+    if (!out.data()) return gStatus::gBLAS_FAIL;
+    for (unsigned t = 0; t < numOfTensors; ++t)
+    {
+        if (!tensors[t]->data()) return gStatus::gBLAS_FAIL;
+    }
+
+    // perform operation
+    // out is the last operand of the walk
+    const gTensor* operands[kMaxTensors + 1] = {};
+    std::copy(tensors, tensors + numOfTensors, operands);
+    operands[numOfTensors] = &out;
+    const gTensorIterator iterator(operands, numOfTensors + 1);
+    const bool outIsFp32 = out.getDType() == DType::fp32;
+    iterator.parallelForEachChunk([&](const gTensorIterator::Chunk& chunk)
+    {
+        // dense fp32 operands are read and written in place, everything else goes through the staging blocks
+        float staging[kMaxTensors][kStagingElements];
+        float result[kStagingElements];
+        const float* inputs[kMaxTensors] = {};
+        const int64_t outStride = chunk.strides[numOfTensors];
+        for (uint64_t begin = 0; begin < chunk.length; begin += kStagingElements)
+        {
+            const uint64_t count = std::min(kStagingElements, chunk.length - begin);
+            for (unsigned t = 0; t < numOfTensors; ++t)
+            {
+                const int64_t stride = chunk.strides[t];
+                const byte* src = chunk.data[t] + static_cast<int64_t>(begin) * stride * codecs[t]->elementSize;
+                if (codecs[t]->dtype == DType::fp32 && chunk.isContiguous(t))
+                {
+                    inputs[t] = reinterpret_cast<const float*>(src);
+                    continue;
+                }
+                codecs[t]->widen(src, stride, count, staging[t]);
+                inputs[t] = staging[t];
+            }
+            byte* dst = chunk.data[numOfTensors] + static_cast<int64_t>(begin) * outStride * outCodec->elementSize;
+            if (outIsFp32 && chunk.isContiguous(numOfTensors))
+            {
+                blockFn(expression, inputs, count, reinterpret_cast<float*>(dst));
+                continue;
+            }
+            blockFn(expression, inputs, count, result);
+            outCodec->narrow(result, dst, outStride, count, rounding);
+        }
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+} // namespace gblas::expr::detail
@@ -0,0 +1,172 @@
+#ifndef GBLAS_EXPRESSION_H
+#define GBLAS_EXPRESSION_H
+
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+#include "common.h"
+#include "data_types/conversions.h"
+#include "gTensor/gTensor.h"
+
+namespace gblas::expr {
+
+/// lazy elementwise expressions over gTensor. building an expression only records the tree, evaluate()
+/// computes it in a single pass over memory:
+///
+///     expr::evaluate(out, 0.5f * expr::ref(a) + expr::ref(x) * expr::ref(z) - 1.0f);
+///
+/// every node works in fp32. the tensors are widened a block at a time, the whole tree runs as one loop
+/// over the block and the result is narrowed once into the dtype of `out`, so an expression costs one read
+/// of every operand and one write of `out` whatever its depth.
+
+// the elementwise functions a node can apply
+struct Add {static float apply(float a, float b) {return a + b;}};
+struct Sub {static float apply(float a, float b) {return a - b;}};
+struct Mul {static float apply(float a, float b) {return a * b;}};
+struct Div {static float apply(float a, float b) {return a / b;}};
+struct Max {static float apply(float a, float b) {return a < b ? b : a;}};
+struct Min {static float apply(float a, float b) {return b < a ? b : a;}};
+struct Neg {static float apply(float a) {return -a;}};
+struct Abs {static float apply(float a) {return std::fabs(a);}};
+
+/// base of every node, marks the types the operators below accept
+struct Node {};
+
+template<typename T>
+concept Expression = std::derived_from<T, Node>;
+
+/// a tensor operand. the node reads slot `Slot` of the staged inputs, slots are numbered by the order the
+/// tensors appear in the expression
+struct TensorRef : Node
+{
+    static constexpr unsigned kNumOfTensors = 1;
+    const gTensor* tensor = nullptr;
+
+    template<unsigned Slot>
+    float at(const float* const* inputs, uint64_t i) const {return inputs[Slot][i];}
+    void collect(const gTensor** tensors) const {*tensors = tensor;}
+};
+
+/// a constant, the same for every element
+struct Scalar : Node
+{
+    static constexpr unsigned kNumOfTensors = 0;
+    float value = 0.0f;
+
+    template<unsigned Slot>
+    float at(const float* const*, uint64_t) const {return value;}
+    void collect(const gTensor**) const {}
+};
+
+template<typename Op, typename E>
+struct Unary : Node
+{
+    static constexpr unsigned kNumOfTensors = E::kNumOfTensors;
+    E operand;
+
+    template<unsigned Slot>
+    float at(const float* const* inputs, uint64_t i) const {return Op::apply(operand.template at<Slot>(inputs, i));}
+    void collect(const gTensor** tensors) const {operand.collect(tensors);}
+};
+
+template<typename Op, typename L, typename R>
+struct Binary : Node
+{
+    static constexpr unsigned kNumOfTensors = L::kNumOfTensors + R::kNumOfTensors;
+    L lhs;
+    R rhs;
+
+    template<unsigned Slot>
+    float at(const float* const* inputs, uint64_t i) const
+    {
+        return Op::apply(lhs.template at<Slot>(inputs, i), rhs.template at<Slot + L::kNumOfTensors>(inputs, i));
+    }
+    void collect(const gTensor** tensors) const
+    {
+        lhs.collect(tensors);
+        rhs.collect(tensors + L::kNumOfTensors);
+    }
+};
+
+/// the tensor as an expression operand, the tensor must outlive the evaluation
+inline TensorRef ref(const gTensor& tensor) {return TensorRef{{}, &tensor};}
+
+// numbers mix freely with nodes and become Scalar
+template<typename T>
+concept Operand = Expression<T> || std::is_arithmetic_v<T>;
+
+template<Operand T>
+auto toNode(const T& value)
+{
+    if constexpr (Expression<T>) return value;
+    else return Scalar{{}, static_cast<float>(value)};
+}
+
+template<typename Op, Operand L, Operand R>
+    requires (Expression<L> || Expression<R>)
+auto makeBinary(const L& lhs, const R& rhs)
+{
+    using LNode = decltype(toNode(lhs));
+    using RNode = decltype(toNode(rhs));
+    return Binary<Op, LNode, RNode>{{}, toNode(lhs), toNode(rhs)};
+}
+
+template<Operand L, Operand R> requires (Expression<L> || Expression<R>)
+auto operator+(const L& lhs, const R& rhs) {return makeBinary<Add>(lhs, rhs);}
+template<Operand L, Operand R> requires (Expression<L> || Expression<R>)
+auto operator-(const L& lhs, const R& rhs) {return makeBinary<Sub>(lhs, rhs);}
+template<Operand L, Operand R> requires (Expression<L> || Expression<R>)
+auto operator*(const L& lhs, const R& rhs) {return makeBinary<Mul>(lhs, rhs);}
+template<Operand L, Operand R> requires (Expression<L> || Expression<R>)
+auto operator/(const L& lhs, const R& rhs) {return makeBinary<Div>(lhs, rhs);}
+template<Operand L, Operand R> requires (Expression<L> || Expression<R>)
+auto maximum(const L& lhs, const R& rhs) {return makeBinary<Max>(lhs, rhs);}
+template<Operand L, Operand R> requires (Expression<L> || Expression<R>)
+auto minimum(const L& lhs, const R& rhs) {return makeBinary<Min>(lhs, rhs);}
+
+template<Expression E>
+Unary<Neg, E> operator-(const E& operand) {return Unary<Neg, E>{{}, operand};}
+template<Expression E>
+Unary<Abs, E> abs(const E& operand) {return Unary<Abs, E>{{}, operand};}
+/// max(x, 0), NaN stays NaN
+template<Expression E>
+auto relu(const E& operand) {return maximum(operand, 0.0f);}
+
+/// one expression can read this many tensors, the walk moves them and `out` together
+constexpr unsigned kMaxTensors = 7;
+
+namespace detail {
+
+/// out[i] = expression at element i for n staged elements, inputs[slot] holds n fp32 values per tensor
+using BlockFn = void (*)(const void* expression, const float* const* inputs, uint64_t n, float* out);
+
+template<typename E>
+void evaluateBlock(const void* expression, const float* const* inputs, uint64_t n, float* out)
+{
+    const E& tree = *static_cast<const E*>(expression);
+    for (uint64_t i = 0; i < n; ++i) out[i] = tree.template at<0>(inputs, i);
+}
+
+/// walks the tensors and `out` together on the thread pool and runs blockFn on staged fp32 blocks
+gStatus evaluate(const gTensor* const* tensors, unsigned numOfTensors, gTensor& out, RoundingMode rounding,
+                 const void* expression, BlockFn blockFn);
+
+} // namespace detail
+
+/// out = expression, element by element. the tensors of the expression and `out` must share sizes and have
+/// a dtype computed through fp32 (fp32, bf16, fp16, tf32, fp8_152, fp8_143), strides are free. the result is
+/// narrowed to the dtype of `out` with `rounding`. `out` may also appear in the expression, as long as it
+/// does not partially overlap another operand.
+template<Expression E>
+gStatus evaluate(gTensor& out, const E& expression, RoundingMode rounding = RoundingMode::NearestEven)
+{
+    static_assert(E::kNumOfTensors <= kMaxTensors, "an expression reads at most 7 tensors");
+    const gTensor* tensors[kMaxTensors] = {};
+    expression.collect(tensors);
+    return detail::evaluate(tensors, E::kNumOfTensors, out, rounding, &expression, &detail::evaluateBlock<E>);
+}
+
+} // namespace gblas::expr
+
+#endif //GBLAS_EXPRESSION_H
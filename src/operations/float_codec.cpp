@@ -0,0 +1,89 @@
+#include "float_codec.h"
+
+namespace gblas {
+
+namespace {
+
+template<typename Storage, float (*decode)(const Storage&)>
+void widenScalar(const byte* src, int64_t stride, uint64_t n, float* dst)
+{
+    const Storage* typed = reinterpret_cast<const Storage*>(src);
+    for (uint64_t i = 0; i < n; ++i) dst[i] = decode(typed[static_cast<int64_t>(i) * stride]);
+}
+
+template<typename Storage, Storage (*encode)(const float&, RoundingMode)>
+void narrowScalar(const float* src, byte* dst, int64_t stride, uint64_t n, RoundingMode rounding)
+{
+    Storage* typed = reinterpret_cast<Storage*>(dst);
+    for (uint64_t i = 0; i < n; ++i) typed[static_cast<int64_t>(i) * stride] = encode(src[i], rounding);
+}
+
+// contiguous runs go through the bulk conversions, which are vectorized for the host cpu
+template<typename Storage, float (*decode)(const Storage&), void (*bulk)(const Storage*, float*, size_t)>
+void widenRun(const byte* src, int64_t stride, uint64_t n, float* dst)
+{
+    if (stride == 1)
+    {
+        bulk(reinterpret_cast<const Storage*>(src), dst, n);
+        return;
+    }
+    widenScalar<Storage, decode>(src, stride, n, dst);
+}
+
+template<typename Storage, Storage (*encode)(const float&, RoundingMode),
+         void (*bulk)(const float*, Storage*, size_t, RoundingMode)>
+void narrowRun(const float* src, byte* dst, int64_t stride, uint64_t n, RoundingMode rounding)
+{
+    if (stride == 1)
+    {
+        bulk(src, reinterpret_cast<Storage*>(dst), n, rounding);
+        return;
+    }
+    narrowScalar<Storage, encode>(src, dst, stride, n, rounding);
+}
+
+float fp32Identity(const float& value) {return value;}
+float fp32Round(const float& value, RoundingMode) {return value;}
+
+const FloatCodec kFp32Codec{DType::fp32, 4, &widenScalar<float, &fp32Identity>, &narrowScalar<float, &fp32Round>};
+const FloatCodec kBf16Codec{DType::bf16, 2,
+                            &widenRun<uint16_t, &Conversions::bf16_to_fp32, &Conversions::bf16_to_fp32>,
+                            &narrowRun<uint16_t, &Conversions::fp32_to_bf16, &Conversions::fp32_to_bf16>};
+const FloatCodec kFp16Codec{DType::fp16, 2,
+                            &widenRun<uint16_t, &Conversions::fp16_to_fp32, &Conversions::fp16_to_fp32>,
+                            &narrowRun<uint16_t, &Conversions::fp32_to_fp16, &Conversions::fp32_to_fp16>};
+const FloatCodec kTf32Codec{DType::tf32, 4,
+                            &widenRun<uint32_t, &Conversions::tf32_to_fp32, &Conversions::tf32_to_fp32>,
+                            &narrowRun<uint32_t, &Conversions::fp32_to_tf32, &Conversions::fp32_to_tf32>};
+const FloatCodec kFp8_152Codec{DType::fp8_152, 1,
+                               &widenRun<uint8_t, &Conversions::fp8_152_to_fp32, &Conversions::fp8_152_to_fp32>,
+                               &narrowRun<uint8_t, &Conversions::fp32_to_fp8_152, &Conversions::fp32_to_fp8_152>};
+const FloatCodec kFp8_143Codec{DType::fp8_143, 1,
+                               &widenRun<uint8_t, &Conversions::fp8_143_to_fp32, &Conversions::fp8_143_to_fp32>,
+                               &narrowRun<uint8_t, &Conversions::fp32_to_fp8_143, &Conversions::fp32_to_fp8_143>};
+
+} // anonymous namespace
+
+const FloatCodec* getFloatCodec(DType dtype)
+{
+    switch (dtype)
+    {
+        case DType::fp32:
+            return &kFp32Codec;
+        case DType::bf16:
+            return &kBf16Codec;
+        case DType::fp16:
+            return &kFp16Codec;
+        case DType::tf32:
+            return &kTf32Codec;
+        case DType::fp8_152:
+            return &kFp8_152Codec;
+        case DType::fp8_143:
+            return &kFp8_143Codec;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+} // namespace gblas
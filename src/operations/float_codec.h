@@ -0,0 +1,26 @@
+#ifndef GBLAS_FLOAT_CODEC_H
+#define GBLAS_FLOAT_CODEC_H
+
+#include <cstdint>
+#include "common.h"
+#include "data_types/conversions.h"
+#include "gTensor/DataBuffer.h"
+
+namespace gblas {
+
+/// moves a floating dtype in and out of fp32, the type operations compute low precision data in.
+/// strides are in elements, the fp32 side is always contiguous.
+struct FloatCodec
+{
+    DType dtype = DType::dtypeNR;
+    unsigned elementSize = 0;
+    void (*widen)(const byte* src, int64_t stride, uint64_t n, float* dst) = nullptr;
+    void (*narrow)(const float* src, byte* dst, int64_t stride, uint64_t n, RoundingMode rounding) = nullptr;
+};
+
+/// codec of the given dtype, nullptr for the types that are not computed through fp32
+const FloatCodec* getFloatCodec(DType dtype);
+
+} // namespace gblas
+
+#endif //GBLAS_FLOAT_CODEC_H
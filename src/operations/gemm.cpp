@@ -0,0 +1,1136 @@
+#include "operations.h"
+#include "matrix_view.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "gTensor/gTensor.h"
+#include "kernels/kernels.h"
+#include "runtime/Parallel.h"
+#include "runtime/Workspace.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace gblas {
+
+namespace {
+
+// below this many multiply-adds per thread the fork/join costs more than it saves
+constexpr uint64_t kMinWorkPerThread = 1ull << 21;
+// upper bounds of the micro-kernel shapes and depth blocks, used to size stack buffers
+constexpr unsigned kMaxTileElements = 1024;
+constexpr unsigned kMaxTileCols = 64;
+constexpr unsigned kMaxDepthBlock = 512;
+
+// copy the rows x depth block at src into slivers of mr rows: dst[(sliver*depth + p)*mr + r].
+// rows beyond the matrix are zero filled so the micro-kernel always sees full slivers.
+template<typename T>
+void packA(const T* src, const MatrixView& a, uint64_t rows, uint64_t depth, unsigned mr, T* dst)
+{
+    for (uint64_t i = 0; i < rows; i += mr)
+    {
+        const uint64_t valid = std::min<uint64_t>(mr, rows - i);
+        const T* sliver = src + static_cast<int64_t>(i) * a.rowStride;
+        for (uint64_t p = 0; p < depth; ++p)
+        {
+            const T* column = sliver + static_cast<int64_t>(p) * a.colStride;
+            uint64_t r = 0;
+            for (; r < valid; ++r) dst[r] = column[static_cast<int64_t>(r) * a.rowStride];
+            for (; r < mr; ++r) dst[r] = T(0);
+            dst += mr;
+        }
+    }
+}
+
+// copy the depth x cols block at src into slivers of nr columns: dst[(sliver*depth + p)*nr + j]
+template<typename T>
+void packB(const T* src, const MatrixView& b, uint64_t depth, uint64_t cols, unsigned nr, T* dst)
+{
+    const uint64_t valid = std::min<uint64_t>(nr, cols);
+    for (uint64_t p = 0; p < depth; ++p)
+    {
+        const T* row = src + static_cast<int64_t>(p) * b.rowStride;
+        uint64_t j = 0;
+        if (b.colStride == 1)
+        {
+            for (; j < valid; ++j) dst[j] = row[j];
+        }
+        else
+        {
+            for (; j < valid; ++j) dst[j] = row[static_cast<int64_t>(j) * b.colStride];
+        }
+        for (; j < nr; ++j) dst[j] = T(0);
+        dst += nr;
+    }
+}
+
+// same layout as packA/packB for operands stored in a low precision type, converted to fp32 on the way in.
+// the codec widens runs along the contiguous direction of the source, so each element is decoded once and
+// the vector conversion kernels see runs as long as the panel allows.
+void packSliversWidened(const byte* src, int64_t sliverStride, int64_t depthStride, const FloatCodec& codec,
+                        uint64_t extent, uint64_t depth, unsigned width, float* dst)
+{
+    const int64_t elementSize = codec.elementSize;
+    for (uint64_t i = 0; i < extent; i += width)
+    {
+        const uint64_t valid = std::min<uint64_t>(width, extent - i);
+        const byte* sliver = src + static_cast<int64_t>(i) * sliverStride * elementSize;
+        if (depthStride == 1 && sliverStride != 1)
+        {
+            // every line of the sliver is contiguous along the depth, decode it whole and interleave
+            float line[kMaxDepthBlock];
+            for (uint64_t r = 0; r < valid; ++r)
+            {
+                codec.widen(sliver + static_cast<int64_t>(r) * sliverStride * elementSize, 1, depth, line);
+                for (uint64_t p = 0; p < depth; ++p) dst[p * width + r] = line[p];
+            }
+            for (uint64_t r = valid; r < width; ++r)
+            {
+                for (uint64_t p = 0; p < depth; ++p) dst[p * width + r] = 0.0f;
+            }
+            dst += depth * width;
+            continue;
+        }
+        for (uint64_t p = 0; p < depth; ++p)
+        {
+            codec.widen(sliver + static_cast<int64_t>(p) * depthStride * elementSize, sliverStride, valid, dst);
+            for (uint64_t r = valid; r < width; ++r) dst[r] = 0.0f;
+            dst += width;
+        }
+    }
+}
+
+// a matrix read by the epilogue, element (r, c) matches element (r, c) of C. a row vector broadcast over the
+// rows has a row stride of 0. codec is set for a dtype other than the compute type.
+struct EpilogueOperand
+{
+    MatrixView view;
+    const byte* data = nullptr;
+    DType dtype = DType::dtypeNR;
+    const FloatCodec* codec = nullptr;
+};
+
+// C = activation(product + bias) + residual, applied to a tile after its last depth block
+struct EpilogueStage
+{
+    EpilogueOperand bias;
+    EpilogueOperand residual;
+    Activation activation = Activation::None;
+
+    bool isActive() const {return bias.data || residual.data || activation != Activation::None;}
+};
+
+template<typename T>
+struct GemmProblem
+{
+    MatrixView a, b, c;
+    const byte* aData = nullptr;
+    const byte* bData = nullptr;
+    byte* cData = nullptr;
+    // set for operands stored in another floating type, they are converted through fp32 (T is float then)
+    const FloatCodec* aCodec = nullptr;
+    const FloatCodec* bCodec = nullptr;
+    const FloatCodec* cCodec = nullptr;
+    RoundingMode rounding = RoundingMode::NearestEven;
+    T alpha = T(1);
+    T beta = T(0);
+    EpilogueStage epilogue;
+    // scratch memory for the panels, nullptr to use the default allocator
+    Workspace* workspace = nullptr;
+    // threads the product may use, 0 for the whole pool
+    unsigned maxThreads = 0;
+};
+
+// cols elements of an epilogue operand starting at (row, col), in the compute type
+template<typename T>
+void loadEpilogueRow(const EpilogueOperand& operand, uint64_t row, uint64_t col, uint64_t cols, T* dst)
+{
+    const int64_t offset = static_cast<int64_t>(row) * operand.view.rowStride +
+                           static_cast<int64_t>(col) * operand.view.colStride;
+    if constexpr (std::is_same_v<T, float>)
+    {
+        if (operand.codec)
+        {
+            operand.codec->widen(operand.data + offset * operand.codec->elementSize, operand.view.colStride, cols, dst);
+            return;
+        }
+    }
+    const T* src = reinterpret_cast<const T*>(operand.data) + offset;
+    for (uint64_t j = 0; j < cols; ++j) dst[j] = src[static_cast<int64_t>(j) * operand.view.colStride];
+}
+
+template<typename T>
+T activate(Activation activation, T x)
+{
+    switch (activation)
+    {
+        // NaN fails the comparison and passes through
+        case Activation::ReLU: return x < T(0) ? T(0) : x;
+        case Activation::GELU: return T(0.5) * x * (T(1) + std::erf(x * T(0.70710678118654752)));
+        case Activation::GELUTanh:
+            return T(0.5) * x * (T(1) + std::tanh(T(0.79788456080286536) * (x + T(0.044715) * x * x * x)));
+        case Activation::SiLU: return x / (T(1) + std::exp(-x));
+        default: return x;
+    }
+}
+
+// runs the epilogue over cols finished values of row `row` of C starting at column `col`, at most kMaxTileCols
+template<typename T>
+void applyEpilogue(const EpilogueStage& epilogue, T* line, uint64_t row, uint64_t col, uint64_t cols)
+{
+    T operand[kMaxTileCols];
+    if (epilogue.bias.data)
+    {
+        loadEpilogueRow(epilogue.bias, row, col, cols, operand);
+        for (uint64_t j = 0; j < cols; ++j) line[j] += operand[j];
+    }
+    if (epilogue.activation != Activation::None)
+    {
+        for (uint64_t j = 0; j < cols; ++j) line[j] = activate(epilogue.activation, line[j]);
+    }
+    if (epilogue.residual.data)
+    {
+        loadEpilogueRow(epilogue.residual, row, col, cols, operand);
+        for (uint64_t j = 0; j < cols; ++j) line[j] += operand[j];
+    }
+}
+
+// C = beta*C for an empty product, followed by the epilogue
+template<typename T>
+void scaleC(const GemmProblem<T>& problem)
+{
+    const MatrixView& c = problem.c;
+    const bool epilogue = problem.epilogue.isActive();
+    T line[kMaxTileCols];
+    for (uint64_t i = 0; i < c.rows; ++i)
+    {
+        for (uint64_t j = 0; j < c.cols; j += kMaxTileCols)
+        {
+            const uint64_t cols = std::min<uint64_t>(kMaxTileCols, c.cols - j);
+            const int64_t offset = static_cast<int64_t>(i) * c.rowStride + static_cast<int64_t>(j) * c.colStride;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                if (problem.cCodec)
+                {
+                    const FloatCodec& codec = *problem.cCodec;
+                    byte* cRow = problem.cData + offset * codec.elementSize;
+                    codec.widen(cRow, c.colStride, cols, line);
+                    for (uint64_t t = 0; t < cols; ++t) line[t] = problem.beta == 0.0f ? 0.0f : problem.beta * line[t];
+                    if (epilogue) applyEpilogue(problem.epilogue, line, i, j, cols);
+                    codec.narrow(line, cRow, c.colStride, cols, problem.rounding);
+                    continue;
+                }
+            }
+            T* cRow = reinterpret_cast<T*>(problem.cData) + offset;
+            for (uint64_t t = 0; t < cols; ++t)
+            {
+                const T value = cRow[static_cast<int64_t>(t) * c.colStride];
+                line[t] = problem.beta == T(0) ? T(0) : problem.beta * value;
+            }
+            if (epilogue) applyEpilogue(problem.epilogue, line, i, j, cols);
+            for (uint64_t t = 0; t < cols; ++t) cRow[static_cast<int64_t>(t) * c.colStride] = line[t];
+        }
+    }
+}
+
+// merge a finished fp32 tile into a C stored in a low precision type: c = narrow(tile + beta*c)
+void storeTileNarrowed(const GemmProblem<float>& problem, const float* tile, int64_t ld, uint64_t row, uint64_t col,
+                       uint64_t rows, uint64_t cols)
+{
+    const MatrixView& c = problem.c;
+    const FloatCodec& codec = *problem.cCodec;
+    float line[kMaxTileCols];
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        byte* cRow = problem.cData + (static_cast<int64_t>(row + r) * c.rowStride +
+                                      static_cast<int64_t>(col) * c.colStride) * codec.elementSize;
+        const float* tileRow = tile + static_cast<int64_t>(r) * ld;
+        if (problem.beta != 0.0f)
+        {
+            codec.widen(cRow, c.colStride, cols, line);
+            for (uint64_t j = 0; j < cols; ++j) line[j] = tileRow[j] + problem.beta * line[j];
+        }
+        else
+        {
+            for (uint64_t j = 0; j < cols; ++j) line[j] = tileRow[j];
+        }
+        if (problem.epilogue.isActive()) applyEpilogue(problem.epilogue, line, row + r, col, cols);
+        codec.narrow(line, cRow, c.colStride, cols, problem.rounding);
+    }
+}
+
+template<typename T>
+void packPanelA(const GemmProblem<T>& problem, uint64_t ic, uint64_t pc, uint64_t rows, uint64_t depth, unsigned mr,
+                T* dst)
+{
+    const MatrixView& a = problem.a;
+    const int64_t offset = static_cast<int64_t>(ic) * a.rowStride + static_cast<int64_t>(pc) * a.colStride;
+    if constexpr (std::is_same_v<T, float>)
+    {
+        if (problem.aCodec)
+        {
+            packSliversWidened(problem.aData + offset * problem.aCodec->elementSize, a.rowStride, a.colStride,
+                               *problem.aCodec, rows, depth, mr, dst);
+            return;
+        }
+    }
+    packA(reinterpret_cast<const T*>(problem.aData) + offset, a, rows, depth, mr, dst);
+}
+
+template<typename T>
+void packPanelB(const GemmProblem<T>& problem, uint64_t pc, uint64_t jc, uint64_t depth, uint64_t cols, unsigned nr,
+                T* dst)
+{
+    const MatrixView& b = problem.b;
+    const int64_t offset = static_cast<int64_t>(pc) * b.rowStride + static_cast<int64_t>(jc) * b.colStride;
+    if constexpr (std::is_same_v<T, float>)
+    {
+        if (problem.bCodec)
+        {
+            // B slivers run along the columns, so the roles of the strides swap compared to A
+            packSliversWidened(problem.bData + offset * problem.bCodec->elementSize, b.colStride, b.rowStride,
+                               *problem.bCodec, std::min<uint64_t>(nr, cols), depth, nr, dst);
+            return;
+        }
+    }
+    packB(reinterpret_cast<const T*>(problem.bData) + offset, b, depth, cols, nr, dst);
+}
+
+// bf16 A for the tile kernels: every row of the rows x depth block contiguous, zero padded to depthPadded
+// and to whole slivers of mr rows
+void packPanelA(const GemmProblem<float>& problem, uint64_t ic, uint64_t pc, uint64_t rows, uint64_t depth,
+                uint64_t depthPadded, unsigned mr, uint16_t* dst)
+{
+    const MatrixView& a = problem.a;
+    const uint16_t* src = reinterpret_cast<const uint16_t*>(problem.aData) + static_cast<int64_t>(ic) * a.rowStride +
+                          static_cast<int64_t>(pc) * a.colStride;
+    const uint64_t paddedRows = (rows + mr - 1) / mr * mr;
+    for (uint64_t r = 0; r < paddedRows; ++r, dst += depthPadded)
+    {
+        uint64_t p = 0;
+        if (r < rows)
+        {
+            const uint16_t* row = src + static_cast<int64_t>(r) * a.rowStride;
+            if (a.colStride == 1)
+            {
+                std::copy(row, row + depth, dst);
+                p = depth;
+            }
+            for (; p < depth; ++p) dst[p] = row[static_cast<int64_t>(p) * a.colStride];
+        }
+        std::fill(dst + p, dst + depthPadded, uint16_t(0));
+    }
+}
+
+// bf16 B for the tile kernels: one sliver of nr columns in depth pairs, dst[(p/2*nr + j)*2 + p%2] = B(p, j)
+void packPanelB(const GemmProblem<float>& problem, uint64_t pc, uint64_t jc, uint64_t depth, uint64_t depthPadded,
+                uint64_t cols, unsigned nr, uint16_t* dst)
+{
+    const MatrixView& b = problem.b;
+    const uint16_t* src = reinterpret_cast<const uint16_t*>(problem.bData) + static_cast<int64_t>(pc) * b.rowStride +
+                          static_cast<int64_t>(jc) * b.colStride;
+    const uint64_t valid = std::min<uint64_t>(nr, cols);
+    for (uint64_t p = 0; p < depthPadded; p += 2, dst += nr * 2)
+    {
+        for (uint64_t t = 0; t < 2; ++t)
+        {
+            const uint16_t* row = src + static_cast<int64_t>(p + t) * b.rowStride;
+            uint64_t j = 0;
+            if (p + t < depth)
+            {
+                for (; j < valid; ++j) dst[j * 2 + t] = row[static_cast<int64_t>(j) * b.colStride];
+            }
+            for (; j < nr; ++j) dst[j * 2 + t] = 0;
+        }
+    }
+}
+
+// Goto/BLIS style loop nest: jc (nc columns of B, L3) -> pc (kc depth) -> ic (mc rows of A, L2)
+// -> jr (nr columns) -> ir (mr rows) around the register tiled micro-kernel. the panels hold the
+// kernel's Packed type, the tile kernels take bf16 panels and accumulate in fp32.
+template<typename T, typename Kernel>
+void gemmBlocked(const GemmProblem<T>& problem, const Kernel& kernel)
+{
+    using Packed = typename Kernel::Packed;
+    const MatrixView& c = problem.c;
+    const uint64_t m = c.rows, n = c.cols, k = problem.a.cols;
+    const unsigned mr = kernel.mr, nr = kernel.nr, align = kernel.depthAlign;
+    assert(mr * nr <= kMaxTileElements && nr <= kMaxTileCols && kernel.kc <= kMaxDepthBlock && kernel.kc % align == 0);
+
+    const uint64_t work = m * n * k;
+    const unsigned threads = static_cast<unsigned>(
+        std::clamp<uint64_t>(work / kMinWorkPerThread, 1, problem.maxThreads ? problem.maxThreads : getMaxThreads()));
+
+    // spread small M over the threads by shrinking the row blocks, never below one sliver
+    uint64_t mc = kernel.mc;
+    const uint64_t rowsPerThread = (m + threads - 1) / threads;
+    mc = std::min<uint64_t>(mc, std::max<uint64_t>(mr, (rowsPerThread + mr - 1) / mr * mr));
+    const uint64_t kc = std::min<uint64_t>(kernel.kc, (k + align - 1) / align * align);
+    const uint64_t nc = std::min<uint64_t>(kernel.nc, (n + nr - 1) / nr * nr);
+
+    PanelPtr<Packed> bPanel = allocatePanel<Packed>(kc * nc, problem.workspace);
+    const uint64_t aPanelSize = mc * kc;
+    PanelPtr<Packed> aPanels = allocatePanel<Packed>(aPanelSize * threads, problem.workspace);
+    const bool directC = c.colStride == 1 && !problem.cCodec;
+    const bool epilogue = problem.epilogue.isActive();
+
+    // a low precision C is produced from fp32 tiles, when the depth takes several passes the partial sums
+    // live in an fp32 buffer padded to whole tiles so the micro-kernel can always write it directly
+    const bool staged = problem.cCodec != nullptr;
+    PanelPtr<T> partials;
+    const int64_t partialsLd = static_cast<int64_t>((n + nr - 1) / nr * nr);
+    if (staged && k > kc) partials = allocatePanel<T>(((m + mr - 1) / mr * mr) * partialsLd, problem.workspace);
+
+    for (uint64_t jc = 0; jc < n; jc += nc)
+    {
+        const uint64_t ncCur = std::min(nc, n - jc);
+        const uint64_t bSlivers = (ncCur + nr - 1) / nr;
+        for (uint64_t pc = 0; pc < k; pc += kc)
+        {
+            const uint64_t kcCur = std::min(kc, k - pc);
+            const uint64_t kcPadded = (kcCur + align - 1) / align * align;
+            const bool lastPass = pc + kcCur == k;
+            // the first depth block applies beta, the following ones accumulate
+            const T beta = pc == 0 ? problem.beta : T(1);
+
+            parallelFor(bSlivers, threads, [&](uint64_t sliver, unsigned)
+            {
+                const uint64_t j = sliver * nr;
+                Packed* dst = bPanel.get() + sliver * kcPadded * nr;
+                if constexpr (std::is_same_v<Packed, T>) packPanelB(problem, pc, jc + j, kcCur, ncCur - j, nr, dst);
+                else packPanelB(problem, pc, jc + j, kcCur, kcPadded, ncCur - j, nr, dst);
+            });
+
+            const uint64_t rowBlocks = (m + mc - 1) / mc;
+            parallelFor(rowBlocks, threads, [&](uint64_t block, unsigned thread)
+            {
+                Packed* aPanel = aPanels.get() + thread * aPanelSize;
+                const uint64_t ic = block * mc;
+                const uint64_t mcCur = std::min(mc, m - ic);
+                if constexpr (std::is_same_v<Packed, T>) packPanelA(problem, ic, pc, mcCur, kcCur, mr, aPanel);
+                else packPanelA(problem, ic, pc, mcCur, kcCur, kcPadded, mr, aPanel);
+
+                alignas(64) T tile[kMaxTileElements];
+                for (uint64_t jr = 0; jr < ncCur; jr += nr)
+                {
+                    const uint64_t nrCur = std::min<uint64_t>(nr, ncCur - jr);
+                    const Packed* bSliver = bPanel.get() + (jr / nr) * kcPadded * nr;
+                    for (uint64_t ir = 0; ir < mcCur; ir += mr)
+                    {
+                        const uint64_t mrCur = std::min<uint64_t>(mr, mcCur - ir);
+                        const Packed* aSliver = aPanel + (ir / mr) * kcPadded * mr;
+                        if constexpr (std::is_same_v<T, float>)
+                        {
+                            if (staged)
+                            {
+                                T* target = tile;
+                                int64_t ld = nr;
+                                if (partials)
+                                {
+                                    target = partials.get() + static_cast<int64_t>(ic + ir) * partialsLd +
+                                             static_cast<int64_t>(jc + jr);
+                                    ld = partialsLd;
+                                }
+                                kernel.microKernel(kcPadded, aSliver, bSliver, target, ld, problem.alpha,
+                                                   partials && pc != 0 ? T(1) : T(0));
+                                if (lastPass) storeTileNarrowed(problem, target, ld, ic + ir, jc + jr, mrCur, nrCur);
+                                continue;
+                            }
+                        }
+                        T* cTile = reinterpret_cast<T*>(problem.cData) + static_cast<int64_t>(ic + ir) * c.rowStride +
+                                   static_cast<int64_t>(jc + jr) * c.colStride;
+                        if (directC && mrCur == mr && nrCur == nr)
+                        {
+                            kernel.microKernel(kcPadded, aSliver, bSliver, cTile, c.rowStride, problem.alpha, beta);
+                            // the tile was just written and is still in L1
+                            if (epilogue && lastPass)
+                            {
+                                for (uint64_t r = 0; r < mr; ++r)
+                                {
+                                    applyEpilogue(problem.epilogue, cTile + static_cast<int64_t>(r) * c.rowStride,
+                                                  ic + ir + r, jc + jr, nr);
+                                }
+                            }
+                            continue;
+                        }
+                        // partial or strided tile: compute into the local tile and merge
+                        kernel.microKernel(kcPadded, aSliver, bSliver, tile, nr, problem.alpha, T(0));
+                        for (uint64_t r = 0; r < mrCur; ++r)
+                        {
+                            T* cRow = cTile + static_cast<int64_t>(r) * c.rowStride;
+                            T* line = tile + r * nr;
+                            if (beta != T(0))
+                            {
+                                for (uint64_t j = 0; j < nrCur; ++j)
+                                {
+                                    line[j] += beta * cRow[static_cast<int64_t>(j) * c.colStride];
+                                }
+                            }
+                            if (epilogue && lastPass)
+                            {
+                                applyEpilogue(problem.epilogue, line, ic + ir + r, jc + jr, nrCur);
+                            }
+                            for (uint64_t j = 0; j < nrCur; ++j) cRow[static_cast<int64_t>(j) * c.colStride] = line[j];
+                        }
+                    }
+                }
+            });
+        }
+    }
+}
+
+template<typename T, typename Kernel>
+gStatus gemmTyped(GemmProblem<T> problem, const Kernel& kernel)
+{
+    // the micro-kernel stores rows of C, a column major C is computed as C^T = op(B)^T * op(A)^T
+    if (problem.c.colStride != 1 && problem.c.rowStride == 1)
+    {
+        std::swap(problem.a, problem.b);
+        std::swap(problem.aData, problem.bData);
+        std::swap(problem.aCodec, problem.bCodec);
+        problem.a = problem.a.transposed();
+        problem.b = problem.b.transposed();
+        problem.c = problem.c.transposed();
+        problem.epilogue.bias.view = problem.epilogue.bias.view.transposed();
+        problem.epilogue.residual.view = problem.epilogue.residual.view.transposed();
+    }
+    if (problem.a.cols == 0 || problem.alpha == T(0))
+    {
+        scaleC(problem);
+        return gStatus::gBLAS_PASS;
+    }
+    gemmBlocked(problem, kernel);
+    return gStatus::gBLAS_PASS;
+}
+
+// unsigned or signed int8 A times signed int8 B accumulated in int32, C in int32 or requantized to 8 bits
+struct GemmI8Problem
+{
+    MatrixView a, b, c;
+    const byte* aData = nullptr;
+    const byte* bData = nullptr;
+    byte* cData = nullptr;
+    // a signed A is offset by 128 while packing to feed the unsigned operand of the kernel
+    bool signedA = false;
+    DType cType = DType::int32;
+    // set for an 8 bit C, alpha and beta are not used then
+    const Requantization* requantization = nullptr;
+    // truncated to integers, as for the other integer operations
+    int32_t alpha = 1;
+    int32_t beta = 0;
+    Workspace* workspace = nullptr;
+    unsigned maxThreads = 0;
+};
+
+// rows x depth block of A into slivers of mr rows with the depth interleaved by 4:
+// dst[((sliver*quads + q)*mr + r)*4 + t] = A(r, 4q + t). rows and depth beyond the matrix are zero filled up
+// to whole slivers and depthPadded. with rowPanel every row is contiguous instead: dst[row*depthPadded + p].
+void packI8A(const GemmI8Problem& problem, uint64_t ic, uint64_t pc, uint64_t rows, uint64_t depth,
+             uint64_t depthPadded, unsigned mr, bool rowPanel, uint8_t* dst)
+{
+    const MatrixView& a = problem.a;
+    const uint8_t flip = problem.signedA ? 0x80 : 0;
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(problem.aData) + static_cast<int64_t>(ic) * a.rowStride +
+                         static_cast<int64_t>(pc) * a.colStride;
+    if (rowPanel)
+    {
+        const uint64_t paddedRows = (rows + mr - 1) / mr * mr;
+        for (uint64_t r = 0; r < paddedRows; ++r, dst += depthPadded)
+        {
+            uint64_t p = 0;
+            if (r < rows)
+            {
+                const uint8_t* row = src + static_cast<int64_t>(r) * a.rowStride;
+                for (; p < depth; ++p) dst[p] = row[static_cast<int64_t>(p) * a.colStride] ^ flip;
+            }
+            std::fill(dst + p, dst + depthPadded, uint8_t(0));
+        }
+        return;
+    }
+    const uint64_t quads = depthPadded / 4;
+    for (uint64_t i = 0; i < rows; i += mr)
+    {
+        const uint64_t valid = std::min<uint64_t>(mr, rows - i);
+        const uint8_t* sliver = src + static_cast<int64_t>(i) * a.rowStride;
+        for (uint64_t q = 0; q < quads; ++q)
+        {
+            const uint64_t steps = q * 4 < depth ? std::min<uint64_t>(4, depth - q * 4) : 0;
+            for (uint64_t r = 0; r < mr; ++r)
+            {
+                const uint8_t* row = sliver + static_cast<int64_t>(r) * a.rowStride +
+                                     static_cast<int64_t>(q * 4) * a.colStride;
+                for (uint64_t t = 0; t < 4; ++t)
+                {
+                    dst[r * 4 + t] = r < valid && t < steps ? row[static_cast<int64_t>(t) * a.colStride] ^ flip : 0;
+                }
+            }
+            dst += mr * 4;
+        }
+    }
+}
+
+// depth x cols block of B into one sliver of nr columns: dst[(q*nr + j)*4 + t] = B(4q + t, j), zero filled.
+// colSums receives the sums of the nr columns when A is signed.
+void packI8B(const GemmI8Problem& problem, uint64_t pc, uint64_t jc, uint64_t depth, uint64_t depthPadded,
+             uint64_t cols, unsigned nr, int8_t* dst, int32_t* colSums)
+{
+    const MatrixView& b = problem.b;
+    const int8_t* src = reinterpret_cast<const int8_t*>(problem.bData) + static_cast<int64_t>(pc) * b.rowStride +
+                        static_cast<int64_t>(jc) * b.colStride;
+    const uint64_t valid = std::min<uint64_t>(nr, cols);
+    const uint64_t quads = depthPadded / 4;
+    if (colSums) std::fill(colSums, colSums + nr, 0);
+    for (uint64_t q = 0; q < quads; ++q)
+    {
+        const uint64_t steps = q * 4 < depth ? std::min<uint64_t>(4, depth - q * 4) : 0;
+        for (uint64_t j = 0; j < nr; ++j)
+        {
+            const int8_t* column = src + static_cast<int64_t>(q * 4) * b.rowStride +
+                                   static_cast<int64_t>(j) * b.colStride;
+            int32_t sum = 0;
+            for (uint64_t t = 0; t < 4; ++t)
+            {
+                const int8_t value = j < valid && t < steps ? column[static_cast<int64_t>(t) * b.rowStride] : 0;
+                dst[j * 4 + t] = value;
+                sum += value;
+            }
+            if (colSums) colSums[j] += sum;
+        }
+        dst += nr * 4;
+    }
+    // (a + 128)*b over the depth is a*b + 128*sum(b), the kernel starts every column from minus the excess
+    if (colSums)
+    {
+        for (uint64_t j = 0; j < nr; ++j) colSums[j] *= -128;
+    }
+}
+
+// c = clamp(nearbyint((acc + bias) * scale) + zeroPoint), narrowed to the 8 bit dtype of C
+void storeTileRequantized(const GemmI8Problem& problem, const int32_t* tile, int64_t ld, uint64_t row, uint64_t col,
+                          uint64_t rows, uint64_t cols)
+{
+    const Requantization& rq = *problem.requantization;
+    const MatrixView& c = problem.c;
+    const bool isSigned = problem.cType == DType::int8;
+    const float low = static_cast<float>(std::max(rq.min, isSigned ? -128 : 0) - rq.zeroPoint);
+    const float high = static_cast<float>(std::min(rq.max, isSigned ? 127 : 255) - rq.zeroPoint);
+    float scales[kMaxTileCols];
+    int32_t bias[kMaxTileCols];
+    for (uint64_t j = 0; j < cols; ++j)
+    {
+        scales[j] = rq.perColumn ? rq.scales[col + j] : rq.scales[0];
+        bias[j] = rq.bias ? rq.bias[col + j] : 0;
+    }
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        const int32_t* tileRow = tile + static_cast<int64_t>(r) * ld;
+        const int64_t offset = static_cast<int64_t>(row + r) * c.rowStride + static_cast<int64_t>(col) * c.colStride;
+        for (uint64_t j = 0; j < cols; ++j)
+        {
+            // the sum leaves int32 for a bias near its limits
+            const float sum = static_cast<float>(static_cast<int64_t>(tileRow[j]) + bias[j]);
+            const float scaled = std::nearbyint(sum * scales[j]);
+            const int32_t value = static_cast<int32_t>(std::clamp(scaled, low, high)) + rq.zeroPoint;
+            const int64_t at = offset + static_cast<int64_t>(j) * c.colStride;
+            if (isSigned) reinterpret_cast<int8_t*>(problem.cData)[at] = static_cast<int8_t>(value);
+            else reinterpret_cast<uint8_t*>(problem.cData)[at] = static_cast<uint8_t>(value);
+        }
+    }
+}
+
+// the loop nest of gemmBlocked over byte panels, see there
+void gemmBlockedI8(const GemmI8Problem& problem, const kernels::GemmI8Kernel& kernel)
+{
+    const MatrixView& c = problem.c;
+    const uint64_t m = c.rows, n = c.cols, k = problem.a.cols;
+    const unsigned mr = kernel.mr, nr = kernel.nr;
+    const unsigned align = kernel.depthAlign;
+    assert(mr * nr <= kMaxTileElements && nr <= kMaxTileCols && kernel.kc % align == 0 && align % 4 == 0);
+
+    // an int8 multiply-add is about a quarter of an fp32 one
+    const uint64_t work = m * n * k / 4;
+    const unsigned threads = static_cast<unsigned>(
+        std::clamp<uint64_t>(work / kMinWorkPerThread, 1, problem.maxThreads ? problem.maxThreads : getMaxThreads()));
+
+    uint64_t mc = kernel.mc;
+    const uint64_t rowsPerThread = (m + threads - 1) / threads;
+    mc = std::min<uint64_t>(mc, std::max<uint64_t>(mr, (rowsPerThread + mr - 1) / mr * mr));
+    const uint64_t kc = std::min<uint64_t>(kernel.kc, (k + align - 1) / align * align);
+    const uint64_t nc = std::min<uint64_t>(kernel.nc, (n + nr - 1) / nr * nr);
+
+    PanelPtr<int8_t> bPanel = allocatePanel<int8_t>(kc * nc, problem.workspace);
+    PanelPtr<int32_t> colOffsets;
+    if (problem.signedA) colOffsets = allocatePanel<int32_t>(nc, problem.workspace);
+    const uint64_t aPanelSize = mc * kc;
+    PanelPtr<uint8_t> aPanels = allocatePanel<uint8_t>(aPanelSize * threads, problem.workspace);
+
+    const bool staged = problem.requantization != nullptr;
+    const bool directC = !staged && c.colStride == 1 && problem.alpha == 1 && (problem.beta == 0 || problem.beta == 1);
+    PanelPtr<int32_t> partials;
+    const int64_t partialsLd = static_cast<int64_t>((n + nr - 1) / nr * nr);
+    if (staged && k > kc) partials = allocatePanel<int32_t>(((m + mr - 1) / mr * mr) * partialsLd, problem.workspace);
+
+    for (uint64_t jc = 0; jc < n; jc += nc)
+    {
+        const uint64_t ncCur = std::min(nc, n - jc);
+        const uint64_t bSlivers = (ncCur + nr - 1) / nr;
+        for (uint64_t pc = 0; pc < k; pc += kc)
+        {
+            const uint64_t kcCur = std::min(kc, k - pc);
+            // the kernel walks the depth in steps of align, the packing zero fills up to it
+            const uint64_t kcPadded = (kcCur + align - 1) / align * align;
+            const bool lastPass = pc + kcCur == k;
+            const int32_t beta = pc == 0 ? problem.beta : 1;
+
+            parallelFor(bSlivers, threads, [&](uint64_t sliver, unsigned)
+            {
+                const uint64_t j = sliver * nr;
+                packI8B(problem, pc, jc + j, kcCur, kcPadded, ncCur - j, nr, bPanel.get() + sliver * kcPadded * nr,
+                        colOffsets ? colOffsets.get() + j : nullptr);
+            });
+
+            const uint64_t rowBlocks = (m + mc - 1) / mc;
+            parallelFor(rowBlocks, threads, [&](uint64_t block, unsigned thread)
+            {
+                uint8_t* aPanel = aPanels.get() + thread * aPanelSize;
+                const uint64_t ic = block * mc;
+                const uint64_t mcCur = std::min(mc, m - ic);
+                packI8A(problem, ic, pc, mcCur, kcCur, kcPadded, mr, kernel.rowPanelA, aPanel);
+
+                alignas(64) int32_t tile[kMaxTileElements];
+                for (uint64_t jr = 0; jr < ncCur; jr += nr)
+                {
+                    const uint64_t nrCur = std::min<uint64_t>(nr, ncCur - jr);
+                    const int8_t* bSliver = bPanel.get() + (jr / nr) * kcPadded * nr;
+                    const int32_t* offsets = colOffsets ? colOffsets.get() + jr : nullptr;
+                    for (uint64_t ir = 0; ir < mcCur; ir += mr)
+                    {
+                        const uint64_t mrCur = std::min<uint64_t>(mr, mcCur - ir);
+                        const uint8_t* aSliver = aPanel + (ir / mr) * kcPadded * mr;
+                        if (staged)
+                        {
+                            int32_t* target = tile;
+                            int64_t ld = nr;
+                            if (partials)
+                            {
+                                target = partials.get() + static_cast<int64_t>(ic + ir) * partialsLd +
+                                         static_cast<int64_t>(jc + jr);
+                                ld = partialsLd;
+                            }
+                            kernel.microKernel(kcPadded, aSliver, bSliver, target, ld, offsets, partials && pc != 0);
+                            if (lastPass) storeTileRequantized(problem, target, ld, ic + ir, jc + jr, mrCur, nrCur);
+                            continue;
+                        }
+                        int32_t* cTile = reinterpret_cast<int32_t*>(problem.cData) +
+                                         static_cast<int64_t>(ic + ir) * c.rowStride +
+                                         static_cast<int64_t>(jc + jr) * c.colStride;
+                        if (directC && mrCur == mr && nrCur == nr)
+                        {
+                            kernel.microKernel(kcPadded, aSliver, bSliver, cTile, c.rowStride, offsets, beta == 1);
+                            continue;
+                        }
+                        // partial, strided or scaled tile: merge in int64 and wrap to int32 as the kernel does
+                        kernel.microKernel(kcPadded, aSliver, bSliver, tile, nr, offsets, false);
+                        const int64_t alpha = problem.alpha;
+                        for (uint64_t r = 0; r < mrCur; ++r)
+                        {
+                            int32_t* cRow = cTile + static_cast<int64_t>(r) * c.rowStride;
+                            for (uint64_t j = 0; j < nrCur; ++j)
+                            {
+                                int32_t& value = cRow[static_cast<int64_t>(j) * c.colStride];
+                                const int64_t sum = alpha * tile[r * nr + j] + (beta == 0 ? 0 : int64_t(beta) * value);
+                                value = static_cast<int32_t>(static_cast<uint32_t>(sum));
+                            }
+                        }
+                    }
+                }
+            });
+        }
+    }
+}
+
+gStatus gemmTyped(GemmI8Problem problem, const kernels::GemmI8Kernel& kernel)
+{
+    // s8 x s8 without an epilogue is symmetric in its operands, a column major C swaps them as gemmTyped does
+    if (problem.signedA && !problem.requantization && problem.c.colStride != 1 && problem.c.rowStride == 1)
+    {
+        std::swap(problem.a, problem.b);
+        std::swap(problem.aData, problem.bData);
+        problem.a = problem.a.transposed();
+        problem.b = problem.b.transposed();
+        problem.c = problem.c.transposed();
+    }
+    if (!problem.requantization && (problem.a.cols == 0 || problem.alpha == 0))
+    {
+        const MatrixView& c = problem.c;
+        for (uint64_t i = 0; i < c.rows; ++i)
+        {
+            int32_t* row = reinterpret_cast<int32_t*>(problem.cData) + static_cast<int64_t>(i) * c.rowStride;
+            for (uint64_t j = 0; j < c.cols; ++j)
+            {
+                int32_t& value = row[static_cast<int64_t>(j) * c.colStride];
+                value = static_cast<int32_t>(static_cast<uint32_t>(int64_t(problem.beta) * value));
+            }
+        }
+        return gStatus::gBLAS_PASS;
+    }
+    if (problem.a.cols == 0)
+    {
+        // an empty depth requantizes the bias alone
+        alignas(64) int32_t zeros[kMaxTileCols] = {};
+        for (uint64_t i = 0; i < problem.c.rows; ++i)
+        {
+            for (uint64_t j = 0; j < problem.c.cols; j += kMaxTileCols)
+            {
+                storeTileRequantized(problem, zeros, 0, i, j, 1, std::min<uint64_t>(kMaxTileCols, problem.c.cols - j));
+            }
+        }
+        return gStatus::gBLAS_PASS;
+    }
+    gemmBlockedI8(problem, kernel);
+    return gStatus::gBLAS_PASS;
+}
+
+// one product of a batch, validated and with the transposes folded into the views
+struct GemmEntry
+{
+    MatrixView a, b, c;
+    const byte* aData = nullptr;
+    const byte* bData = nullptr;
+    byte* cData = nullptr;
+    double alpha = 1.0;
+    double beta = 0.0;
+};
+
+// the matrices of a gemm, false when they do not describe one. empty products are left out of the batch.
+bool addEntry(const gTensor& a, const gTensor& b, gTensor& c, bool transposeA, bool transposeB, double alpha,
+              double beta, std::vector<GemmEntry>& entries)
+{
+    GemmEntry entry;
+    if (!getInnerMatrixView(a, transposeA, entry.a) || !getInnerMatrixView(b, transposeB, entry.b) ||
+        !getInnerMatrixView(c, false, entry.c))
+    {
+        return false;
+    }
+    if (entry.a.rows != entry.c.rows || entry.b.cols != entry.c.cols || entry.a.cols != entry.b.rows) return false;
+    if (entry.c.rows == 0 || entry.c.cols == 0) return true;
+    if (!a.data() || !b.data() || !c.data()) return false;
+    entry.aData = a.data();
+    entry.bData = b.data();
+    entry.cData = c.data();
+    entry.alpha = alpha;
+    entry.beta = beta;
+    entries.push_back(entry);
+    return true;
+}
+
+// source of the scratch of the threads that run whole products of a batch side by side: their blocks are cut
+// from the workspace attached to the operation, under a lock since the threads share it. the batch runs in a
+// scope of that workspace which gives everything back at once, so deallocate has nothing to do
+class CarvedAllocator : public Allocator
+{
+public:
+    explicit CarvedAllocator(Workspace& parent) : m_parent(parent) {}
+    byte* allocate(uint64_t sizeInBytes) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_parent.allocate(sizeInBytes);
+    }
+    void deallocate(byte*, uint64_t) override {}
+private:
+    Workspace& m_parent;
+    std::mutex m_mutex;
+};
+
+// products large enough to split over the whole pool run one after the other, the others run side by side
+// with one thread each, which keeps more threads busy than splitting every small product
+template<typename Problem, typename Kernel>
+void gemmBatch(const std::vector<GemmEntry>& entries, const Problem& prototype, const Kernel& kernel)
+{
+    using T = decltype(prototype.alpha);
+    const auto makeProblem = [&](const GemmEntry& entry)
+    {
+        Problem problem = prototype;
+        problem.a = entry.a;
+        problem.b = entry.b;
+        problem.c = entry.c;
+        problem.aData = entry.aData;
+        problem.bData = entry.bData;
+        problem.cData = entry.cData;
+        problem.alpha = static_cast<T>(entry.alpha);
+        problem.beta = static_cast<T>(entry.beta);
+        return problem;
+    };
+    // the panels and partials of a product are given back before the next one, the peak of the attached
+    // workspace is that of the largest product and not the sum over the batch
+    const auto runSerial = [&](const GemmEntry& entry)
+    {
+        Workspace::Scope scope(prototype.workspace);
+        gemmTyped(makeProblem(entry), kernel);
+    };
+    const uint64_t maxThreads = getMaxThreads();
+    std::vector<const GemmEntry*> small;
+    for (const GemmEntry& entry : entries)
+    {
+        const uint64_t work = entry.c.rows * entry.c.cols * entry.a.cols;
+        if (maxThreads > 1 && work / kMinWorkPerThread >= maxThreads) runSerial(entry);
+        else small.push_back(&entry);
+    }
+    if (small.size() == 1 || maxThreads == 1)
+    {
+        for (const GemmEntry* entry : small) runSerial(*entry);
+        return;
+    }
+    // one workspace per thread for the length of the batch, from the attached workspace if there is one and
+    // from the default (pooled) allocator otherwise. they are released before returning
+    Workspace::Scope parentScope(prototype.workspace);
+    std::optional<CarvedAllocator> carved;
+    if (prototype.workspace) carved.emplace(*prototype.workspace);
+    Allocator& allocator = carved ? static_cast<Allocator&>(*carved) : getDefaultAllocator();
+    const unsigned threads = static_cast<unsigned>(std::min<uint64_t>(maxThreads, small.size()));
+    std::vector<std::unique_ptr<Workspace>> scratch(threads);
+    parallelFor(small.size(), threads, [&](uint64_t i, unsigned thread)
+    {
+        if (!scratch[thread]) scratch[thread] = std::make_unique<Workspace>(0, allocator);
+        Workspace::Scope scope(scratch[thread].get());
+        Problem problem = makeProblem(*small[i]);
+        problem.workspace = scratch[thread].get();
+        problem.maxThreads = 1;
+        gemmTyped(problem, kernel);
+    });
+}
+
+// picks the compute type from the dtypes every product of the batch shares
+gStatus runGemms(const std::vector<GemmEntry>& entries, DType aType, DType bType, DType cType, RoundingMode rounding,
+                 Workspace* workspace, const EpilogueStage& epilogue = {},
+                 const Requantization* requantization = nullptr)
+{
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    if (aType == DType::int8 || aType == DType::uint8 || bType == DType::int8 || requantization)
+    {
+        if (epilogue.isActive()) return gStatus::gBLAS_FAIL;
+        // u8 x s8 and s8 x s8 into int32, or into int8/uint8 through the requantization epilogue
+        const bool cValid = requantization ? cType == DType::int8 || cType == DType::uint8 : cType == DType::int32;
+        if (bType != DType::int8 || (aType != DType::int8 && aType != DType::uint8) || !cValid)
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        // alpha and beta are truncated to int32 by the batch, they must fit it
+        for (const GemmEntry& entry : entries)
+        {
+            int32_t alpha = 0, beta = 0;
+            if (!toIntegerScalar(entry.alpha, alpha) || !toIntegerScalar(entry.beta, beta))
+            {
+                return gStatus::gBLAS_FAIL;
+            }
+        }
+        GemmI8Problem prototype;
+        prototype.signedA = aType == DType::int8;
+        prototype.cType = cType;
+        prototype.requantization = requantization;
+        prototype.workspace = workspace;
+        if (!entries.empty()) gemmBatch(entries, prototype, table.gemmI8);
+        return gStatus::gBLAS_PASS;
+    }
+    if (aType == DType::fp64 && bType == DType::fp64 && cType == DType::fp64)
+    {
+        // the epilogue operands follow the compute type
+        if ((epilogue.bias.data && epilogue.bias.dtype != DType::fp64) ||
+            (epilogue.residual.data && epilogue.residual.dtype != DType::fp64))
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        GemmProblem<double> prototype;
+        prototype.epilogue = epilogue;
+        prototype.workspace = workspace;
+        if (!entries.empty()) gemmBatch(entries, prototype, table.gemmF64);
+        return gStatus::gBLAS_PASS;
+    }
+    // everything else accumulates in fp32, operands in other floating types are converted while packing
+    const FloatCodec* aCodec = getFloatCodec(aType);
+    const FloatCodec* bCodec = getFloatCodec(bType);
+    const FloatCodec* cCodec = getFloatCodec(cType);
+    if (!aCodec || !bCodec || !cCodec) return gStatus::gBLAS_FAIL;
+    GemmProblem<float> prototype;
+    prototype.aCodec = aType == DType::fp32 ? nullptr : aCodec;
+    prototype.bCodec = bType == DType::fp32 ? nullptr : bCodec;
+    prototype.cCodec = cType == DType::fp32 ? nullptr : cCodec;
+    prototype.rounding = rounding;
+    prototype.epilogue = epilogue;
+    for (EpilogueOperand* operand : {&prototype.epilogue.bias, &prototype.epilogue.residual})
+    {
+        if (!operand->data) continue;
+        operand->codec = getFloatCodec(operand->dtype);
+        if (!operand->codec) return gStatus::gBLAS_FAIL;
+        if (operand->dtype == DType::fp32) operand->codec = nullptr;
+    }
+    prototype.workspace = workspace;
+    if (entries.empty()) return gStatus::gBLAS_PASS;
+    // bf16 operands go to the tile kernels as they are where the host has them
+    if (aType == DType::bf16 && bType == DType::bf16 && table.gemmBf16.microKernel)
+    {
+        gemmBatch(entries, prototype, table.gemmBf16);
+        return gStatus::gBLAS_PASS;
+    }
+    gemmBatch(entries, prototype, table.gemmF32);
+    return gStatus::gBLAS_PASS;
+}
+
+} // anonymous namespace
+
+gStatus Operations::gemm(const gTensor& a, const gTensor& b, gTensor& c, double alpha, double beta,
+                         bool transposeA, bool transposeB, RoundingMode rounding)
+{
+    return gemm(a, b, c, GemmEpilogue{}, alpha, beta, transposeA, transposeB, rounding);
+}
+
+gStatus Operations::gemm(const gTensor& a, const gTensor& b, gTensor& c, const GemmEpilogue& epilogue, double alpha,
+                         double beta, bool transposeA, bool transposeB, RoundingMode rounding)
+{
+    // validate inputs
+    if (a.getRank() != 2 || b.getRank() != 2 || c.getRank() != 2) return gStatus::gBLAS_FAIL;
+    std::vector<GemmEntry> entries;
+    if (!addEntry(a, b, c, transposeA, transposeB, alpha, beta, entries)) return gStatus::gBLAS_FAIL;
+    MatrixView cView;
+    getMatrixView(c, false, cView);
+    EpilogueStage stage;
+    stage.activation = epilogue.activation;
+    if (const gTensor* bias = epilogue.bias)
+    {
+        if (bias->getRank() != 1 || bias->getSize(0) != cView.cols || (cView.cols && !bias->data()))
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        // C is written while the bias is read, their bytes must not overlap
+        if (sharesBytes(*bias, c)) return gStatus::gBLAS_FAIL;
+        stage.bias = {{cView.rows, cView.cols, 0, bias->getStride(0)}, bias->data(), bias->getDType()};
+    }
+    if (const gTensor* residual = epilogue.residual)
+    {
+        MatrixView view;
+        if (!getMatrixView(*residual, false, view) || view.rows != cView.rows || view.cols != cView.cols)
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        // C is written while the residual is read, their bytes must not overlap
+        if (!residual->data() && !entries.empty()) return gStatus::gBLAS_FAIL;
+        if (sharesBytes(*residual, c)) return gStatus::gBLAS_FAIL;
+        stage.residual = {view, residual->data(), residual->getDType()};
+    }
+
+    // perform operation
+    Workspace::Scope scratch(m_workspace);
+    return runGemms(entries, a.getDType(), b.getDType(), c.getDType(), rounding, m_workspace, stage);
+}
+
+gStatus Operations::gemmRequantized(const gTensor& a, const gTensor& b, gTensor& c,
+                                    const Requantization& requantization, bool transposeA, bool transposeB)
+{
+    // validate inputs
+    if (a.getRank() != 2 || b.getRank() != 2 || c.getRank() != 2 || !requantization.scales) return gStatus::gBLAS_FAIL;
+    if (requantization.min > requantization.max) return gStatus::gBLAS_FAIL;
+    std::vector<GemmEntry> entries;
+    if (!addEntry(a, b, c, transposeA, transposeB, 1.0, 0.0, entries)) return gStatus::gBLAS_FAIL;
+    // a NaN or infinite scale has no integer to round to
+    MatrixView cView;
+    getMatrixView(c, false, cView);
+    const uint64_t scaleCount = requantization.perColumn ? cView.cols : 1;
+    for (uint64_t j = 0; j < scaleCount; ++j)
+    {
+        if (!std::isfinite(requantization.scales[j])) return gStatus::gBLAS_FAIL;
+    }
+
+    // perform operation
+    Workspace::Scope scratch(m_workspace);
+    return runGemms(entries, a.getDType(), b.getDType(), c.getDType(), RoundingMode::NearestEven, m_workspace, {},
+                    &requantization);
+}
+
+gStatus Operations::gemmStridedBatched(const gTensor& a, const gTensor& b, gTensor& c, double alpha, double beta,
+                                       bool transposeA, bool transposeB, RoundingMode rounding)
+{
+    // validate inputs
+    const unsigned rank = c.getRank();
+    if (rank < 3 || a.getRank() != rank || b.getRank() != rank) return gStatus::gBLAS_FAIL;
+    uint64_t count = 1;
+    for (unsigned dim = 2; dim < rank; ++dim)
+    {
+        const uint64_t size = c.getSize(dim);
+        if ((a.getSize(dim) != size && a.getSize(dim) != 1) || (b.getSize(dim) != size && b.getSize(dim) != 1))
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        count *= size;
+    }
+    MatrixView aView, bView, cView;
+    if (!getInnerMatrixView(a, transposeA, aView) || !getInnerMatrixView(b, transposeB, bView) ||
+        !getInnerMatrixView(c, false, cView))
+    {
+        return gStatus::gBLAS_FAIL;
+    }
+    if (aView.rows != cView.rows || bView.cols != cView.cols || aView.cols != bView.rows) return gStatus::gBLAS_FAIL;
+    if (count == 0 || cView.rows == 0 || cView.cols == 0) return gStatus::gBLAS_PASS;
+    if (!a.data() || !b.data() || !c.data()) return gStatus::gBLAS_FAIL;
+
+    // the batch dims walk like an odometer, dim 2 fastest, a broadcast operand keeps its offset
+    const int64_t aSize = getSingleElementSizeInBytes(a.getDType());
+    const int64_t bSize = getSingleElementSizeInBytes(b.getDType());
+    const int64_t cSize = getSingleElementSizeInBytes(c.getDType());
+    std::vector<GemmEntry> entries(count, GemmEntry{aView, bView, cView, a.data(), b.data(), c.data(), alpha, beta});
+    Coordinates index = {};
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        GemmEntry& entry = entries[i];
+        for (unsigned dim = 2; dim < rank; ++dim)
+        {
+            const int64_t at = static_cast<int64_t>(index[dim]);
+            if (a.getSize(dim) != 1) entry.aData += at * a.getStride(dim) * aSize;
+            if (b.getSize(dim) != 1) entry.bData += at * b.getStride(dim) * bSize;
+            entry.cData += at * c.getStride(dim) * cSize;
+        }
+        for (unsigned dim = 2; dim < rank && ++index[dim] == c.getSize(dim); ++dim) index[dim] = 0;
+    }
+
+    // perform operation
+    Workspace::Scope scratch(m_workspace);
+    return runGemms(entries, a.getDType(), b.getDType(), c.getDType(), rounding, m_workspace);
+}
+
+gStatus Operations::gemmGrouped(const GemmGroupEntry* group, uint64_t count, RoundingMode rounding)
+{
+    // validate inputs
+    if (count == 0) return gStatus::gBLAS_PASS;
+    if (!group) return gStatus::gBLAS_FAIL;
+    std::vector<GemmEntry> entries;
+    entries.reserve(count);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const GemmGroupEntry& item = group[i];
+        if (!item.a || !item.b || !item.c || item.a->getRank() != 2 || item.b->getRank() != 2 ||
+            item.c->getRank() != 2)
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        // one compute type for the whole group
+        if (item.a->getDType() != group[0].a->getDType() || item.b->getDType() != group[0].b->getDType() ||
+            item.c->getDType() != group[0].c->getDType())
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+        if (!addEntry(*item.a, *item.b, *item.c, item.transposeA, item.transposeB, item.alpha, item.beta, entries))
+        {
+            return gStatus::gBLAS_FAIL;
+        }
+    }
+
+    // perform operation
+    Workspace::Scope scratch(m_workspace);
+    return runGemms(entries, group[0].a->getDType(), group[0].b->getDType(), group[0].c->getDType(), rounding,
+                    m_workspace);
+}
+
+} // namespace gblas
@@ -0,0 +1,261 @@
+#include "operations.h"
+#include "matrix_view.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "gTensor/gTensor.h"
+#include "kernels/kernels.h"
+#include "runtime/Parallel.h"
+#include "runtime/Workspace.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace gblas {
+
+namespace {
+
+// rows of op(A) handled by one task, the task keeps their results for every vector on its stack
+constexpr uint64_t kGemvRows = 512;
+// the row form walks the depth in blocks, so a tile of rows is still in L1 when the next vectors need it
+constexpr uint64_t kGemvDepth = 2048;
+// vectors computed in one pass over A
+constexpr uint64_t kGemvBatch = 16;
+// below this many bytes of A per piece the fork/join costs more than it saves
+constexpr uint64_t kGemvBytesPerPiece = 256 << 10;
+
+template<typename T>
+struct GemvProblem
+{
+    MatrixView a;
+    const byte* aData = nullptr;
+    const FloatCodec* aCodec = nullptr;
+    // alpha * x, widened and packed: vector b starts at x + b * a.cols
+    const T* x = nullptr;
+    uint64_t batch = 1;
+    // y of vector b starts at yData + b * yBatchStride elements, its elements are yStride apart
+    byte* yData = nullptr;
+    int64_t yStride = 0;
+    int64_t yBatchStride = 0;
+    const FloatCodec* yCodec = nullptr;
+    T beta = T(0);
+    RoundingMode rounding = RoundingMode::NearestEven;
+};
+
+// t[b * kGemvRows + r] = sum over p of A(row + r, p) * x_b[p] for the rows of one task. A with neither
+// unit stride goes one row at a time through a widened copy.
+template<typename T, typename Src>
+void multiplyBlock(const GemvProblem<T>& problem, const kernels::GemvKernels<Src, T>& kernels,
+                   const kernels::GemvKernels<T, T>& widened, uint64_t row, uint64_t rows, uint64_t batch,
+                   uint64_t firstVector, T* t)
+{
+    const MatrixView& a = problem.a;
+    const uint64_t k = a.cols;
+    const T* x = problem.x + firstVector * k;
+    const int64_t ldx = static_cast<int64_t>(k);
+    const unsigned vectors = static_cast<unsigned>(batch);
+    for (uint64_t b = 0; b < batch; ++b) std::fill(t + b * kGemvRows, t + b * kGemvRows + rows, T(0));
+    const int64_t elementSize = problem.aCodec ? problem.aCodec->elementSize : sizeof(T);
+    const byte* block = problem.aData + static_cast<int64_t>(row) * a.rowStride * elementSize;
+    const Src* aBlock = reinterpret_cast<const Src*>(block);
+    if (a.colStride == 1)
+    {
+        for (uint64_t p = 0; p < k; p += kGemvDepth)
+        {
+            kernels.byRows(rows, std::min(kGemvDepth, k - p), aBlock + p, a.rowStride, x + p, ldx, vectors, t, kGemvRows);
+        }
+        return;
+    }
+    if (a.rowStride == 1)
+    {
+        kernels.byCols(rows, k, aBlock, a.colStride, x, ldx, vectors, t, kGemvRows);
+        return;
+    }
+    T line[kGemvDepth];
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        const byte* aRow = block + static_cast<int64_t>(r) * a.rowStride * elementSize;
+        for (uint64_t p = 0; p < k; p += kGemvDepth)
+        {
+            const uint64_t depth = std::min(kGemvDepth, k - p);
+            const byte* src = aRow + static_cast<int64_t>(p) * a.colStride * elementSize;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                problem.aCodec->widen(src, a.colStride, depth, line);
+            }
+            else
+            {
+                for (uint64_t i = 0; i < depth; ++i) line[i] = reinterpret_cast<const T*>(src)[i * a.colStride];
+            }
+            widened.byRows(1, depth, line, 0, x + p, ldx, vectors, t + r, kGemvRows);
+        }
+    }
+}
+
+// y = t + beta * y for the rows of one task
+template<typename T>
+void storeBlock(const GemvProblem<T>& problem, uint64_t row, uint64_t rows, uint64_t batch, uint64_t firstVector,
+                const T* t)
+{
+    for (uint64_t b = 0; b < batch; ++b)
+    {
+        const T* tb = t + b * kGemvRows;
+        const int64_t offset = static_cast<int64_t>(firstVector + b) * problem.yBatchStride +
+                               static_cast<int64_t>(row) * problem.yStride;
+        if constexpr (std::is_same_v<T, float>)
+        {
+            const FloatCodec& codec = *problem.yCodec;
+            byte* y = problem.yData + offset * codec.elementSize;
+            float line[kGemvRows];
+            if (problem.beta != 0.0f)
+            {
+                codec.widen(y, problem.yStride, rows, line);
+                for (uint64_t r = 0; r < rows; ++r) line[r] = tb[r] + problem.beta * line[r];
+            }
+            else
+            {
+                std::copy(tb, tb + rows, line);
+            }
+            codec.narrow(line, y, problem.yStride, rows, problem.rounding);
+        }
+        else
+        {
+            T* y = reinterpret_cast<T*>(problem.yData) + offset;
+            for (uint64_t r = 0; r < rows; ++r)
+            {
+                T& value = y[static_cast<int64_t>(r) * problem.yStride];
+                value = problem.beta == T(0) ? tb[r] : tb[r] + problem.beta * value;
+            }
+        }
+    }
+}
+
+// the rows are split over the pool in tasks of kGemvRows, each task streams its rows of A once for up to
+// kGemvBatch vectors
+template<typename T, typename Src>
+void gemvTyped(const GemvProblem<T>& problem, const kernels::GemvKernels<Src, T>& kernels,
+               const kernels::GemvKernels<T, T>& widened)
+{
+    const uint64_t m = problem.a.rows;
+    const uint64_t rowBlocks = (m + kGemvRows - 1) / kGemvRows;
+    const uint64_t elementSize = problem.aCodec ? problem.aCodec->elementSize : sizeof(T);
+    const uint64_t blockBytes = std::max<uint64_t>(1, kGemvRows * problem.a.cols * elementSize);
+    const uint64_t grain = std::max<uint64_t>(1, kGemvBytesPerPiece / blockBytes);
+    for (uint64_t firstVector = 0; firstVector < problem.batch; firstVector += kGemvBatch)
+    {
+        const uint64_t batch = std::min(kGemvBatch, problem.batch - firstVector);
+        parallelForRange(rowBlocks, grain, [&](uint64_t begin, uint64_t end, unsigned)
+        {
+            alignas(64) T t[kGemvBatch * kGemvRows];
+            for (uint64_t block = begin; block < end; ++block)
+            {
+                const uint64_t row = block * kGemvRows;
+                const uint64_t rows = std::min(kGemvRows, m - row);
+                multiplyBlock(problem, kernels, widened, row, rows, batch, firstVector, t);
+                storeBlock(problem, row, rows, batch, firstVector, t);
+            }
+        });
+    }
+}
+
+// alpha * x packed into contiguous vectors of the compute type
+template<typename T>
+void packVectors(const gTensor& x, uint64_t k, uint64_t batch, T alpha, T* dst)
+{
+    const int64_t stride = x.getStride(0);
+    const int64_t batchStride = batch > 1 ? x.getStride(1) : 0;
+    for (uint64_t b = 0; b < batch; ++b)
+    {
+        T* vector = dst + b * k;
+        if constexpr (std::is_same_v<T, float>)
+        {
+            const FloatCodec& codec = *getFloatCodec(x.getDType());
+            codec.widen(x.data() + static_cast<int64_t>(b) * batchStride * codec.elementSize, stride, k, vector);
+        }
+        else
+        {
+            const T* src = reinterpret_cast<const T*>(x.data()) + static_cast<int64_t>(b) * batchStride;
+            for (uint64_t p = 0; p < k; ++p) vector[p] = src[static_cast<int64_t>(p) * stride];
+        }
+        if (alpha != T(1))
+        {
+            for (uint64_t p = 0; p < k; ++p) vector[p] *= alpha;
+        }
+    }
+}
+
+gStatus runGemv(const gTensor& a, const gTensor& x, gTensor& y, double alpha, double beta, bool transposeA,
+                RoundingMode rounding, Workspace* workspace, unsigned rank)
+{
+    // validate inputs
+    MatrixView aView;
+    if (!getMatrixView(a, transposeA, aView) || x.getRank() != rank || y.getRank() != rank) return gStatus::gBLAS_FAIL;
+    if (x.getSize(0) != aView.cols || y.getSize(0) != aView.rows) return gStatus::gBLAS_FAIL;
+    const uint64_t batch = rank == 2 ? x.getSize(1) : 1;
+    if (rank == 2 && y.getSize(1) != batch) return gStatus::gBLAS_FAIL;
+    if (aView.rows == 0 || batch == 0) return gStatus::gBLAS_PASS;
+    if ((aView.cols != 0 && (!a.data() || !x.data())) || !y.data()) return gStatus::gBLAS_FAIL;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    Workspace::Scope scratch(workspace);
+    const uint64_t k = aView.cols;
+    if (a.getDType() == DType::fp64 && x.getDType() == DType::fp64 && y.getDType() == DType::fp64)
+    {
+        PanelPtr<double> vectors = allocatePanel<double>(std::max<uint64_t>(1, k * batch), workspace);
+        packVectors(x, k, batch, alpha, vectors.get());
+        GemvProblem<double> problem{aView, a.data(), nullptr, vectors.get(), batch, y.data()};
+        problem.yStride = y.getStride(0);
+        problem.yBatchStride = rank == 2 ? y.getStride(1) : 0;
+        problem.beta = beta;
+        gemvTyped(problem, table.gemvF64, table.gemvF64);
+        return gStatus::gBLAS_PASS;
+    }
+    // everything else accumulates in fp32, A is decoded by the kernels and x is widened up front
+    const FloatCodec* aCodec = getFloatCodec(a.getDType());
+    const FloatCodec* xCodec = getFloatCodec(x.getDType());
+    const FloatCodec* yCodec = getFloatCodec(y.getDType());
+    if (!aCodec || !xCodec || !yCodec) return gStatus::gBLAS_FAIL;
+    PanelPtr<float> vectors = allocatePanel<float>(std::max<uint64_t>(1, k * batch), workspace);
+    packVectors(x, k, batch, static_cast<float>(alpha), vectors.get());
+    GemvProblem<float> problem{aView, a.data(), aCodec, vectors.get(), batch, y.data()};
+    problem.yStride = y.getStride(0);
+    problem.yBatchStride = rank == 2 ? y.getStride(1) : 0;
+    problem.yCodec = yCodec;
+    problem.beta = static_cast<float>(beta);
+    problem.rounding = rounding;
+    switch (a.getDType())
+    {
+        case DType::bf16:
+            gemvTyped(problem, table.gemvBf16, table.gemvF32);
+            break;
+        case DType::fp16:
+            gemvTyped(problem, table.gemvFp16, table.gemvF32);
+            break;
+        case DType::fp8_152:
+            gemvTyped(problem, table.gemvFp8_152, table.gemvF32);
+            break;
+        case DType::fp8_143:
+            gemvTyped(problem, table.gemvFp8_143, table.gemvF32);
+            break;
+        default:
+            // fp32, and tf32 which is stored in the fp32 layout
+            gemvTyped(problem, table.gemvF32, table.gemvF32);
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+} // anonymous namespace
+
+gStatus Operations::gemv(const gTensor& a, const gTensor& x, gTensor& y, double alpha, double beta, bool transposeA,
+                         RoundingMode rounding)
+{
+    return runGemv(a, x, y, alpha, beta, transposeA, rounding, m_workspace, 1);
+}
+
+gStatus Operations::gemvBatched(const gTensor& a, const gTensor& x, gTensor& y, double alpha, double beta,
+                                bool transposeA, RoundingMode rounding)
+{
+    return runGemv(a, x, y, alpha, beta, transposeA, rounding, m_workspace, 2);
+}
+
+} // namespace gblas
@@ -0,0 +1,700 @@
+#include "operations.h"
+#include "gTensor/gTensor.h"
+#include "gTensor/gTensorIterator.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "transpose.h"
+#include "kernels/kernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace gblas {
+
+namespace {
+
+using Chunk = gTensorIterator::Chunk;
+
+// Neumaier's compensated sum, the block results of a reduction are added up with it
+struct CompensatedSum
+{
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void add(double value)
+    {
+        const double total = sum + value;
+        if (!std::isfinite(total))
+        {
+            sum = total;
+            return;
+        }
+        if (std::abs(sum) >= std::abs(value)) compensation += (sum - total) + value;
+        else compensation += (value - total) + sum;
+        sum = total;
+    }
+    double get() const {return std::isfinite(sum) ? sum + compensation : sum;}
+};
+
+// the largest magnitude and where it is first seen
+template<typename T>
+struct MaxAt
+{
+    T value = 0;
+    uint64_t index = 0;
+    bool found = false;
+};
+
+// the type an operation computes a dtype in
+enum class Compute
+{
+    F32,
+    F64,
+    Integer,
+    None,
+};
+
+Compute getCompute(DType dtype)
+{
+    switch (dtype)
+    {
+        case DType::fp32:
+        case DType::bf16:
+        case DType::fp16:
+        case DType::tf32:
+        case DType::fp8_152:
+        case DType::fp8_143:
+            return Compute::F32;
+        case DType::fp64:
+            return Compute::F64;
+        case DType::int8:
+        case DType::uint8:
+        case DType::int16:
+        case DType::int32:
+        case DType::int64:
+            return Compute::Integer;
+        default:
+            return Compute::None;
+    }
+}
+
+// calls fn.template operator()<T>() with the element type of an integer dtype
+template<typename Fn>
+void withIntegerType(DType dtype, Fn fn)
+{
+    switch (dtype)
+    {
+        case DType::int8: fn.template operator()<int8_t>(); break;
+        case DType::uint8: fn.template operator()<uint8_t>(); break;
+        case DType::int16: fn.template operator()<int16_t>(); break;
+        case DType::int32: fn.template operator()<int32_t>(); break;
+        case DType::int64: fn.template operator()<int64_t>(); break;
+        default: break;
+    }
+}
+
+template<typename T>
+uint64_t magnitude(T value)
+{
+    // through the unsigned type so the most negative value has a magnitude too
+    const uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+    return value < 0 ? 0 - bits : bits;
+}
+
+// elements [begin, begin + count) of an operand as a contiguous array of the compute type. fp32 and fp64
+// runs that already are contiguous are used in place, the others are widened into staging.
+template<typename T>
+T* stage(const Chunk& chunk, unsigned op, const FloatCodec* codec, uint64_t begin, uint64_t count, T* staging)
+{
+    const int64_t stride = chunk.strides[op];
+    if constexpr (std::is_same_v<T, double>)
+    {
+        double* data = chunk.get<double>(op) + static_cast<int64_t>(begin) * stride;
+        if (chunk.isContiguous(op)) return data;
+        for (uint64_t i = 0; i < count; ++i) staging[i] = data[static_cast<int64_t>(i) * stride];
+    }
+    else
+    {
+        byte* data = chunk.data[op] + static_cast<int64_t>(begin) * stride * codec->elementSize;
+        if (codec->dtype == DType::fp32 && chunk.isContiguous(op)) return reinterpret_cast<float*>(data);
+        codec->widen(data, stride, count, staging);
+    }
+    return staging;
+}
+
+// the counterpart of stage for runs that were modified, staged runs are narrowed back
+template<typename T>
+void unstage(const Chunk& chunk, unsigned op, const FloatCodec* codec, uint64_t begin, uint64_t count,
+             const T* run, const T* staging, RoundingMode rounding)
+{
+    if (run != staging) return;
+    const int64_t stride = chunk.strides[op];
+    if constexpr (std::is_same_v<T, double>)
+    {
+        double* data = chunk.get<double>(op) + static_cast<int64_t>(begin) * stride;
+        for (uint64_t i = 0; i < count; ++i) data[static_cast<int64_t>(i) * stride] = staging[i];
+    }
+    else
+    {
+        codec->narrow(staging, chunk.data[op] + static_cast<int64_t>(begin) * stride * codec->elementSize, stride,
+                      count, rounding);
+    }
+}
+
+// calls runFn(runs, count, begin) over a chunk in runs of up to kStagingElements, with the first N operands
+// as contiguous arrays of the compute type T (float or double). with writeBack the runs are stored back.
+template<typename T, unsigned N, typename RunFn>
+void forEachRun(const Chunk& chunk, const FloatCodec* codec, RunFn runFn, bool writeBack = false,
+                RoundingMode rounding = RoundingMode::NearestEven)
+{
+    T staging[N][kStagingElements];
+    std::array<T*, N> runs;
+    for (uint64_t begin = 0; begin < chunk.length; begin += kStagingElements)
+    {
+        const uint64_t count = std::min(kStagingElements, chunk.length - begin);
+        for (unsigned op = 0; op < N; ++op) runs[op] = stage<T>(chunk, op, codec, begin, count, staging[op]);
+        runFn(runs, count, begin);
+        if (!writeBack) continue;
+        for (unsigned op = 0; op < N; ++op) unstage<T>(chunk, op, codec, begin, count, runs[op], staging[op], rounding);
+    }
+}
+
+// result per block, computed on the thread pool
+template<typename Partial, typename BlockFn>
+std::vector<Partial> reduceBlocks(const gTensorIterator& iterator, BlockFn blockFn)
+{
+    std::vector<Partial> partials(iterator.getNumOfBlocks());
+    iterator.parallelForEachBlock([&](uint64_t block) {partials[block] = blockFn(block);});
+    return partials;
+}
+
+// adds up what chunkFn(chunk, sum) adds for every chunk. the blocks are added in order, so the result does
+// not depend on the number of threads.
+template<typename ChunkFn>
+double sumBlocks(const gTensorIterator& iterator, ChunkFn chunkFn)
+{
+    const std::vector<CompensatedSum> partials = reduceBlocks<CompensatedSum>(iterator, [&](uint64_t block)
+    {
+        CompensatedSum sum;
+        iterator.forEachChunkInBlock(block, [&](const Chunk& chunk) {chunkFn(chunk, sum);});
+        return sum;
+    });
+    CompensatedSum total;
+    for (const CompensatedSum& partial : partials)
+    {
+        total.add(partial.sum);
+        total.add(partial.compensation);
+    }
+    return total.get();
+}
+
+// the first largest magnitude of a floating tensor, NaN is skipped
+template<typename T>
+MaxAt<T> maxAtFloat(const gTensorIterator& iterator, const FloatCodec* codec)
+{
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const std::vector<MaxAt<T>> partials = reduceBlocks<MaxAt<T>>(iterator, [&](uint64_t block)
+    {
+        MaxAt<T> best;
+        iterator.forEachChunkInBlock(block, [&](const Chunk& chunk)
+        {
+            forEachRun<T, 1>(chunk, codec, [&](const std::array<T*, 1>& runs, uint64_t count, uint64_t begin)
+            {
+                T largest;
+                if constexpr (std::is_same_v<T, double>) largest = table.amaxF64(count, runs[0]);
+                else largest = table.amaxF32(count, runs[0]);
+                if (best.found && largest <= best.value) return;
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    if (std::abs(runs[0][i]) == largest)
+                    {
+                        best = {largest, chunk.index + begin + i, true};
+                        return;
+                    }
+                }
+            });
+        });
+        return best;
+    });
+    MaxAt<T> result;
+    for (const MaxAt<T>& partial : partials)
+    {
+        if (partial.found && (!result.found || partial.value > result.value)) result = partial;
+    }
+    return result;
+}
+
+template<typename T>
+MaxAt<uint64_t> maxAtInteger(const gTensorIterator& iterator)
+{
+    const std::vector<MaxAt<uint64_t>> partials = reduceBlocks<MaxAt<uint64_t>>(iterator, [&](uint64_t block)
+    {
+        MaxAt<uint64_t> best;
+        iterator.forEachChunkInBlock(block, [&](const Chunk& chunk)
+        {
+            const T* data = chunk.get<const T>(0);
+            for (uint64_t i = 0; i < chunk.length; ++i)
+            {
+                const uint64_t value = magnitude(data[static_cast<int64_t>(i) * chunk.strides[0]]);
+                if (!best.found || value > best.value) best = {value, chunk.index + i, true};
+            }
+        });
+        return best;
+    });
+    MaxAt<uint64_t> result;
+    for (const MaxAt<uint64_t>& partial : partials)
+    {
+        if (partial.found && (!result.found || partial.value > result.value)) result = partial;
+    }
+    return result;
+}
+
+// squares summed in T, with a second pass scaled by a power of two when that over- or underflowed
+template<typename T>
+double nrm2Float(const gTensorIterator& iterator, const FloatCodec* codec)
+{
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const auto dotKernel = [&](uint64_t n, const T* x, const T* y) -> T
+    {
+        if constexpr (std::is_same_v<T, double>) return table.dotF64(n, x, y);
+        else return table.dotF32(n, x, y);
+    };
+    double sumOfSquares = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+    {
+        forEachRun<T, 1>(chunk, codec, [&](const std::array<T*, 1>& runs, uint64_t count, uint64_t)
+        {
+            sum.add(dotKernel(count, runs[0], runs[0]));
+        });
+    });
+    // below this the squares of the larger elements may already have lost bits to underflow
+    constexpr T kSmallestSafe = std::numeric_limits<T>::min() / std::numeric_limits<T>::epsilon();
+    if (std::isfinite(sumOfSquares) && sumOfSquares >= kSmallestSafe) return std::sqrt(sumOfSquares);
+
+    const MaxAt<T> largest = maxAtFloat<T>(iterator, codec);
+    if (!largest.found || largest.value == 0 || std::isinf(largest.value))
+    {
+        // all zeros, or an inf that no scaling brings back
+        return std::isnan(sumOfSquares) ? sumOfSquares : largest.found ? static_cast<double>(largest.value) : 0.0;
+    }
+    // the largest element is brought near 1 by 2^exponent. the scale goes on in two halves, for a subnormal
+    // maximum 2^exponent itself is beyond the range of T
+    const int exponent = -std::ilogb(largest.value);
+    const T first = std::ldexp(T(1), exponent / 2);
+    const T second = std::ldexp(T(1), exponent - exponent / 2);
+    sumOfSquares = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+    {
+        forEachRun<T, 1>(chunk, codec, [&](const std::array<T*, 1>& runs, uint64_t count, uint64_t)
+        {
+            T scaled[kStagingElements];
+            if constexpr (std::is_same_v<T, double>)
+            {
+                table.scalF64(count, first, runs[0], scaled);
+                table.scalF64(count, second, scaled, scaled);
+            }
+            else
+            {
+                table.scalF32(count, first, runs[0], scaled);
+                table.scalF32(count, second, scaled, scaled);
+            }
+            sum.add(dotKernel(count, scaled, scaled));
+        });
+    });
+    return std::ldexp(std::sqrt(sumOfSquares), -exponent);
+}
+
+// byte moves for copy and swap, by element size
+template<typename Fn>
+void withElementType(unsigned elementSize, Fn fn)
+{
+    switch (elementSize)
+    {
+        case 1: fn.template operator()<uint8_t>(); break;
+        case 2: fn.template operator()<uint16_t>(); break;
+        case 4: fn.template operator()<uint32_t>(); break;
+        case 8: fn.template operator()<uint64_t>(); break;
+        default: break;
+    }
+}
+
+bool hasData(const gTensor& tensor)
+{
+    return tensor.getTotalSizeInElements() == 0 || tensor.data();
+}
+
+} // anonymous namespace
+
+gStatus Operations::dot(const gTensor& x, const gTensor& y, double& result)
+{
+    // validate inputs
+    result = 0.0;
+    const DType dtype = x.getDType();
+    const Compute compute = getCompute(dtype);
+    if (compute == Compute::None || y.getDType() != dtype || !sameShape(x, y)) return gStatus::gBLAS_FAIL;
+    if (!hasData(x) || !hasData(y)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const gTensorIterator iterator({&x, &y});
+    const FloatCodec* codec = getFloatCodec(dtype);
+    switch (compute)
+    {
+        case Compute::F32:
+            result = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+            {
+                forEachRun<float, 2>(chunk, codec, [&](const std::array<float*, 2>& runs, uint64_t count, uint64_t)
+                {
+                    sum.add(table.dotF32(count, runs[0], runs[1]));
+                });
+            });
+            break;
+        case Compute::F64:
+            result = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+            {
+                forEachRun<double, 2>(chunk, codec, [&](const std::array<double*, 2>& runs, uint64_t count, uint64_t)
+                {
+                    sum.add(table.dotF64(count, runs[0], runs[1]));
+                });
+            });
+            break;
+        default:
+            withIntegerType(dtype, [&]<typename T>()
+            {
+                result = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+                {
+                    const T* xData = chunk.get<const T>(0);
+                    const T* yData = chunk.get<const T>(1);
+                    // int64 products (up to 2^126) are exact in int128 but a few of them overflow the sum,
+                    // they go to the compensated sum one by one
+                    if constexpr (sizeof(T) == 8)
+                    {
+                        for (uint64_t i = 0; i < chunk.length; ++i)
+                        {
+                            const __int128 xValue = xData[static_cast<int64_t>(i) * chunk.strides[0]];
+                            const __int128 product = xValue * yData[static_cast<int64_t>(i) * chunk.strides[1]];
+                            sum.add(static_cast<double>(product));
+                        }
+                        return;
+                    }
+                    // int8 and int16 products fit int64 many times over, int32 ones (up to 2^62) only twice
+                    using Acc = std::conditional_t<sizeof(T) == 4, __int128, int64_t>;
+                    Acc acc = 0;
+                    for (uint64_t i = 0; i < chunk.length; ++i)
+                    {
+                        acc += static_cast<Acc>(xData[static_cast<int64_t>(i) * chunk.strides[0]]) *
+                               yData[static_cast<int64_t>(i) * chunk.strides[1]];
+                    }
+                    sum.add(static_cast<double>(acc));
+                });
+            });
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::nrm2(const gTensor& x, double& result)
+{
+    // validate inputs
+    result = 0.0;
+    const DType dtype = x.getDType();
+    const Compute compute = getCompute(dtype);
+    if (compute == Compute::None || !hasData(x)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const gTensorIterator iterator(x);
+    switch (compute)
+    {
+        case Compute::F32:
+            result = nrm2Float<float>(iterator, getFloatCodec(dtype));
+            break;
+        case Compute::F64:
+            result = nrm2Float<double>(iterator, nullptr);
+            break;
+        default:
+            withIntegerType(dtype, [&]<typename T>()
+            {
+                result = std::sqrt(sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+                {
+                    const T* data = chunk.get<const T>(0);
+                    for (uint64_t i = 0; i < chunk.length; ++i)
+                    {
+                        const double value = static_cast<double>(data[static_cast<int64_t>(i) * chunk.strides[0]]);
+                        sum.add(value * value);
+                    }
+                }));
+            });
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::asum(const gTensor& x, double& result)
+{
+    // validate inputs
+    result = 0.0;
+    const DType dtype = x.getDType();
+    const Compute compute = getCompute(dtype);
+    if (compute == Compute::None || !hasData(x)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const gTensorIterator iterator(x);
+    const FloatCodec* codec = getFloatCodec(dtype);
+    switch (compute)
+    {
+        case Compute::F32:
+            result = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+            {
+                forEachRun<float, 1>(chunk, codec, [&](const std::array<float*, 1>& runs, uint64_t count, uint64_t)
+                {
+                    sum.add(table.asumF32(count, runs[0]));
+                });
+            });
+            break;
+        case Compute::F64:
+            result = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+            {
+                forEachRun<double, 1>(chunk, codec, [&](const std::array<double*, 1>& runs, uint64_t count, uint64_t)
+                {
+                    sum.add(table.asumF64(count, runs[0]));
+                });
+            });
+            break;
+        default:
+            withIntegerType(dtype, [&]<typename T>()
+            {
+                result = sumBlocks(iterator, [&](const Chunk& chunk, CompensatedSum& sum)
+                {
+                    const T* data = chunk.get<const T>(0);
+                    uint64_t acc = 0;
+                    for (uint64_t i = 0; i < chunk.length; ++i) acc += magnitude(data[static_cast<int64_t>(i) * chunk.strides[0]]);
+                    sum.add(static_cast<double>(acc));
+                });
+            });
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::iamax(const gTensor& x, uint64_t& index)
+{
+    // validate inputs
+    index = 0;
+    const DType dtype = x.getDType();
+    const Compute compute = getCompute(dtype);
+    if (compute == Compute::None || !hasData(x)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const gTensorIterator iterator(x);
+    switch (compute)
+    {
+        case Compute::F32:
+            index = maxAtFloat<float>(iterator, getFloatCodec(dtype)).index;
+            break;
+        case Compute::F64:
+            index = maxAtFloat<double>(iterator, nullptr).index;
+            break;
+        default:
+            withIntegerType(dtype, [&]<typename T>() {index = maxAtInteger<T>(iterator).index;});
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::scal(double alpha, gTensor& x, RoundingMode rounding)
+{
+    // validate inputs
+    const DType dtype = x.getDType();
+    const Compute compute = getCompute(dtype);
+    if (compute == Compute::None || !hasData(x)) return gStatus::gBLAS_FAIL;
+    if (compute == Compute::Integer)
+    {
+        bool fits = false;
+        withIntegerType(dtype, [&]<typename T>()
+        {
+            T factor = 0;
+            fits = toIntegerScalar(alpha, factor);
+        });
+        if (!fits) return gStatus::gBLAS_FAIL;
+    }
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const gTensorIterator iterator(x);
+    const FloatCodec* codec = getFloatCodec(dtype);
+    switch (compute)
+    {
+        case Compute::F32:
+            iterator.parallelForEachChunk([&](const Chunk& chunk)
+            {
+                forEachRun<float, 1>(chunk, codec, [&](const std::array<float*, 1>& runs, uint64_t count, uint64_t)
+                {
+                    table.scalF32(count, static_cast<float>(alpha), runs[0], runs[0]);
+                }, true, rounding);
+            });
+            break;
+        case Compute::F64:
+            iterator.parallelForEachChunk([&](const Chunk& chunk)
+            {
+                forEachRun<double, 1>(chunk, codec, [&](const std::array<double*, 1>& runs, uint64_t count, uint64_t)
+                {
+                    table.scalF64(count, alpha, runs[0], runs[0]);
+                }, true, rounding);
+            });
+            break;
+        default:
+            withIntegerType(dtype, [&]<typename T>()
+            {
+                // like axpy, integer types use alpha truncated to the element type, checked to fit above
+                T factor = 0;
+                toIntegerScalar(alpha, factor);
+                iterator.parallelForEachChunk([&](const Chunk& chunk)
+                {
+                    T* data = chunk.get<T>(0);
+                    for (uint64_t i = 0; i < chunk.length; ++i)
+                    {
+                        T& value = data[static_cast<int64_t>(i) * chunk.strides[0]];
+                        value = multiplyAdd(factor, value, T(0));
+                    }
+                });
+            });
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::copy(const gTensor& x, gTensor& y)
+{
+    // validate inputs
+    const DType dtype = x.getDType();
+    if (dtype == DType::dtypeNR || y.getDType() != dtype || !sameShape(x, y)) return gStatus::gBLAS_FAIL;
+    if (!hasData(x) || !hasData(y)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const unsigned srcDim = getContiguousDim(x);
+    const unsigned dstDim = getContiguousDim(y);
+    if (srcDim != dstDim && srcDim < x.getRank() && dstDim < y.getRank() &&
+        x.getDataBuffer()->data() != y.getDataBuffer()->data())
+    {
+        // a layout change: element by element one side would touch a new cache line for every element
+        copyTransposed(x, y);
+        return gStatus::gBLAS_PASS;
+    }
+    const unsigned elementSize = getSingleElementSizeInBytes(dtype);
+    const gTensorIterator iterator({&x, &y});
+    iterator.parallelForEachChunk([&](const Chunk& chunk)
+    {
+        if (chunk.isContiguous(0) && chunk.isContiguous(1))
+        {
+            std::memmove(chunk.data[1], chunk.data[0], chunk.length * elementSize);
+            return;
+        }
+        withElementType(elementSize, [&]<typename T>()
+        {
+            const T* src = chunk.get<const T>(0);
+            T* dst = chunk.get<T>(1);
+            for (uint64_t i = 0; i < chunk.length; ++i)
+            {
+                dst[static_cast<int64_t>(i) * chunk.strides[1]] = src[static_cast<int64_t>(i) * chunk.strides[0]];
+            }
+        });
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::swap(gTensor& x, gTensor& y)
+{
+    // validate inputs
+    const DType dtype = x.getDType();
+    if (dtype == DType::dtypeNR || y.getDType() != dtype || !sameShape(x, y)) return gStatus::gBLAS_FAIL;
+    if (!hasData(x) || !hasData(y)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const gTensorIterator iterator({&x, &y});
+    iterator.parallelForEachChunk([&](const Chunk& chunk)
+    {
+        withElementType(getSingleElementSizeInBytes(dtype), [&]<typename T>()
+        {
+            T* a = chunk.get<T>(0);
+            T* b = chunk.get<T>(1);
+            if (chunk.isContiguous(0) && chunk.isContiguous(1))
+            {
+                std::swap_ranges(a, a + chunk.length, b);
+                return;
+            }
+            for (uint64_t i = 0; i < chunk.length; ++i)
+            {
+                std::swap(a[static_cast<int64_t>(i) * chunk.strides[0]], b[static_cast<int64_t>(i) * chunk.strides[1]]);
+            }
+        });
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::rot(gTensor& x, gTensor& y, double c, double s, RoundingMode rounding)
+{
+    // validate inputs
+    const DType dtype = x.getDType();
+    const Compute compute = getCompute(dtype);
+    if (compute == Compute::None || y.getDType() != dtype || !sameShape(x, y)) return gStatus::gBLAS_FAIL;
+    if (!hasData(x) || !hasData(y)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const gTensorIterator iterator({&x, &y});
+    const FloatCodec* codec = getFloatCodec(dtype);
+    switch (compute)
+    {
+        case Compute::F32:
+            iterator.parallelForEachChunk([&](const Chunk& chunk)
+            {
+                forEachRun<float, 2>(chunk, codec, [&](const std::array<float*, 2>& runs, uint64_t count, uint64_t)
+                {
+                    table.rotF32(count, static_cast<float>(c), static_cast<float>(s), runs[0], runs[1]);
+                }, true, rounding);
+            });
+            break;
+        case Compute::F64:
+            iterator.parallelForEachChunk([&](const Chunk& chunk)
+            {
+                forEachRun<double, 2>(chunk, codec, [&](const std::array<double*, 2>& runs, uint64_t count, uint64_t)
+                {
+                    table.rotF64(count, c, s, runs[0], runs[1]);
+                }, true, rounding);
+            });
+            break;
+        default:
+            withIntegerType(dtype, [&]<typename T>()
+            {
+                // integer types rotate in fp64, the result is truncated and saturated
+                iterator.parallelForEachChunk([&](const Chunk& chunk)
+                {
+                    T* xData = chunk.get<T>(0);
+                    T* yData = chunk.get<T>(1);
+                    for (uint64_t i = 0; i < chunk.length; ++i)
+                    {
+                        T& xValue = xData[static_cast<int64_t>(i) * chunk.strides[0]];
+                        T& yValue = yData[static_cast<int64_t>(i) * chunk.strides[1]];
+                        const double xOld = static_cast<double>(xValue);
+                        const double yOld = static_cast<double>(yValue);
+                        xValue = saturateToInteger<T>(c * xOld + s * yOld);
+                        yValue = saturateToInteger<T>(c * yOld - s * xOld);
+                    }
+                });
+            });
+            break;
+    }
+    return gStatus::gBLAS_PASS;
+}
+
+} // namespace gblas
@@ -0,0 +1,50 @@
+#ifndef GBLAS_MATRIX_VIEW_H
+#define GBLAS_MATRIX_VIEW_H
+
+#include <cstdint>
+#include <utility>
+#include "gTensor/gTensor.h"
+
+namespace gblas {
+
+/// rank 2 tensor seen as a matrix, element (r, c) lives at data + r*rowStride + c*colStride (in elements)
+struct MatrixView
+{
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    int64_t rowStride = 0;
+    int64_t colStride = 0;
+
+    MatrixView transposed() const {return {cols, rows, colStride, rowStride};}
+};
+
+/// interpret dims 0 and 1 of a tensor as a matrix according to its Layout, optionally transposed.
+/// the dims above are left to the caller, batched operations walk them. returns false for an unknown layout.
+inline bool getInnerMatrixView(const gTensor& tensor, bool transpose, MatrixView& view)
+{
+    if (tensor.getRank() < 2) return false;
+    switch (tensor.getLayout())
+    {
+        case Layout::RowMajor:
+            view = {tensor.getSize(1), tensor.getSize(0), tensor.getStride(1), tensor.getStride(0)};
+            break;
+        case Layout::ColMajor:
+            view = {tensor.getSize(0), tensor.getSize(1), tensor.getStride(0), tensor.getStride(1)};
+            break;
+        default:
+            return false;
+    }
+    if (transpose) view = view.transposed();
+    return true;
+}
+
+/// interpret a rank 2 tensor as a matrix according to its Layout, optionally transposed.
+/// returns false when the tensor does not describe a matrix.
+inline bool getMatrixView(const gTensor& tensor, bool transpose, MatrixView& view)
+{
+    return tensor.getRank() == 2 && getInnerMatrixView(tensor, transpose, view);
+}
+
+} // namespace gblas
+
+#endif //GBLAS_MATRIX_VIEW_H
@@ -0,0 +1,122 @@
+#ifndef GBLAS_OP_UTILS_H
+#define GBLAS_OP_UTILS_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include "gTensor/gTensor.h"
+#include "runtime/Allocator.h"
+#include "runtime/Workspace.h"
+
+namespace gblas {
+
+// low precision runs are widened into fp32 blocks of this size, small enough to stay in L1
+constexpr uint64_t kStagingElements = 512;
+
+inline bool sameShape(const gTensor& a, const gTensor& b)
+{
+    if (a.getRank() != b.getRank()) return false;
+    for (unsigned i = 0; i < a.getRank(); ++i)
+    {
+        if (a.getSize(i) != b.getSize(i)) return false;
+    }
+    return true;
+}
+
+// true when some byte of an element of a is also a byte of an element of b. the spans are taken from the data
+// pointers and strides, so views of unrelated buffers or of raw pointers are compared as well
+inline bool sharesBytes(const gTensor& a, const gTensor& b)
+{
+    if (!a.data() || !b.data() || a.getTotalSizeInElements() == 0 || b.getTotalSizeInElements() == 0) return false;
+    const auto getSpan = [](const gTensor& tensor, uintptr_t& begin, uintptr_t& end)
+    {
+        const int64_t elementSize = getSingleElementSizeInBytes(tensor.getDType());
+        int64_t low = 0, high = 0;
+        for (unsigned dim = 0; dim < tensor.getRank(); ++dim)
+        {
+            const int64_t reach = static_cast<int64_t>(tensor.getSize(dim) - 1) * tensor.getStride(dim);
+            if (reach < 0) low += reach;
+            else high += reach;
+        }
+        begin = reinterpret_cast<uintptr_t>(tensor.data()) + low * elementSize;
+        end = reinterpret_cast<uintptr_t>(tensor.data()) + (high + 1) * elementSize;
+    };
+    uintptr_t aBegin, aEnd, bBegin, bEnd;
+    getSpan(a, aBegin, aEnd);
+    getSpan(b, bBegin, bEnd);
+    return aBegin < bEnd && bBegin < aEnd;
+}
+
+// the scalar of an integer operation: value truncated to T, false when it is NaN, infinite or outside the
+// range of T after truncation
+template<typename T>
+bool toIntegerScalar(double value, T& result)
+{
+    const double truncated = std::trunc(value);
+    // max + 1 is a power of two and exact in fp64, max itself is not for int64
+    if (!(truncated >= static_cast<double>(std::numeric_limits<T>::min()) &&
+          truncated < static_cast<double>(std::numeric_limits<T>::max()) + 1.0))
+    {
+        return false;
+    }
+    result = static_cast<T>(truncated);
+    return true;
+}
+
+// a * b + c, integers wrap around like the vector kernels do. the arithmetic is unsigned for them since signed
+// overflow is undefined
+template<typename T>
+T multiplyAdd(T a, T b, T c)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        using U = std::make_unsigned_t<decltype(a * b)>;
+        return static_cast<T>(static_cast<U>(a) * static_cast<U>(b) + static_cast<U>(c));
+    }
+    else
+    {
+        return static_cast<T>(a * b + c);
+    }
+}
+
+// value truncated to T and saturated to its range, NaN gives 0
+template<typename T>
+T saturateToInteger(double value)
+{
+    if (std::isnan(value)) return 0;
+    const double truncated = std::trunc(value);
+    if (truncated <= static_cast<double>(std::numeric_limits<T>::min())) return std::numeric_limits<T>::min();
+    if (truncated >= static_cast<double>(std::numeric_limits<T>::max()) + 1.0) return std::numeric_limits<T>::max();
+    return static_cast<T>(truncated);
+}
+
+// workspace panels are given back by the caller's Workspace::Scope, only allocator panels need a release
+template<typename T>
+struct PanelDeleter
+{
+    Allocator* allocator = nullptr;
+    uint64_t sizeInBytes = 0;
+    void operator()(T* ptr) const
+    {
+        if (allocator) allocator->deallocate(reinterpret_cast<byte*>(ptr), sizeInBytes);
+    }
+};
+
+template<typename T>
+using PanelPtr = std::unique_ptr<T[], PanelDeleter<T>>;
+
+// without a workspace the panels come from the pooled allocator, repeated shapes reuse the same blocks
+template<typename T>
+PanelPtr<T> allocatePanel(uint64_t elements, Workspace* workspace)
+{
+    if (workspace) return PanelPtr<T>(workspace->allocate<T>(elements), PanelDeleter<T>{});
+    Allocator& allocator = getDefaultAllocator();
+    const uint64_t sizeInBytes = elements * sizeof(T);
+    return PanelPtr<T>(reinterpret_cast<T*>(allocator.allocate(sizeInBytes)), PanelDeleter<T>{&allocator, sizeInBytes});
+}
+
+} // namespace gblas
+
+#endif //GBLAS_OP_UTILS_H
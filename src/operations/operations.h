@@ -0,0 +1,181 @@
+#ifndef GBLAS_OPERATIONS_H
+#define GBLAS_OPERATIONS_H
+
+#include <cstring>
+#include <cstdint>
+#include "data_types/conversions.h"
+
+namespace gblas {
+class gTensor;
+class Workspace;
+struct QuantizedTensor;
+enum class gStatus;
+
+/// one product of a grouped gemm: C = alpha*op(A)*op(B) + beta*C. the products of a group may differ in
+/// shape but share the dtypes of A, B and C.
+struct GemmGroupEntry
+{
+    const gTensor* a = nullptr;
+    const gTensor* b = nullptr;
+    gTensor* c = nullptr;
+    double alpha = 1.0;
+    double beta = 0.0;
+    bool transposeA = false;
+    bool transposeB = false;
+};
+
+/// elementwise function applied by a gemm epilogue
+enum class Activation
+{
+    None,
+    /// max(x, 0)
+    ReLU,
+    /// x * Phi(x) with the exact normal cdf
+    GELU,
+    /// the tanh approximation of GELU
+    GELUTanh,
+    /// x * sigmoid(x)
+    SiLU,
+};
+
+/// steps gemm applies to every tile of C after its last depth block, before C is narrowed to its dtype:
+/// C = activation(alpha*op(A)*op(B) + beta*C + bias) + residual. the operands are read in the compute type
+/// of the product, any floating dtype of the fp32 computed ones or fp64 for an fp64 product.
+struct GemmEpilogue
+{
+    /// rank 1 tensor of one element per column of C, added to every row. must not overlap C. nullptr for none
+    const gTensor* bias = nullptr;
+    Activation activation = Activation::None;
+    /// rank 2 tensor of the shape of C, in any layout. must not overlap C. nullptr for none
+    const gTensor* residual = nullptr;
+};
+
+/// output stage of an int8 gemm: C = clamp(nearbyint((acc + bias[col]) * scale) + zeroPoint, min, max) where acc
+/// is the exact int32 product. the clamp also keeps to the range of the int8 or uint8 dtype of C.
+struct Requantization
+{
+    /// one scale, or one per column of C with perColumn. scales must be finite
+    const float* scales = nullptr;
+    bool perColumn = false;
+    /// one per column of C, nullptr for none
+    const int32_t* bias = nullptr;
+    int32_t zeroPoint = 0;
+    int32_t min = -128;
+    int32_t max = 127;
+};
+
+class Operations
+{
+public:
+    Operations() = default;
+    /// operations take their scratch memory (packing panels, partial results) from the attached workspace
+    /// and give it back before returning. without one they use the default allocator.
+    explicit Operations(Workspace* workspace) : m_workspace(workspace) {}
+    ~Operations() = default;
+    void setWorkspace(Workspace* workspace) {m_workspace = workspace;}
+    Workspace* getWorkspace() const {return m_workspace;}
+    // Level 1 operations //
+    // perform out = alpha*X+Y, dispatched on the dtype of the tensors at runtime.
+    // all tensors must share dtype and sizes, strides are free. low precision types are computed in fp32
+    // and narrowed back with the given rounding, integer types use alpha truncated to the element type and fail
+    // when it is NaN, infinite or out of that type's range. integer results wrap around on overflow.
+    gStatus axpy(double alpha, const gTensor& x, const gTensor& y, gTensor& out,
+                 RoundingMode rounding = RoundingMode::NearestEven);
+    // the reductions below take every dtype and return their result in fp64. floating types are summed
+    // per block in fp32 (fp64 for fp64) and the blocks are added with a compensated sum in a fixed order,
+    // so a result does not change with the number of threads. integer types up to int32 accumulate exactly per
+    // chunk (int32 dot products in 128 bits); int64 products are formed exactly and added in the compensated sum.
+    // result = sum of X*Y over all elements, X and Y share dtype and sizes
+    gStatus dot(const gTensor& x, const gTensor& y, double& result);
+    // result = sqrt(sum of X*X), rescaled by a power of two when the plain sum over- or underflows
+    gStatus nrm2(const gTensor& x, double& result);
+    // result = sum of |X|
+    gStatus asum(const gTensor& x, double& result);
+    // index = element order position (dim 0 fastest) of the first largest |X|, NaN is skipped
+    gStatus iamax(const gTensor& x, uint64_t& index);
+    // perform X = alpha*X, in place with the precision and rounding rules of axpy
+    gStatus scal(double alpha, gTensor& x, RoundingMode rounding = RoundingMode::NearestEven);
+    // perform Y = X, any dtype as long as both tensors share it and their sizes
+    gStatus copy(const gTensor& x, gTensor& y);
+    // exchange the elements of X and Y
+    gStatus swap(gTensor& x, gTensor& y);
+    // apply the plane rotation (X, Y) = (c*X + s*Y, c*Y - s*X), integer types rotate in fp64 and truncate,
+    // saturating to the element type (NaN gives 0)
+    gStatus rot(gTensor& x, gTensor& y, double c, double s, RoundingMode rounding = RoundingMode::NearestEven);
+
+    // Level 2 operations //
+    // perform y = alpha*op(A)*x + beta*y. A follows the conventions of gemm, x and y are rank 1 tensors of
+    // the columns and rows of op(A) with free strides. A in bf16, fp16, tf32, fp8_152 or fp8_143 is decoded
+    // in registers as it is streamed, x and y may be any of the fp32 computed types and are accumulated in
+    // fp32; all fp64 operands compute in fp64. A is read once and its rows are split over the thread pool.
+    gStatus gemv(const gTensor& a, const gTensor& x, gTensor& y, double alpha = 1.0, double beta = 0.0,
+                 bool transposeA = false, RoundingMode rounding = RoundingMode::NearestEven);
+    // gemv of several vectors against the same matrix: x and y are rank 2 with a vector along dim 0 and the
+    // batch along dim 1. A is streamed once for up to 16 vectors, which makes small batches about as cheap
+    // as a single vector for memory bound shapes.
+    gStatus gemvBatched(const gTensor& a, const gTensor& x, gTensor& y, double alpha = 1.0, double beta = 0.0,
+                        bool transposeA = false, RoundingMode rounding = RoundingMode::NearestEven);
+
+    // Level 3 operations //
+    // perform C = alpha*op(A)*op(B) + beta*C where op() optionally transposes its operand.
+    // operands are rank 2 tensors, dim 0 runs along the columns for Layout::RowMajor and along the rows
+    // for Layout::ColMajor, the strides of dim 1 act as the leading dimension.
+    // fp64 operands compute in fp64. any mix of fp32, bf16, fp16, fp8_152 and fp8_143 accumulates in fp32,
+    // low precision A and B are converted while they are packed and a low precision C is narrowed with `rounding`.
+    gStatus gemm(const gTensor& a, const gTensor& b, gTensor& c, double alpha = 1.0, double beta = 0.0,
+                 bool transposeA = false, bool transposeB = false, RoundingMode rounding = RoundingMode::NearestEven);
+    // gemm followed by the epilogue, fused into the store of every tile so C is written once, see GemmEpilogue.
+    // floating types only.
+    gStatus gemm(const gTensor& a, const gTensor& b, gTensor& c, const GemmEpilogue& epilogue, double alpha = 1.0,
+                 double beta = 0.0, bool transposeA = false, bool transposeB = false,
+                 RoundingMode rounding = RoundingMode::NearestEven);
+    // uint8 or int8 A times int8 B accumulates exactly in int32 into an int32 C, with alpha and beta truncated to
+    // int32 (failing when either is NaN, infinite or out of range); the sums wrap like the hardware if they leave
+    // the int32 range, which needs k above 65793.
+    // gemmRequantized writes the product to an int8 or uint8 C through a Requantization stage instead.
+    gStatus gemmRequantized(const gTensor& a, const gTensor& b, gTensor& c, const Requantization& requantization,
+                            bool transposeA = false, bool transposeB = false);
+    // gemm over a batch held in the outer dims: dims 0 and 1 of rank 3 to 5 tensors are the matrices and
+    // every index of the dims above is one product. A and B may have size 1 in a batch dim to share that
+    // matrix across it, the products of C must not overlap.
+    gStatus gemmStridedBatched(const gTensor& a, const gTensor& b, gTensor& c, double alpha = 1.0, double beta = 0.0,
+                               bool transposeA = false, bool transposeB = false,
+                               RoundingMode rounding = RoundingMode::NearestEven);
+    // gemm over `count` independent products of any shape, see GemmGroupEntry.
+    // products large enough to keep the whole pool busy run one after the other, the smaller ones run side
+    // by side with one thread each. the C matrices must not overlap.
+    gStatus gemmGrouped(const GemmGroupEntry* group, uint64_t count, RoundingMode rounding = RoundingMode::NearestEven);
+
+    // Conversions //
+    // dst = src converted to the dtype of dst, any pair of dtypes, with free strides on both sides so a layout
+    // change (a column major fp32 matrix into a row major bf16 one) happens in the same pass. floating types are
+    // narrowed with `rounding`; integers take it as quantize does, saturate and turn NaN into 0. the value is
+    // rounded once: fp64 and integer sources go through fp64 and are rounded to odd on the way to the narrow
+    // floats, only int64 beyond 2^53 is rounded to nearest first. src and dst must not share storage.
+    gStatus cast(const gTensor& src, gTensor& dst, RoundingMode rounding = RoundingMode::NearestEven);
+    // Y = X with its dims reordered: dim i of Y is dim perm[i] of X, so Y must have the sizes of
+    // X.transpose(perm). any dtype, X and Y share it. a reorder that changes the contiguous dim runs in L1 sized
+    // tiles transposed in registers, large outputs are written with non-temporal stores.
+    gStatus permute(const gTensor& x, gTensor& y, const Coordinates& perm);
+    // Y = X between a RowMajor and a ColMajor tensor: the same matrices with dims 0 and 1 exchanged, so Y has
+    // the sizes of X with those two swapped. the batch dims above stay in place; equal layouts copy.
+    gStatus convertLayout(const gTensor& x, gTensor& y);
+
+    // Quantization //
+    // quantize X into q.data with the scales of q.scheme, see quantization.h. with computeScales every group's
+    // scale is set to amax / getQuantizedMax(dtype) (1 for a group of zeros or with an infinite amax), without
+    // it the scales already in q.scales are used, as for delayed scaling with the amax of earlier steps.
+    // values beyond the range saturate, NaN stays NaN in fp8 and becomes -127 in int8. X is any floating dtype.
+    gStatus quantize(const gTensor& x, QuantizedTensor& q, bool computeScales = true,
+                     RoundingMode rounding = RoundingMode::NearestEven);
+    // X = q.data * scale of its group, narrowed to the dtype of X with `rounding`
+    gStatus dequantize(const QuantizedTensor& q, gTensor& x, RoundingMode rounding = RoundingMode::NearestEven);
+private:
+    Workspace* m_workspace = nullptr;
+};
+
+
+
+
+} //namespace gblas
+#endif //GBLAS_OPERATIONS_H
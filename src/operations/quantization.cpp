@@ -0,0 +1,480 @@
+#include "quantization.h"
+#include "operations.h"
+#include "float_codec.h"
+#include "op_utils.h"
+#include "kernels/kernels.h"
+#include "runtime/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace gblas {
+
+namespace {
+
+// pieces are cut at this length so a tensor sharing one scale still spreads over the pool
+constexpr uint64_t kPieceElements = 4096;
+
+bool isQuantizedDType(DType dtype)
+{
+    return dtype == DType::int8 || dtype == DType::fp8_152 || dtype == DType::fp8_143;
+}
+
+// the extent of the elements sharing a scale in every dim
+TSizeArr getScaleBlocks(const TSizeArr& sizes, unsigned rank, const QuantizationScheme& scheme)
+{
+    TSizeArr blocks = {1, 1, 1, 1, 1};
+    for (unsigned dim = 0; dim < rank; ++dim)
+    {
+        const uint64_t whole = std::max<uint64_t>(sizes[dim], 1);
+        switch (scheme.granularity)
+        {
+            case ScaleGranularity::PerTensor: blocks[dim] = whole; break;
+            case ScaleGranularity::PerChannel: blocks[dim] = dim == scheme.axis ? 1 : whole; break;
+            case ScaleGranularity::PerBlock: blocks[dim] = dim == scheme.axis ? scheme.blockSize : 1; break;
+        }
+    }
+    return blocks;
+}
+
+// a run of elements along the line dim, made of groups of groupLength elements that share a scale. the piece
+// starts a group unless the whole piece lies inside a single one.
+struct Piece
+{
+    uint64_t count = 0;
+    uint64_t groupLength = 1;
+    // element offsets of the first element in the two walked tensors
+    int64_t offsets[2] = {};
+    // scale of the first group, its position in the dense scale order and in the scale tensor
+    uint64_t slot = 0;
+    int64_t scaleOffset = 0;
+};
+
+// calls fn(group, from, length) for the parts of the run [position, position + count) of a piece that share
+// a scale. group counts from the start of the piece, from is relative to the run.
+template<typename Fn>
+void forEachGroup(const Piece& piece, uint64_t position, uint64_t count, Fn&& fn)
+{
+    for (uint64_t at = position; at < position + count;)
+    {
+        const uint64_t group = at / piece.groupLength;
+        const uint64_t end = std::min((group + 1) * piece.groupLength, position + count);
+        fn(group, at - position, end - at);
+        at = end;
+    }
+}
+
+// the tensor as lines along the dim scales change least often in, every line cut in pieces of about
+// kPieceElements: small groups are packed whole into a piece, large groups are split over several.
+// pieces are numbered so every thread can find its own.
+class PieceGrid
+{
+public:
+    PieceGrid(const gTensor& first, const gTensor& second, const gTensor& scales, const QuantizationScheme& scheme)
+        : m_rank(first.getRank()), m_sizes(first.getAllSizesInElements()), m_scaleSizes(scales.getAllSizesInElements()),
+          m_strides{first.getAllStridesInElements(), second.getAllStridesInElements()},
+          m_scaleStrides(scales.getAllStridesInElements())
+    {
+        m_blocks = getScaleBlocks(m_sizes, m_rank, scheme);
+        switch (scheme.granularity)
+        {
+            case ScaleGranularity::PerTensor: m_lineDim = 0; break;
+            case ScaleGranularity::PerChannel: m_lineDim = scheme.axis == 0 && m_rank > 1 ? 1 : 0; break;
+            case ScaleGranularity::PerBlock: m_lineDim = scheme.axis; break;
+        }
+        m_numOfScales = 1;
+        for (unsigned dim = 0; dim < m_rank; ++dim)
+        {
+            if (dim == m_lineDim) m_slotStep = m_numOfScales;
+            m_numOfScales *= m_scaleSizes[dim];
+        }
+        const uint64_t total = first.getTotalSizeInElements();
+        const uint64_t lineLength = m_sizes[m_lineDim];
+        if (total == 0) return;
+        m_groupLength = std::min(m_blocks[m_lineDim], lineLength);
+        if (m_groupLength >= kPieceElements)
+        {
+            m_pieceLength = kPieceElements;
+            m_piecesPerGroup = (m_groupLength + kPieceElements - 1) / kPieceElements;
+            m_piecesPerLine = (lineLength + m_groupLength - 1) / m_groupLength * m_piecesPerGroup;
+        }
+        else
+        {
+            m_pieceLength = kPieceElements / m_groupLength * m_groupLength;
+            m_piecesPerLine = (lineLength + m_pieceLength - 1) / m_pieceLength;
+        }
+        m_numOfPieces = total / lineLength * m_piecesPerLine;
+    }
+
+    unsigned getLineDim() const {return m_lineDim;}
+    uint64_t getNumOfPieces() const {return m_numOfPieces;}
+    uint64_t getNumOfScales() const {return m_numOfScales;}
+    uint64_t getMaxGroupsPerPiece() const {return (m_pieceLength + m_groupLength - 1) / m_groupLength;}
+    // every group lies in a single piece, true for block scaling: the amax of a piece's groups is final
+    bool hasPrivateGroups() const
+    {
+        for (unsigned dim = 0; dim < m_rank; ++dim)
+        {
+            if (dim != m_lineDim && m_blocks[dim] != 1 && m_sizes[dim] != 1) return false;
+        }
+        return m_piecesPerGroup == 0;
+    }
+    // steps from the scale of one group of a piece to the next, in the dense order and in the scale tensor
+    uint64_t getSlotStep() const {return m_slotStep;}
+    int64_t getScaleStep() const {return m_scaleStrides[m_lineDim];}
+    // staging run length, whole groups when they fit
+    uint64_t getRunLength() const
+    {
+        return m_groupLength < kStagingElements ? kStagingElements / m_groupLength * m_groupLength : kStagingElements;
+    }
+    // pieces per parallel task, about kParallelGrain elements
+    uint64_t getGrain() const {return std::max<uint64_t>(kParallelGrain / m_pieceLength, 1);}
+
+    Piece get(uint64_t index) const
+    {
+        Piece piece;
+        piece.groupLength = m_groupLength;
+        uint64_t line = index / m_piecesPerLine;
+        const uint64_t inLine = index % m_piecesPerLine;
+        uint64_t begin = inLine * m_pieceLength;
+        uint64_t end = begin + m_pieceLength;
+        if (m_piecesPerGroup)
+        {
+            const uint64_t groupBegin = inLine / m_piecesPerGroup * m_groupLength;
+            begin = groupBegin + inLine % m_piecesPerGroup * m_pieceLength;
+            end = std::min(groupBegin + m_groupLength, begin + m_pieceLength);
+        }
+        end = std::min(end, m_sizes[m_lineDim]);
+        if (begin >= end) return piece;
+        piece.count = end - begin;
+        uint64_t slotStride = 1;
+        for (unsigned dim = 0; dim < m_rank; ++dim)
+        {
+            uint64_t coord = begin;
+            if (dim != m_lineDim)
+            {
+                coord = line % m_sizes[dim];
+                line /= m_sizes[dim];
+            }
+            const uint64_t scaleCoord = coord / m_blocks[dim];
+            piece.offsets[0] += static_cast<int64_t>(coord) * m_strides[0][dim];
+            piece.offsets[1] += static_cast<int64_t>(coord) * m_strides[1][dim];
+            piece.slot += scaleCoord * slotStride;
+            piece.scaleOffset += static_cast<int64_t>(scaleCoord) * m_scaleStrides[dim];
+            slotStride *= m_scaleSizes[dim];
+        }
+        return piece;
+    }
+
+    // scale tensor offset of a dense slot
+    int64_t getScaleOffset(uint64_t slot) const
+    {
+        int64_t offset = 0;
+        for (unsigned dim = 0; dim < m_rank; ++dim)
+        {
+            offset += static_cast<int64_t>(slot % m_scaleSizes[dim]) * m_scaleStrides[dim];
+            slot /= m_scaleSizes[dim];
+        }
+        return offset;
+    }
+private:
+    unsigned m_rank = 1;
+    unsigned m_lineDim = 0;
+    TSizeArr m_sizes;
+    TSizeArr m_blocks;
+    TSizeArr m_scaleSizes;
+    TStrideArr m_strides[2];
+    TStrideArr m_scaleStrides;
+    uint64_t m_groupLength = 1;
+    uint64_t m_pieceLength = 1;
+    // pieces a group is split over, 0 when pieces hold whole groups
+    uint64_t m_piecesPerGroup = 0;
+    uint64_t m_piecesPerLine = 1;
+    uint64_t m_numOfPieces = 0;
+    uint64_t m_numOfScales = 0;
+    uint64_t m_slotStep = 1;
+};
+
+// int8 with a rounding other than the vector kernel's nearest even, saturated the same way
+int8_t quantizeI8(float value, RoundingMode rounding)
+{
+    value = value > -127.0f ? value : -127.0f;
+    value = value < 127.0f ? value : 127.0f;
+    switch (rounding)
+    {
+        case RoundingMode::RoundUp: value = std::ceil(value); break;
+        case RoundingMode::RoundDown: value = std::floor(value); break;
+        case RoundingMode::RoundAwayFromZero: value = std::round(value); break;
+        case RoundingMode::RoundTowardsZero: value = std::trunc(value); break;
+        default: value = std::nearbyint(value); break;
+    }
+    return static_cast<int8_t>(value);
+}
+
+bool validScales(const QuantizedTensor& q)
+{
+    const gTensor& scales = q.scales;
+    if (scales.getDType() != DType::fp32 || scales.getRank() != q.data.getRank() || !scales.data()) return false;
+    try
+    {
+        const TSizeArr expected = getScaleSizes(q.data.getAllSizesInElements(), q.data.getRank(), q.scheme);
+        return scales.getAllSizesInElements() == expected;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+TSizeArr getScaleSizes(const TSizeArr& sizes, unsigned rank, const QuantizationScheme& scheme)
+{
+    if (scheme.granularity != ScaleGranularity::PerTensor && scheme.axis >= rank)
+    {
+        throw std::invalid_argument("quantization axis is beyond the rank of the tensor");
+    }
+    if (scheme.granularity == ScaleGranularity::PerBlock && scheme.blockSize == 0)
+    {
+        throw std::invalid_argument("quantization block size must not be 0");
+    }
+    TSizeArr scaleSizes = {1, 1, 1, 1, 1};
+    const TSizeArr blocks = getScaleBlocks(sizes, rank, scheme);
+    // an empty dim still gets a scale, so every quantized tensor has one to read
+    for (unsigned dim = 0; dim < rank; ++dim)
+    {
+        scaleSizes[dim] = std::max<uint64_t>((sizes[dim] + blocks[dim] - 1) / blocks[dim], 1);
+    }
+    return scaleSizes;
+}
+
+QuantizedTensor makeQuantizedTensor(const gTensor& like, DType dtype, const QuantizationScheme& scheme)
+{
+    if (!isQuantizedDType(dtype)) throw std::invalid_argument("quantized tensors hold int8, fp8_152 or fp8_143");
+    const unsigned rank = like.getRank();
+    const TSizeArr& sizes = like.getAllSizesInElements();
+    const TSizeArr scaleSizes = getScaleSizes(sizes, rank, scheme);
+    TStrideArr strides = {1, 1, 1, 1, 1};
+    TStrideArr scaleStrides = {1, 1, 1, 1, 1};
+    for (unsigned dim = 1; dim < MAX_DIM; ++dim)
+    {
+        strides[dim] = strides[dim - 1] * static_cast<int64_t>(sizes[dim - 1]);
+        scaleStrides[dim] = scaleStrides[dim - 1] * static_cast<int64_t>(scaleSizes[dim - 1]);
+    }
+    QuantizedTensor q{gTensor(sizes, strides, rank, dtype, like.getLayout()),
+                      gTensor(scaleSizes, scaleStrides, rank, DType::fp32, like.getLayout()), scheme};
+    if (q.data.getTotalSizeInElements()) q.data.allocateData();
+    q.scales.allocateData();
+    return q;
+}
+
+float getQuantizedMax(DType dtype)
+{
+    switch (dtype)
+    {
+        case DType::int8: return 127.0f;
+        case DType::fp8_152: return 57344.0f;
+        case DType::fp8_143: return 240.0f;
+        default: return 0.0f;
+    }
+}
+
+gStatus Operations::quantize(const gTensor& x, QuantizedTensor& q, bool computeScales, RoundingMode rounding)
+{
+    // validate inputs
+    const DType dtype = q.data.getDType();
+    const FloatCodec* codec = getFloatCodec(x.getDType());
+    if (!isQuantizedDType(dtype) || !codec || !sameShape(x, q.data) || !validScales(q)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+    if (!x.data() || !q.data.data()) return gStatus::gBLAS_FAIL;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const PieceGrid grid(x, q.data, q.scales, q.scheme);
+    const unsigned lineDim = grid.getLineDim();
+    const int64_t xStride = x.getStride(lineDim);
+    const int64_t qStride = q.data.getStride(lineDim);
+    const uint64_t runLength = grid.getRunLength();
+    const byte* xData = x.data();
+    byte* qData = q.data.data();
+    float* scales = reinterpret_cast<float*>(q.scales.data());
+    const float qmax = getQuantizedMax(dtype);
+    const bool xIsDense = x.getDType() == DType::fp32 && xStride == 1;
+
+    // hands fn(run, count, position) the fp32 values of a piece in runs of at most the staging size
+    auto forEachRun = [&](const Piece& piece, float* staging, auto&& fn)
+    {
+        for (uint64_t position = 0; position < piece.count; position += runLength)
+        {
+            const uint64_t count = std::min(runLength, piece.count - position);
+            const int64_t step = static_cast<int64_t>(position) * xStride;
+            const byte* src = xData + (piece.offsets[0] + step) * codec->elementSize;
+            if (xIsDense)
+            {
+                fn(reinterpret_cast<const float*>(src), count, position);
+                continue;
+            }
+            codec->widen(src, xStride, count, staging);
+            fn(staging, count, position);
+        }
+    };
+
+    // an all zero group and an infinite amax keep a scale of 1
+    auto toScale = [qmax](float amax) {return amax > 0.0f && std::isfinite(amax) ? amax / qmax : 1.0f;};
+    const int64_t scaleStep = grid.getScaleStep();
+    if (computeScales)
+    {
+        // amax of every group of every piece in parallel. groups spread over several pieces are folded into
+        // the scales afterwards in a fixed order, the others get their scale right away.
+        const bool privateGroups = grid.hasPrivateGroups();
+        const uint64_t maxGroups = grid.getMaxGroupsPerPiece();
+        std::vector<float> groupAmax(privateGroups ? 0 : grid.getNumOfPieces() * maxGroups, 0.0f);
+        parallelForRange(grid.getNumOfPieces(), grid.getGrain(), [&](uint64_t begin, uint64_t end, unsigned)
+        {
+            float staging[kStagingElements];
+            float pieceAmax[kPieceElements];
+            for (uint64_t index = begin; index < end; ++index)
+            {
+                const Piece piece = grid.get(index);
+                float* amax = privateGroups ? pieceAmax : groupAmax.data() + index * maxGroups;
+                std::fill(amax, amax + maxGroups, 0.0f);
+                forEachRun(piece, staging, [&](const float* run, uint64_t count, uint64_t position)
+                {
+                    forEachGroup(piece, position, count, [&](uint64_t group, uint64_t from, uint64_t length)
+                    {
+                        amax[group] = std::max(amax[group], table.amaxF32(length, run + from));
+                    });
+                });
+                if (!privateGroups) continue;
+                const uint64_t groups = (piece.count + piece.groupLength - 1) / piece.groupLength;
+                for (uint64_t group = 0; group < groups; ++group)
+                {
+                    scales[piece.scaleOffset + static_cast<int64_t>(group) * scaleStep] = toScale(amax[group]);
+                }
+            }
+        });
+        if (!privateGroups)
+        {
+            std::vector<float> amax(grid.getNumOfScales(), 0.0f);
+            for (uint64_t index = 0; index < grid.getNumOfPieces(); ++index)
+            {
+                const Piece piece = grid.get(index);
+                const uint64_t groups = (piece.count + piece.groupLength - 1) / piece.groupLength;
+                for (uint64_t group = 0; group < groups; ++group)
+                {
+                    float& slot = amax[piece.slot + group * grid.getSlotStep()];
+                    slot = std::max(slot, groupAmax[index * maxGroups + group]);
+                }
+            }
+            for (uint64_t slot = 0; slot < amax.size(); ++slot) scales[grid.getScaleOffset(slot)] = toScale(amax[slot]);
+        }
+    }
+
+    const FloatCodec* qCodec = getFloatCodec(dtype);
+    const unsigned qElementSize = getSingleElementSizeInBytes(dtype);
+    parallelForRange(grid.getNumOfPieces(), grid.getGrain(), [&](uint64_t begin, uint64_t end, unsigned)
+    {
+        float staging[kStagingElements];
+        float scaled[kStagingElements];
+        int8_t packed[kStagingElements];
+        for (uint64_t index = begin; index < end; ++index)
+        {
+            const Piece piece = grid.get(index);
+            forEachRun(piece, staging, [&](const float* run, uint64_t count, uint64_t position)
+            {
+                byte* dst = qData + (piece.offsets[1] + static_cast<int64_t>(position) * qStride) * qElementSize;
+                int8_t* out = reinterpret_cast<int8_t*>(dst);
+                // the nearest even int8 kernel writes in place when it can, the rest goes through a block
+                int8_t* target = qStride == 1 ? out : packed;
+                forEachGroup(piece, position, count, [&](uint64_t group, uint64_t from, uint64_t length)
+                {
+                    const float inverse = 1.0f / scales[piece.scaleOffset + static_cast<int64_t>(group) * scaleStep];
+                    if (dtype != DType::int8)
+                    {
+                        table.scalClampF32(length, inverse, qmax, run + from, scaled + from);
+                    }
+                    else if (rounding == RoundingMode::NearestEven)
+                    {
+                        table.quantizeI8(length, inverse, run + from, target + from);
+                    }
+                    else
+                    {
+                        for (uint64_t i = from; i < from + length; ++i) packed[i] = quantizeI8(run[i] * inverse, rounding);
+                    }
+                });
+                if (dtype != DType::int8)
+                {
+                    qCodec->narrow(scaled, dst, qStride, count, rounding);
+                    return;
+                }
+                if (target == out && rounding == RoundingMode::NearestEven) return;
+                for (uint64_t i = 0; i < count; ++i) out[static_cast<int64_t>(i) * qStride] = packed[i];
+            });
+        }
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+gStatus Operations::dequantize(const QuantizedTensor& q, gTensor& x, RoundingMode rounding)
+{
+    // validate inputs
+    const DType dtype = q.data.getDType();
+    const FloatCodec* codec = getFloatCodec(x.getDType());
+    if (!isQuantizedDType(dtype) || !codec || !sameShape(x, q.data) || !validScales(q)) return gStatus::gBLAS_FAIL;
+    if (x.getTotalSizeInElements() == 0) return gStatus::gBLAS_PASS;
+    if (!x.data() || !q.data.data()) return gStatus::gBLAS_FAIL;
+
+    // perform operation
+    const kernels::KernelTable& table = kernels::getKernelTable();
+    const PieceGrid grid(q.data, x, q.scales, q.scheme);
+    const unsigned lineDim = grid.getLineDim();
+    const int64_t qStride = q.data.getStride(lineDim);
+    const int64_t xStride = x.getStride(lineDim);
+    const int64_t scaleStep = grid.getScaleStep();
+    const uint64_t runLength = grid.getRunLength();
+    const byte* qData = q.data.data();
+    byte* xData = x.data();
+    const float* scales = reinterpret_cast<const float*>(q.scales.data());
+    const FloatCodec* qCodec = getFloatCodec(dtype);
+    const unsigned qElementSize = getSingleElementSizeInBytes(dtype);
+    const bool xIsDense = x.getDType() == DType::fp32 && xStride == 1;
+    parallelForRange(grid.getNumOfPieces(), grid.getGrain(), [&](uint64_t begin, uint64_t end, unsigned)
+    {
+        float staging[kStagingElements];
+        int8_t packed[kStagingElements];
+        for (uint64_t index = begin; index < end; ++index)
+        {
+            const Piece piece = grid.get(index);
+            for (uint64_t position = 0; position < piece.count; position += runLength)
+            {
+                const uint64_t count = std::min(runLength, piece.count - position);
+                const int64_t step = static_cast<int64_t>(position);
+                const byte* src = qData + (piece.offsets[0] + step * qStride) * qElementSize;
+                byte* dst = xData + (piece.offsets[1] + step * xStride) * codec->elementSize;
+                // dense fp32 output is written in place
+                float* result = xIsDense ? reinterpret_cast<float*>(dst) : staging;
+                const int8_t* values = reinterpret_cast<const int8_t*>(src);
+                if (dtype != DType::int8)
+                {
+                    qCodec->widen(src, qStride, count, result);
+                }
+                else if (qStride != 1)
+                {
+                    for (uint64_t i = 0; i < count; ++i) packed[i] = values[static_cast<int64_t>(i) * qStride];
+                    values = packed;
+                }
+                forEachGroup(piece, position, count, [&](uint64_t group, uint64_t from, uint64_t length)
+                {
+                    const float scale = scales[piece.scaleOffset + static_cast<int64_t>(group) * scaleStep];
+                    if (dtype == DType::int8) table.dequantizeI8(length, scale, values + from, result + from);
+                    else table.scalF32(length, scale, result + from, result + from);
+                });
+                if (!xIsDense) codec->narrow(result, dst, xStride, count, rounding);
+            }
+        }
+    });
+    return gStatus::gBLAS_PASS;
+}
+
+} // namespace gblas
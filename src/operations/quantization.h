@@ -0,0 +1,51 @@
+#ifndef GBLAS_QUANTIZATION_H
+#define GBLAS_QUANTIZATION_H
+
+#include <cstdint>
+#include "common.h"
+#include "gTensor/gTensor.h"
+
+namespace gblas {
+
+/// which elements share a scale
+enum class ScaleGranularity
+{
+    /// one scale for the whole tensor
+    PerTensor,
+    /// one scale per index of `axis`
+    PerChannel,
+    /// one scale per `blockSize` consecutive elements along `axis` and per index of the other dims
+    PerBlock,
+};
+
+struct QuantizationScheme
+{
+    ScaleGranularity granularity = ScaleGranularity::PerTensor;
+    unsigned axis = 0;
+    uint64_t blockSize = 32;
+};
+
+/// a tensor stored in int8, fp8_152 or fp8_143 with the fp32 scales that bring it back: element c stands for
+/// data[c] * scales[c / block], where block is the extent of the elements sharing a scale in every dim.
+/// scales is a dense tensor of the rank of data with the sizes of getScaleSizes.
+struct QuantizedTensor
+{
+    gTensor data;
+    gTensor scales;
+    QuantizationScheme scheme;
+};
+
+/// sizes of the scale tensor for a tensor of the given sizes: 1 in the dims that share a scale, the number of
+/// channels or blocks along the scheme's axis. throws std::invalid_argument for an axis beyond the rank or
+/// a block size of 0.
+TSizeArr getScaleSizes(const TSizeArr& sizes, unsigned rank, const QuantizationScheme& scheme);
+/// a dense quantized tensor with the sizes and layout of `like` and its scales, both allocated.
+/// throws std::invalid_argument for a dtype that cannot be quantized to.
+QuantizedTensor makeQuantizedTensor(const gTensor& like, DType dtype, const QuantizationScheme& scheme = {});
+/// largest magnitude a quantized dtype holds, the amax of a group is mapped onto it: 127 for int8 (symmetric),
+/// 57344 for fp8_152 and 240 for fp8_143, whose top exponent is reserved for inf and NaN. 0 for other dtypes.
+float getQuantizedMax(DType dtype);
+
+} // namespace gblas
+
+#endif //GBLAS_QUANTIZATION_H
@@ -0,0 +1,162 @@
+#include "transpose.h"
+#include "operations.h"
+#include "op_utils.h"
+#include "gTensor/gTensor.h"
+#include "kernels/kernels.h"
+#include "runtime/Parallel.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace gblas {
+
+namespace {
+
+// bytes of the square tiles a transposed copy goes through, well within L1. their edge is the power of two
+// that keeps a tile of the element size within it: 128 elements of 1 and 2 bytes, 64 of 4 and 8 bytes.
+// shorter edges leave partial cache lines on the strided side
+constexpr uint64_t kTransposeTileBytes = 32 << 10;
+
+// outputs of at least this size, about an L2, are written with non-temporal stores: they would not stay in
+// the closer caches anyway and the stores save reading every line of the destination first
+constexpr uint64_t kStreamingBytes = 2ull << 20;
+
+// the tensors are visited in square tiles of the two contiguous dims: the source lines of a tile are converted
+// (or copied) into an L1 staging tile of the destination dtype, which the transpose kernel then writes out along
+// the destination lines. both sides move whole cache lines and the strided side never touches more than one
+// tile's worth of lines
+struct TransposePlan
+{
+    unsigned rank = 0;
+    TSizeArr sizes = {};
+    TStrideArr srcStrides = {};
+    TStrideArr dstStrides = {};
+    const byte* src = nullptr;
+    byte* dst = nullptr;
+    DType srcType = DType::dtypeNR;
+    DType dstType = DType::dtypeNR;
+    // dim the source is contiguous along (r in a tile) and the one of the destination (c)
+    unsigned srcDim = 0;
+    unsigned dstDim = 0;
+    // edge of a tile in elements
+    uint64_t edge = 0;
+    uint64_t tilesR = 0;
+    uint64_t tilesC = 0;
+
+    uint64_t getNumOfTiles() const
+    {
+        uint64_t tiles = tilesR * tilesC;
+        for (unsigned dim = 0; dim < rank; ++dim)
+        {
+            if (dim != srcDim && dim != dstDim) tiles *= sizes[dim];
+        }
+        return tiles;
+    }
+
+    // element offsets of the first element of a tile and its extent along r and c
+    void locate(uint64_t tile, int64_t& srcOffset, int64_t& dstOffset, uint64_t& rows, uint64_t& cols) const
+    {
+        const uint64_t r = tile % tilesR * edge;
+        const uint64_t c = tile / tilesR % tilesC * edge;
+        rows = std::min(edge, sizes[srcDim] - r);
+        cols = std::min(edge, sizes[dstDim] - c);
+        srcOffset = static_cast<int64_t>(r) * srcStrides[srcDim] + static_cast<int64_t>(c) * srcStrides[dstDim];
+        dstOffset = static_cast<int64_t>(r) * dstStrides[srcDim] + static_cast<int64_t>(c) * dstStrides[dstDim];
+        uint64_t outer = tile / (tilesR * tilesC);
+        for (unsigned dim = 0; dim < rank; ++dim)
+        {
+            if (dim == srcDim || dim == dstDim) continue;
+            const int64_t coord = static_cast<int64_t>(outer % sizes[dim]);
+            outer /= sizes[dim];
+            srcOffset += coord * srcStrides[dim];
+            dstOffset += coord * dstStrides[dim];
+        }
+    }
+};
+
+} // anonymous namespace
+
+unsigned getContiguousDim(const gTensor& tensor)
+{
+    for (unsigned dim = 0; dim < tensor.getRank(); ++dim)
+    {
+        if (tensor.getSize(dim) > 1 && tensor.getStride(dim) == 1) return dim;
+    }
+    return tensor.getRank();
+}
+
+void copyTransposed(const gTensor& src, gTensor& dst, ConvertRunFn convert, RoundingMode rounding)
+{
+    TransposePlan plan;
+    plan.rank = src.getRank();
+    plan.sizes = src.getAllSizesInElements();
+    plan.srcStrides = src.getAllStridesInElements();
+    plan.dstStrides = dst.getAllStridesInElements();
+    plan.src = src.data();
+    plan.dst = dst.data();
+    plan.srcType = src.getDType();
+    plan.dstType = dst.getDType();
+    plan.srcDim = getContiguousDim(src);
+    plan.dstDim = getContiguousDim(dst);
+    const unsigned srcSize = getSingleElementSizeInBytes(plan.srcType);
+    const unsigned dstSize = getSingleElementSizeInBytes(plan.dstType);
+    plan.edge = std::bit_floor(static_cast<uint64_t>(std::sqrt(kTransposeTileBytes / dstSize)));
+    plan.tilesR = (plan.sizes[plan.srcDim] + plan.edge - 1) / plan.edge;
+    plan.tilesC = (plan.sizes[plan.dstDim] + plan.edge - 1) / plan.edge;
+    const kernels::KernelTable::TransposeFn transpose = kernels::getKernelTable().transpose[std::countr_zero(dstSize)];
+    const bool streaming = src.getTotalSizeInElements() * dstSize >= kStreamingBytes;
+    const uint64_t grain = std::max<uint64_t>(1, kParallelGrain / (plan.edge * plan.edge));
+    parallelForRange(plan.getNumOfTiles(), grain, [&](uint64_t begin, uint64_t end, unsigned)
+    {
+        alignas(kCacheLineSize) byte staging[kTransposeTileBytes];
+        for (uint64_t tile = begin; tile < end; ++tile)
+        {
+            int64_t srcOffset, dstOffset;
+            uint64_t rows, cols;
+            plan.locate(tile, srcOffset, dstOffset, rows, cols);
+            // staging line c holds the tile's column c in the destination dtype
+            for (uint64_t c = 0; c < cols; ++c)
+            {
+                const int64_t offset = srcOffset + static_cast<int64_t>(c) * plan.srcStrides[plan.dstDim];
+                const byte* line = plan.src + offset * srcSize;
+                byte* staged = staging + c * plan.edge * dstSize;
+                if (convert) convert(plan.srcType, line, 1, plan.dstType, staged, 1, rows, rounding);
+                else std::memcpy(staged, line, rows * dstSize);
+            }
+            transpose(rows, cols, staging, plan.edge, plan.dst + dstOffset * dstSize, plan.dstStrides[plan.srcDim],
+                      streaming);
+        }
+    });
+}
+
+gStatus Operations::permute(const gTensor& x, gTensor& y, const Coordinates& perm)
+{
+    // validate inputs
+    std::array<bool, MAX_DIM> used = {};
+    for (unsigned i = 0; i < x.getRank(); ++i)
+    {
+        if (perm[i] >= x.getRank() || used[perm[i]]) return gStatus::gBLAS_FAIL;
+        used[perm[i]] = true;
+    }
+
+    // perform operation
+    return copy(x.transpose(perm), y);
+}
+
+gStatus Operations::convertLayout(const gTensor& x, gTensor& y)
+{
+    // validate inputs
+    const Layout from = x.getLayout();
+    const Layout to = y.getLayout();
+    if (from == Layout::LayoutNR || to == Layout::LayoutNR) return gStatus::gBLAS_FAIL;
+    if (from == to) return copy(x, y);
+    if (x.getRank() < 2) return gStatus::gBLAS_FAIL;
+
+    // perform operation
+    // the matrix of dims 0 and 1 stays the same, only which of the two dims holds its rows changes
+    return copy(x.transpose(0, 1), y);
+}
+
+} // namespace gblas
@@ -0,0 +1,25 @@
+#ifndef GBLAS_TRANSPOSE_H
+#define GBLAS_TRANSPOSE_H
+
+#include <cstdint>
+#include "common.h"
+#include "gTensor/gTensor.h"
+
+namespace gblas {
+
+/// converts count elements of srcType into dstType, strides in elements
+using ConvertRunFn = void (*)(DType srcType, const byte* src, int64_t srcStride, DType dstType, byte* dst,
+                              int64_t dstStride, uint64_t count, RoundingMode rounding);
+
+/// the dim a tensor is contiguous along (stride 1 over more than one element), its rank when there is none
+unsigned getContiguousDim(const gTensor& tensor);
+
+/// dst = src for tensors of the same shape that are contiguous along different dims, see getContiguousDim.
+/// convert turns the source elements into the dtype of dst, nullptr when both share the dtype. the tensors
+/// must not share storage, the work is split over the thread pool.
+void copyTransposed(const gTensor& src, gTensor& dst, ConvertRunFn convert = nullptr,
+                    RoundingMode rounding = RoundingMode::NearestEven);
+
+} // namespace gblas
+
+#endif //GBLAS_TRANSPOSE_H
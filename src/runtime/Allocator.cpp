@@ -0,0 +1,183 @@
+#include "Allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace gblas {
+
+namespace {
+
+constexpr uint64_t kMinClassSize = 64;
+constexpr unsigned kClassesPerOctave = 4;
+
+uint64_t roundUp(uint64_t value, uint64_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// class 0 holds blocks up to 64 bytes, every power of two above it is split into four classes
+unsigned getClassIndex(uint64_t sizeInBytes)
+{
+    if (sizeInBytes <= kMinClassSize) return 0;
+    const unsigned octave = 63 - std::countl_zero(sizeInBytes - 1);
+    const uint64_t step = 1ull << (octave - 2);
+    const uint64_t sub = (sizeInBytes - (1ull << octave) + step - 1) / step;
+    return (octave - 6) * kClassesPerOctave + static_cast<unsigned>(sub);
+}
+
+uint64_t getClassSizeOfIndex(unsigned index)
+{
+    if (index == 0) return kMinClassSize;
+    const unsigned octave = (index - 1) / kClassesPerOctave + 6;
+    const uint64_t sub = (index - 1) % kClassesPerOctave + 1;
+    return (1ull << octave) + sub * (1ull << (octave - 2));
+}
+
+std::atomic<uint64_t> gNextPoolId{0};
+std::atomic<Allocator*> gDefaultAllocator{nullptr};
+
+Allocator& getBuiltinAllocator()
+{
+    // never destroyed, thread caches may still return blocks to it while the process exits
+    static AlignedAllocator* heap = new AlignedAllocator(kCacheLineSize);
+    static PoolAllocator* pool = new PoolAllocator(*heap);
+    return *pool;
+}
+
+} // anonymous namespace
+
+AlignedAllocator::AlignedAllocator(uint64_t alignment, bool hugePages)
+    : m_alignment(std::max(alignment, kCacheLineSize)), m_hugePages(hugePages)
+{
+    if (!std::has_single_bit(m_alignment)) throw std::invalid_argument("alignment must be a power of two");
+}
+
+byte* AlignedAllocator::allocate(uint64_t sizeInBytes)
+{
+    const bool huge = m_hugePages && sizeInBytes >= kHugePageSize;
+    const uint64_t alignment = huge ? std::max(m_alignment, kHugePageSize) : m_alignment;
+    // aligned_alloc wants a whole number of alignments
+    const uint64_t size = roundUp(std::max<uint64_t>(sizeInBytes, 1), alignment);
+    void* ptr = std::aligned_alloc(alignment, size);
+    if (!ptr) throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // only a hint, the kernel may still back the range with small pages
+    if (huge) madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    return static_cast<byte*>(ptr);
+}
+
+void AlignedAllocator::deallocate(byte* ptr, uint64_t)
+{
+    std::free(ptr);
+}
+
+struct PoolAllocator::ThreadCache
+{
+    Allocator* upstream = nullptr;
+    uint64_t cachedBytes = 0;
+    std::vector<std::vector<byte*>> freeLists;
+
+    ~ThreadCache() {release();}
+    void release()
+    {
+        for (unsigned index = 0; index < freeLists.size(); ++index)
+        {
+            for (byte* block : freeLists[index]) upstream->deallocate(block, getClassSizeOfIndex(index));
+            freeLists[index].clear();
+        }
+        cachedBytes = 0;
+    }
+};
+
+PoolAllocator::PoolAllocator(Allocator& upstream, uint64_t maxPooledSize, uint64_t maxCachedBytes)
+    : m_upstream(upstream), m_maxPooledSize(maxPooledSize), m_maxCachedBytes(maxCachedBytes), m_id(gNextPoolId++)
+{
+}
+
+PoolAllocator::~PoolAllocator()
+{
+    trim();
+}
+
+uint64_t PoolAllocator::getClassSize(uint64_t sizeInBytes)
+{
+    return getClassSizeOfIndex(getClassIndex(sizeInBytes));
+}
+
+PoolAllocator::ThreadCache& PoolAllocator::getThreadCache()
+{
+    // the caches of every pool the thread has used, a thread rarely sees more than one pool
+    thread_local std::vector<std::pair<uint64_t, std::unique_ptr<ThreadCache>>> caches;
+    for (auto& [id, cache] : caches)
+    {
+        if (id == m_id) return *cache;
+    }
+    auto cache = std::make_unique<ThreadCache>();
+    cache->upstream = &m_upstream;
+    cache->freeLists.resize(getClassIndex(m_maxPooledSize) + 1);
+    caches.emplace_back(m_id, std::move(cache));
+    return *caches.back().second;
+}
+
+byte* PoolAllocator::allocate(uint64_t sizeInBytes)
+{
+    if (sizeInBytes > m_maxPooledSize) return m_upstream.allocate(sizeInBytes);
+    const unsigned index = getClassIndex(sizeInBytes);
+    ThreadCache& cache = getThreadCache();
+    std::vector<byte*>& freeList = cache.freeLists[index];
+    if (!freeList.empty())
+    {
+        byte* block = freeList.back();
+        freeList.pop_back();
+        cache.cachedBytes -= getClassSizeOfIndex(index);
+        return block;
+    }
+    return m_upstream.allocate(getClassSizeOfIndex(index));
+}
+
+void PoolAllocator::deallocate(byte* ptr, uint64_t sizeInBytes)
+{
+    if (!ptr) return;
+    if (sizeInBytes > m_maxPooledSize)
+    {
+        m_upstream.deallocate(ptr, sizeInBytes);
+        return;
+    }
+    const unsigned index = getClassIndex(sizeInBytes);
+    const uint64_t classSize = getClassSizeOfIndex(index);
+    ThreadCache& cache = getThreadCache();
+    if (cache.cachedBytes + classSize > m_maxCachedBytes)
+    {
+        m_upstream.deallocate(ptr, classSize);
+        return;
+    }
+    cache.freeLists[index].push_back(ptr);
+    cache.cachedBytes += classSize;
+}
+
+void PoolAllocator::trim()
+{
+    getThreadCache().release();
+}
+
+Allocator& getDefaultAllocator()
+{
+    Allocator* allocator = gDefaultAllocator.load(std::memory_order_acquire);
+    return allocator ? *allocator : getBuiltinAllocator();
+}
+
+void setDefaultAllocator(Allocator* allocator)
+{
+    gDefaultAllocator.store(allocator, std::memory_order_release);
+}
+
+} // namespace gblas
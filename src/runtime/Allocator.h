@@ -0,0 +1,71 @@
+#ifndef GBLAS_ALLOCATOR_H
+#define GBLAS_ALLOCATOR_H
+
+#include <cstdint>
+#include "gTensor/DataBuffer.h"
+
+namespace gblas {
+
+constexpr uint64_t kCacheLineSize = 64;
+constexpr uint64_t kPageSize = 4096;
+constexpr uint64_t kHugePageSize = 2ull << 20;
+
+/// source of tensor memory. blocks are at least cache line aligned so kernels can use aligned vector
+/// access. allocate throws std::bad_alloc on failure, deallocate gets the size that was passed to allocate.
+class Allocator
+{
+public:
+    virtual ~Allocator() = default;
+    virtual byte* allocate(uint64_t sizeInBytes) = 0;
+    virtual void deallocate(byte* ptr, uint64_t sizeInBytes) = 0;
+};
+
+/// straight from the heap, aligned to `alignment` bytes (a power of two, at least a cache line).
+/// with hugePages, allocations of a huge page or more are huge page aligned and advised to the kernel
+/// for transparent huge pages, which cuts TLB misses on large operands.
+class AlignedAllocator : public Allocator
+{
+public:
+    explicit AlignedAllocator(uint64_t alignment = kCacheLineSize, bool hugePages = false);
+    byte* allocate(uint64_t sizeInBytes) override;
+    void deallocate(byte* ptr, uint64_t sizeInBytes) override;
+    uint64_t getAlignment() const {return m_alignment;}
+private:
+    uint64_t m_alignment;
+    bool m_hugePages;
+};
+
+/// caches freed blocks per thread in size classes (four per power of two), so a repeated allocation of
+/// the same size is served without the heap. blocks above maxPooledSize and blocks that would grow a
+/// thread's cache beyond maxCachedBytes go back to upstream. a block may be freed on another thread
+/// than the one it came from. the pool must outlive every thread that used it.
+class PoolAllocator : public Allocator
+{
+public:
+    explicit PoolAllocator(Allocator& upstream, uint64_t maxPooledSize = 256ull << 20,
+                           uint64_t maxCachedBytes = 512ull << 20);
+    ~PoolAllocator() override;
+    byte* allocate(uint64_t sizeInBytes) override;
+    void deallocate(byte* ptr, uint64_t sizeInBytes) override;
+    /// return the calling thread's cached blocks to upstream
+    void trim();
+    /// rounded size a request is served with
+    static uint64_t getClassSize(uint64_t sizeInBytes);
+private:
+    struct ThreadCache;
+    ThreadCache& getThreadCache();
+    Allocator& m_upstream;
+    uint64_t m_maxPooledSize;
+    uint64_t m_maxCachedBytes;
+    uint64_t m_id;
+};
+
+/// the allocator tensors use unless told otherwise, a PoolAllocator over 64 byte aligned heap memory
+Allocator& getDefaultAllocator();
+/// replace the default allocator, nullptr restores the built in one. buffers keep the allocator they were
+/// created with, so the previous allocator must stay alive while its buffers do.
+void setDefaultAllocator(Allocator* allocator);
+
+} // namespace gblas
+
+#endif //GBLAS_ALLOCATOR_H
@@ -0,0 +1,148 @@
+#include "CpuFeatures.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gblas {
+
+namespace {
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    // __builtin_cpu_supports also verifies the OS saves the extended register state (XCR0)
+    __builtin_cpu_init();
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.fma = __builtin_cpu_supports("fma");
+    features.f16c = __builtin_cpu_supports("f16c");
+    features.avx512f = __builtin_cpu_supports("avx512f");
+    features.avx512bw = __builtin_cpu_supports("avx512bw");
+    features.avx512vl = __builtin_cpu_supports("avx512vl");
+    features.avx512dq = __builtin_cpu_supports("avx512dq");
+    features.avxvnni = __builtin_cpu_supports("avxvnni");
+    features.avx512vnni = __builtin_cpu_supports("avx512vnni");
+    features.avx512bf16 = __builtin_cpu_supports("avx512bf16");
+    features.amxTile = __builtin_cpu_supports("amx-tile");
+    features.amxInt8 = __builtin_cpu_supports("amx-int8");
+    features.amxBf16 = __builtin_cpu_supports("amx-bf16");
+#endif
+    return features;
+}
+
+// Linux keeps the tile data state disabled until the process asks for it, the request holds for every
+// thread of the process and must come before the first tile instruction
+bool requestAmxState()
+{
+#if defined(__linux__) && defined(__x86_64__)
+    constexpr long kArchReqXcompPerm = 0x1023;
+    constexpr long kXfeatureXtileData = 18;
+    static const bool granted = syscall(SYS_arch_prctl, kArchReqXcompPerm, kXfeatureXtileData) == 0;
+    return granted;
+#else
+    return false;
+#endif
+}
+
+} // anonymous namespace
+
+const CpuFeatures& getCpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+bool isIsaLevelSupported(IsaLevel level)
+{
+    const CpuFeatures& f = getCpuFeatures();
+    const bool avx2 = f.avx2 && f.fma && f.f16c;
+    const bool avx512 = avx2 && f.avx512f && f.avx512bw && f.avx512vl && f.avx512dq;
+    switch (level)
+    {
+        case IsaLevel::Scalar:
+            return true;
+        case IsaLevel::AVX2:
+            return avx2;
+        case IsaLevel::AVX2VNNI:
+            return avx2 && f.avxvnni;
+        case IsaLevel::AVX512:
+            return avx512;
+        case IsaLevel::AVX512VNNI:
+            return avx512 && f.avx512vnni;
+        case IsaLevel::AMX:
+            return avx512 && f.avx512vnni && f.avx512bf16 && f.amxTile && f.amxInt8 && f.amxBf16 &&
+                   requestAmxState();
+        default:
+            return false;
+    }
+}
+
+IsaLevel getHostIsaLevel()
+{
+    static const IsaLevel level = []()
+    {
+        int best = static_cast<int>(IsaLevel::IsaLevelNR) - 1;
+        while (best > 0 && !isIsaLevelSupported(static_cast<IsaLevel>(best))) --best;
+        return static_cast<IsaLevel>(best);
+    }();
+    return level;
+}
+
+IsaLevel getDispatchIsaLevel()
+{
+    static const IsaLevel level = []()
+    {
+        const IsaLevel host = getHostIsaLevel();
+        const char* value = std::getenv("GBLAS_ISA");
+        const IsaLevel requested = value ? getIsaLevelByName(value) : IsaLevel::IsaLevelNR;
+        if (value && *value && requested == IsaLevel::IsaLevelNR)
+        {
+            // once per process, the level is resolved a single time
+            std::fprintf(stderr, "gBLAS: ignoring unknown GBLAS_ISA value \"%s\", using %s\n", value,
+                         isaLevelName(host));
+        }
+        if (requested == IsaLevel::IsaLevelNR || requested >= host) return host;
+        int best = static_cast<int>(requested);
+        while (best > 0 && !isIsaLevelSupported(static_cast<IsaLevel>(best))) --best;
+        return static_cast<IsaLevel>(best);
+    }();
+    return level;
+}
+
+const char* isaLevelName(IsaLevel level)
+{
+    switch (level)
+    {
+        case IsaLevel::Scalar:
+            return "scalar";
+        case IsaLevel::AVX2:
+            return "avx2";
+        case IsaLevel::AVX2VNNI:
+            return "avx2_vnni";
+        case IsaLevel::AVX512:
+            return "avx512";
+        case IsaLevel::AVX512VNNI:
+            return "avx512_vnni";
+        case IsaLevel::AMX:
+            return "amx";
+        default:
+            break;
+    }
+    return "unknown";
+}
+
+IsaLevel getIsaLevelByName(const char* name)
+{
+    for (int level = 0; level < static_cast<int>(IsaLevel::IsaLevelNR); ++level)
+    {
+        if (std::strcmp(name, isaLevelName(static_cast<IsaLevel>(level))) == 0) return static_cast<IsaLevel>(level);
+    }
+    return IsaLevel::IsaLevelNR;
+}
+
+} // namespace gblas
@@ -0,0 +1,59 @@
+#ifndef GBLAS_CPUFEATURES_H
+#define GBLAS_CPUFEATURES_H
+
+namespace gblas {
+
+/// instruction set levels we ship kernels for, ordered from the most generic to the most specific.
+/// a host does not support every level below its best one: an AVX-512 host may lack AVX-VNNI.
+enum class IsaLevel
+{
+    Scalar,
+    AVX2,
+    // AVX2 with the 256 bit VNNI dot products
+    AVX2VNNI,
+    AVX512,
+    // AVX-512 with VNNI
+    AVX512VNNI,
+    // AVX-512 VNNI and BF16 with the AMX int8 and bf16 tiles, once the OS lets the process use them
+    AMX,
+    IsaLevelNR
+};
+
+struct CpuFeatures
+{
+    bool sse42 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool avx512dq = false;
+    bool avxvnni = false;
+    bool avx512vnni = false;
+    bool avx512bf16 = false;
+    // the tile registers, set when the cpu has them and the OS saves their state. Linux also wants each
+    // process to ask for the permission before the first tile instruction.
+    bool amxTile = false;
+    bool amxInt8 = false;
+    bool amxBf16 = false;
+};
+
+/// features of the host cpu, detected once on first use
+const CpuFeatures& getCpuFeatures();
+/// whether the kernels of a level can run on the host cpu
+bool isIsaLevelSupported(IsaLevel level);
+/// highest level whose kernels can run on the host cpu
+IsaLevel getHostIsaLevel();
+/// level the kernel tables are picked from: the host level, lowered to the one named by the GBLAS_ISA
+/// environment variable (see isaLevelName) when it is set, to test or benchmark the other kernels.
+/// a level the host does not support falls back to the best supported level below it, a name that is not a
+/// level is ignored with a warning on stderr.
+IsaLevel getDispatchIsaLevel();
+const char* isaLevelName(IsaLevel level);
+/// level named `name` as returned by isaLevelName, IsaLevelNR for an unknown name
+IsaLevel getIsaLevelByName(const char* name);
+
+} // namespace gblas
+
+#endif //GBLAS_CPUFEATURES_H
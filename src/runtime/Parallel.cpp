@@ -0,0 +1,367 @@
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gblas {
+
+namespace {
+
+// set on pool threads and on a caller while it runs a loop, loops started from there run serially
+thread_local bool t_inLoop = false;
+
+// "0-3,8,10-11" as in /sys/devices/system/node/node0/cpulist
+std::vector<unsigned> parseCpuList(const std::string& list)
+{
+    std::vector<unsigned> cpus;
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        size_t next = list.find(',', pos);
+        if (next == std::string::npos) next = list.size();
+        const std::string item = list.substr(pos, next - pos);
+        const size_t dash = item.find('-');
+        try
+        {
+            const unsigned first = static_cast<unsigned>(std::stoul(item.substr(0, dash)));
+            const unsigned last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(item.substr(dash + 1)));
+            for (unsigned cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        catch (const std::exception&)
+        {
+            // a malformed item is skipped
+        }
+        pos = next + 1;
+    }
+    return cpus;
+}
+
+std::vector<unsigned> getAllowedCpus()
+{
+    std::vector<unsigned> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty())
+    {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+bool pinThread(std::thread& thread, const std::vector<unsigned>& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)cpus;
+    return false;
+#endif
+}
+
+unsigned getEnvThreads()
+{
+    const char* value = std::getenv("GBLAS_NUM_THREADS");
+    return value ? static_cast<unsigned>(std::strtoul(value, nullptr, 10)) : 0;
+}
+
+} // anonymous namespace
+
+struct alignas(64) ThreadPool::Range
+{
+    std::atomic_flag locked = ATOMIC_FLAG_INIT;
+    uint64_t begin = 0;
+    uint64_t end = 0;
+
+    void lock()
+    {
+        while (locked.test_and_set(std::memory_order_acquire))
+        {
+            while (locked.test(std::memory_order_relaxed)) {}
+        }
+    }
+    void unlock() {locked.clear(std::memory_order_release);}
+};
+
+struct alignas(64) ThreadPool::Worker
+{
+    // bumped to hand the worker a loop, or to stop it
+    std::atomic<uint64_t> ticket{0};
+};
+
+std::vector<std::vector<unsigned>> getNumaNodes()
+{
+    const std::vector<unsigned> allowed = getAllowedCpus();
+    std::vector<std::vector<unsigned>> nodes;
+    for (unsigned node = 0; ; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) break;
+        std::string list;
+        std::getline(file, list);
+        std::vector<unsigned> cpus;
+        for (unsigned cpu : parseCpuList(list))
+        {
+            if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) cpus.push_back(cpu);
+        }
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    if (nodes.empty()) nodes.push_back(allowed);
+    return nodes;
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+{
+    std::vector<std::vector<unsigned>> nodes = getNumaNodes();
+    if (options.numaNode >= 0 && static_cast<size_t>(options.numaNode) < nodes.size())
+    {
+        nodes = {nodes[options.numaNode]};
+    }
+    // the order threads are placed on cpus in
+    std::vector<unsigned> order;
+    if (options.affinity == Affinity::Spread)
+    {
+        size_t largest = 0;
+        for (const auto& node : nodes) largest = std::max(largest, node.size());
+        for (size_t i = 0; i < largest; ++i)
+        {
+            for (const auto& node : nodes)
+            {
+                if (i < node.size()) order.push_back(node[i]);
+            }
+        }
+    }
+    else
+    {
+        for (const auto& node : nodes) order.insert(order.end(), node.begin(), node.end());
+    }
+
+    m_numOfThreads = options.threads ? options.threads : getEnvThreads();
+    if (!m_numOfThreads) m_numOfThreads = static_cast<unsigned>(order.size());
+    m_numOfThreads = std::max(1u, m_numOfThreads);
+    m_ranges = std::make_unique<Range[]>(m_numOfThreads);
+    m_workers = std::make_unique<Worker[]>(m_numOfThreads);
+    m_cpus.assign(m_numOfThreads, -1);
+
+    // the calling thread is the user's and stays where it is, the workers take the following cpus
+    m_threads.reserve(m_numOfThreads - 1);
+    for (unsigned thread = 1; thread < m_numOfThreads; ++thread)
+    {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, thread);
+        if (options.affinity != Affinity::None)
+        {
+            const unsigned cpu = order[thread % order.size()];
+            if (pinThread(m_threads.back(), {cpu})) m_cpus[thread] = static_cast<int>(cpu);
+        }
+        else if (options.numaNode >= 0)
+        {
+            pinThread(m_threads.back(), order);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_stop.store(true, std::memory_order_release);
+    for (unsigned thread = 1; thread < m_numOfThreads; ++thread)
+    {
+        m_workers[thread].ticket.fetch_add(1, std::memory_order_release);
+        m_workers[thread].ticket.notify_one();
+    }
+    for (auto& thread : m_threads) thread.join();
+}
+
+void ThreadPool::workerLoop(unsigned thread)
+{
+    t_inLoop = true;
+    Worker& worker = m_workers[thread];
+    uint64_t seen = 0;
+    while (true)
+    {
+        worker.ticket.wait(seen, std::memory_order_acquire);
+        seen = worker.ticket.load(std::memory_order_acquire);
+        if (m_stop.load(std::memory_order_acquire)) return;
+        participate(thread);
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) m_pending.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(uint64_t count, uint64_t grain, unsigned maxThreads, const RangeFn& fn)
+{
+    if (count == 0) return;
+    grain = std::max<uint64_t>(grain, 1);
+    const uint64_t pieces = (count + grain - 1) / grain;
+    const unsigned participants = static_cast<unsigned>(
+        std::min<uint64_t>({std::max(maxThreads, 1u), m_numOfThreads, pieces}));
+    if (participants <= 1 || t_inLoop || m_busy.exchange(true, std::memory_order_acquire))
+    {
+        for (uint64_t begin = 0; begin < count; begin += grain) fn(begin, std::min(begin + grain, count), 0);
+        return;
+    }
+
+    m_fn = &fn;
+    m_grain = grain;
+    m_participants = participants;
+    m_error = nullptr;
+    m_failed.store(false, std::memory_order_relaxed);
+    for (unsigned thread = 0; thread < participants; ++thread)
+    {
+        m_ranges[thread].begin = count * thread / participants;
+        m_ranges[thread].end = count * (thread + 1) / participants;
+    }
+    m_pending.store(participants - 1, std::memory_order_relaxed);
+    for (unsigned thread = 1; thread < participants; ++thread)
+    {
+        m_workers[thread].ticket.fetch_add(1, std::memory_order_release);
+        m_workers[thread].ticket.notify_one();
+    }
+
+    t_inLoop = true;
+    participate(0);
+    t_inLoop = false;
+    for (unsigned left = m_pending.load(std::memory_order_acquire); left; left = m_pending.load(std::memory_order_acquire))
+    {
+        m_pending.wait(left, std::memory_order_acquire);
+    }
+    std::exception_ptr error = std::move(m_error);
+    m_busy.store(false, std::memory_order_release);
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::participate(unsigned thread)
+{
+    uint64_t begin, end;
+    do
+    {
+        while (takePiece(thread, begin, end))
+        {
+            // after a failure the remaining pieces are drained without running them
+            if (m_failed.load(std::memory_order_relaxed)) continue;
+            try
+            {
+                (*m_fn)(begin, end, thread);
+            }
+            catch (...)
+            {
+                if (!m_failed.exchange(true)) m_error = std::current_exception();
+            }
+        }
+    } while (steal(thread));
+}
+
+bool ThreadPool::takePiece(unsigned thread, uint64_t& begin, uint64_t& end)
+{
+    Range& range = m_ranges[thread];
+    range.lock();
+    begin = range.begin;
+    end = std::min(range.begin + m_grain, range.end);
+    range.begin = end;
+    range.unlock();
+    return begin < end;
+}
+
+bool ThreadPool::steal(unsigned thread)
+{
+    for (unsigned i = 1; i < m_participants; ++i)
+    {
+        Range& victim = m_ranges[(thread + i) % m_participants];
+        victim.lock();
+        const uint64_t remaining = victim.end - victim.begin;
+        const uint64_t stolenEnd = victim.end;
+        // half of what is left, or all of it when that is a single piece
+        if (remaining) victim.end -= remaining > m_grain ? remaining / 2 : remaining;
+        const uint64_t stolenBegin = victim.end;
+        victim.unlock();
+        if (!remaining) continue;
+        Range& own = m_ranges[thread];
+        own.lock();
+        own.begin = stolenBegin;
+        own.end = stolenEnd;
+        own.unlock();
+        return true;
+    }
+    return false;
+}
+
+namespace {
+
+std::mutex g_poolMutex;
+std::atomic<ThreadPool*> g_pool{nullptr};
+
+} // anonymous namespace
+
+ThreadPool& getThreadPool()
+{
+    if (ThreadPool* pool = g_pool.load(std::memory_order_acquire)) return *pool;
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    // never destroyed, so library calls from static destructors still find it
+    if (!g_pool.load(std::memory_order_relaxed)) g_pool.store(new ThreadPool(), std::memory_order_release);
+    return *g_pool.load(std::memory_order_relaxed);
+}
+
+void setThreadPoolOptions(const ThreadPoolOptions& options)
+{
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    delete g_pool.exchange(new ThreadPool(options), std::memory_order_acq_rel);
+}
+
+unsigned getMaxThreads()
+{
+    return getThreadPool().getNumOfThreads();
+}
+
+void parallelFor(uint64_t count, unsigned threads, const std::function<void(uint64_t, unsigned)>& fn)
+{
+    getThreadPool().parallelFor(count, 1, threads, [&](uint64_t begin, uint64_t end, unsigned thread)
+    {
+        for (uint64_t i = begin; i < end; ++i) fn(i, thread);
+    });
+}
+
+void parallelForRange(uint64_t count, uint64_t grain, const ThreadPool::RangeFn& fn)
+{
+    ThreadPool& pool = getThreadPool();
+    pool.parallelFor(count, grain, pool.getNumOfThreads(), fn);
+}
+
+void parallelForTiles(uint64_t rows, uint64_t cols, uint64_t tileRows, uint64_t tileCols,
+                      const std::function<void(uint64_t, uint64_t, uint64_t, uint64_t, unsigned)>& fn)
+{
+    tileRows = std::max<uint64_t>(tileRows, 1);
+    tileCols = std::max<uint64_t>(tileCols, 1);
+    const uint64_t rowTiles = (rows + tileRows - 1) / tileRows;
+    const uint64_t colTiles = (cols + tileCols - 1) / tileCols;
+    ThreadPool& pool = getThreadPool();
+    pool.parallelFor(rowTiles * colTiles, 1, pool.getNumOfThreads(), [&](uint64_t begin, uint64_t end, unsigned thread)
+    {
+        for (uint64_t tile = begin; tile < end; ++tile)
+        {
+            const uint64_t row = tile / colTiles * tileRows;
+            const uint64_t col = tile % colTiles * tileCols;
+            fn(row, std::min(row + tileRows, rows), col, std::min(col + tileCols, cols), thread);
+        }
+    });
+}
+
+} // namespace gblas
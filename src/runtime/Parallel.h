@@ -0,0 +1,106 @@
+#ifndef GBLAS_PARALLEL_H
+#define GBLAS_PARALLEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace gblas {
+
+/// elementwise work is split in pieces of this many elements, a range of a single piece runs serially
+constexpr uint64_t kParallelGrain = 16 << 10;
+
+/// how pool threads are pinned to cpus
+enum class Affinity
+{
+    None,       // left to the OS
+    Compact,    // thread i on the i-th allowed cpu, filling a NUMA node before the next one
+    Spread,     // round robin over the NUMA nodes, for bandwidth bound work
+};
+
+struct ThreadPoolOptions
+{
+    /// threads including the calling one, 0 takes GBLAS_NUM_THREADS or else the number of allowed cpus
+    unsigned threads = 0;
+    Affinity affinity = Affinity::None;
+    /// keep the threads on the cpus of this node, -1 for any node
+    int numaNode = -1;
+};
+
+/// persistent worker threads for the library. a parallel loop splits its range evenly over the
+/// participants, each takes grain sized pieces off the front of its own range, and a participant that
+/// runs dry steals the back half of another one's range. the calling thread takes part as thread 0.
+/// one loop runs at a time, a loop started while another one runs (or from inside one) runs serially
+/// on the calling thread. an exception thrown by the body is rethrown to the caller after the loop.
+class ThreadPool
+{
+public:
+    using RangeFn = std::function<void(uint64_t begin, uint64_t end, unsigned thread)>;
+
+    explicit ThreadPool(const ThreadPoolOptions& options = {});
+    ~ThreadPool();
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    /// threads a loop may run on, the caller included
+    unsigned getNumOfThreads() const {return m_numOfThreads;}
+    /// cpu each thread was pinned to, -1 when it was not
+    int getThreadCpu(unsigned thread) const {return thread < m_cpus.size() ? m_cpus[thread] : -1;}
+
+    /// run fn(begin, end, thread) over [0, count) in pieces of at most grain, on up to maxThreads threads.
+    /// thread is below min(maxThreads, getNumOfThreads()).
+    void parallelFor(uint64_t count, uint64_t grain, unsigned maxThreads, const RangeFn& fn);
+
+private:
+    struct Range;
+    struct Worker;
+    void workerLoop(unsigned thread);
+    void participate(unsigned thread);
+    bool takePiece(unsigned thread, uint64_t& begin, uint64_t& end);
+    bool steal(unsigned thread);
+
+    unsigned m_numOfThreads = 1;
+    std::vector<int> m_cpus;
+    std::unique_ptr<Range[]> m_ranges;
+    std::unique_ptr<Worker[]> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_busy{false};
+    std::atomic<bool> m_stop{false};
+    // the running loop
+    const RangeFn* m_fn = nullptr;
+    uint64_t m_grain = 1;
+    unsigned m_participants = 1;
+    std::atomic<unsigned> m_pending{0};
+    std::exception_ptr m_error;
+    std::atomic<bool> m_failed{false};
+};
+
+/// the pool operations run on, created on first use
+ThreadPool& getThreadPool();
+/// replace the library pool, must not be called while a library call is running
+void setThreadPoolOptions(const ThreadPoolOptions& options);
+
+/// cpus of each NUMA node this process may run on, a single node when the topology is unknown
+std::vector<std::vector<unsigned>> getNumaNodes();
+
+/// number of threads the library may use
+unsigned getMaxThreads();
+
+/// run fn(index, thread) for every index in [0, count) on up to `threads` threads, the caller takes part
+/// as thread 0. indices are handed out dynamically and the call returns once all of them are done.
+void parallelFor(uint64_t count, unsigned threads, const std::function<void(uint64_t, unsigned)>& fn);
+
+/// run fn(begin, end, thread) over [0, count) in pieces of at most grain elements on the library pool
+void parallelForRange(uint64_t count, uint64_t grain, const ThreadPool::RangeFn& fn);
+
+/// run fn(rowBegin, rowEnd, colBegin, colEnd, thread) over the tiles of a rows x cols grid
+void parallelForTiles(uint64_t rows, uint64_t cols, uint64_t tileRows, uint64_t tileCols,
+                      const std::function<void(uint64_t, uint64_t, uint64_t, uint64_t, unsigned)>& fn);
+
+} // namespace gblas
+
+#endif //GBLAS_PARALLEL_H
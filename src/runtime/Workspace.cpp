@@ -0,0 +1,115 @@
+#include "Workspace.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace gblas {
+
+namespace {
+
+// smallest block chained on demand, keeps a cold workspace from chaining a block per request
+constexpr uint64_t kMinBlockSize = 64 << 10;
+
+} // anonymous namespace
+
+Workspace::Workspace(uint64_t capacityInBytes, Allocator& allocator) : m_allocator(allocator)
+{
+    if (capacityInBytes) addBlock(capacityInBytes);
+}
+
+Workspace::~Workspace()
+{
+    releaseBlocks();
+}
+
+void Workspace::addBlock(uint64_t sizeInBytes)
+{
+    Block block;
+    block.data = m_allocator.allocate(sizeInBytes);
+    block.size = sizeInBytes;
+    block.usedBefore = m_used;
+    m_blocks.push_back(block);
+}
+
+void Workspace::releaseBlocks()
+{
+    for (const Block& block : m_blocks) m_allocator.deallocate(block.data, block.size);
+    m_blocks.clear();
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+byte* Workspace::allocate(uint64_t sizeInBytes, uint64_t alignment)
+{
+    if (!std::has_single_bit(alignment)) throw std::invalid_argument("alignment must be a power of two");
+    m_maxAlignment = std::max(m_maxAlignment, alignment);
+    while (true)
+    {
+        if (m_block < m_blocks.size())
+        {
+            Block& block = m_blocks[m_block];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            const uint64_t offset = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+            if (offset + sizeInBytes <= block.size)
+            {
+                m_offset = offset + sizeInBytes;
+                m_used = block.usedBefore + m_offset;
+                m_peak = std::max(m_peak, m_used);
+                return block.data + offset;
+            }
+        }
+        // the current block is full, continue in the next one (kept from before a rewind) or chain a new one
+        if (m_block + 1 < m_blocks.size())
+        {
+            ++m_block;
+            m_blocks[m_block].usedBefore = m_used;
+        }
+        else
+        {
+            addBlock(std::max({sizeInBytes + alignment, getCapacity(), kMinBlockSize}));
+            m_block = static_cast<unsigned>(m_blocks.size() - 1);
+        }
+        m_offset = 0;
+    }
+}
+
+void Workspace::rewind(Marker marker)
+{
+    m_block = marker.block;
+    m_offset = marker.offset;
+    m_used = m_block < m_blocks.size() ? m_blocks[m_block].usedBefore + m_offset : 0;
+}
+
+void Workspace::reset()
+{
+    if (m_blocks.size() > 1)
+    {
+        // one block for the peak, plus the padding the chained blocks may have saved by starting aligned
+        const uint64_t merged = m_peak + m_blocks.size() * m_maxAlignment;
+        releaseBlocks();
+        addBlock(merged);
+    }
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+void Workspace::reserve(uint64_t sizeInBytes)
+{
+    reset();
+    if (getCapacity() < sizeInBytes)
+    {
+        releaseBlocks();
+        addBlock(sizeInBytes);
+    }
+}
+
+uint64_t Workspace::getCapacity() const
+{
+    uint64_t capacity = 0;
+    for (const Block& block : m_blocks) capacity += block.size;
+    return capacity;
+}
+
+} // namespace gblas
@@ -0,0 +1,91 @@
+#ifndef GBLAS_WORKSPACE_H
+#define GBLAS_WORKSPACE_H
+
+#include <cstdint>
+#include <vector>
+#include "runtime/Allocator.h"
+
+namespace gblas {
+
+/// scratch memory for operations, handed out by bumping an offset and given back all at once.
+/// when a request does not fit, another block is chained, and the next reset() merges the blocks into one
+/// block as large as the peak usage. so after the first call of a shape, later calls do not allocate.
+/// a workspace belongs to one thread at a time.
+class Workspace
+{
+public:
+    /// position to rewind to, see Scope
+    struct Marker
+    {
+        unsigned block = 0;
+        uint64_t offset = 0;
+    };
+
+    explicit Workspace(uint64_t capacityInBytes = 0, Allocator& allocator = getDefaultAllocator());
+    ~Workspace();
+    Workspace(const Workspace& other) = delete;
+    Workspace& operator=(const Workspace& other) = delete;
+
+    /// sizeInBytes bytes aligned to `alignment` (a power of two), valid until reset or a rewind past them
+    byte* allocate(uint64_t sizeInBytes, uint64_t alignment = kCacheLineSize);
+    template<typename T>
+    T* allocate(uint64_t count, uint64_t alignment = kCacheLineSize)
+    {
+        return reinterpret_cast<T*>(allocate(count * sizeof(T), alignment));
+    }
+
+    /// release everything handed out, O(1) unless blocks were chained since the last reset
+    void reset();
+    /// make sure sizeInBytes fit without chaining, releases everything handed out
+    void reserve(uint64_t sizeInBytes);
+    Marker getMarker() const {return {m_block, m_offset};}
+    void rewind(Marker marker);
+
+    uint64_t getCapacity() const;
+    /// bytes handed out since the last reset, alignment padding included
+    uint64_t getUsage() const {return m_used;}
+    /// the largest usage seen, a capacity that serves every call so far without chaining
+    uint64_t getPeakUsage() const {return m_peak;}
+
+    /// gives back everything allocated within its lifetime, a null workspace is allowed and ignored
+    class Scope
+    {
+    public:
+        explicit Scope(Workspace* workspace) : m_workspace(workspace)
+        {
+            if (m_workspace) m_marker = m_workspace->getMarker();
+        }
+        ~Scope()
+        {
+            if (m_workspace) m_workspace->rewind(m_marker);
+        }
+        Scope(const Scope& other) = delete;
+        Scope& operator=(const Scope& other) = delete;
+    private:
+        Workspace* m_workspace;
+        Marker m_marker;
+    };
+
+private:
+    struct Block
+    {
+        byte* data = nullptr;
+        uint64_t size = 0;
+        // usage of the blocks before this one when it became current
+        uint64_t usedBefore = 0;
+    };
+    void addBlock(uint64_t sizeInBytes);
+    void releaseBlocks();
+
+    Allocator& m_allocator;
+    std::vector<Block> m_blocks;
+    unsigned m_block = 0;
+    uint64_t m_offset = 0;
+    uint64_t m_used = 0;
+    uint64_t m_peak = 0;
+    uint64_t m_maxAlignment = kCacheLineSize;
+};
+
+} // namespace gblas
+
+#endif //GBLAS_WORKSPACE_H
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "runtime/Allocator.h"
+#include <thread>
+
+using namespace gblas;
+
+namespace {
+
+// counts the calls that reach the heap
+class CountingAllocator : public Allocator
+{
+public:
+    byte* allocate(uint64_t sizeInBytes) override
+    {
+        ++allocations;
+        return m_heap.allocate(sizeInBytes);
+    }
+    void deallocate(byte* ptr, uint64_t sizeInBytes) override
+    {
+        ++deallocations;
+        m_heap.deallocate(ptr, sizeInBytes);
+    }
+    unsigned allocations = 0;
+    unsigned deallocations = 0;
+private:
+    AlignedAllocator m_heap;
+};
+
+bool isAligned(const void* ptr, uint64_t alignment)
+{
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+} // anonymous namespace
+
+TEST(AllocatorTest, alignment)
+{
+    AlignedAllocator cacheLine;
+    AlignedAllocator page(kPageSize);
+    AlignedAllocator huge(kCacheLineSize, true);
+    for (uint64_t size : {uint64_t(1), uint64_t(100), uint64_t(4097), kHugePageSize + 1})
+    {
+        byte* a = cacheLine.allocate(size);
+        byte* b = page.allocate(size);
+        byte* c = huge.allocate(size);
+        EXPECT_TRUE(isAligned(a, kCacheLineSize));
+        EXPECT_TRUE(isAligned(b, kPageSize));
+        EXPECT_TRUE(isAligned(c, size >= kHugePageSize ? kHugePageSize : kCacheLineSize));
+        cacheLine.deallocate(a, size);
+        page.deallocate(b, size);
+        huge.deallocate(c, size);
+    }
+    EXPECT_THROW(AlignedAllocator(100), std::invalid_argument);
+}
+
+TEST(AllocatorTest, pool_size_classes)
+{
+    EXPECT_EQ(PoolAllocator::getClassSize(1), 64);
+    EXPECT_EQ(PoolAllocator::getClassSize(64), 64);
+    EXPECT_EQ(PoolAllocator::getClassSize(65), 80);
+    EXPECT_EQ(PoolAllocator::getClassSize(128), 128);
+    EXPECT_EQ(PoolAllocator::getClassSize(129), 160);
+    EXPECT_EQ(PoolAllocator::getClassSize(1000), 1024);
+    EXPECT_EQ(PoolAllocator::getClassSize(1025), 1280);
+    for (uint64_t size = 1; size < 100000; size = size * 3 / 2 + 1)
+    {
+        const uint64_t classSize = PoolAllocator::getClassSize(size);
+        EXPECT_GE(classSize, size);
+        EXPECT_LE(classSize, std::max<uint64_t>(64, size + size / 4 + 1));
+    }
+}
+
+TEST(AllocatorTest, pool_reuses_blocks)
+{
+    CountingAllocator heap;
+    {
+        PoolAllocator pool(heap, 1 << 20, 4 << 20);
+        byte* first = pool.allocate(1000);
+        pool.deallocate(first, 1000);
+        // a size of the same class is served from the cache
+        byte* second = pool.allocate(1010);
+        EXPECT_EQ(first, second);
+        EXPECT_EQ(heap.allocations, 1);
+        pool.deallocate(second, 1010);
+
+        // above the pooled size the pool is bypassed
+        byte* large = pool.allocate(2 << 20);
+        pool.deallocate(large, 2 << 20);
+        EXPECT_EQ(heap.allocations, 2);
+        EXPECT_EQ(heap.deallocations, 1);
+
+        // a block freed on another thread lands in that thread's cache and goes back when it exits
+        byte* block = pool.allocate(5000);
+        std::thread([&]() {pool.deallocate(block, 5000);}).join();
+        EXPECT_EQ(heap.deallocations, 2);
+    }
+    EXPECT_EQ(heap.allocations, heap.deallocations);
+}
+
+TEST(AllocatorTest, data_buffer_uses_allocator)
+{
+    CountingAllocator heap;
+    {
+        DataBuffer buffer(256, heap);
+        EXPECT_TRUE(isAligned(buffer.data(), kCacheLineSize));
+        EXPECT_EQ(buffer.getAllocator(), &heap);
+        DataBuffer copy = buffer.clone();
+        EXPECT_EQ(heap.allocations, 2);
+        // dropping the last reference releases the storage through its own allocator
+        byte external[16];
+        copy = DataBuffer(16, external);
+        EXPECT_EQ(heap.deallocations, 1);
+        buffer = std::move(copy);
+        EXPECT_EQ(heap.deallocations, 2);
+    }
+    EXPECT_EQ(heap.allocations, heap.deallocations);
+}
+
+TEST(AllocatorTest, tensor_allocation)
+{
+    CountingAllocator heap;
+    setDefaultAllocator(&heap);
+    {
+        gTensor tensor({33, 7, 1, 1, 1}, {1, 40, 280, 280, 280}, 5, DType::fp32);
+        tensor.allocateData();
+        EXPECT_EQ(heap.allocations, 1);
+        EXPECT_EQ(tensor.getDataBuffer()->size(), tensor.getMemorySizeInBytes());
+        EXPECT_TRUE(isAligned(tensor.data(), kCacheLineSize));
+        EXPECT_EQ(*reinterpret_cast<float*>(tensor[{32, 6, 0, 0, 0}]), 0.0f);
+    }
+    setDefaultAllocator(nullptr);
+    EXPECT_EQ(heap.deallocations, 1);
+}
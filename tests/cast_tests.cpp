@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+using namespace gblas::test;
+
+class CastTest : public testing::Test
+{
+public:
+    // a tensor holding the given values in element order
+    template<typename T>
+    static gTensor makeVector(const std::vector<T>& values, DType dtype)
+    {
+        gTensor tensor = makeTensor({values.size()}, dtype);
+        std::memcpy(tensor.data(), values.data(), values.size() * sizeof(T));
+        return tensor;
+    }
+
+    // element (r, c, b) of a rank 3 tensor
+    template<typename T>
+    static T at(const gTensor& tensor, uint64_t r, uint64_t c, uint64_t b)
+    {
+        const int64_t row = static_cast<int64_t>(r) * tensor.getStride(0);
+        const int64_t col = static_cast<int64_t>(c) * tensor.getStride(1);
+        return reinterpret_cast<const T*>(tensor.data())[row + col + static_cast<int64_t>(b) * tensor.getStride(2)];
+    }
+
+    template<typename T>
+    static T first(const gTensor& tensor, uint64_t i = 0)
+    {
+        return reinterpret_cast<const T*>(tensor.data())[i];
+    }
+protected:
+    Operations m_ops;
+};
+
+TEST_F(CastTest, layout_change_matches_elementwise)
+{
+    // a column major fp32 batch of matrices becomes row major in the narrow types, every element rounded as
+    // the scalar conversion does; the strided destination takes the untiled path
+    const uint64_t rows = 67, cols = 45, batch = 3;
+    gTensor src = makeTensor({rows, cols, batch}, DType::fp32);
+    float* values = reinterpret_cast<float*>(src.data());
+    for (uint64_t i = 0; i < rows * cols * batch; ++i) values[i] = std::sin(static_cast<float>(i)) * 300.0f;
+    for (RoundingMode rounding : {RoundingMode::NearestEven, RoundingMode::RoundTowardsZero})
+    {
+        for (DType dtype : {DType::bf16, DType::fp16, DType::tf32, DType::fp8_143})
+        {
+            for (bool strided : {false, true})
+            {
+                gTensor dst = makeTensor({cols * (strided ? 2 : 1), rows, batch}, dtype).transpose(0, 1);
+                if (strided) dst = dst.slice(1, 0, cols * 2, 2);
+                ASSERT_EQ(m_ops.cast(src, dst, rounding), gStatus::gBLAS_PASS);
+                gTensor back = makeTensor({rows, cols, batch}, DType::fp32);
+                ASSERT_EQ(m_ops.cast(dst, back), gStatus::gBLAS_PASS);
+                for (uint64_t b = 0; b < batch; ++b)
+                {
+                    for (uint64_t r = 0; r < rows; ++r)
+                    {
+                        for (uint64_t c = 0; c < cols; ++c)
+                        {
+                            const float value = at<float>(src, r, c, b);
+                            float expected = 0.0f;
+                            switch (dtype)
+                            {
+                                case DType::bf16:
+                                    expected = Conversions::bf16_to_fp32(Conversions::fp32_to_bf16(value, rounding));
+                                    ASSERT_EQ(at<uint16_t>(dst, r, c, b), Conversions::fp32_to_bf16(value, rounding));
+                                    break;
+                                case DType::fp16:
+                                    expected = Conversions::fp16_to_fp32(Conversions::fp32_to_fp16(value, rounding));
+                                    break;
+                                case DType::tf32:
+                                    expected = Conversions::tf32_to_fp32(Conversions::fp32_to_tf32(value, rounding));
+                                    break;
+                                default:
+                                    expected = Conversions::fp8_143_to_fp32(Conversions::fp32_to_fp8_143(value,
+                                                                                                          rounding));
+                                    break;
+                            }
+                            ASSERT_EQ(at<float>(back, r, c, b), expected) << static_cast<int>(dtype) << " " << r
+                                                                          << "," << c << "," << b;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // the same dtype only moves the elements
+    gTensor transposed = makeTensor({cols, rows, batch}, DType::fp32).transpose(0, 1);
+    ASSERT_EQ(m_ops.cast(src, transposed), gStatus::gBLAS_PASS);
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        for (uint64_t c = 0; c < cols; ++c)
+        {
+            ASSERT_EQ(at<float>(transposed, r, c, 2), at<float>(src, r, c, 2));
+        }
+    }
+}
+
+TEST_F(CastTest, integers_and_fp64_round_once)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const gTensor wide = makeVector<double>({300.0, -1e9, 2.5, -2.5, nan, 126.7}, DType::fp64);
+    gTensor i8 = makeTensor({6}, DType::int8);
+    ASSERT_EQ(m_ops.cast(wide, i8), gStatus::gBLAS_PASS);
+    const int8_t nearest[6] = {127, -128, 2, -2, 0, 127};
+    for (uint64_t i = 0; i < 6; ++i) EXPECT_EQ(first<int8_t>(i8, i), nearest[i]) << i;
+    ASSERT_EQ(m_ops.cast(wide, i8, RoundingMode::RoundAwayFromZero), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<int8_t>(i8, 2), 3);
+    EXPECT_EQ(first<int8_t>(i8, 3), -3);
+
+    // integers saturate into the narrower type, int64 stays exact
+    const gTensor i32 = makeVector<int32_t>({1000, -1000, 5, std::numeric_limits<int32_t>::max()}, DType::int32);
+    gTensor u8 = makeTensor({4}, DType::uint8);
+    ASSERT_EQ(m_ops.cast(i32, u8), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<uint8_t>(u8, 0), 255);
+    EXPECT_EQ(first<uint8_t>(u8, 1), 0);
+    EXPECT_EQ(first<uint8_t>(u8, 2), 5);
+    const gTensor big = makeVector<int64_t>({(int64_t(1) << 60) + 1}, DType::int64);
+    gTensor same = makeTensor({1}, DType::int64);
+    gTensor i16 = makeTensor({1}, DType::int16);
+    ASSERT_EQ(m_ops.cast(big, same), gStatus::gBLAS_PASS);
+    ASSERT_EQ(m_ops.cast(big, i16), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<int64_t>(same), (int64_t(1) << 60) + 1);
+    EXPECT_EQ(first<int16_t>(i16), std::numeric_limits<int16_t>::max());
+
+    // just above a bf16 tie and just below a bf16 value: rounding to fp32 first would land on the tie and
+    // on the value, and round both the wrong way
+    const gTensor close = makeVector<double>({1.0 + std::ldexp(1.0, -8) + std::ldexp(1.0, -30),
+                                              1.0 + std::ldexp(1.0, -7) - std::ldexp(1.0, -40)}, DType::fp64);
+    gTensor bf16 = makeTensor({2}, DType::bf16);
+    ASSERT_EQ(m_ops.cast(close, bf16), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<uint16_t>(bf16, 0), 0x3F81);
+    ASSERT_EQ(m_ops.cast(close, bf16, RoundingMode::RoundTowardsZero), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<uint16_t>(bf16, 1), 0x3F80);
+    gTensor fp32 = makeTensor({2}, DType::fp32);
+    ASSERT_EQ(m_ops.cast(close, fp32, RoundingMode::RoundUp), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<float>(fp32, 1), 1.0f + std::ldexp(1.0f, -7));
+    ASSERT_EQ(m_ops.cast(close, fp32, RoundingMode::RoundDown), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<float>(fp32, 1), std::nextafter(1.0f + std::ldexp(1.0f, -7), 0.0f));
+
+    // an integer tie in fp16 and a float beyond int16
+    const gTensor odd = makeVector<int32_t>({2049}, DType::int32);
+    gTensor fp16 = makeTensor({1}, DType::fp16);
+    ASSERT_EQ(m_ops.cast(odd, fp16), gStatus::gBLAS_PASS);
+    EXPECT_EQ(Conversions::fp16_to_fp32(first<uint16_t>(fp16)), 2048.0f);
+    ASSERT_EQ(m_ops.cast(odd, fp16, RoundingMode::RoundUp), gStatus::gBLAS_PASS);
+    EXPECT_EQ(Conversions::fp16_to_fp32(first<uint16_t>(fp16)), 2050.0f);
+    const gTensor large = makeVector<float>({40000.0f}, DType::fp32);
+    ASSERT_EQ(m_ops.cast(large, i16), gStatus::gBLAS_PASS);
+    EXPECT_EQ(first<int16_t>(i16), std::numeric_limits<int16_t>::max());
+}
+
+TEST_F(CastTest, invalid_input_fails)
+{
+    const gTensor src = makeTensor({8, 4}, DType::fp32);
+    gTensor other = makeTensor({4, 8}, DType::bf16);
+    EXPECT_EQ(m_ops.cast(src, other), gStatus::gBLAS_FAIL);
+    gTensor unallocated({8, 4, 1, 1, 1}, {1, 8, 32, 32, 32}, 2, DType::bf16);
+    EXPECT_EQ(m_ops.cast(src, unallocated), gStatus::gBLAS_FAIL);
+    gTensor untyped({8, 4, 1, 1, 1}, {1, 8, 32, 32, 32}, 2, DType::dtypeNR);
+    EXPECT_EQ(m_ops.cast(src, untyped), gStatus::gBLAS_FAIL);
+    // a destination sharing the source's storage
+    gTensor alias = src;
+    EXPECT_EQ(m_ops.cast(src, alias), gStatus::gBLAS_FAIL);
+    const gTensor empty = makeTensor({0, 4}, DType::fp32);
+    gTensor emptyDst = makeTensor({0, 4}, DType::int8);
+    EXPECT_EQ(m_ops.cast(empty, emptyDst), gStatus::gBLAS_PASS);
+}
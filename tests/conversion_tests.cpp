@@ -0,0 +1,194 @@
+#include "data_types/conversions.h"
+#include "kernels/kernels.h"
+#include <gtest/gtest.h>
+#include <bit>
+#include <random>
+#include <vector>
+
+using namespace gblas;
+
+namespace {
+
+constexpr RoundingMode kRoundingModes[] = {RoundingMode::NearestEven, RoundingMode::RoundUp, RoundingMode::RoundDown,
+                                           RoundingMode::RoundAwayFromZero, RoundingMode::RoundTowardsZero};
+
+std::vector<const kernels::KernelTable*> availableTables()
+{
+    std::vector<const kernels::KernelTable*> tables;
+    for (unsigned level = 0; level < static_cast<unsigned>(IsaLevel::IsaLevelNR); ++level)
+    {
+        const kernels::KernelTable* table = kernels::getKernelTable(static_cast<IsaLevel>(level));
+        if (table) tables.push_back(table);
+    }
+    return tables;
+}
+
+// random bit patterns plus the values sitting on every rounding and range boundary of the narrow types.
+// the odd length leaves a tail for the vector kernels.
+std::vector<float> conversionInputs()
+{
+    std::vector<uint32_t> bits = {0x00000000, 0x80000000, 0x7F800000, 0xFF800000, 0x7FC00000, 0xFFC00000,
+                                  0x7F800001, 0xFF812345, 0x7F7FFFFF, 0xFF7FFFFF, 0x00000001, 0x807FFFFF,
+                                  0x3F808000, 0x3F818000, 0x3F800001, 0xBF808000, 0x477FF000, 0x477FE000,
+                                  0x477FEFFF, 0x33000000, 0x33000001, 0x387FC000, 0x38800000, 0xB8801000,
+                                  0x47700000, 0x47600001, 0x43700000, 0x43780000, 0x3C800000, 0x3C7FFFFF,
+                                  0x3F801000, 0x3F803000, 0x3F802FFF, 0xBF801001, 0x7F7FF000, 0x7F7FEFFF};
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint32_t> anyBits;
+    // mostly exponents in the range of the narrow types, where the rounding happens
+    std::uniform_int_distribution<uint32_t> exponent(100, 150);
+    for (unsigned i = 0; i < 4000; ++i)
+    {
+        uint32_t value = anyBits(gen);
+        if (i % 4 != 0) value = (value & 0x807FFFFF) | (exponent(gen) << 23);
+        bits.push_back(value);
+    }
+    bits.push_back(0x3F800000);
+    std::vector<float> values;
+    for (uint32_t b : bits) values.push_back(std::bit_cast<float>(b));
+    return values;
+}
+
+template<typename Storage, typename Bulk, typename Scalar>
+void expectNarrowMatches(Bulk bulk, Scalar scalar, IsaLevel isa)
+{
+    const std::vector<float> inputs = conversionInputs();
+    std::vector<Storage> result(inputs.size());
+    for (RoundingMode rounding : kRoundingModes)
+    {
+        bulk(inputs.size(), inputs.data(), result.data(), rounding);
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            ASSERT_EQ(result[i], scalar(inputs[i], rounding)) << "input 0x" << std::hex << std::bit_cast<uint32_t>(inputs[i])
+                << " rounding " << static_cast<int>(rounding) << " isa " << isaLevelName(isa);
+        }
+    }
+}
+
+// decodes every encoding and compares the bits, so NaN and signed zero are checked as well
+template<typename Storage, typename Bulk, typename Scalar>
+void expectWidenMatches(Bulk bulk, Scalar scalar, IsaLevel isa)
+{
+    std::vector<Storage> inputs;
+    for (uint32_t value = 0; value <= std::numeric_limits<Storage>::max(); ++value) inputs.push_back(static_cast<Storage>(value));
+    std::vector<float> result(inputs.size());
+    bulk(inputs.size(), inputs.data(), result.data());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        ASSERT_EQ(std::bit_cast<uint32_t>(result[i]), std::bit_cast<uint32_t>(scalar(inputs[i])))
+            << "input 0x" << std::hex << static_cast<uint32_t>(inputs[i]) << " isa " << isaLevelName(isa);
+    }
+}
+
+} // anonymous namespace
+
+TEST(BulkConversionTest, narrowingMatchesScalar)
+{
+    for (const kernels::KernelTable* table : availableTables())
+    {
+        expectNarrowMatches<uint16_t>(table->f32ToBf16, [](float v, RoundingMode r) {return Conversions::fp32_to_bf16(v, r);}, table->isa);
+        expectNarrowMatches<uint16_t>(table->f32ToFp16, [](float v, RoundingMode r) {return Conversions::fp32_to_fp16(v, r);}, table->isa);
+        expectNarrowMatches<uint32_t>(table->f32ToTf32, [](float v, RoundingMode r) {return Conversions::fp32_to_tf32(v, r);}, table->isa);
+        expectNarrowMatches<uint8_t>(table->f32ToFp8_152, [](float v, RoundingMode r) {return Conversions::fp32_to_fp8_152(v, r);}, table->isa);
+        expectNarrowMatches<uint8_t>(table->f32ToFp8_143, [](float v, RoundingMode r) {return Conversions::fp32_to_fp8_143(v, r);}, table->isa);
+    }
+}
+
+TEST(BulkConversionTest, wideningMatchesScalar)
+{
+    for (const kernels::KernelTable* table : availableTables())
+    {
+        expectWidenMatches<uint16_t>(table->bf16ToF32, [](uint16_t v) {return Conversions::bf16_to_fp32(v);}, table->isa);
+        expectWidenMatches<uint16_t>(table->fp16ToF32, [](uint16_t v) {return Conversions::fp16_to_fp32(v);}, table->isa);
+        expectWidenMatches<uint8_t>(table->fp8_152ToF32, [](uint8_t v) {return Conversions::fp8_152_to_fp32(v);}, table->isa);
+        expectWidenMatches<uint8_t>(table->fp8_143ToF32, [](uint8_t v) {return Conversions::fp8_143_to_fp32(v);}, table->isa);
+    }
+}
+
+namespace {
+
+// decodes an E/M minifloat with plain arithmetic, independent of the precomputed tables
+template<unsigned E, unsigned M>
+float referenceDecode(uint32_t bits)
+{
+    const int bias = (1 << (E - 1)) - 1;
+    const uint32_t exponent = (bits >> M) & ((1u << E) - 1);
+    const uint32_t mantissa = bits & ((1u << M) - 1);
+    const float sign = (bits >> (E + M)) & 1 ? -1.0f : 1.0f;
+    if (exponent == (1u << E) - 1) return mantissa ? std::numeric_limits<float>::quiet_NaN() : sign * INFINITY;
+    if (exponent == 0) return sign * std::ldexp(static_cast<float>(mantissa), 1 - bias - static_cast<int>(M));
+    return sign * std::ldexp(static_cast<float>(mantissa | (1u << M)), static_cast<int>(exponent) - bias - static_cast<int>(M));
+}
+
+template<unsigned E, unsigned M, size_t N>
+void expectTableMatchesReference(const std::array<uint32_t, N>& table)
+{
+    for (uint32_t bits = 0; bits < N; ++bits)
+    {
+        const float expected = referenceDecode<E, M>(bits);
+        if (std::isnan(expected))
+        {
+            ASSERT_EQ(table[bits], 0x7FC00000u) << "encoding 0x" << std::hex << bits;
+            continue;
+        }
+        ASSERT_EQ(table[bits], std::bit_cast<uint32_t>(expected)) << "encoding 0x" << std::hex << bits;
+    }
+}
+
+} // anonymous namespace
+
+TEST(DecodeTableTest, matchesArithmeticDecode)
+{
+    expectTableMatchesReference<5, 10>(kFp16DecodeTable);
+    expectTableMatchesReference<5, 2>(kFp8_152DecodeTable);
+    expectTableMatchesReference<4, 3>(kFp8_143DecodeTable);
+    static_assert(kFp8_143DecodeTable[0x38] == 0x3F800000u);
+    static_assert(kFp8_152DecodeTable[0xBC] == 0xBF800000u);
+}
+
+TEST(BulkConversionTest, arrayApiRoundTrips)
+{
+    const std::vector<float> inputs = {1.0f, -2.5f, 0.0f, 448.0f, 3.0e-5f, -65504.0f, 0.1f};
+    std::vector<uint16_t> halves(inputs.size());
+    std::vector<float> decoded(inputs.size());
+    Conversions::fp32_to_fp16(inputs.data(), halves.data(), inputs.size(), RoundingMode::NearestEven);
+    Conversions::fp16_to_fp32(halves.data(), decoded.data(), decoded.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        EXPECT_EQ(halves[i], Conversions::fp32_to_fp16(inputs[i], RoundingMode::NearestEven));
+        EXPECT_NEAR(decoded[i], inputs[i], std::abs(inputs[i]) * 1e-3f + 1e-7f);
+    }
+
+    std::vector<uint32_t> tf32(inputs.size());
+    Conversions::fp32_to_tf32(inputs.data(), tf32.data(), inputs.size(), RoundingMode::RoundTowardsZero);
+    Conversions::tf32_to_fp32(tf32.data(), decoded.data(), decoded.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        EXPECT_EQ(std::bit_cast<uint32_t>(decoded[i]), std::bit_cast<uint32_t>(inputs[i]) & 0xFFFFE000);
+    }
+}
+
+TEST(ScalarConversionTest, roundingEdgeCases)
+{
+    // bf16 ties go to even and round away from zero increments the magnitude once
+    EXPECT_EQ(Conversions::fp32_to_bf16(std::bit_cast<float>(0x3F808000u), RoundingMode::NearestEven), 0x3F80);
+    EXPECT_EQ(Conversions::fp32_to_bf16(std::bit_cast<float>(0x3F818000u), RoundingMode::NearestEven), 0x3F82);
+    EXPECT_EQ(Conversions::fp32_to_bf16(std::bit_cast<float>(0x3F800001u), RoundingMode::RoundAwayFromZero), 0x3F81);
+    EXPECT_EQ(Conversions::fp32_to_bf16(std::bit_cast<float>(0xBF800001u), RoundingMode::RoundDown), 0xBF81);
+    // a NaN with its payload in the low half must not become inf
+    EXPECT_EQ(Conversions::fp32_to_bf16(std::bit_cast<float>(0x7F800001u), RoundingMode::NearestEven), 0x7FC0);
+    // the smallest fp16 subnormal and the rounding into it
+    EXPECT_EQ(Conversions::fp32_to_fp16(std::ldexp(1.0f, -24), RoundingMode::NearestEven), 0x0001);
+    EXPECT_EQ(Conversions::fp32_to_fp16(std::ldexp(1.5f, -24), RoundingMode::NearestEven), 0x0002);
+    EXPECT_EQ(Conversions::fp32_to_fp16(std::ldexp(1.0f, -15), RoundingMode::NearestEven), 0x0200);
+    // tf32 keeps 10 mantissa bits and carries into the exponent
+    EXPECT_EQ(Conversions::fp32_to_tf32(std::bit_cast<float>(0x3F801000u), RoundingMode::NearestEven), 0x3F800000u);
+    EXPECT_EQ(Conversions::fp32_to_tf32(std::bit_cast<float>(0x3F803000u), RoundingMode::NearestEven), 0x3F804000u);
+    EXPECT_EQ(Conversions::fp32_to_tf32(std::bit_cast<float>(0x3FFFF001u), RoundingMode::RoundUp), 0x40000000u);
+    // fp8 overflow saturates to the inf encoding of each format
+    EXPECT_EQ(Conversions::fp32_to_fp8_152(1.0e6f, RoundingMode::NearestEven), 0x7C);
+    EXPECT_EQ(Conversions::fp32_to_fp8_152(-1.0e6f, RoundingMode::NearestEven), 0xFC);
+    EXPECT_EQ(Conversions::fp32_to_fp8_143(1000.0f, RoundingMode::NearestEven), 0x78);
+    EXPECT_EQ(Conversions::fp32_to_fp8_143(1.0625f, RoundingMode::NearestEven), 0x38);
+    EXPECT_EQ(Conversions::fp32_to_fp8_143(1.0625f, RoundingMode::RoundUp), 0x39);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "runtime/CpuFeatures.h"
+#include "kernels/kernels.h"
+#include <cstdlib>
+
+using namespace gblas;
+
+TEST(CpuFeaturesTest, level_names_round_trip)
+{
+    for (int level = 0; level < static_cast<int>(IsaLevel::IsaLevelNR); ++level)
+    {
+        EXPECT_EQ(getIsaLevelByName(isaLevelName(static_cast<IsaLevel>(level))), static_cast<IsaLevel>(level));
+    }
+    EXPECT_EQ(getIsaLevelByName("avx1024"), IsaLevel::IsaLevelNR);
+    EXPECT_EQ(getIsaLevelByName(""), IsaLevel::IsaLevelNR);
+}
+
+TEST(CpuFeaturesTest, supported_levels_have_their_tables)
+{
+    EXPECT_TRUE(isIsaLevelSupported(IsaLevel::Scalar));
+    EXPECT_TRUE(isIsaLevelSupported(getHostIsaLevel()));
+    // every level builds on the ones it extends
+    if (isIsaLevelSupported(IsaLevel::AVX512))
+    {
+        EXPECT_TRUE(isIsaLevelSupported(IsaLevel::AVX2));
+    }
+    if (isIsaLevelSupported(IsaLevel::AVX512VNNI))
+    {
+        EXPECT_TRUE(isIsaLevelSupported(IsaLevel::AVX512));
+    }
+    if (isIsaLevelSupported(IsaLevel::AVX2VNNI))
+    {
+        EXPECT_TRUE(isIsaLevelSupported(IsaLevel::AVX2));
+    }
+    if (isIsaLevelSupported(IsaLevel::AVX2))
+    {
+        EXPECT_TRUE(getCpuFeatures().sse42);
+    }
+    for (int level = 0; level < static_cast<int>(IsaLevel::IsaLevelNR); ++level)
+    {
+        const kernels::KernelTable* table = kernels::getKernelTable(static_cast<IsaLevel>(level));
+        if (!isIsaLevelSupported(static_cast<IsaLevel>(level)))
+        {
+            EXPECT_EQ(table, nullptr);
+        }
+        if (table)
+        {
+            EXPECT_EQ(table->isa, static_cast<IsaLevel>(level));
+        }
+    }
+}
+
+TEST(CpuFeaturesTest, dispatch_follows_the_environment)
+{
+    // ctest runs the suite again with GBLAS_ISA set
+    const char* value = std::getenv("GBLAS_ISA");
+    const IsaLevel requested = value ? getIsaLevelByName(value) : IsaLevel::IsaLevelNR;
+    IsaLevel expected = getHostIsaLevel();
+    if (requested < expected)
+    {
+        expected = requested;
+        while (!isIsaLevelSupported(expected)) expected = static_cast<IsaLevel>(static_cast<int>(expected) - 1);
+    }
+    EXPECT_EQ(getDispatchIsaLevel(), expected);
+    if (kernels::getKernelTable(expected))
+    {
+        EXPECT_EQ(kernels::getKernelTable().isa, expected);
+    }
+}
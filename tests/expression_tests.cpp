@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/expression.h"
+#include "operations/operations.h"
+#include <cmath>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+using namespace gblas::test;
+
+class ExpressionTest : public testing::Test
+{
+public:
+    static float* fp32(gTensor& tensor) {return reinterpret_cast<float*>(tensor.data());}
+};
+
+TEST_F(ExpressionTest, fused_result_matches_separate_passes)
+{
+    const uint64_t cols = 300, rows = 70;
+    gTensor a = makeMatrix(rows, cols, DType::fp32);
+    gTensor x = makeMatrix(rows, cols, DType::fp32);
+    // a padded out and a transposed view make the walk stage some operands and not others
+    gTensor out = makeMatrix(rows, cols, DType::fp32, Layout::RowMajor, 5);
+    gTensor zT = makeMatrix(cols, rows, DType::fp32);
+    gTensor z = zT.transpose(0, 1);
+    for (uint64_t i = 0; i < cols * rows; ++i)
+    {
+        fp32(a)[i] = static_cast<float>(i % 19) - 9.0f;
+        fp32(x)[i] = 0.25f * static_cast<float>(i % 7);
+        fp32(zT)[i] = static_cast<float>(i % 5) - 2.5f;
+    }
+    using namespace expr;
+    ASSERT_EQ(evaluate(out, relu(0.5f * ref(a) + ref(x) * ref(z)) - 1.0, RoundingMode::NearestEven),
+              gStatus::gBLAS_PASS);
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        for (uint64_t c = 0; c < cols; ++c)
+        {
+            const uint64_t i = r * cols + c;
+            const float fused = 0.5f * fp32(a)[i] + fp32(x)[i] * fp32(zT)[c * rows + r];
+            ASSERT_EQ(fp32(out)[r * (cols + 5) + c], std::max(fused, 0.0f) - 1.0f) << c << ", " << r;
+        }
+    }
+
+    // the same chain as separate operations agrees to the rounding of the intermediates
+    gTensor y = a.clone();
+    Operations ops;
+    ASSERT_EQ(ops.axpy(2.0, x, a, y), gStatus::gBLAS_PASS);
+    ASSERT_EQ(ops.scal(-0.5, y), gStatus::gBLAS_PASS);
+    ASSERT_EQ(evaluate(out, -(2.0f * ref(x) + ref(a)) / 2), gStatus::gBLAS_PASS);
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        for (uint64_t c = 0; c < cols; ++c) ASSERT_EQ(fp32(out)[r * (cols + 5) + c], fp32(y)[r * cols + c]);
+    }
+}
+
+TEST_F(ExpressionTest, conversions_fuse_into_the_store)
+{
+    const uint64_t cols = 1100, rows = 3;
+    gTensor x = makeMatrix(rows, cols, DType::bf16);
+    gTensor scale = makeMatrix(rows, cols, DType::fp8_143);
+    gTensor out = makeMatrix(rows, cols, DType::fp16);
+    gTensor rounded = makeMatrix(rows, cols, DType::bf16);
+    auto* xData = reinterpret_cast<uint16_t*>(x.data());
+    std::vector<float> xs(cols * rows), scales(cols * rows);
+    for (uint64_t i = 0; i < cols * rows; ++i)
+    {
+        xData[i] = Conversions::fp32_to_bf16(static_cast<float>(i) * 0.013f - 7.0f, RoundingMode::NearestEven);
+        scale.data()[i] = Conversions::fp32_to_fp8_143(1.0f + static_cast<float>(i % 4) * 0.25f,
+                                                      RoundingMode::NearestEven);
+        xs[i] = Conversions::bf16_to_fp32(xData[i]);
+        scales[i] = Conversions::fp8_143_to_fp32(scale.data()[i]);
+    }
+    using namespace expr;
+    ASSERT_EQ(evaluate(out, abs(ref(x)) * ref(scale) + 0.1f), gStatus::gBLAS_PASS);
+    ASSERT_EQ(evaluate(rounded, ref(x) / 3.0f, RoundingMode::RoundTowardsZero), gStatus::gBLAS_PASS);
+    const auto* outData = reinterpret_cast<const uint16_t*>(out.data());
+    const auto* roundedData = reinterpret_cast<const uint16_t*>(rounded.data());
+    for (uint64_t i = 0; i < cols * rows; ++i)
+    {
+        // computed in fp32 and rounded once, on the store
+        const float expected = std::fabs(xs[i]) * scales[i] + 0.1f;
+        ASSERT_EQ(outData[i], Conversions::fp32_to_fp16(expected, RoundingMode::NearestEven)) << i;
+        ASSERT_EQ(roundedData[i], Conversions::fp32_to_bf16(xs[i] / 3.0f, RoundingMode::RoundTowardsZero)) << i;
+    }
+}
+
+TEST_F(ExpressionTest, in_place_and_invalid_operands)
+{
+    gTensor x = makeMatrix(10, 40, DType::fp32);
+    for (uint64_t i = 0; i < 400; ++i) fp32(x)[i] = static_cast<float>(i);
+    using namespace expr;
+    ASSERT_EQ(evaluate(x, minimum(ref(x) * ref(x), 1000.0f)), gStatus::gBLAS_PASS);
+    EXPECT_EQ(fp32(x)[20], 400.0f);
+    EXPECT_EQ(fp32(x)[50], 1000.0f);
+    ASSERT_EQ(evaluate(x, Scalar{{}, 3.0f}), gStatus::gBLAS_PASS);
+    EXPECT_EQ(fp32(x)[399], 3.0f);
+
+    gTensor other = makeMatrix(11, 40, DType::fp32);
+    gTensor doubles = makeMatrix(10, 40, DType::fp64);
+    gTensor ints = makeMatrix(10, 40, DType::int32);
+    EXPECT_EQ(evaluate(x, ref(x) + ref(other)), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(evaluate(x, ref(doubles) * 2), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(evaluate(ints, ref(x) * 2), gStatus::gBLAS_FAIL);
+}
@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "kernels/kernels.h"
+#include "runtime/CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+
+class Int8GemmTest : public testing::Test
+{
+public:
+    // rows x cols matrix filled over the whole range of its dtype, the leading dimension is padded by `pad`
+    gTensor makeMatrix(uint64_t rows, uint64_t cols, DType dtype, Layout layout = Layout::RowMajor, uint64_t pad = 0)
+    {
+        gTensor tensor = test::makeMatrix(rows, cols, dtype, layout, pad);
+        std::uniform_int_distribution<int> dist(-128, 127);
+        const uint64_t elements = tensor.getMemorySizeInBytes() / getSingleElementSizeInBytes(dtype);
+        for (uint64_t i = 0; i < elements; ++i)
+        {
+            const int value = dist(m_rng);
+            if (dtype == DType::int32) reinterpret_cast<int32_t*>(tensor.data())[i] = value * 1000;
+            else tensor.data()[i] = static_cast<byte>(value);
+        }
+        return tensor;
+    }
+
+    // element (r, c) of op(tensor) widened to int64
+    static int64_t at(const gTensor& tensor, uint64_t r, uint64_t c, bool transpose = false)
+    {
+        if (transpose) std::swap(r, c);
+        const bool rowMajor = tensor.getLayout() == Layout::RowMajor;
+        const int64_t offset = static_cast<int64_t>(rowMajor ? c : r) + static_cast<int64_t>(rowMajor ? r : c) * tensor.getStride(1);
+        switch (tensor.getDType())
+        {
+            case DType::uint8: return reinterpret_cast<const uint8_t*>(tensor.data())[offset];
+            case DType::int8: return reinterpret_cast<const int8_t*>(tensor.data())[offset];
+            default: return reinterpret_cast<const int32_t*>(tensor.data())[offset];
+        }
+    }
+
+    static std::vector<int64_t> reference(const gTensor& a, const gTensor& b, uint64_t m, uint64_t n, uint64_t k,
+                                          bool transA, bool transB)
+    {
+        std::vector<int64_t> product(m * n, 0);
+        for (uint64_t i = 0; i < m; ++i)
+        {
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                for (uint64_t p = 0; p < k; ++p) product[i * n + j] += at(a, i, p, transA) * at(b, p, j, transB);
+            }
+        }
+        return product;
+    }
+protected:
+    Operations m_ops;
+    std::mt19937 m_rng{11};
+};
+
+TEST_F(Int8GemmTest, int32_results_are_exact)
+{
+    struct Case
+    {
+        uint64_t m, n, k;
+        DType aType;
+        Layout layoutC;
+        bool transA, transB;
+        double alpha, beta;
+    };
+    // odd sizes reach the partial tiles, k = 1601 takes several depth blocks and pads the last one
+    const Case cases[] = {
+        {37, 45, 29, DType::uint8, Layout::RowMajor, false, false, 1.0, 0.0},
+        {37, 45, 29, DType::int8, Layout::RowMajor, true, false, 1.0, 1.0},
+        {20, 70, 1601, DType::int8, Layout::RowMajor, false, true, 1.0, 0.0},
+        {20, 70, 1601, DType::uint8, Layout::ColMajor, true, true, 1.0, 1.0},
+        {13, 33, 65, DType::int8, Layout::ColMajor, false, false, 3.0, -2.0},
+        {64, 64, 64, DType::uint8, Layout::RowMajor, false, false, -1.0, 2.0},
+    };
+    for (const Case& t : cases)
+    {
+        const gTensor a = t.transA ? makeMatrix(t.k, t.m, t.aType, Layout::ColMajor, 3)
+                                   : makeMatrix(t.m, t.k, t.aType, Layout::RowMajor, 3);
+        const gTensor b = t.transB ? makeMatrix(t.n, t.k, DType::int8, Layout::RowMajor, 1)
+                                   : makeMatrix(t.k, t.n, DType::int8, Layout::ColMajor, 1);
+        gTensor c = makeMatrix(t.m, t.n, DType::int32, t.layoutC, 2);
+        const gTensor original = c.clone();
+        ASSERT_EQ(m_ops.gemm(a, b, c, t.alpha, t.beta, t.transA, t.transB), gStatus::gBLAS_PASS);
+        const std::vector<int64_t> product = reference(a, b, t.m, t.n, t.k, t.transA, t.transB);
+        for (uint64_t i = 0; i < t.m; ++i)
+        {
+            for (uint64_t j = 0; j < t.n; ++j)
+            {
+                const int64_t expected = static_cast<int64_t>(t.alpha) * product[i * t.n + j] +
+                                         static_cast<int64_t>(t.beta) * at(original, i, j);
+                ASSERT_EQ(at(c, i, j), expected) << t.m << "x" << t.n << "x" << t.k << " at " << i << "," << j;
+            }
+        }
+    }
+}
+
+TEST_F(Int8GemmTest, every_supported_level_agrees)
+{
+    // the extremes of both operands, where a saturating pair sum would show
+    const uint64_t k = 128;
+    const auto valueA = [](uint64_t r, uint64_t p) {return (r + p) % 3 ? uint8_t(255) : static_cast<uint8_t>(r * 7 + p);};
+    const auto valueB = [](uint64_t p, uint64_t j) {return (p + j) % 5 ? int8_t(-128) : static_cast<int8_t>(p * 13 + j);};
+    for (int level = 0; level < static_cast<int>(IsaLevel::IsaLevelNR); ++level)
+    {
+        const kernels::KernelTable* table = kernels::getKernelTable(static_cast<IsaLevel>(level));
+        if (!table) continue;
+        const kernels::GemmI8Kernel& kernel = table->gemmI8;
+        ASSERT_EQ(k % kernel.depthAlign, 0u) << isaLevelName(table->isa);
+        // the panel layouts of kernels.h
+        std::vector<uint8_t> a(kernel.mr * k);
+        std::vector<int8_t> b(kernel.nr * k);
+        for (uint64_t p = 0; p < k; ++p)
+        {
+            for (unsigned r = 0; r < kernel.mr; ++r)
+            {
+                a[kernel.rowPanelA ? r * k + p : ((p / 4) * kernel.mr + r) * 4 + p % 4] = valueA(r, p);
+            }
+            for (unsigned j = 0; j < kernel.nr; ++j) b[((p / 4) * kernel.nr + j) * 4 + p % 4] = valueB(p, j);
+        }
+        std::vector<int32_t> offsets(kernel.nr);
+        for (unsigned j = 0; j < kernel.nr; ++j) offsets[j] = static_cast<int32_t>(j) * 1000 - 7000;
+        for (bool accumulate : {false, true})
+        {
+            std::vector<int32_t> result(kernel.mr * kernel.nr, 5);
+            kernel.microKernel(k, a.data(), b.data(), result.data(), kernel.nr, offsets.data(), accumulate);
+            for (unsigned r = 0; r < kernel.mr; ++r)
+            {
+                for (unsigned j = 0; j < kernel.nr; ++j)
+                {
+                    int32_t expected = offsets[j] + (accumulate ? 5 : 0);
+                    for (uint64_t p = 0; p < k; ++p) expected += valueA(r, p) * valueB(p, j);
+                    ASSERT_EQ(result[r * kernel.nr + j], expected) << isaLevelName(table->isa) << " " << r << "," << j;
+                }
+            }
+        }
+        EXPECT_EQ(kernel.kc % kernel.depthAlign, 0u) << isaLevelName(table->isa);
+    }
+}
+
+TEST_F(Int8GemmTest, requantized_output)
+{
+    const uint64_t m = 19, n = 40;
+    for (uint64_t k : {uint64_t(0), uint64_t(48), uint64_t(1700)})
+    {
+        for (DType cType : {DType::int8, DType::uint8})
+        {
+            const gTensor a = makeMatrix(m, k, DType::uint8);
+            const gTensor b = makeMatrix(k, n, DType::int8);
+            gTensor c = makeMatrix(m, n, cType, Layout::ColMajor);
+            std::vector<float> scales(n);
+            std::vector<int32_t> bias(n);
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                scales[j] = 1.0f / static_cast<float>(256 + 64 * j);
+                bias[j] = static_cast<int32_t>(j * 777) - 9000;
+            }
+            Requantization rq;
+            rq.scales = scales.data();
+            rq.perColumn = true;
+            rq.bias = bias.data();
+            rq.zeroPoint = cType == DType::int8 ? -3 : 120;
+            // one bound tighter than the dtype, the other left to it
+            rq.min = cType == DType::int8 ? -100 : -1000;
+            rq.max = cType == DType::int8 ? 1000 : 200;
+            ASSERT_EQ(m_ops.gemmRequantized(a, b, c, rq), gStatus::gBLAS_PASS);
+            const std::vector<int64_t> product = reference(a, b, m, n, k, false, false);
+            const int64_t low = std::max<int64_t>(rq.min, cType == DType::int8 ? -128 : 0);
+            const int64_t high = std::min<int64_t>(rq.max, cType == DType::int8 ? 127 : 255);
+            for (uint64_t i = 0; i < m; ++i)
+            {
+                for (uint64_t j = 0; j < n; ++j)
+                {
+                    const float scaled = static_cast<float>(product[i * n + j] + bias[j]) * scales[j];
+                    const int64_t expected = std::clamp<int64_t>(static_cast<int64_t>(std::nearbyint(scaled)) +
+                                                                 rq.zeroPoint, low, high);
+                    ASSERT_EQ(at(c, i, j), expected) << k << " " << i << "," << j;
+                }
+            }
+        }
+    }
+
+    // a bias at the limits of int32 is added to the accumulator without wrapping
+    const gTensor a = makeMatrix(m, 48, DType::uint8);
+    const gTensor b = makeMatrix(48, n, DType::int8);
+    gTensor c = makeMatrix(m, n, DType::int8);
+    std::vector<int32_t> bias(n);
+    for (uint64_t j = 0; j < n; ++j)
+    {
+        bias[j] = j % 2 ? std::numeric_limits<int32_t>::max() : std::numeric_limits<int32_t>::min();
+    }
+    const float scale = 1.0f / (1 << 24);
+    Requantization rq;
+    rq.scales = &scale;
+    rq.bias = bias.data();
+    ASSERT_EQ(m_ops.gemmRequantized(a, b, c, rq), gStatus::gBLAS_PASS);
+    const std::vector<int64_t> product = reference(a, b, m, n, 48, false, false);
+    for (uint64_t i = 0; i < m; ++i)
+    {
+        for (uint64_t j = 0; j < n; ++j)
+        {
+            const float scaled = static_cast<float>(product[i * n + j] + bias[j]) * scale;
+            ASSERT_EQ(at(c, i, j), std::clamp<int64_t>(static_cast<int64_t>(std::nearbyint(scaled)), -128, 127));
+        }
+    }
+}
+
+TEST_F(Int8GemmTest, invalid_types_fail)
+{
+    const gTensor u8 = makeMatrix(8, 8, DType::uint8);
+    const gTensor s8 = makeMatrix(8, 8, DType::int8);
+    gTensor i32 = makeMatrix(8, 8, DType::int32);
+    gTensor out8 = makeMatrix(8, 8, DType::int8);
+    gTensor f32({8, 8, 1, 1, 1}, {1, 8, 64, 64, 64}, 2, DType::fp32);
+    f32.allocateData();
+    // B must be signed, C int32 without a requantization and 8 bits with one
+    EXPECT_EQ(m_ops.gemm(s8, u8, i32), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemm(u8, s8, f32), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemm(u8, s8, out8), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemm(f32, s8, i32), gStatus::gBLAS_FAIL);
+    // alpha and beta are truncated to int32 and must fit it
+    EXPECT_EQ(m_ops.gemm(u8, s8, i32, 2.9, -1.5), gStatus::gBLAS_PASS);
+    for (double bad : {std::nan(""), std::numeric_limits<double>::infinity(), 3e9, -3e9})
+    {
+        EXPECT_EQ(m_ops.gemm(u8, s8, i32, bad, 0.0), gStatus::gBLAS_FAIL);
+        EXPECT_EQ(m_ops.gemm(u8, s8, i32, 1.0, bad), gStatus::gBLAS_FAIL);
+    }
+    const float scale = 0.5f;
+    Requantization rq;
+    EXPECT_EQ(m_ops.gemmRequantized(u8, s8, out8, rq), gStatus::gBLAS_FAIL);
+    rq.scales = &scale;
+    EXPECT_EQ(m_ops.gemmRequantized(u8, s8, i32, rq), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemmRequantized(u8, s8, out8, rq), gStatus::gBLAS_PASS);
+    // scales without an integer to round to
+    for (float bad : {std::nanf(""), INFINITY})
+    {
+        std::vector<float> scales(8, 0.5f);
+        scales[5] = bad;
+        rq.scales = scales.data();
+        rq.perColumn = true;
+        EXPECT_EQ(m_ops.gemmRequantized(u8, s8, out8, rq), gStatus::gBLAS_FAIL);
+        rq.perColumn = false;
+        rq.scales = &scales[5];
+        EXPECT_EQ(m_ops.gemmRequantized(u8, s8, out8, rq), gStatus::gBLAS_FAIL);
+    }
+}
@@ -0,0 +1,543 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "data_types/non_conventional_dtypes.h"
+#include "runtime/Parallel.h"
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+
+template<typename T>
+class GemmTest : public testing::Test
+{
+public:
+    static constexpr DType dtype = std::is_same_v<T, float> ? DType::fp32 : DType::fp64;
+
+    // rows x cols matrix, the leading dimension is padded by `pad` elements to exercise strides.
+    // the tensor owns the buffer.
+    T* allocateMatrix(gTensor& tensor, uint64_t rows, uint64_t cols, Layout layout, uint64_t pad = 0)
+    {
+        tensor = test::makeMatrix(rows, cols, dtype, layout, pad);
+        const uint64_t elements = tensor.getMemorySizeInBytes() / sizeof(T);
+        T* data = reinterpret_cast<T*>(tensor.data());
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (uint64_t i = 0; i < elements; ++i) data[i] = static_cast<T>(dist(m_rng));
+        return data;
+    }
+
+    static T& at(T* data, const gTensor& tensor, uint64_t r, uint64_t c)
+    {
+        const bool rowMajor = tensor.getLayout() == Layout::RowMajor;
+        return data[(rowMajor ? c : r) + (rowMajor ? r : c) * tensor.getStride(1)];
+    }
+
+    void runAndCompare(uint64_t m, uint64_t n, uint64_t k, Layout layoutA, Layout layoutB, Layout layoutC,
+                       bool transA, bool transB, double alpha, double beta)
+    {
+        gTensor a, b, c;
+        T* aData = transA ? allocateMatrix(a, k, m, layoutA, 3) : allocateMatrix(a, m, k, layoutA, 3);
+        T* bData = transB ? allocateMatrix(b, n, k, layoutB, 1) : allocateMatrix(b, k, n, layoutB, 1);
+        T* cData = allocateMatrix(c, m, n, layoutC, 2);
+        std::vector<double> expected(m * n);
+        for (uint64_t i = 0; i < m; ++i)
+        {
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                double sum = 0;
+                for (uint64_t p = 0; p < k; ++p)
+                {
+                    const double av = transA ? at(aData, a, p, i) : at(aData, a, i, p);
+                    const double bv = transB ? at(bData, b, j, p) : at(bData, b, p, j);
+                    sum += av * bv;
+                }
+                expected[i * n + j] = alpha * sum + beta * at(cData, c, i, j);
+            }
+        }
+        ASSERT_EQ(m_ops.gemm(a, b, c, alpha, beta, transA, transB), gStatus::gBLAS_PASS);
+        const double tolerance = (std::is_same_v<T, float> ? 1e-5 : 1e-12) * static_cast<double>(k + 1);
+        for (uint64_t i = 0; i < m; ++i)
+        {
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                ASSERT_NEAR(at(cData, c, i, j), expected[i * n + j], tolerance) << "at (" << i << ", " << j << ")";
+            }
+        }
+    }
+protected:
+    Operations m_ops;
+    std::mt19937 m_rng{42};
+};
+
+using gemmTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(GemmTest, gemmTypes);
+
+TYPED_TEST(GemmTest, row_major_odd_sizes)
+{
+    this->runAndCompare(37, 53, 29, Layout::RowMajor, Layout::RowMajor, Layout::RowMajor, false, false, 1.0, 0.0);
+}
+
+TYPED_TEST(GemmTest, col_major_with_beta)
+{
+    this->runAndCompare(45, 31, 70, Layout::ColMajor, Layout::ColMajor, Layout::ColMajor, false, false, 0.5, 2.0);
+}
+
+TYPED_TEST(GemmTest, transposes_and_mixed_layouts)
+{
+    for (bool transA : {false, true})
+    {
+        for (bool transB : {false, true})
+        {
+            this->runAndCompare(19, 23, 17, Layout::ColMajor, Layout::RowMajor, Layout::RowMajor, transA, transB,
+                                1.5, -1.0);
+            this->runAndCompare(19, 23, 17, Layout::RowMajor, Layout::ColMajor, Layout::ColMajor, transA, transB,
+                                1.0, 1.0);
+        }
+    }
+}
+
+TYPED_TEST(GemmTest, multiple_cache_blocks)
+{
+    // larger than one kc and nc block and big enough to run threaded
+    this->runAndCompare(301, 3200, 520, Layout::RowMajor, Layout::RowMajor, Layout::RowMajor, false, false, 1.0, 0.5);
+}
+
+TYPED_TEST(GemmTest, empty_depth_scales_c)
+{
+    this->runAndCompare(8, 8, 0, Layout::RowMajor, Layout::RowMajor, Layout::RowMajor, false, false, 1.0, 3.0);
+}
+
+TEST(GemmValidationTest, mismatched_shapes_fail)
+{
+    Operations ops;
+    std::vector<float> storage(25);
+    byte* data = reinterpret_cast<byte*>(storage.data());
+    gTensor a({4, 3, 1, 1, 1}, {1, 4, 12, 12, 12}, 2, DType::fp32, Layout::RowMajor, data);
+    gTensor b({5, 5, 1, 1, 1}, {1, 5, 25, 25, 25}, 2, DType::fp32, Layout::RowMajor, data);
+    gTensor c({5, 3, 1, 1, 1}, {1, 5, 15, 15, 15}, 2, DType::fp32, Layout::RowMajor, data);
+    EXPECT_EQ(ops.gemm(a, b, c), gStatus::gBLAS_FAIL);
+    gTensor vector({4, 1, 1, 1, 1}, {1, 4, 4, 4, 4}, 1, DType::fp32, Layout::RowMajor, data);
+    EXPECT_EQ(ops.gemm(vector, b, c), gStatus::gBLAS_FAIL);
+}
+
+class MixedPrecisionGemmTest : public testing::Test
+{
+public:
+    // rows x cols row major matrix filled by gen(r, c), stored as T
+    template<typename T>
+    gTensor makeMatrix(uint64_t rows, uint64_t cols, DType dtype, Layout layout, const std::function<float(uint64_t, uint64_t)>& gen)
+    {
+        const bool rowMajor = layout == Layout::RowMajor;
+        gTensor tensor = test::makeMatrix(rows, cols, dtype, layout);
+        T* data = reinterpret_cast<T*>(tensor.data());
+        for (uint64_t r = 0; r < rows; ++r)
+        {
+            for (uint64_t c = 0; c < cols; ++c)
+            {
+                data[rowMajor ? r * cols + c : c * rows + r] = T(gen(r, c));
+            }
+        }
+        return tensor;
+    }
+
+    template<typename T>
+    static float get(const gTensor& tensor, uint64_t r, uint64_t c)
+    {
+        const T* data = reinterpret_cast<const T*>(tensor.data());
+        const bool rowMajor = tensor.getLayout() == Layout::RowMajor;
+        return static_cast<float>(data[rowMajor ? r * tensor.getSize(0) + c : c * tensor.getSize(0) + r]);
+    }
+protected:
+    Operations m_ops;
+};
+
+TEST_F(MixedPrecisionGemmTest, bf16_inputs_fp32_output)
+{
+    const uint64_t m = 33, n = 70, k = 45;
+    auto genA = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 7 + c * 3) % 11) * 0.125f - 0.5f;};
+    auto genB = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 5 + c) % 9) * 0.25f - 1.0f;};
+    for (Layout layout : {Layout::RowMajor, Layout::ColMajor})
+    {
+        gTensor a = makeMatrix<bf16_t>(m, k, DType::bf16, layout, genA);
+        gTensor b = makeMatrix<bf16_t>(k, n, DType::bf16, layout, genB);
+        gTensor c = makeMatrix<float>(m, n, DType::fp32, Layout::RowMajor, [](uint64_t, uint64_t) {return 0.0f;});
+        ASSERT_EQ(m_ops.gemm(a, b, c), gStatus::gBLAS_PASS);
+        for (uint64_t i = 0; i < m; ++i)
+        {
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                double expected = 0;
+                for (uint64_t p = 0; p < k; ++p) expected += (double)get<bf16_t>(a, i, p) * get<bf16_t>(b, p, j);
+                ASSERT_NEAR(get<float>(c, i, j), expected, 1e-4);
+            }
+        }
+    }
+}
+
+TEST_F(MixedPrecisionGemmTest, bf16_tiles_with_padded_depth)
+{
+    // with bf16 tiles the depth is padded to whole tile rows, an odd k larger than kc pads the last pass
+    const uint64_t m = 70, n = 90, k = 1037;
+    auto genA = [](uint64_t r, uint64_t c) {return static_cast<float>(static_cast<int>((r * 3 + c) % 7) - 3);};
+    auto genB = [](uint64_t r, uint64_t c) {return static_cast<float>((r + c * 11) % 5) * 0.5f;};
+    auto genC = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 2 + c) % 9);};
+    for (Layout layout : {Layout::RowMajor, Layout::ColMajor})
+    {
+        gTensor a = makeMatrix<bf16_t>(m, k, DType::bf16, layout, genA);
+        gTensor b = makeMatrix<bf16_t>(k, n, DType::bf16, layout, genB);
+        gTensor c = makeMatrix<float>(m, n, DType::fp32, layout, genC);
+        gTensor narrow = makeMatrix<bf16_t>(m, n, DType::bf16, layout, genC);
+        ASSERT_EQ(m_ops.gemm(a, b, c, 2.0, -1.0), gStatus::gBLAS_PASS);
+        ASSERT_EQ(m_ops.gemm(a, b, narrow, 2.0, -1.0), gStatus::gBLAS_PASS);
+        for (uint64_t i = 0; i < m; ++i)
+        {
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                // exact in fp32 whatever the order of the sums
+                float expected = 0;
+                for (uint64_t p = 0; p < k; ++p) expected += genA(i, p) * genB(p, j);
+                expected = 2.0f * expected - genC(i, j);
+                ASSERT_EQ(get<float>(c, i, j), expected) << "at (" << i << ", " << j << ")";
+                ASSERT_EQ(get<bf16_t>(narrow, i, j), bf16_t(expected).toFloat()) << "at (" << i << ", " << j << ")";
+            }
+        }
+    }
+}
+
+TEST_F(MixedPrecisionGemmTest, fp8_and_fp16_inputs_bf16_output_with_beta)
+{
+    // depth larger than any kc so the fp32 partial sums span several passes
+    const uint64_t m = 29, n = 41, k = 1100;
+    auto genA = [](uint64_t r, uint64_t c) {return static_cast<float>(static_cast<int>((r + 3 * c) % 5) - 2);};
+    auto genB = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 13 + c) % 3) * 0.5f;};
+    auto genC = [](uint64_t r, uint64_t c) {return static_cast<float>((r + c) % 4);};
+    gTensor a = makeMatrix<fp8_143>(m, k, DType::fp8_143, Layout::RowMajor, genA);
+    gTensor b = makeMatrix<fp16_t>(k, n, DType::fp16, Layout::ColMajor, genB);
+    gTensor c = makeMatrix<bf16_t>(m, n, DType::bf16, Layout::RowMajor, genC);
+    ASSERT_EQ(m_ops.gemm(a, b, c, 1.0, 2.0), gStatus::gBLAS_PASS);
+    for (uint64_t i = 0; i < m; ++i)
+    {
+        for (uint64_t j = 0; j < n; ++j)
+        {
+            // all products and sums are exact in fp32, so only the final narrowing rounds
+            float expected = 2.0f * genC(i, j);
+            for (uint64_t p = 0; p < k; ++p) expected += genA(i, p) * genB(p, j);
+            ASSERT_EQ(get<bf16_t>(c, i, j), bf16_t(expected).toFloat()) << "at (" << i << ", " << j << ")";
+        }
+    }
+}
+
+TEST_F(MixedPrecisionGemmTest, output_rounding_mode_is_honoured)
+{
+    const uint64_t m = 17, n = 19, k = 23;
+    auto genA = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 3 + c) % 7) + 1.0f;};
+    auto genB = [](uint64_t r, uint64_t c) {return static_cast<float>((r + c * 5) % 6) + 1.0f;};
+    gTensor a = makeMatrix<bf16_t>(m, k, DType::bf16, Layout::RowMajor, genA);
+    gTensor b = makeMatrix<bf16_t>(k, n, DType::bf16, Layout::RowMajor, genB);
+    for (RoundingMode rounding : {RoundingMode::RoundTowardsZero, RoundingMode::RoundUp, RoundingMode::NearestEven})
+    {
+        gTensor c = makeMatrix<fp8_143>(m, n, DType::fp8_143, Layout::ColMajor, [](uint64_t, uint64_t) {return 0.0f;});
+        ASSERT_EQ(m_ops.gemm(a, b, c, 0.03125, 0.0, false, false, rounding), gStatus::gBLAS_PASS);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(c.data());
+        for (uint64_t i = 0; i < m; ++i)
+        {
+            for (uint64_t j = 0; j < n; ++j)
+            {
+                float sum = 0;
+                for (uint64_t p = 0; p < k; ++p) sum += genA(i, p) * genB(p, j);
+                ASSERT_EQ(data[j * m + i], Conversions::fp32_to_fp8_143(sum * 0.03125f, rounding));
+            }
+        }
+    }
+}
+
+TEST_F(MixedPrecisionGemmTest, unsupported_types_fail)
+{
+    gTensor a = makeMatrix<int32_t>(4, 4, DType::int32, Layout::RowMajor, [](uint64_t, uint64_t) {return 1.0f;});
+    gTensor b = makeMatrix<float>(4, 4, DType::fp32, Layout::RowMajor, [](uint64_t, uint64_t) {return 1.0f;});
+    gTensor c = makeMatrix<float>(4, 4, DType::fp32, Layout::RowMajor, [](uint64_t, uint64_t) {return 1.0f;});
+    EXPECT_EQ(m_ops.gemm(a, b, c), gStatus::gBLAS_FAIL);
+}
+
+class BatchedGemmTest : public testing::Test
+{
+public:
+    // a row major batch of rows x cols fp32 matrices, the batch dims follow the matrix
+    gTensor makeBatch(uint64_t rows, uint64_t cols, uint64_t batch0, uint64_t batch1)
+    {
+        gTensor tensor = test::makeTensor({cols, rows, batch0, batch1}, DType::fp32);
+        fill(tensor, rows * cols * batch0 * batch1);
+        return tensor;
+    }
+
+    gTensor makeMatrix(uint64_t rows, uint64_t cols)
+    {
+        gTensor tensor = test::makeMatrix(rows, cols);
+        fill(tensor, rows * cols);
+        return tensor;
+    }
+
+    void fill(gTensor& tensor, uint64_t elements)
+    {
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        float* data = reinterpret_cast<float*>(tensor.data());
+        for (uint64_t i = 0; i < elements; ++i) data[i] = dist(m_rng);
+    }
+
+    // element (r, c) of the row major matrix at data with leading dimension ld
+    static float at(const float* data, int64_t ld, uint64_t r, uint64_t c) {return data[r * ld + c];}
+protected:
+    Operations m_ops;
+    std::mt19937 m_rng{3};
+};
+
+TEST_F(BatchedGemmTest, strided_batch_with_shared_operand)
+{
+    const uint64_t m = 13, n = 9, k = 21, heads = 3, groups = 2;
+    gTensor a = makeBatch(m, k, heads, groups);
+    // one B per group, shared by the heads
+    gTensor b = makeBatch(k, n, 1, groups);
+    gTensor c = makeBatch(m, n, heads, groups);
+    const std::vector<float> cBefore(reinterpret_cast<float*>(c.data()),
+                                     reinterpret_cast<float*>(c.data()) + m * n * heads * groups);
+    ASSERT_EQ(m_ops.gemmStridedBatched(a, b, c, 2.0, -1.0), gStatus::gBLAS_PASS);
+    for (uint64_t g = 0; g < groups; ++g)
+    {
+        for (uint64_t h = 0; h < heads; ++h)
+        {
+            const uint64_t product = g * heads + h;
+            const float* aData = reinterpret_cast<const float*>(a.data()) + product * m * k;
+            const float* bData = reinterpret_cast<const float*>(b.data()) + g * k * n;
+            const float* cData = reinterpret_cast<const float*>(c.data()) + product * m * n;
+            for (uint64_t i = 0; i < m; ++i)
+            {
+                for (uint64_t j = 0; j < n; ++j)
+                {
+                    double sum = 0.0;
+                    for (uint64_t p = 0; p < k; ++p) sum += at(aData, k, i, p) * at(bData, n, p, j);
+                    const double expected = 2.0 * sum - cBefore[product * m * n + i * n + j];
+                    ASSERT_NEAR(at(cData, n, i, j), expected, 1e-4) << product << ": " << i << ", " << j;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(BatchedGemmTest, grouped_matches_single_products)
+{
+    // many small ragged products run side by side, a few larger ones spread over the pool
+    std::vector<gTensor> as, bs, cs, expected;
+    std::vector<GemmGroupEntry> group;
+    for (uint64_t i = 0; i < 150; ++i)
+    {
+        const uint64_t m = 4 + i % 13, n = 3 + i % 7, k = 5 + i % 11;
+        const bool transposeA = i % 3 == 0;
+        as.push_back(transposeA ? makeMatrix(k, m) : makeMatrix(m, k));
+        bs.push_back(makeMatrix(k, n));
+        cs.push_back(makeMatrix(m, n));
+        expected.push_back(cs.back().clone());
+        group.push_back({nullptr, nullptr, nullptr, 0.5, i % 2 ? 1.0 : 0.0, transposeA, false});
+    }
+    as.push_back(makeMatrix(300, 700));
+    bs.push_back(makeMatrix(700, 400));
+    cs.push_back(makeMatrix(300, 400));
+    expected.push_back(cs.back().clone());
+    group.push_back({nullptr, nullptr, nullptr, 1.0, 0.0, false, false});
+    for (size_t i = 0; i < group.size(); ++i)
+    {
+        group[i].a = &as[i];
+        group[i].b = &bs[i];
+        group[i].c = &cs[i];
+        ASSERT_EQ(m_ops.gemm(as[i], bs[i], expected[i], group[i].alpha, group[i].beta, group[i].transposeA),
+                  gStatus::gBLAS_PASS);
+    }
+    // a pool of several threads whatever the host has, so the side by side schedule runs
+    setThreadPoolOptions({4});
+    const gStatus status = m_ops.gemmGrouped(group.data(), group.size());
+    setThreadPoolOptions({});
+    ASSERT_EQ(status, gStatus::gBLAS_PASS);
+    for (size_t i = 0; i < group.size(); ++i)
+    {
+        const uint64_t elements = cs[i].getSize(0) * cs[i].getSize(1);
+        const float* result = reinterpret_cast<const float*>(cs[i].data());
+        const float* reference = reinterpret_cast<const float*>(expected[i].data());
+        for (uint64_t e = 0; e < elements; ++e) ASSERT_NEAR(result[e], reference[e], 1e-4) << i << ": " << e;
+    }
+}
+
+TEST_F(BatchedGemmTest, mismatched_batches_fail)
+{
+    gTensor a = makeBatch(4, 5, 2, 3);
+    gTensor b = makeBatch(5, 6, 3, 3);
+    gTensor c = makeBatch(4, 6, 2, 3);
+    EXPECT_EQ(m_ops.gemmStridedBatched(a, b, c), gStatus::gBLAS_FAIL);
+    gTensor matrixA = makeMatrix(4, 5), matrixB = makeMatrix(5, 6), matrixC = makeMatrix(4, 6);
+    EXPECT_EQ(m_ops.gemmStridedBatched(matrixA, matrixB, matrixC), gStatus::gBLAS_FAIL);
+
+    gTensor fp64C({6, 4, 1, 1, 1}, {1, 6, 24, 24, 24}, 2, DType::fp64);
+    fp64C.allocateData();
+    std::vector<GemmGroupEntry> group = {{&matrixA, &matrixB, &matrixC}, {&matrixA, &matrixB, &fp64C}};
+    EXPECT_EQ(m_ops.gemmGrouped(group.data(), group.size()), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemmGrouped(group.data(), 1), gStatus::gBLAS_PASS);
+}
+
+class GemmEpilogueTest : public MixedPrecisionGemmTest
+{
+public:
+    // rank 1 tensor of n elements filled by gen(i), stored as T
+    template<typename T>
+    static gTensor makeVector(uint64_t n, DType dtype, const std::function<float(uint64_t)>& gen)
+    {
+        gTensor tensor = test::makeTensor({n}, dtype);
+        for (uint64_t i = 0; i < n; ++i) reinterpret_cast<T*>(tensor.data())[i] = T(gen(i));
+        return tensor;
+    }
+
+    static double activate(Activation activation, double x)
+    {
+        switch (activation)
+        {
+            case Activation::ReLU: return x < 0 ? 0 : x;
+            case Activation::GELU: return 0.5 * x * (1 + std::erf(x / std::sqrt(2.0)));
+            case Activation::GELUTanh: return 0.5 * x * (1 + std::tanh(0.7978845608 * (x + 0.044715 * x * x * x)));
+            case Activation::SiLU: return x / (1 + std::exp(-x));
+            default: return x;
+        }
+    }
+};
+
+TEST_F(GemmEpilogueTest, fused_epilogue_matches_separate_passes)
+{
+    // depth larger than any kc, the epilogue must only run after the last depth block
+    const uint64_t m = 37, n = 45, k = 700;
+    auto genA = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 7 + c * 3) % 11) * 0.125f - 0.625f;};
+    auto genB = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 5 + c) % 9) * 0.0625f - 0.25f;};
+    auto genC = [](uint64_t r, uint64_t c) {return static_cast<float>((r + 2 * c) % 5) - 2.0f;};
+    auto genBias = [](uint64_t i) {return static_cast<float>(i % 7) - 3.0f;};
+    auto genResidual = [](uint64_t r, uint64_t c) {return static_cast<float>((r * c) % 3) * 0.5f;};
+    const gTensor a = makeMatrix<float>(m, k, DType::fp32, Layout::RowMajor, genA);
+    const gTensor b = makeMatrix<float>(k, n, DType::fp32, Layout::ColMajor, genB);
+    const gTensor bias = makeVector<bf16_t>(n, DType::bf16, genBias);
+    const gTensor residual = makeMatrix<float>(m, n, DType::fp32, Layout::ColMajor, genResidual);
+    std::vector<double> product(m * n, 0.0);
+    for (uint64_t i = 0; i < m; ++i)
+    {
+        for (uint64_t j = 0; j < n; ++j)
+        {
+            for (uint64_t p = 0; p < k; ++p) product[i * n + j] += (double)genA(i, p) * genB(p, j);
+        }
+    }
+    for (Activation activation : {Activation::None, Activation::ReLU, Activation::GELU, Activation::GELUTanh,
+                                  Activation::SiLU})
+    {
+        // a row major C takes the direct tiles, a column major one is computed transposed and the bf16 one
+        // is narrowed from fp32 tiles
+        for (DType cType : {DType::fp32, DType::bf16})
+        {
+            for (Layout layout : {Layout::RowMajor, Layout::ColMajor})
+            {
+                gTensor c = cType == DType::fp32 ? makeMatrix<float>(m, n, cType, layout, genC)
+                                                 : makeMatrix<bf16_t>(m, n, cType, layout, genC);
+                const GemmEpilogue epilogue{&bias, activation, &residual};
+                ASSERT_EQ(m_ops.gemm(a, b, c, epilogue, 0.5, 2.0), gStatus::gBLAS_PASS);
+                for (uint64_t i = 0; i < m; ++i)
+                {
+                    for (uint64_t j = 0; j < n; ++j)
+                    {
+                        const double expected = activate(activation, 0.5 * product[i * n + j] + 2.0 * genC(i, j) +
+                                                                     genBias(j)) + genResidual(i, j);
+                        const float result = cType == DType::fp32 ? get<float>(c, i, j) : get<bf16_t>(c, i, j);
+                        const double tolerance = (cType == DType::fp32 ? 1e-5 : 8e-3) * std::max(1.0, std::abs(expected));
+                        ASSERT_NEAR(result, expected, tolerance) << static_cast<int>(activation) << " at (" << i
+                                                                 << ", " << j << ")";
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(GemmEpilogueTest, fp64_and_empty_depth)
+{
+    const uint64_t m = 20, n = 30, k = 50;
+    auto gen = [](uint64_t r, uint64_t c) {return static_cast<float>((r * 3 + c) % 7) * 0.25f - 0.75f;};
+    auto genBias = [](uint64_t i) {return static_cast<float>(i % 4) - 1.5f;};
+    const gTensor a = makeMatrix<double>(m, k, DType::fp64, Layout::ColMajor, gen);
+    const gTensor b = makeMatrix<double>(k, n, DType::fp64, Layout::RowMajor, gen);
+    const gTensor bias = makeVector<double>(n, DType::fp64, genBias);
+    gTensor c = makeMatrix<double>(m, n, DType::fp64, Layout::RowMajor, gen);
+    ASSERT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{&bias, Activation::GELUTanh}, 1.0, 1.0), gStatus::gBLAS_PASS);
+    for (uint64_t i = 0; i < m; ++i)
+    {
+        for (uint64_t j = 0; j < n; ++j)
+        {
+            double sum = gen(i, j) + genBias(j);
+            for (uint64_t p = 0; p < k; ++p) sum += (double)gen(i, p) * gen(p, j);
+            // get reads through fp32
+            ASSERT_NEAR(get<double>(c, i, j), activate(Activation::GELUTanh, sum), 1e-6);
+        }
+    }
+
+    // without a depth the epilogue still runs on beta*C
+    const gTensor emptyA = makeMatrix<float>(m, 0, DType::fp32, Layout::RowMajor, gen);
+    const gTensor emptyB = makeMatrix<float>(0, n, DType::fp32, Layout::RowMajor, gen);
+    const gTensor residual = makeMatrix<float>(m, n, DType::fp32, Layout::RowMajor, gen);
+    const gTensor fp32Bias = makeVector<float>(n, DType::fp32, genBias);
+    gTensor fp32C = makeMatrix<float>(m, n, DType::fp32, Layout::ColMajor, gen);
+    ASSERT_EQ(m_ops.gemm(emptyA, emptyB, fp32C, GemmEpilogue{&fp32Bias, Activation::SiLU, &residual}, 1.0, 3.0),
+              gStatus::gBLAS_PASS);
+    for (uint64_t i = 0; i < m; ++i)
+    {
+        for (uint64_t j = 0; j < n; ++j)
+        {
+            const double expected = activate(Activation::SiLU, 3.0 * gen(i, j) + genBias(j)) + gen(i, j);
+            ASSERT_NEAR(get<float>(fp32C, i, j), expected, 1e-5);
+        }
+    }
+}
+
+TEST_F(GemmEpilogueTest, invalid_operands_fail)
+{
+    auto one = [](uint64_t, uint64_t) {return 1.0f;};
+    const gTensor a = makeMatrix<float>(4, 6, DType::fp32, Layout::RowMajor, one);
+    const gTensor b = makeMatrix<float>(6, 5, DType::fp32, Layout::RowMajor, one);
+    gTensor c = makeMatrix<float>(4, 5, DType::fp32, Layout::RowMajor, one);
+    const gTensor shortBias = makeVector<float>(4, DType::fp32, [](uint64_t) {return 1.0f;});
+    const gTensor intBias = makeVector<int32_t>(5, DType::int32, [](uint64_t) {return 1.0f;});
+    const gTensor wrongShape = makeMatrix<float>(5, 4, DType::fp32, Layout::RowMajor, one);
+    EXPECT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{&shortBias}), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{&intBias}), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{nullptr, Activation::None, &wrongShape}), gStatus::gBLAS_FAIL);
+    // the residual cannot be C itself, C is written as the residual is read
+    EXPECT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{nullptr, Activation::None, &c}), gStatus::gBLAS_FAIL);
+    // nor a view of C's storage at another offset
+    const gTensor storage = makeMatrix<float>(5, 5, DType::fp32, Layout::RowMajor, one);
+    gTensor top = storage.slice(1, 0, 4);
+    const gTensor shifted = storage.slice(1, 1, 5);
+    EXPECT_EQ(m_ops.gemm(a, b, top, GemmEpilogue{nullptr, Activation::None, &shifted}), gStatus::gBLAS_FAIL);
+    // nor a view over C's bytes through a raw pointer, for the residual and the bias alike
+    gTensor rawC({5, 4, 1, 1, 1}, {1, 5, 20, 20, 20}, 2, DType::fp32, Layout::RowMajor, c.data());
+    EXPECT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{nullptr, Activation::None, &rawC}), gStatus::gBLAS_FAIL);
+    byte* lastRow = c.data() + 3 * 5 * sizeof(float);
+    const gTensor rowOfC({5, 1, 1, 1, 1}, {1, 5, 5, 5, 5}, 1, DType::fp32, Layout::RowMajor, lastRow);
+    EXPECT_EQ(m_ops.gemm(a, b, c, GemmEpilogue{&rowOfC}), gStatus::gBLAS_FAIL);
+    // the storage of C outside its bytes is fine
+    byte* spareRow = const_cast<byte*>(storage.data()) + 4 * 5 * sizeof(float);
+    const gTensor spare({5, 1, 1, 1, 1}, {1, 5, 5, 5, 5}, 1, DType::fp32, Layout::RowMajor, spareRow);
+    EXPECT_EQ(m_ops.gemm(a, b, top, GemmEpilogue{&spare}), gStatus::gBLAS_PASS);
+
+    // an fp64 product takes fp64 operands, integer products have no epilogue
+    const gTensor a64 = makeMatrix<double>(4, 6, DType::fp64, Layout::RowMajor, one);
+    const gTensor b64 = makeMatrix<double>(6, 5, DType::fp64, Layout::RowMajor, one);
+    gTensor c64 = makeMatrix<double>(4, 5, DType::fp64, Layout::RowMajor, one);
+    const gTensor bias = makeVector<float>(5, DType::fp32, [](uint64_t) {return 1.0f;});
+    EXPECT_EQ(m_ops.gemm(a64, b64, c64, GemmEpilogue{&bias}), gStatus::gBLAS_FAIL);
+    const gTensor a8 = makeMatrix<int8_t>(4, 6, DType::int8, Layout::RowMajor, one);
+    const gTensor b8 = makeMatrix<int8_t>(6, 5, DType::int8, Layout::RowMajor, one);
+    gTensor c32 = makeMatrix<int32_t>(4, 5, DType::int32, Layout::RowMajor, one);
+    EXPECT_EQ(m_ops.gemm(a8, b8, c32, GemmEpilogue{nullptr, Activation::ReLU}), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.gemm(a8, b8, c32), gStatus::gBLAS_PASS);
+}
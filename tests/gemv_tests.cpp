@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "kernels/kernels.h"
+#include <cmath>
+#include <random>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+
+class GemvTest : public testing::Test
+{
+public:
+    // values are rounded to the dtype on the way in, so the reference sees what the operation sees
+    static void set(gTensor& tensor, int64_t index, double value)
+    {
+        byte* data = tensor.data();
+        const float f = static_cast<float>(value);
+        switch (tensor.getDType())
+        {
+            case DType::fp64: reinterpret_cast<double*>(data)[index] = value; break;
+            case DType::fp32: reinterpret_cast<float*>(data)[index] = f; break;
+            case DType::bf16:
+                reinterpret_cast<uint16_t*>(data)[index] = Conversions::fp32_to_bf16(f, RoundingMode::NearestEven);
+                break;
+            case DType::fp16:
+                reinterpret_cast<uint16_t*>(data)[index] = Conversions::fp32_to_fp16(f, RoundingMode::NearestEven);
+                break;
+            case DType::fp8_152: data[index] = Conversions::fp32_to_fp8_152(f, RoundingMode::NearestEven); break;
+            case DType::fp8_143: data[index] = Conversions::fp32_to_fp8_143(f, RoundingMode::NearestEven); break;
+            default: break;
+        }
+    }
+
+    static double get(const gTensor& tensor, int64_t index)
+    {
+        const byte* data = tensor.data();
+        switch (tensor.getDType())
+        {
+            case DType::fp64: return reinterpret_cast<const double*>(data)[index];
+            case DType::fp32: return reinterpret_cast<const float*>(data)[index];
+            case DType::bf16: return Conversions::bf16_to_fp32(reinterpret_cast<const uint16_t*>(data)[index]);
+            case DType::fp16: return Conversions::fp16_to_fp32(reinterpret_cast<const uint16_t*>(data)[index]);
+            case DType::fp8_152: return Conversions::fp8_152_to_fp32(data[index]);
+            case DType::fp8_143: return Conversions::fp8_143_to_fp32(data[index]);
+            default: return 0.0;
+        }
+    }
+
+    // dim 0 has `inner` elements `step` apart, dim 1 has `outer` lines, filled with random values
+    gTensor make(uint64_t inner, uint64_t outer, unsigned rank, DType dtype, Layout layout = Layout::RowMajor,
+                 int64_t step = 1)
+    {
+        const int64_t ld = static_cast<int64_t>(inner) * step + 1;
+        std::vector<uint64_t> sizes = {inner, outer};
+        sizes.resize(rank);
+        gTensor tensor = test::makeTensor(sizes, {step, ld}, dtype, layout);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (uint64_t o = 0; o < outer; ++o)
+        {
+            for (uint64_t i = 0; i < inner; ++i) set(tensor, offset(tensor, i, o), dist(m_rng));
+        }
+        return tensor;
+    }
+
+    static int64_t offset(const gTensor& tensor, uint64_t i, uint64_t o)
+    {
+        return static_cast<int64_t>(i) * tensor.getStride(0) + static_cast<int64_t>(o) * tensor.getStride(1);
+    }
+
+    // element (r, c) of op(A), with the conventions of gemm
+    static double at(const gTensor& a, bool transpose, uint64_t r, uint64_t c)
+    {
+        if (transpose) std::swap(r, c);
+        return a.getLayout() == Layout::RowMajor ? get(a, offset(a, c, r)) : get(a, offset(a, r, c));
+    }
+
+    void runAndCompare(gTensor& a, bool transpose, uint64_t batch, double alpha, double beta, DType vectorType,
+                       double tolerance)
+    {
+        const bool rowMajor = a.getLayout() == Layout::RowMajor;
+        const uint64_t m = (rowMajor != transpose) ? a.getSize(1) : a.getSize(0);
+        const uint64_t k = (rowMajor != transpose) ? a.getSize(0) : a.getSize(1);
+        const unsigned rank = batch > 1 ? 2 : 1;
+        gTensor x = make(k, batch, rank, vectorType);
+        gTensor y = make(m, batch, rank, vectorType, Layout::RowMajor, 2);
+        std::vector<double> expected(m * batch);
+        for (uint64_t b = 0; b < batch; ++b)
+        {
+            for (uint64_t i = 0; i < m; ++i)
+            {
+                double sum = 0.0;
+                for (uint64_t p = 0; p < k; ++p) sum += at(a, transpose, i, p) * get(x, offset(x, p, b));
+                expected[b * m + i] = alpha * sum + beta * get(y, offset(y, i, b));
+            }
+        }
+        const gStatus status = batch > 1 ? m_ops.gemvBatched(a, x, y, alpha, beta, transpose)
+                                         : m_ops.gemv(a, x, y, alpha, beta, transpose);
+        ASSERT_EQ(status, gStatus::gBLAS_PASS);
+        for (uint64_t b = 0; b < batch; ++b)
+        {
+            for (uint64_t i = 0; i < m; ++i)
+            {
+                const double value = get(y, offset(y, i, b));
+                const double expect = expected[b * m + i];
+                ASSERT_NEAR(value, expect, tolerance * (1.0 + std::abs(expect))) << i << ", " << b;
+            }
+        }
+    }
+protected:
+    Operations m_ops;
+    std::mt19937 m_rng{7};
+};
+
+TEST_F(GemvTest, fp32_and_fp64_layouts)
+{
+    for (DType dtype : {DType::fp32, DType::fp64})
+    {
+        const double tolerance = dtype == DType::fp32 ? 1e-4 : 1e-12;
+        for (Layout layout : {Layout::RowMajor, Layout::ColMajor})
+        {
+            for (bool transpose : {false, true})
+            {
+                gTensor a = make(67, 301, 2, dtype, layout);
+                runAndCompare(a, transpose, 1, 1.5, 0.0, dtype, tolerance);
+                runAndCompare(a, transpose, 1, -1.0, 0.5, dtype, tolerance);
+            }
+        }
+        // neither dim of A has a unit stride
+        gTensor strided = make(45, 33, 2, dtype, Layout::RowMajor, 3);
+        runAndCompare(strided, false, 1, 1.0, 1.0, dtype, tolerance);
+    }
+}
+
+TEST_F(GemvTest, long_rows_and_threads)
+{
+    // deeper than one depth block and tall enough to be split over the pool
+    gTensor a = make(4500, 600, 2, DType::fp32);
+    runAndCompare(a, false, 1, 1.0, 0.0, DType::fp32, 1e-4);
+    runAndCompare(a, true, 1, 1.0, 0.0, DType::fp32, 1e-4);
+}
+
+TEST_F(GemvTest, low_precision_weights)
+{
+    for (DType dtype : {DType::bf16, DType::fp16, DType::fp8_152, DType::fp8_143})
+    {
+        for (Layout layout : {Layout::RowMajor, Layout::ColMajor})
+        {
+            gTensor a = make(131, 75, 2, dtype, layout);
+            runAndCompare(a, false, 1, 1.0, 0.0, DType::fp32, 1e-5);
+            // a bf16 y is rounded once at the end
+            runAndCompare(a, false, 1, 1.0, 1.0, DType::bf16, 1e-2);
+        }
+    }
+}
+
+TEST_F(GemvTest, batched_matches_single_vectors)
+{
+    for (DType dtype : {DType::fp32, DType::bf16, DType::fp8_143})
+    {
+        for (Layout layout : {Layout::RowMajor, Layout::ColMajor})
+        {
+            gTensor a = make(97, 150, 2, dtype, layout);
+            for (uint64_t batch : {2u, 5u, 19u}) runAndCompare(a, false, batch, 0.5, 0.0, DType::fp32, 1e-5);
+
+            // every vector of a batch is computed exactly like a single one
+            const bool rowMajor = layout == Layout::RowMajor;
+            const uint64_t m = rowMajor ? 150 : 97, k = rowMajor ? 97 : 150;
+            gTensor x = make(k, 6, 2, DType::fp32);
+            gTensor y = make(m, 6, 2, DType::fp32);
+            ASSERT_EQ(m_ops.gemvBatched(a, x, y), gStatus::gBLAS_PASS);
+            for (uint64_t b = 0; b < 6; ++b)
+            {
+                gTensor xb({k, 1, 1, 1, 1}, {1, (int64_t)k, (int64_t)k, (int64_t)k, (int64_t)k}, 1, DType::fp32);
+                gTensor yb({m, 1, 1, 1, 1}, {1, (int64_t)m, (int64_t)m, (int64_t)m, (int64_t)m}, 1, DType::fp32);
+                xb.initData(x.data() + offset(x, 0, b) * sizeof(float));
+                yb.allocateData();
+                ASSERT_EQ(m_ops.gemv(a, xb, yb), gStatus::gBLAS_PASS);
+                for (uint64_t i = 0; i < m; ++i) ASSERT_EQ(get(yb, i), get(y, offset(y, i, b))) << i << ", " << b;
+            }
+        }
+    }
+}
+
+TEST_F(GemvTest, mismatched_shapes_fail)
+{
+    gTensor a = make(8, 5, 2, DType::fp32);
+    gTensor x = make(7, 1, 1, DType::fp32);
+    gTensor y = make(5, 1, 1, DType::fp32);
+    EXPECT_EQ(m_ops.gemv(a, x, y), gStatus::gBLAS_FAIL);
+    gTensor x8 = make(8, 1, 1, DType::fp32);
+    EXPECT_EQ(m_ops.gemv(a, x8, y), gStatus::gBLAS_PASS);
+    EXPECT_EQ(m_ops.gemvBatched(a, x8, y), gStatus::gBLAS_FAIL);
+    gTensor xi = make(8, 1, 1, DType::int32);
+    EXPECT_EQ(m_ops.gemv(a, xi, y), gStatus::gBLAS_FAIL);
+}
+
+TEST(GemvKernelTest, every_supported_level_agrees)
+{
+    // 3 vectors and odd sizes reach the vector groups, the single rows and the padded tails
+    const uint64_t rows = 23, k = 37;
+    const unsigned batch = 3;
+    std::vector<uint16_t> a(rows * k);
+    std::vector<float> x(k * batch);
+    for (uint64_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = Conversions::fp32_to_bf16(static_cast<float>(i % 13) * 0.25f - 1.5f, RoundingMode::NearestEven);
+    }
+    for (uint64_t i = 0; i < x.size(); ++i) x[i] = static_cast<float>(i % 5) - 2.0f;
+    for (bool byCols : {false, true})
+    {
+        std::vector<float> expected(rows * batch, 0.0f);
+        const auto& reference = kernels::getKernelTable(IsaLevel::Scalar)->gemvBf16;
+        (byCols ? reference.byCols : reference.byRows)(rows, k, a.data(), byCols ? rows : k, x.data(), k, batch,
+                                                       expected.data(), rows);
+        for (int level = 0; level < static_cast<int>(IsaLevel::IsaLevelNR); ++level)
+        {
+            const kernels::KernelTable* table = kernels::getKernelTable(static_cast<IsaLevel>(level));
+            if (!table) continue;
+            std::vector<float> result(rows * batch, 0.0f);
+            (byCols ? table->gemvBf16.byCols : table->gemvBf16.byRows)(rows, k, a.data(), byCols ? rows : k,
+                                                                       x.data(), k, batch, result.data(), rows);
+            // small integers and quarters, every order of summation is exact
+            EXPECT_EQ(result, expected) << isaLevelName(table->isa) << (byCols ? " by columns" : " by rows");
+        }
+    }
+}
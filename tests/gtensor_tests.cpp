@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
-#include "gTensor/gTensor.h"
+#include "gTensor/gTensor.h"
+#include "gTensor/gTensorIterator.h"
+#include <memory>
+#include <vector>
 
 using namespace gblas;
 
@@ -33,9 +36,9 @@ TEST_F(GTensorTest, creation_strided_bf16)
 TEST_F(GTensorTest, data_injection_int32)
 {
     allocateTensor({100, 100, 1, 1, 1}, {1, 100, 10000, 10000, 10000}, 5, DType::int32);
-    auto dataArr = new std::array<uint32_t, 100*100>;
+    auto dataArr = std::make_unique<std::array<uint32_t, 100*100>>();
     std::fill(dataArr->begin(), dataArr->end(), 1);
-    tensor.initData(dataArr);
+    tensor.initData(dataArr.get());
     auto val = (*tensor.getDataBuffer())[100];
     EXPECT_EQ(*(int32_t*)(val), 1);
 }
@@ -43,10 +46,10 @@ TEST_F(GTensorTest, data_injection_int32)
 TEST_F(GTensorTest, data_extraction_int32)
 {
     allocateTensor({100, 100, 1, 1, 1}, {1, 100, 10000, 10000, 10000}, 5, DType::int32);
-    auto dataArr = new std::array<uint32_t, 100*100>;
+    auto dataArr = std::make_unique<std::array<uint32_t, 100*100>>();
     unsigned value = 0;
     std::generate(dataArr->begin(), dataArr->end(), [&value](){return value++;});
-    tensor.initData(dataArr);
+    tensor.initData(dataArr.get());
 
     for(unsigned i = 0; i < tensor.getTotalSizeInElements(); i++)
     {
@@ -57,10 +60,10 @@ TEST_F(GTensorTest, data_extraction_int32)
 TEST_F(GTensorTest, data_extraction_coordinates_int32)
 {
     allocateTensor({100, 100, 1, 1, 1}, {1, 100, 10000, 10000, 10000}, 5, DType::int32);
-    auto dataArr = new std::array<uint32_t, 100*100>;
+    auto dataArr = std::make_unique<std::array<uint32_t, 100*100>>();
     unsigned value = 0;
     std::generate(dataArr->begin(), dataArr->end(), [&value](){return value++;});
-    tensor.initData(dataArr);
+    tensor.initData(dataArr.get());
     Coordinates coords = {0, 0};
     EXPECT_EQ(*(int32_t*)(tensor[coords]), 0);
     coords = {50, 0};
@@ -72,10 +75,10 @@ TEST_F(GTensorTest, data_extraction_coordinates_int32)
 TEST_F(GTensorTest, data_extraction_coordinates_strided_int32)
 {
     allocateTensor({100, 100, 1, 1, 1}, {1, 200, 20000, 20000, 20000}, 5, DType::int32);
-    auto dataArr = new std::array<uint32_t, 100*200>;
+    auto dataArr = std::make_unique<std::array<uint32_t, 100*200>>();
     unsigned value = 0;
     std::generate(dataArr->begin(), dataArr->end(), [&value](){return value++;});
-    tensor.initData(dataArr);
+    tensor.initData(dataArr.get());
     Coordinates coords = {0, 10};
     EXPECT_EQ(*(int32_t*)(tensor[coords]), 0*1 + 10*200);
     coords = {50, 1};
@@ -83,3 +86,184 @@ TEST_F(GTensorTest, data_extraction_coordinates_strided_int32)
     coords = {25, 25};
     EXPECT_EQ(*(int32_t*)(tensor[coords]), 25*1 + 25*200);
 }
+
+TEST_F(GTensorTest, copies_share_data)
+{
+    allocateTensor({10, 10, 1, 1, 1}, {1, 10, 100, 100, 100}, 2, DType::fp32);
+    tensor.allocateData();
+    gTensor copy = tensor;
+    EXPECT_EQ(copy.data(), tensor.data());
+    EXPECT_EQ(tensor.getDataBuffer()->getUseCount(), 2);
+    *(float*)copy[5] = 3.0f;
+    EXPECT_EQ(*(float*)tensor[5], 3.0f);
+
+    gTensor deep = tensor.clone();
+    EXPECT_NE(deep.data(), tensor.data());
+    EXPECT_TRUE(deep == tensor);
+    *(float*)deep[5] = 4.0f;
+    EXPECT_EQ(*(float*)tensor[5], 3.0f);
+}
+
+TEST_F(GTensorTest, views_and_shared_storage)
+{
+    allocateTensor({10, 10, 1, 1, 1}, {1, 10, 100, 100, 100}, 2, DType::int32);
+    std::vector<int32_t> external(100, 7);
+    tensor.initData(external.data());
+    EXPECT_FALSE(tensor.getDataBuffer()->isOwning());
+    EXPECT_EQ(tensor.data(), reinterpret_cast<byte*>(external.data()));
+
+    // shared storage stays alive as long as a tensor refers to it
+    auto storage = std::shared_ptr<byte>(new byte[400](), std::default_delete<byte[]>());
+    std::weak_ptr<byte> observer = storage;
+    tensor.initData(std::move(storage));
+    gTensor copy = tensor;
+    tensor = gTensor();
+    EXPECT_FALSE(observer.expired());
+    copy = gTensor();
+    EXPECT_TRUE(observer.expired());
+}
+
+namespace {
+
+// element at (x, y, z) through the strides of a view
+int32_t at(const gTensor& view, uint64_t x, uint64_t y = 0, uint64_t z = 0)
+{
+    const int64_t offset = x * view.getStride(0) + y * view.getStride(1) + z * view.getStride(2);
+    return reinterpret_cast<const int32_t*>(view.data())[offset];
+}
+
+} // anonymous namespace
+
+TEST_F(GTensorTest, slice_and_transpose_views)
+{
+    allocateTensor({6, 4, 1, 1, 1}, {1, 6, 24, 24, 24}, 2, DType::int32);
+    tensor.allocateData();
+    for (int i = 0; i < 24; ++i) *(int32_t*)tensor[i] = i;
+
+    gTensor columns = tensor.slice(0, 1, 6, 2);
+    EXPECT_EQ(columns.getSize(0), 3);
+    EXPECT_EQ(columns.getStride(0), 2);
+    EXPECT_EQ(columns.getOffsetInElements(), 1);
+    EXPECT_EQ(tensor.getDataBuffer()->getUseCount(), 2);
+    EXPECT_EQ(at(columns, 2, 3), 5 + 3 * 6);
+    EXPECT_FALSE(columns.isDense());
+    // the view writes through to the shared buffer
+    *(int32_t*)columns[0] = -1;
+    EXPECT_EQ(*(int32_t*)tensor[1], -1);
+
+    gTensor rows = columns.slice(1, 2, 4);
+    EXPECT_EQ(rows.getOffsetInElements(), 1 + 2 * 6);
+    EXPECT_EQ(at(rows, 1, 1), 3 + 3 * 6);
+
+    gTensor transposed = tensor.transpose(0, 1);
+    EXPECT_EQ(transposed.getSize(0), 4);
+    EXPECT_EQ(transposed.getStride(0), 6);
+    EXPECT_EQ(at(transposed, 3, 5), 5 + 3 * 6);
+    EXPECT_EQ(transposed.transpose({1, 0, 2, 3, 4}).getAllStridesInElements(), tensor.getAllStridesInElements());
+
+    // clone packs only the elements the view spans
+    gTensor packed = rows.clone();
+    EXPECT_EQ(packed.getOffsetInElements(), 0);
+    EXPECT_EQ(packed.getDataBuffer()->size(), rows.getMemorySizeInBytes());
+    EXPECT_EQ(at(packed, 1, 1), 3 + 3 * 6);
+
+    EXPECT_THROW(tensor.slice(2, 0, 1), std::out_of_range);
+    EXPECT_THROW(tensor.slice(0, 0, 7), std::out_of_range);
+    EXPECT_THROW(tensor.slice(0, 0, 6, 0), std::invalid_argument);
+    EXPECT_THROW(tensor.transpose({0, 0, 2, 3, 4}), std::invalid_argument);
+}
+
+TEST_F(GTensorTest, reshape_and_broadcast_views)
+{
+    allocateTensor({6, 4, 1, 1, 1}, {1, 6, 24, 24, 24}, 2, DType::int32);
+    tensor.allocateData();
+    for (int i = 0; i < 24; ++i) *(int32_t*)tensor[i] = i;
+
+    gTensor cube = tensor.reshape({2, 3, 4, 1, 1}, 3);
+    EXPECT_EQ(cube.getRank(), 3);
+    EXPECT_EQ(cube.getStride(1), 2);
+    EXPECT_EQ(cube.getStride(2), 6);
+    EXPECT_EQ(at(cube, 1, 2, 3), 1 + 2 * 2 + 3 * 6);
+
+    // splitting a strided dim keeps its stride
+    gTensor columns = tensor.slice(0, 0, 6, 2);
+    gTensor split = columns.reshape({3, 2, 2, 1, 1}, 3);
+    EXPECT_EQ(split.getStride(0), 2);
+    EXPECT_EQ(split.getStride(1), 6);
+    EXPECT_EQ(split.getStride(2), 12);
+    EXPECT_EQ(at(split, 2, 1, 1), 4 + 18);
+    // every other column is still evenly spaced, so the dims merge
+    EXPECT_EQ(columns.reshape({12, 1, 1, 1, 1}, 1).getStride(0), 2);
+    // merging dims that are not contiguous with each other needs a copy
+    EXPECT_THROW(tensor.slice(0, 0, 4).reshape({16, 1, 1, 1, 1}, 1), std::invalid_argument);
+    EXPECT_THROW(tensor.transpose(0, 1).reshape({24, 1, 1, 1, 1}, 1), std::invalid_argument);
+    EXPECT_THROW(tensor.reshape({5, 5, 1, 1, 1}, 2), std::invalid_argument);
+
+    gTensor row = tensor.slice(1, 2, 3);
+    gTensor repeated = row.broadcast({6, 3, 2, 1, 1}, 3);
+    EXPECT_EQ(repeated.getStride(1), 0);
+    EXPECT_EQ(repeated.getStride(2), 0);
+    EXPECT_EQ(at(repeated, 4, 2, 1), 4 + 2 * 6);
+    EXPECT_EQ(repeated.getMemorySizeInBytes(), 6 * sizeof(int32_t));
+    EXPECT_THROW(tensor.broadcast({6, 8, 1, 1, 1}, 2), std::invalid_argument);
+}
+
+TEST_F(GTensorTest, iterator_merges_dims)
+{
+    allocateTensor({6, 4, 3, 1, 1}, {1, 6, 24, 72, 72}, 3, DType::int32);
+    tensor.allocateData();
+    for (int i = 0; i < 72; ++i) *(int32_t*)tensor[i] = i;
+
+    // dense is a single chunk
+    gTensorIterator dense = tensor.getIterator();
+    EXPECT_EQ(dense.getNumOfChunks(), 1);
+    EXPECT_EQ(dense.getChunkLength(), 72);
+    EXPECT_TRUE(dense.isContiguous());
+
+    // whole rows of a slice along dim 1 merge into one run per dim 2 step
+    gTensor rows = tensor.slice(1, 1, 3);
+    gTensorIterator rowIterator = rows.getIterator();
+    EXPECT_EQ(rowIterator.getNumOfChunks(), 3);
+    EXPECT_EQ(rowIterator.getChunkLength(), 12);
+    std::vector<int32_t> visited;
+    rowIterator.forEachChunk([&](const gTensorIterator::Chunk& chunk)
+    {
+        EXPECT_TRUE(chunk.isContiguous(0));
+        visited.insert(visited.end(), chunk.get<int32_t>(0), chunk.get<int32_t>(0) + chunk.length);
+    });
+    ASSERT_EQ(visited.size(), 36);
+    EXPECT_EQ(visited[0], 6);
+    EXPECT_EQ(visited[12], 24 + 6);
+    EXPECT_EQ(visited[35], 48 + 17);
+
+    // a transposed operand keeps the dims apart and walks its runs strided
+    gTensor view = tensor.transpose(0, 1);
+    gTensor transposed({4, 6, 3, 1, 1}, {1, 4, 24, 72, 72}, 3, DType::int32);
+    transposed.allocateData();
+    for (int i = 0; i < 72; ++i) *(int32_t*)transposed[i] = (i / 4) % 6 + (i % 4) * 6 + (i / 24) * 24;
+    gTensorIterator pair({&view, &transposed});
+    EXPECT_EQ(pair.getNumOfDims(), 3);
+    EXPECT_FALSE(pair.isContiguous());
+    gTensorIterator::Chunk chunk;
+    uint64_t elements = 0;
+    while (pair.next(chunk))
+    {
+        EXPECT_EQ(chunk.strides[0], 6);
+        EXPECT_EQ(chunk.strides[1], 1);
+        for (uint64_t i = 0; i < chunk.length; ++i)
+        {
+            EXPECT_EQ(chunk.get<int32_t>(0)[i * 6], chunk.get<int32_t>(1)[i]);
+        }
+        elements += chunk.length;
+    }
+    EXPECT_EQ(elements, 72);
+
+    // broadcast dims repeat the same run
+    gTensor repeated = tensor.slice(1, 0, 1).slice(2, 0, 1).broadcast({6, 4, 3, 1, 1}, 3);
+    gTensorIterator broadcast({&repeated, &tensor});
+    EXPECT_EQ(broadcast.getNumOfChunks(), 12);
+    broadcast.forEachChunk([&](const gTensorIterator::Chunk& run) {EXPECT_EQ(run.data[0], tensor.data());});
+
+    gTensor other({6, 4, 1, 1, 1}, {1, 6, 24, 24, 24}, 2, DType::int32);
+    EXPECT_THROW(gTensorIterator({&tensor, &other}), std::invalid_argument);
+}
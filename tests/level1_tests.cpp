@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "runtime/Parallel.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+
+class Level1Test : public testing::Test
+{
+public:
+    // a dense rank 1 tensor that owns its zero initialized buffer
+    template<typename T>
+    T* allocateVector(gTensor& tensor, uint64_t n, DType dtype)
+    {
+        tensor = test::makeTensor({n}, dtype);
+        return reinterpret_cast<T*>(tensor.data());
+    }
+protected:
+    Operations ops;
+    gTensor x, y;
+};
+
+TEST_F(Level1Test, reductions_fp32_and_fp64)
+{
+    const uint64_t n = 1000;
+    float* xData = allocateVector<float>(x, n, DType::fp32);
+    float* yData = allocateVector<float>(y, n, DType::fp32);
+    double dot = 0.0, squares = 0.0, absSum = 0.0;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        xData[i] = i == 700 ? -9.0f : static_cast<float>(i % 17) - 8.0f;
+        yData[i] = 0.25f * static_cast<float>(i % 5);
+        dot += static_cast<double>(xData[i]) * yData[i];
+        squares += static_cast<double>(xData[i]) * xData[i];
+        absSum += std::abs(xData[i]);
+    }
+    double result = 0.0;
+    uint64_t index = 0;
+    ASSERT_EQ(ops.dot(x, y, result), gStatus::gBLAS_PASS);
+    EXPECT_DOUBLE_EQ(result, dot);
+    ASSERT_EQ(ops.nrm2(x, result), gStatus::gBLAS_PASS);
+    EXPECT_NEAR(result, std::sqrt(squares), 1e-5);
+    ASSERT_EQ(ops.asum(x, result), gStatus::gBLAS_PASS);
+    EXPECT_DOUBLE_EQ(result, absSum);
+    ASSERT_EQ(ops.iamax(x, index), gStatus::gBLAS_PASS);
+    EXPECT_EQ(index, 700u);
+
+    double* aData = allocateVector<double>(x, n, DType::fp64);
+    double* bData = allocateVector<double>(y, n, DType::fp64);
+    dot = 0.0;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        aData[i] = 0.5 * static_cast<double>(i);
+        bData[i] = 1.0 / static_cast<double>(i + 1);
+        dot += aData[i] * bData[i];
+    }
+    ASSERT_EQ(ops.dot(x, y, result), gStatus::gBLAS_PASS);
+    EXPECT_NEAR(result, dot, 1e-12);
+    ASSERT_EQ(ops.iamax(x, index), gStatus::gBLAS_PASS);
+    EXPECT_EQ(index, n - 1);
+}
+
+TEST_F(Level1Test, low_precision_and_integer_types)
+{
+    const uint64_t n = 300;
+    uint16_t* xData = allocateVector<uint16_t>(x, n, DType::bf16);
+    uint16_t* yData = allocateVector<uint16_t>(y, n, DType::bf16);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        xData[i] = Conversions::fp32_to_bf16(static_cast<float>(i % 7) - 3.0f, RoundingMode::NearestEven);
+        yData[i] = Conversions::fp32_to_bf16(2.0f, RoundingMode::NearestEven);
+    }
+    double result = 0.0;
+    ASSERT_EQ(ops.dot(x, y, result), gStatus::gBLAS_PASS);
+    double expected = 0.0;
+    for (uint64_t i = 0; i < n; ++i) expected += 2.0 * (static_cast<double>(i % 7) - 3.0);
+    EXPECT_DOUBLE_EQ(result, expected);
+    ASSERT_EQ(ops.scal(0.5, x), gStatus::gBLAS_PASS);
+    EXPECT_EQ(Conversions::bf16_to_fp32(xData[6]), 1.5f);
+
+    int8_t* aData = allocateVector<int8_t>(x, n, DType::int8);
+    int8_t* bData = allocateVector<int8_t>(y, n, DType::int8);
+    int64_t exact = 0;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        aData[i] = static_cast<int8_t>(i % 2 ? 127 : -128);
+        bData[i] = static_cast<int8_t>(-128);
+        exact += static_cast<int64_t>(aData[i]) * bData[i];
+    }
+    ASSERT_EQ(ops.dot(x, y, result), gStatus::gBLAS_PASS);
+    EXPECT_EQ(result, static_cast<double>(exact));
+    ASSERT_EQ(ops.asum(x, result), gStatus::gBLAS_PASS);
+    EXPECT_EQ(result, 150.0 * 128 + 150.0 * 127);
+    uint64_t index = 1;
+    ASSERT_EQ(ops.iamax(x, index), gStatus::gBLAS_PASS);
+    EXPECT_EQ(index, 0u);
+
+    int32_t* cData = allocateVector<int32_t>(x, n, DType::int32);
+    for (uint64_t i = 0; i < n; ++i) cData[i] = static_cast<int32_t>(i);
+    ASSERT_EQ(ops.scal(3.7, x), gStatus::gBLAS_PASS);
+    EXPECT_EQ(cData[10], 30);
+
+    // products near the top of int32 and int64 do not wrap the sum
+    int32_t* dData = allocateVector<int32_t>(x, 4, DType::int32);
+    for (uint64_t i = 0; i < 4; ++i) dData[i] = 2000000000;
+    ASSERT_EQ(ops.dot(x, x, result), gStatus::gBLAS_PASS);
+    EXPECT_EQ(result, 1.6e19);
+    int64_t* eData = allocateVector<int64_t>(x, 3, DType::int64);
+    for (uint64_t i = 0; i < 3; ++i) eData[i] = -(int64_t(1) << 62);
+    ASSERT_EQ(ops.dot(x, x, result), gStatus::gBLAS_PASS);
+    EXPECT_EQ(result, std::ldexp(3.0, 124));
+}
+
+TEST_F(Level1Test, strided_views)
+{
+    const uint64_t cols = 40, rows = 30;
+    const int64_t ld = static_cast<int64_t>(cols);
+    gTensor matrix({cols, rows, 1, 1, 1}, {1, ld, ld * (int64_t)rows, ld * (int64_t)rows, ld * (int64_t)rows}, 2,
+                   DType::fp32);
+    matrix.allocateData();
+    float* data = reinterpret_cast<float*>(matrix.data());
+    for (uint64_t i = 0; i < cols * rows; ++i) data[i] = static_cast<float>(i % 23) - 11.0f;
+
+    // iamax counts in the element order of the view, dim 0 of the transpose walks down the columns
+    gTensor transposed = matrix.transpose(0, 1);
+    data[5 * cols + 3] = 100.0f;
+    uint64_t index = 0;
+    ASSERT_EQ(ops.iamax(transposed, index), gStatus::gBLAS_PASS);
+    EXPECT_EQ(index, 3 * rows + 5);
+
+    // even and odd columns, rotated by 90 degrees and swapped back
+    gTensor even = matrix.slice(0, 0, cols, 2);
+    gTensor odd = matrix.slice(0, 1, cols, 2);
+    const std::vector<float> before(data, data + cols * rows);
+    ASSERT_EQ(ops.rot(even, odd, 0.0, 1.0), gStatus::gBLAS_PASS);
+    for (uint64_t i = 0; i < cols * rows; i += 2)
+    {
+        ASSERT_EQ(data[i], before[i + 1]);
+        ASSERT_EQ(data[i + 1], -before[i]);
+    }
+    ASSERT_EQ(ops.swap(even, odd), gStatus::gBLAS_PASS);
+    ASSERT_EQ(ops.scal(-1.0, even), gStatus::gBLAS_PASS);
+    for (uint64_t i = 0; i < cols * rows; ++i) ASSERT_EQ(data[i], before[i]) << i;
+
+    double dense = 0.0, strided = 0.0;
+    gTensor evenCopy = even.clone();
+    float* packedData = allocateVector<float>(x, even.getTotalSizeInElements(), DType::fp32);
+    gTensor packedView({cols / 2, rows, 1, 1, 1}, {1, (int64_t)cols / 2, 0, 0, 0}, 2, DType::fp32);
+    packedView.initData(reinterpret_cast<byte*>(packedData));
+    ASSERT_EQ(ops.copy(even, packedView), gStatus::gBLAS_PASS);
+    EXPECT_EQ(packedData[cols / 2 + 1], data[cols + 2]);
+    ASSERT_EQ(ops.dot(packedView, packedView, dense), gStatus::gBLAS_PASS);
+    ASSERT_EQ(ops.dot(even, evenCopy, strided), gStatus::gBLAS_PASS);
+    EXPECT_EQ(dense, strided);
+}
+
+TEST_F(Level1Test, nrm2_scaling_and_nan)
+{
+    const uint64_t n = 64;
+    float* xData = allocateVector<float>(x, n, DType::fp32);
+    double result = 0.0;
+    for (float value : {1e-30f, 1e30f})
+    {
+        for (uint64_t i = 0; i < n; ++i) xData[i] = value;
+        ASSERT_EQ(ops.nrm2(x, result), gStatus::gBLAS_PASS);
+        EXPECT_NEAR(result / (8.0 * value), 1.0, 1e-6) << value;
+    }
+    double* aData = allocateVector<double>(y, n, DType::fp64);
+    for (uint64_t i = 0; i < n; ++i) aData[i] = 1e200;
+    ASSERT_EQ(ops.nrm2(y, result), gStatus::gBLAS_PASS);
+    EXPECT_NEAR(result / 8e200, 1.0, 1e-12);
+
+    // only subnormals: the scale that brings them near 1 does not fit the type itself
+    for (uint64_t i = 0; i < n; ++i) xData[i] = i < 4 ? static_cast<float>(i + 1) * 1e-40f : 0.0f;
+    ASSERT_EQ(ops.nrm2(x, result), gStatus::gBLAS_PASS);
+    double squares = 0.0;
+    for (uint64_t i = 0; i < 4; ++i) squares += static_cast<double>(xData[i]) * xData[i];
+    EXPECT_NEAR(result / std::sqrt(squares), 1.0, 1e-6);
+    for (uint64_t i = 0; i < n; ++i) aData[i] = i < 4 ? static_cast<double>(i + 1) * 1e-310 : 0.0;
+    ASSERT_EQ(ops.nrm2(y, result), gStatus::gBLAS_PASS);
+    EXPECT_NEAR(result / (std::sqrt(30.0) * 1e-310), 1.0, 1e-6);
+
+    // NaN propagates through the norm but is skipped by iamax, ties keep the first index
+    for (uint64_t i = 0; i < n; ++i) xData[i] = i % 2 ? -3.0f : 1.0f;
+    xData[0] = std::numeric_limits<float>::quiet_NaN();
+    uint64_t index = 0;
+    ASSERT_EQ(ops.iamax(x, index), gStatus::gBLAS_PASS);
+    EXPECT_EQ(index, 1u);
+    ASSERT_EQ(ops.nrm2(x, result), gStatus::gBLAS_PASS);
+    EXPECT_TRUE(std::isnan(result));
+}
+
+TEST_F(Level1Test, reductions_do_not_depend_on_threads)
+{
+    const uint64_t n = 1 << 20;
+    float* xData = allocateVector<float>(x, n, DType::fp32);
+    float* yData = allocateVector<float>(y, n, DType::fp32);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        xData[i] = 1.0f / static_cast<float>(1 + i % 1013);
+        yData[i] = static_cast<float>(i % 7) - 3.3f;
+    }
+    std::vector<double> results;
+    for (unsigned threads : {1u, 3u, 4u})
+    {
+        setThreadPoolOptions({threads});
+        double dot = 0.0, norm = 0.0;
+        ASSERT_EQ(ops.dot(x, y, dot), gStatus::gBLAS_PASS);
+        ASSERT_EQ(ops.nrm2(x, norm), gStatus::gBLAS_PASS);
+        results.push_back(dot);
+        results.push_back(norm);
+    }
+    setThreadPoolOptions({});
+    for (size_t i = 2; i < results.size(); ++i) EXPECT_EQ(results[i], results[i % 2]);
+}
+
+TEST_F(Level1Test, mismatched_inputs_fail)
+{
+    allocateVector<float>(x, 16, DType::fp32);
+    allocateVector<float>(y, 8, DType::fp32);
+    double result = 0.0;
+    EXPECT_EQ(ops.dot(x, y, result), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.copy(x, y), gStatus::gBLAS_FAIL);
+    allocateVector<double>(y, 16, DType::fp64);
+    EXPECT_EQ(ops.swap(x, y), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.rot(x, y, 1.0, 0.0), gStatus::gBLAS_FAIL);
+
+    // integer scal takes the rule of axpy for alpha, rot saturates its results
+    int16_t* aData = allocateVector<int16_t>(x, 4, DType::int16);
+    int16_t* bData = allocateVector<int16_t>(y, 4, DType::int16);
+    EXPECT_EQ(ops.scal(40000.0, x), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.scal(std::nan(""), x), gStatus::gBLAS_FAIL);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        aData[i] = 30000;
+        bData[i] = -30000;
+    }
+    ASSERT_EQ(ops.rot(x, y, 1.0, -1.0), gStatus::gBLAS_PASS);
+    EXPECT_EQ(aData[0], std::numeric_limits<int16_t>::max());
+    EXPECT_EQ(bData[0], 0);
+    ASSERT_EQ(ops.rot(x, y, std::nan(""), 0.0), gStatus::gBLAS_PASS);
+    EXPECT_EQ(aData[1], 0);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "data_types/non_conventional_dtypes.h"
+#include "kernels/kernels.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace gblas;
+
+class AxpyTest : public testing::Test
+{
+public:
+    // the tensor owns the zero initialized buffer
+    template<typename T>
+    T* allocateTensor(gTensor& tensor, TSizeArr sizes, TStrideArr strides, unsigned rank, DType dtype)
+    {
+        tensor = gTensor{sizes, strides, rank, dtype};
+        tensor.allocateData();
+        return reinterpret_cast<T*>(tensor.data());
+    }
+protected:
+    Operations ops;
+    gTensor x, y, out;
+};
+
+TEST_F(AxpyTest, dense_fp32)
+{
+    const unsigned n = 1000; // not a multiple of any vector width
+    auto xData = allocateTensor<float>(x, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::fp32);
+    auto yData = allocateTensor<float>(y, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::fp32);
+    auto outData = allocateTensor<float>(out, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::fp32);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        xData[i] = static_cast<float>(i);
+        yData[i] = 1.0f;
+    }
+    EXPECT_EQ(ops.axpy(2.0, x, y, out), gStatus::gBLAS_PASS);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(outData[i], 2.0f * i + 1.0f);
+    }
+}
+
+TEST_F(AxpyTest, in_place_fp64)
+{
+    const unsigned n = 37;
+    auto xData = allocateTensor<double>(x, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::fp64);
+    auto yData = allocateTensor<double>(y, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::fp64);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        xData[i] = 0.5 * i;
+        yData[i] = -1.0;
+    }
+    EXPECT_EQ(ops.axpy(4.0, x, y, y), gStatus::gBLAS_PASS);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(yData[i], 2.0 * i - 1.0);
+    }
+}
+
+TEST_F(AxpyTest, strided_int32)
+{
+    // x is a 10x10 window of a 20 wide row pitch, y and out are dense
+    auto xData = allocateTensor<int32_t>(x, {10, 10, 1, 1, 1}, {1, 20, 200, 200, 200}, 2, DType::int32);
+    auto yData = allocateTensor<int32_t>(y, {10, 10, 1, 1, 1}, {1, 10, 100, 100, 100}, 2, DType::int32);
+    auto outData = allocateTensor<int32_t>(out, {10, 10, 1, 1, 1}, {1, 10, 100, 100, 100}, 2, DType::int32);
+    for (unsigned i = 0; i < 20 * 9 + 10; ++i) xData[i] = static_cast<int32_t>(i);
+    for (unsigned i = 0; i < 100; ++i) yData[i] = 3;
+    EXPECT_EQ(ops.axpy(2, x, y, out), gStatus::gBLAS_PASS);
+    for (unsigned row = 0; row < 10; ++row)
+    {
+        for (unsigned col = 0; col < 10; ++col)
+        {
+            EXPECT_EQ(outData[row * 10 + col], 2 * static_cast<int32_t>(row * 20 + col) + 3);
+        }
+    }
+}
+
+TEST_F(AxpyTest, integer_overflow_wraps)
+{
+    // the same wrapped results from the vector kernels, their scalar fallback and the strided loop
+    const unsigned n = 37;
+    auto xData = allocateTensor<int32_t>(x, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::int32);
+    auto yData = allocateTensor<int32_t>(y, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::int32);
+    auto outData = allocateTensor<int32_t>(out, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::int32);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        xData[i] = std::numeric_limits<int32_t>::max() - static_cast<int32_t>(i);
+        yData[i] = std::numeric_limits<int32_t>::max();
+    }
+    ASSERT_EQ(ops.axpy(3, x, y, out), gStatus::gBLAS_PASS);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        const uint32_t expected = 3u * static_cast<uint32_t>(xData[i]) + static_cast<uint32_t>(yData[i]);
+        EXPECT_EQ(outData[i], static_cast<int32_t>(expected)) << i;
+    }
+    gTensor strided = x.slice(0, 0, n, 2);
+    gTensor yStrided = y.slice(0, 0, n, 2);
+    gTensor outStrided = out.slice(0, 0, n, 2);
+    ASSERT_EQ(ops.axpy(-2, strided, yStrided, outStrided), gStatus::gBLAS_PASS);
+    for (unsigned i = 0; i < n; i += 2)
+    {
+        const uint32_t expected = static_cast<uint32_t>(-2) * static_cast<uint32_t>(xData[i]) +
+                                  static_cast<uint32_t>(yData[i]);
+        EXPECT_EQ(outData[i], static_cast<int32_t>(expected)) << i;
+    }
+
+    auto xWide = allocateTensor<int64_t>(x, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::int64);
+    auto yWide = allocateTensor<int64_t>(y, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::int64);
+    auto outWide = allocateTensor<int64_t>(out, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, DType::int64);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        xWide[i] = std::numeric_limits<int64_t>::min() + static_cast<int64_t>(i);
+        yWide[i] = -1;
+    }
+    ASSERT_EQ(ops.axpy(5, x, y, out), gStatus::gBLAS_PASS);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        const uint64_t expected = 5u * static_cast<uint64_t>(xWide[i]) + static_cast<uint64_t>(yWide[i]);
+        EXPECT_EQ(outWide[i], static_cast<int64_t>(expected)) << i;
+    }
+}
+
+TEST_F(AxpyTest, transposed_output_fp32)
+{
+    // out walks dim 0 with a stride, so no dim can be treated as contiguous for all tensors
+    auto xData = allocateTensor<float>(x, {8, 4, 1, 1, 1}, {1, 8, 32, 32, 32}, 2, DType::fp32);
+    auto yData = allocateTensor<float>(y, {8, 4, 1, 1, 1}, {1, 8, 32, 32, 32}, 2, DType::fp32);
+    auto outData = allocateTensor<float>(out, {8, 4, 1, 1, 1}, {4, 1, 32, 32, 32}, 2, DType::fp32);
+    for (unsigned i = 0; i < 32; ++i)
+    {
+        xData[i] = static_cast<float>(i);
+        yData[i] = 100.0f;
+    }
+    EXPECT_EQ(ops.axpy(1.0, x, y, out), gStatus::gBLAS_PASS);
+    for (unsigned c = 0; c < 8; ++c)
+    {
+        for (unsigned r = 0; r < 4; ++r)
+        {
+            EXPECT_EQ(outData[c * 4 + r], static_cast<float>(r * 8 + c) + 100.0f);
+        }
+    }
+}
+
+template<typename T>
+class AxpyLowPrecisionTest : public AxpyTest {};
+
+using lowPrecisionTypes = ::testing::Types<bf16_t, fp16_t, fp8_152, fp8_143>;
+TYPED_TEST_SUITE(AxpyLowPrecisionTest, lowPrecisionTypes);
+
+template<typename T> constexpr DType dtypeOf();
+template<> constexpr DType dtypeOf<bf16_t>() {return DType::bf16;}
+template<> constexpr DType dtypeOf<fp16_t>() {return DType::fp16;}
+template<> constexpr DType dtypeOf<fp8_152>() {return DType::fp8_152;}
+template<> constexpr DType dtypeOf<fp8_143>() {return DType::fp8_143;}
+
+TYPED_TEST(AxpyLowPrecisionTest, matches_fp32_reference)
+{
+    const unsigned n = 333;
+    const DType dtype = dtypeOf<TypeParam>();
+    auto xData = this->template allocateTensor<TypeParam>(this->x, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, dtype);
+    auto yData = this->template allocateTensor<TypeParam>(this->y, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, dtype);
+    auto outData = this->template allocateTensor<TypeParam>(this->out, {n, 1, 1, 1, 1}, {1, n, n, n, n}, 1, dtype);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        xData[i] = TypeParam(static_cast<float>(i % 7) * 0.25f);
+        yData[i] = TypeParam(static_cast<float>(i % 5) - 2.0f);
+    }
+    EXPECT_EQ(this->ops.axpy(1.5, this->x, this->y, this->out), gStatus::gBLAS_PASS);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        TypeParam expected(1.5f * xData[i].toFloat() + yData[i].toFloat());
+        EXPECT_EQ(outData[i].value(), expected.value()) << "index " << i;
+    }
+}
+
+TEST_F(AxpyTest, mismatched_inputs_fail)
+{
+    allocateTensor<float>(x, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::fp32);
+    allocateTensor<float>(y, {8, 1, 1, 1, 1}, {1, 8, 8, 8, 8}, 1, DType::fp32);
+    allocateTensor<float>(out, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::fp32);
+    EXPECT_EQ(ops.axpy(1.0, x, y, out), gStatus::gBLAS_FAIL);
+    allocateTensor<double>(y, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::fp64);
+    EXPECT_EQ(ops.axpy(1.0, x, y, out), gStatus::gBLAS_FAIL);
+
+    // an integer alpha must be finite and fit the element type once truncated
+    allocateTensor<uint8_t>(x, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::uint8);
+    allocateTensor<uint8_t>(y, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::uint8);
+    allocateTensor<uint8_t>(out, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::uint8);
+    EXPECT_EQ(ops.axpy(255.9, x, y, out), gStatus::gBLAS_PASS);
+    EXPECT_EQ(ops.axpy(-0.5, x, y, out), gStatus::gBLAS_PASS);
+    EXPECT_EQ(ops.axpy(256.0, x, y, out), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.axpy(-1.0, x, y, out), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.axpy(std::nan(""), x, y, out), gStatus::gBLAS_FAIL);
+    allocateTensor<int32_t>(x, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::int32);
+    allocateTensor<int32_t>(y, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::int32);
+    allocateTensor<int32_t>(out, {16, 1, 1, 1, 1}, {1, 16, 16, 16, 16}, 1, DType::int32);
+    EXPECT_EQ(ops.axpy(3e9, x, y, out), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.axpy(INFINITY, x, y, out), gStatus::gBLAS_FAIL);
+}
+
+TEST(KernelTableTest, every_supported_level_agrees)
+{
+    const unsigned n = 100;
+    std::vector<float> x(n), y(n), expected(n), result(n);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        x[i] = static_cast<float>(i) * 0.5f;
+        y[i] = static_cast<float>(n - i);
+    }
+    kernels::getKernelTable(IsaLevel::Scalar)->axpyF32(n, 3.0f, x.data(), y.data(), expected.data());
+    for (int level = 0; level < static_cast<int>(IsaLevel::IsaLevelNR); ++level)
+    {
+        const kernels::KernelTable* table = kernels::getKernelTable(static_cast<IsaLevel>(level));
+        if (!table) continue;
+        table->axpyF32(n, 3.0f, x.data(), y.data(), result.data());
+        EXPECT_EQ(result, expected) << isaLevelName(table->isa);
+    }
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "gTensor/gTensorIterator.h"
+#include "operations/operations.h"
+#include "runtime/Parallel.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gblas;
+
+TEST(ParallelTest, every_index_once)
+{
+    ThreadPool pool(ThreadPoolOptions{4});
+    EXPECT_EQ(pool.getNumOfThreads(), 4);
+    for (uint64_t count : {uint64_t(1), uint64_t(7), uint64_t(1000), uint64_t(100003)})
+    {
+        for (uint64_t grain : {uint64_t(1), uint64_t(16), uint64_t(5000)})
+        {
+            std::vector<std::atomic<unsigned>> hits(count);
+            std::atomic<unsigned> maxThread{0};
+            pool.parallelFor(count, grain, 3, [&](uint64_t begin, uint64_t end, unsigned thread)
+            {
+                EXPECT_LE(end - begin, grain);
+                for (uint64_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+                unsigned seen = maxThread.load();
+                while (thread > seen && !maxThread.compare_exchange_weak(seen, thread)) {}
+            });
+            for (uint64_t i = 0; i < count; ++i) ASSERT_EQ(hits[i].load(), 1) << count << " " << grain << " " << i;
+            EXPECT_LT(maxThread.load(), 3);
+        }
+    }
+}
+
+TEST(ParallelTest, uneven_work_is_stolen)
+{
+    ThreadPool pool(ThreadPoolOptions{4});
+    // all the slow indices start out on thread 0, the others steal them
+    std::vector<unsigned> owner(64, 0);
+    pool.parallelFor(64, 1, 4, [&](uint64_t begin, uint64_t end, unsigned thread)
+    {
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            if (i < 16) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            owner[i] = thread;
+        }
+    });
+    bool stolen = false;
+    for (uint64_t i = 0; i < 16; ++i) stolen |= owner[i] != 0;
+    EXPECT_TRUE(stolen);
+}
+
+TEST(ParallelTest, errors_and_nesting)
+{
+    ThreadPool pool(ThreadPoolOptions{4});
+    EXPECT_THROW(pool.parallelFor(100, 1, 4, [](uint64_t begin, uint64_t, unsigned)
+    {
+        if (begin == 57) throw std::runtime_error("failed");
+    }), std::runtime_error);
+
+    // a loop started inside a loop runs serially on the thread that started it
+    std::atomic<uint64_t> total{0};
+    pool.parallelFor(8, 1, 4, [&](uint64_t, uint64_t, unsigned outer)
+    {
+        pool.parallelFor(100, 10, 4, [&](uint64_t begin, uint64_t end, unsigned inner)
+        {
+            EXPECT_EQ(inner, 0);
+            total += end - begin;
+        });
+        (void)outer;
+    });
+    EXPECT_EQ(total.load(), 800);
+
+    // callers on several threads share the pool
+    std::vector<std::thread> callers;
+    std::atomic<uint64_t> sum{0};
+    for (int t = 0; t < 4; ++t)
+    {
+        callers.emplace_back([&]()
+        {
+            for (int rep = 0; rep < 50; ++rep)
+            {
+                pool.parallelFor(1000, 10, 4, [&](uint64_t begin, uint64_t end, unsigned) {sum += end - begin;});
+            }
+        });
+    }
+    for (auto& caller : callers) caller.join();
+    EXPECT_EQ(sum.load(), 4 * 50 * 1000);
+}
+
+TEST(ParallelTest, affinity_and_tiles)
+{
+    const auto nodes = getNumaNodes();
+    ASSERT_FALSE(nodes.empty());
+    ThreadPool pinned(ThreadPoolOptions{3, Affinity::Compact, 0});
+    EXPECT_EQ(pinned.getThreadCpu(0), -1);
+    for (unsigned thread = 1; thread < 3; ++thread)
+    {
+        const int cpu = pinned.getThreadCpu(thread);
+        // pinning may be refused in a restricted environment, a pinned thread sits on node 0
+        if (cpu >= 0)
+        {
+            EXPECT_NE(std::find(nodes[0].begin(), nodes[0].end(), static_cast<unsigned>(cpu)), nodes[0].end());
+        }
+    }
+
+    std::vector<std::atomic<unsigned>> grid(37 * 53);
+    parallelForTiles(37, 53, 8, 16, [&](uint64_t rowBegin, uint64_t rowEnd, uint64_t colBegin, uint64_t colEnd, unsigned)
+    {
+        EXPECT_LE(rowEnd - rowBegin, 8);
+        EXPECT_LE(colEnd - colBegin, 16);
+        for (uint64_t row = rowBegin; row < rowEnd; ++row)
+        {
+            for (uint64_t col = colBegin; col < colEnd; ++col) grid[row * 53 + col].fetch_add(1);
+        }
+    });
+    for (const auto& hits : grid) ASSERT_EQ(hits.load(), 1);
+}
+
+TEST(ParallelTest, parallel_axpy_on_views)
+{
+    // large enough to be split over the pool, with a strided operand
+    const uint64_t cols = 3000, rows = 40;
+    gTensor x({cols, rows, 1, 1, 1}, {1, (int64_t)cols, (int64_t)(cols * rows), (int64_t)(cols * rows),
+              (int64_t)(cols * rows)}, 2, DType::fp32);
+    gTensor y({2 * cols, rows, 1, 1, 1}, {1, 2 * (int64_t)cols, 2 * (int64_t)(cols * rows),
+              2 * (int64_t)(cols * rows), 2 * (int64_t)(cols * rows)}, 2, DType::fp32);
+    x.allocateData();
+    y.allocateData();
+    float* xData = reinterpret_cast<float*>(x.data());
+    float* yData = reinterpret_cast<float*>(y.data());
+    for (uint64_t i = 0; i < cols * rows; ++i) xData[i] = static_cast<float>(i % 97);
+    for (uint64_t i = 0; i < 2 * cols * rows; ++i) yData[i] = static_cast<float>(i % 13);
+    gTensor yView = y.slice(0, 1, 2 * cols, 2);
+    gTensor out = x.clone();
+
+    Operations ops;
+    ASSERT_EQ(ops.axpy(2.0, x, yView, out), gStatus::gBLAS_PASS);
+    const float* outData = reinterpret_cast<const float*>(out.data());
+    for (uint64_t row = 0; row < rows; ++row)
+    {
+        for (uint64_t col = 0; col < cols; ++col)
+        {
+            const uint64_t i = row * cols + col;
+            ASSERT_EQ(outData[i], 2.0f * xData[i] + yData[row * 2 * cols + 2 * col + 1]) << row << " " << col;
+        }
+    }
+}
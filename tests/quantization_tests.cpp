@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "operations/quantization.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "test_utils.h"
+
+using namespace gblas;
+using namespace gblas::test;
+
+class QuantizationTest : public testing::Test
+{
+public:
+    static float* fp32(gTensor& tensor) {return reinterpret_cast<float*>(tensor.data());}
+    static float at(const gTensor& tensor, uint64_t col, uint64_t row)
+    {
+        const int64_t offset = static_cast<int64_t>(col) * tensor.getStride(0) + static_cast<int64_t>(row) * tensor.getStride(1);
+        return reinterpret_cast<const float*>(tensor.data())[offset];
+    }
+};
+
+TEST_F(QuantizationTest, round_trip_within_half_a_step)
+{
+    const uint64_t cols = 300, rows = 70;
+    gTensor x = makeMatrix(rows, cols);
+    // every row has its own magnitude so the granularities pick different scales
+    float amax = 0.0f;
+    for (uint64_t r = 0; r < rows; ++r)
+    {
+        for (uint64_t c = 0; c < cols; ++c)
+        {
+            fp32(x)[r * cols + c] = std::sin(static_cast<float>(c * 7 + r)) * static_cast<float>(r + 1);
+            amax = std::max(amax, std::abs(fp32(x)[r * cols + c]));
+        }
+    }
+    const gTensor xT = x.transpose(0, 1);
+    // lines longer than a piece of work split a group over several pieces
+    gTensor wide = makeMatrix(2, 9000);
+    for (uint64_t i = 0; i < 18000; ++i) fp32(wide)[i] = std::cos(static_cast<float>(i)) * (i < 9000 ? 1.0f : 0.25f);
+    const QuantizationScheme schemes[] = {
+        {ScaleGranularity::PerTensor, 0, 0},
+        {ScaleGranularity::PerChannel, 1, 0},
+        {ScaleGranularity::PerBlock, 0, 32},
+        {ScaleGranularity::PerBlock, 1, 16},
+    };
+    Operations ops;
+    const gTensor* sources[] = {&x, &xT, &wide};
+    for (const gTensor* source : sources)
+    {
+        for (DType dtype : {DType::int8, DType::fp8_143, DType::fp8_152})
+        {
+            for (const QuantizationScheme& scheme : schemes)
+            {
+                QuantizedTensor q = makeQuantizedTensor(*source, dtype, scheme);
+                ASSERT_EQ(ops.quantize(*source, q), gStatus::gBLAS_PASS);
+                gTensor back = source->clone();
+                ASSERT_EQ(ops.dequantize(q, back), gStatus::gBLAS_PASS);
+
+                // the scale of the group holding the largest element maps it onto the largest quantized value
+                const TSizeArr scaleSizes = q.scales.getAllSizesInElements();
+                const float qmax = getQuantizedMax(dtype);
+                float largestScale = 0.0f;
+                for (uint64_t i = 0; i < scaleSizes[0] * scaleSizes[1]; ++i)
+                {
+                    largestScale = std::max(largestScale, fp32(q.scales)[i]);
+                }
+                EXPECT_FLOAT_EQ(largestScale * qmax, source == &wide ? 1.0f : amax);
+
+                const float relative = dtype == DType::int8 ? 0.0f : dtype == DType::fp8_143 ? 0.0625f : 0.125f;
+                for (uint64_t c = 0; c < source->getSize(0); ++c)
+                {
+                    for (uint64_t r = 0; r < source->getSize(1); ++r)
+                    {
+                        uint64_t scaleCoord[2] = {c, r};
+                        for (unsigned dim = 0; dim < 2; ++dim)
+                        {
+                            const uint64_t size = source->getSize(dim);
+                            const bool blocked = scheme.granularity == ScaleGranularity::PerBlock && dim == scheme.axis;
+                            scaleCoord[dim] /= blocked ? scheme.blockSize : (size + scaleSizes[dim] - 1) / scaleSizes[dim];
+                        }
+                        const float scale = at(q.scales, scaleCoord[0], scaleCoord[1]);
+                        const float value = at(*source, c, r);
+                        // the fp8 encoders flush below the smallest normal
+                        const int minNormal = dtype == DType::fp8_143 ? -6 : -14;
+                        const float step = dtype == DType::int8 ? 0.5f * scale : std::ldexp(scale, minNormal);
+                        ASSERT_LE(std::abs(at(back, c, r) - value), relative * std::abs(value) + step)
+                            << static_cast<int>(dtype) << " " << static_cast<int>(scheme.granularity) << " " << c << " " << r;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(QuantizationTest, given_scales_saturate_and_round)
+{
+    gTensor x = makeMatrix(1, 6);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float values[6] = {1000.0f, -1e9f, 2.7f, -2.2f, 0.5f, nan};
+    std::copy(values, values + 6, fp32(x));
+    Operations ops;
+
+    QuantizedTensor fp8 = makeQuantizedTensor(x, DType::fp8_143);
+    fp32(fp8.scales)[0] = 1.0f;
+    ASSERT_EQ(ops.quantize(x, fp8, false), gStatus::gBLAS_PASS);
+    gTensor back = makeMatrix(1, 6);
+    ASSERT_EQ(ops.dequantize(fp8, back), gStatus::gBLAS_PASS);
+    EXPECT_EQ(fp32(back)[0], 240.0f);
+    EXPECT_EQ(fp32(back)[1], -240.0f);
+    EXPECT_TRUE(std::isnan(fp32(back)[5]));
+
+    QuantizedTensor i8 = makeQuantizedTensor(x, DType::int8);
+    fp32(i8.scales)[0] = 0.5f;
+    ASSERT_EQ(ops.quantize(x, i8, false, RoundingMode::RoundDown), gStatus::gBLAS_PASS);
+    const int8_t* q = reinterpret_cast<const int8_t*>(i8.data.data());
+    EXPECT_EQ(q[0], 127);
+    EXPECT_EQ(q[1], -127);
+    EXPECT_EQ(q[2], 5);
+    EXPECT_EQ(q[3], -5);
+    EXPECT_EQ(q[4], 1);
+    ASSERT_EQ(ops.quantize(x, i8, false), gStatus::gBLAS_PASS);
+    EXPECT_EQ(q[2], 5);
+    EXPECT_EQ(q[3], -4);
+    ASSERT_EQ(ops.dequantize(i8, back), gStatus::gBLAS_PASS);
+    EXPECT_EQ(fp32(back)[3], -2.0f);
+
+    // an all zero tensor keeps a scale of 1
+    gTensor zeros = makeMatrix(1, 6);
+    ASSERT_EQ(ops.quantize(zeros, i8), gStatus::gBLAS_PASS);
+    EXPECT_EQ(fp32(i8.scales)[0], 1.0f);
+}
+
+TEST_F(QuantizationTest, invalid_input_is_rejected)
+{
+    const gTensor x = makeMatrix(4, 8);
+    EXPECT_THROW(makeQuantizedTensor(x, DType::fp32), std::invalid_argument);
+    EXPECT_THROW(makeQuantizedTensor(x, DType::int8, {ScaleGranularity::PerChannel, 2, 0}), std::invalid_argument);
+    EXPECT_THROW(makeQuantizedTensor(x, DType::int8, {ScaleGranularity::PerBlock, 0, 0}), std::invalid_argument);
+    const TSizeArr blockSizes = getScaleSizes(x.getAllSizesInElements(), 2, {ScaleGranularity::PerBlock, 0, 3});
+    EXPECT_EQ(blockSizes[0], 3u);
+    EXPECT_EQ(blockSizes[1], 4u);
+
+    Operations ops;
+    QuantizedTensor q = makeQuantizedTensor(x, DType::int8, {ScaleGranularity::PerChannel, 1, 0});
+    // scales of another scheme, an integer input and a shape mismatch
+    QuantizedTensor wrongScales = q;
+    wrongScales.scheme = {ScaleGranularity::PerChannel, 0, 0};
+    EXPECT_EQ(ops.quantize(x, wrongScales), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.quantize(makeMatrix(4, 8, DType::int32), q), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(ops.quantize(makeMatrix(8, 4), q), gStatus::gBLAS_FAIL);
+    gTensor out = makeMatrix(4, 8, DType::int16);
+    EXPECT_EQ(ops.dequantize(q, out), gStatus::gBLAS_FAIL);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "gTensor/TensorFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "test_utils.h"
+
+using namespace gblas;
+using namespace gblas::test;
+
+class TensorFileTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        path = testing::TempDir() + "gblas_tensor_file_" +
+               testing::UnitTest::GetInstance()->current_test_info()->name() + ".gbt";
+    }
+    void TearDown() override {std::remove(path.c_str());}
+
+    static gTensor makeFilled(uint64_t cols, uint64_t rows, DType dtype, Layout layout = Layout::RowMajor)
+    {
+        gTensor tensor = makeTensor({cols, rows}, dtype, layout);
+        for (uint64_t i = 0; i < tensor.getMemorySizeInBytes(); ++i) tensor.data()[i] = static_cast<byte>(i * 7 + 3);
+        return tensor;
+    }
+protected:
+    std::string path;
+};
+
+TEST_F(TensorFileTest, round_trip_maps_without_copies)
+{
+    const gTensor weights = makeFilled(300, 17, DType::bf16);
+    const gTensor bias = makeFilled(17, 1, DType::fp32, Layout::ColMajor);
+    // a view keeps its strides: every other column of a transposed matrix
+    const gTensor view = makeFilled(40, 30, DType::int8).transpose(0, 1).slice(1, 0, 40, 2);
+    const gTensor empty({0, 4, 1, 1, 1}, {1, 1, 4, 4, 4}, 2, DType::fp64);
+    saveTensorFile(path, {{"weights", weights}, {"bias", bias}, {"view", view}, {"empty", empty}});
+
+    for (MapHint hint : {MapHint::None, MapHint::Sequential, MapHint::Populate})
+    {
+        MappedTensorFile file(path, hint);
+        ASSERT_EQ(file.getNumOfTensors(), 4u);
+        EXPECT_EQ(file.getName(2), "view");
+        EXPECT_TRUE(file.contains("bias"));
+        EXPECT_FALSE(file.contains("missing"));
+        EXPECT_THROW(file.getTensor("missing"), std::out_of_range);
+        for (const gTensor* original : {&weights, &bias, &view})
+        {
+            const std::string name = original == &weights ? "weights" : original == &bias ? "bias" : "view";
+            const gTensor& loaded = file.getTensor(name);
+            EXPECT_EQ(loaded.getRank(), original->getRank());
+            EXPECT_EQ(loaded.getDType(), original->getDType());
+            EXPECT_EQ(loaded.getLayout(), original->getLayout());
+            EXPECT_EQ(loaded.getAllSizesInElements(), original->getAllSizesInElements());
+            EXPECT_EQ(loaded.getAllStridesInElements(), original->getAllStridesInElements());
+            ASSERT_EQ(loaded.getMemorySizeInBytes(), original->getMemorySizeInBytes());
+            EXPECT_EQ(std::memcmp(loaded.data(), original->data(), loaded.getMemorySizeInBytes()), 0) << name;
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded.data()) % kPageSize, 0u) << name;
+        }
+        EXPECT_EQ(file.getTensor("empty").getTotalSizeInElements(), 0u);
+        EXPECT_EQ(file.getTensor("empty").data(), nullptr);
+        file.prefetch(0);
+    }
+}
+
+TEST_F(TensorFileTest, tensors_outlive_the_file_and_never_write_back)
+{
+    saveTensorFile(path, {{"a", makeFilled(64, 64, DType::fp32)}}, kCacheLineSize);
+    gTensor tensor;
+    {
+        MappedTensorFile file(path);
+        tensor = file.getTensor("a");
+    }
+    const byte first = tensor.data()[0];
+    tensor.data()[0] = static_cast<byte>(first + 1);
+    MappedTensorFile again(path);
+    EXPECT_EQ(again.getTensor(0).data()[0], first);
+    EXPECT_EQ(tensor.data()[0], static_cast<byte>(first + 1));
+}
+
+TEST_F(TensorFileTest, invalid_input_is_rejected)
+{
+    const gTensor tensor = makeFilled(8, 8, DType::fp32);
+    EXPECT_THROW(saveTensorFile(path, {{"a", tensor}, {"a", tensor}}), std::invalid_argument);
+    EXPECT_THROW(saveTensorFile(path, {{"a", tensor}}, 100), std::invalid_argument);
+    gTensor unallocated({8, 8, 1, 1, 1}, {1, 8, 64, 64, 64}, 2, DType::fp32);
+    EXPECT_THROW(saveTensorFile(path, {{"a", unallocated}}), std::invalid_argument);
+    EXPECT_THROW(MappedTensorFile(path + ".missing"), std::runtime_error);
+
+    // a truncated file and a file of another kind
+    saveTensorFile(path, {{"a", tensor}});
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size() - 10));
+    }
+    EXPECT_THROW(MappedTensorFile{path}, std::runtime_error);
+    contents[0] = 'x';
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+    EXPECT_THROW(MappedTensorFile{path}, std::runtime_error);
+    contents[0] = 'g';
+
+    // a single field of the header or the first record set to a value the writer never produces: an alignment
+    // below a cache line, a layout past the last, a data offset inside the file but off the alignment
+    const auto expectCorruptFieldRejected = [&](size_t fieldOffset, auto value)
+    {
+        std::string corrupt = contents;
+        std::memcpy(corrupt.data() + fieldOffset, &value, sizeof(value));
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(corrupt.data(), static_cast<std::streamsize>(corrupt.size()));
+        }
+        EXPECT_THROW(MappedTensorFile{path}, std::runtime_error) << "field at " << fieldOffset;
+    };
+    constexpr size_t kRecord = 32;
+    expectCorruptFieldRejected(16, uint64_t(96));
+    expectCorruptFieldRejected(kRecord + 104, static_cast<uint32_t>(Layout::LayoutNR));
+    expectCorruptFieldRejected(kRecord + 80, uint64_t(64));
+    // sizes and strides whose extent wraps around 64 bits to the recorded data size
+    expectCorruptFieldRejected(kRecord, (uint64_t(1) << 62) + 8);
+    expectCorruptFieldRejected(kRecord + 40, std::numeric_limits<int64_t>::min());
+    // the file is intact again
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+    EXPECT_NO_THROW(MappedTensorFile{path});
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "gTensor/TensorView.h"
+#include <stdexcept>
+
+using namespace gblas;
+
+class TensorViewTest : public testing::Test
+{
+public:
+    // 4 x 3 x 2 int32 tensor holding its own element order position
+    void SetUp() override
+    {
+        tensor = gTensor({4, 3, 2, 1, 1}, {1, 4, 12, 24, 24}, 3, DType::int32);
+        tensor.allocateData();
+        for (int i = 0; i < 24; ++i) reinterpret_cast<int32_t*>(tensor.data())[i] = i;
+    }
+protected:
+    gTensor tensor;
+};
+
+TEST_F(TensorViewTest, access_matches_the_strides)
+{
+    TensorView<int32_t, 3, true> view(tensor);
+    EXPECT_EQ(view(1, 2, 1), 1 + 2 * 4 + 12);
+    EXPECT_EQ((view[{3, 0, 1}]), 3 + 12);
+    EXPECT_EQ(view.row(1, 1)[2], 4 + 12 + 2);
+    EXPECT_EQ(view.getTotalSizeInElements(), 24u);
+    view(0, 0, 0) = -7;
+    EXPECT_EQ(reinterpret_cast<int32_t*>(tensor.data())[0], -7);
+
+    // a transposed slice needs the strided flavour
+    const gTensor view2d = tensor.slice(2, 1, 2).transpose(0, 1);
+    EXPECT_FALSE((TensorView<const int32_t, 3, true>::fits(view2d)));
+    TensorView<const int32_t, 3> strided(view2d);
+    EXPECT_EQ(strided(2, 3, 0), 3 + 2 * 4 + 12);
+    EXPECT_EQ(strided.getStride(0), 4);
+}
+
+TEST_F(TensorViewTest, visit_picks_the_fitting_view)
+{
+    const gTensor rows = tensor.reshape({12, 2, 1, 1, 1}, 2);
+    const gTensor columns = rows.transpose(0, 1);
+    for (const gTensor* source : {&rows, &columns})
+    {
+        const int64_t sum = visitTensorView<const int32_t, 2>(*source, [](const auto& view)
+        {
+            using View = std::decay_t<decltype(view)>;
+            int64_t total = 0;
+            for (uint64_t o = 0; o < view.getSize(1); ++o)
+            {
+                const int32_t* run = view.row(o);
+                const int64_t sign = View::kContiguous ? 1 : -1;
+                for (uint64_t i = 0; i < view.getSize(0); ++i) total += run[i * view.getStride(0)] * sign;
+            }
+            return total;
+        });
+        EXPECT_EQ(sum, source == &rows ? 276 : -276);
+    }
+}
+
+TEST_F(TensorViewTest, mismatches_throw)
+{
+    EXPECT_THROW((TensorView<int32_t, 2>(tensor)), std::invalid_argument);
+    EXPECT_THROW((TensorView<float, 3>(tensor)), std::invalid_argument);
+    EXPECT_THROW((TensorView<const int32_t, 3, true>(tensor.slice(0, 0, 4, 2))), std::invalid_argument);
+    gTensor empty({4, 3, 2, 1, 1}, {1, 4, 12, 24, 24}, 3, DType::bf16);
+    EXPECT_THROW((TensorView<uint16_t, 3>(empty)), std::invalid_argument);
+    empty.allocateData();
+    EXPECT_NO_THROW((TensorView<Bfloat16, 3>(empty)));
+    EXPECT_THROW(visitTensorView<int16_t>(tensor, [](const auto&) {}), std::invalid_argument);
+    EXPECT_THROW((visitTensorView<int32_t, 2>(tensor, [](const auto&) {})), std::invalid_argument);
+}
@@ -0,0 +1,55 @@
+#ifndef GBLAS_TEST_UTILS_H
+#define GBLAS_TEST_UTILS_H
+
+#include <cstdint>
+#include <vector>
+#include "common.h"
+#include "gTensor/gTensor.h"
+
+namespace gblas::test {
+
+/// tensor of the given sizes and strides, one of each per dim of its rank, allocated and zeroed
+inline gTensor makeTensor(const std::vector<uint64_t>& sizes, const std::vector<int64_t>& strides, DType dtype,
+                          Layout layout = Layout::RowMajor)
+{
+    TSizeArr allSizes = {1, 1, 1, 1, 1};
+    TStrideArr allStrides = {1, 1, 1, 1, 1};
+    int64_t next = 1;
+    for (unsigned dim = 0; dim < sizes.size(); ++dim)
+    {
+        allSizes[dim] = sizes[dim];
+        allStrides[dim] = strides[dim];
+        next = strides[dim] * static_cast<int64_t>(sizes[dim]);
+    }
+    for (unsigned dim = sizes.size(); dim < MAX_DIM; ++dim) allStrides[dim] = next;
+    gTensor tensor(allSizes, allStrides, sizes.size(), dtype, layout);
+    tensor.allocateData();
+    return tensor;
+}
+
+/// dense tensor of the given sizes, dim 0 contiguous, allocated and zeroed
+inline gTensor makeTensor(const std::vector<uint64_t>& sizes, DType dtype, Layout layout = Layout::RowMajor)
+{
+    std::vector<int64_t> strides(sizes.size());
+    int64_t stride = 1;
+    for (unsigned dim = 0; dim < sizes.size(); ++dim)
+    {
+        strides[dim] = stride;
+        stride *= static_cast<int64_t>(sizes[dim]);
+    }
+    return makeTensor(sizes, strides, dtype, layout);
+}
+
+/// rows x cols matrix in the given layout, dim 0 runs along a row of a row major matrix and along a column of a
+/// col major one. `pad` unused elements follow every line of dim 0
+inline gTensor makeMatrix(uint64_t rows, uint64_t cols, DType dtype = DType::fp32, Layout layout = Layout::RowMajor,
+                          uint64_t pad = 0)
+{
+    const uint64_t inner = layout == Layout::RowMajor ? cols : rows;
+    const uint64_t outer = layout == Layout::RowMajor ? rows : cols;
+    return makeTensor({inner, outer}, {1, static_cast<int64_t>(inner + pad)}, dtype, layout);
+}
+
+} // namespace gblas::test
+
+#endif //GBLAS_TEST_UTILS_H
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include <cstring>
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+using namespace gblas::test;
+
+class TransposeTest : public testing::Test
+{
+public:
+    // dense tensor of the given sizes, dim 0 contiguous, every byte set from its position
+    static gTensor makeFilled(const std::vector<uint64_t>& sizes, DType dtype, Layout layout = Layout::RowMajor)
+    {
+        gTensor tensor = makeTensor(sizes, dtype, layout);
+        const uint64_t bytes = tensor.getTotalSizeInElements() * getSingleElementSizeInBytes(dtype);
+        for (uint64_t i = 0; i < bytes; ++i) tensor.data()[i] = static_cast<byte>(i * 7 + i / 251);
+        return tensor;
+    }
+
+    // address of the element at the given coordinates
+    static const byte* at(const gTensor& tensor, const Coordinates& coords)
+    {
+        int64_t offset = 0;
+        for (unsigned dim = 0; dim < tensor.getRank(); ++dim)
+        {
+            offset += static_cast<int64_t>(coords[dim]) * tensor.getStride(dim);
+        }
+        return tensor.data() + offset * getSingleElementSizeInBytes(tensor.getDType());
+    }
+
+    // y(c) == x(c[perm^-1]) for every coordinate c of y
+    static void expectPermuted(const gTensor& x, const gTensor& y, const Coordinates& perm)
+    {
+        const unsigned size = getSingleElementSizeInBytes(x.getDType());
+        Coordinates coords = {};
+        for (uint64_t i = 0; i < y.getTotalSizeInElements(); ++i)
+        {
+            uint64_t rest = i;
+            Coordinates from = {};
+            for (unsigned dim = 0; dim < y.getRank(); ++dim)
+            {
+                coords[dim] = static_cast<unsigned>(rest % y.getSize(dim));
+                rest /= y.getSize(dim);
+                from[perm[dim]] = coords[dim];
+            }
+            ASSERT_EQ(std::memcmp(at(y, coords), at(x, from), size), 0) << "element " << i;
+        }
+    }
+protected:
+    Operations m_ops;
+};
+
+TEST_F(TransposeTest, permute_every_element_size)
+{
+    // odd sizes leave partial micro tiles and partial L1 tiles on both sides
+    const std::vector<std::pair<std::vector<uint64_t>, Coordinates>> cases = {
+        {{67, 45}, {1, 0, 2, 3, 4}},
+        {{129, 3, 70}, {2, 1, 0, 3, 4}},
+        {{17, 33, 2, 9}, {3, 2, 0, 1, 4}},
+        {{5, 19, 3, 2, 23}, {4, 0, 3, 1, 2}},
+        {{40, 1, 31}, {1, 2, 0, 3, 4}},
+    };
+    for (DType dtype : {DType::int8, DType::fp16, DType::fp32, DType::fp64})
+    {
+        for (const auto& [sizes, perm] : cases)
+        {
+            const gTensor x = makeFilled(sizes, dtype);
+            std::vector<uint64_t> permuted(sizes.size());
+            for (unsigned dim = 0; dim < sizes.size(); ++dim) permuted[dim] = sizes[perm[dim]];
+            gTensor y = makeFilled(permuted, dtype);
+            ASSERT_EQ(m_ops.permute(x, y, perm), gStatus::gBLAS_PASS);
+            expectPermuted(x, y, perm);
+            // and back
+            Coordinates inverse = {0, 1, 2, 3, 4};
+            for (unsigned dim = 0; dim < sizes.size(); ++dim) inverse[perm[dim]] = dim;
+            gTensor back = makeFilled(sizes, dtype);
+            ASSERT_EQ(m_ops.permute(y, back, inverse), gStatus::gBLAS_PASS);
+            const uint64_t bytes = x.getTotalSizeInElements() * getSingleElementSizeInBytes(dtype);
+            ASSERT_EQ(std::memcmp(back.data(), x.data(), bytes), 0);
+            if (sizes.size() == 2)
+            {
+                // a strided destination
+                gTensor strided = makeFilled({sizes[0] * 2, sizes[1]}, dtype).slice(0, 0, sizes[0] * 2, 2);
+                ASSERT_EQ(m_ops.permute(y, strided, perm), gStatus::gBLAS_PASS);
+                expectPermuted(y, strided, perm);
+            }
+        }
+    }
+}
+
+TEST_F(TransposeTest, convert_layout_keeps_the_matrices)
+{
+    // a row major batch holds its matrices with dim 0 along the columns, a col major one along the rows
+    const gTensor rowMajor = makeFilled({45, 67, 3}, DType::bf16, Layout::RowMajor);
+    gTensor colMajor = makeFilled({67, 45, 3}, DType::bf16, Layout::ColMajor);
+    ASSERT_EQ(m_ops.convertLayout(rowMajor, colMajor), gStatus::gBLAS_PASS);
+    expectPermuted(rowMajor, colMajor, {1, 0, 2, 3, 4});
+    gTensor again = makeFilled({45, 67, 3}, DType::bf16, Layout::RowMajor);
+    ASSERT_EQ(m_ops.convertLayout(colMajor, again), gStatus::gBLAS_PASS);
+    ASSERT_EQ(std::memcmp(again.data(), rowMajor.data(), 45 * 67 * 3 * 2), 0);
+
+    // large enough for the non-temporal stores, with rows that are not vector aligned
+    const gTensor large = makeFilled({1031, 1029}, DType::fp32, Layout::RowMajor);
+    gTensor converted = makeFilled({1029, 1031}, DType::fp32, Layout::ColMajor);
+    ASSERT_EQ(m_ops.convertLayout(large, converted), gStatus::gBLAS_PASS);
+    expectPermuted(large, converted, {1, 0, 2, 3, 4});
+}
+
+TEST_F(TransposeTest, invalid_input_fails)
+{
+    const gTensor x = makeFilled({8, 4, 2}, DType::fp32);
+    gTensor y = makeFilled({2, 8, 4}, DType::fp32);
+    EXPECT_EQ(m_ops.permute(x, y, {2, 0, 1, 3, 4}), gStatus::gBLAS_PASS);
+    EXPECT_EQ(m_ops.permute(x, y, {2, 0, 0, 3, 4}), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.permute(x, y, {3, 0, 1, 2, 4}), gStatus::gBLAS_FAIL);
+    EXPECT_EQ(m_ops.permute(x, y, {0, 1, 2, 3, 4}), gStatus::gBLAS_FAIL);
+    gTensor other = makeFilled({2, 8, 4}, DType::fp16);
+    EXPECT_EQ(m_ops.permute(x, other, {2, 0, 1, 3, 4}), gStatus::gBLAS_FAIL);
+
+    gTensor colMajor = makeFilled({4, 8, 2}, DType::fp32, Layout::ColMajor);
+    EXPECT_EQ(m_ops.convertLayout(x, colMajor), gStatus::gBLAS_PASS);
+    gTensor untyped = makeFilled({4, 8, 2}, DType::fp32, Layout::LayoutNR);
+    EXPECT_EQ(m_ops.convertLayout(x, untyped), gStatus::gBLAS_FAIL);
+    gTensor wrong = makeFilled({8, 4, 2}, DType::fp32, Layout::ColMajor);
+    EXPECT_EQ(m_ops.convertLayout(x, wrong), gStatus::gBLAS_FAIL);
+}
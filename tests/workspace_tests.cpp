@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "gTensor/gTensor.h"
+#include "operations/operations.h"
+#include "runtime/Parallel.h"
+#include "runtime/Workspace.h"
+#include <vector>
+#include "test_utils.h"
+
+using namespace gblas;
+
+namespace {
+
+class CountingAllocator : public Allocator
+{
+public:
+    byte* allocate(uint64_t sizeInBytes) override
+    {
+        ++allocations;
+        return m_heap.allocate(sizeInBytes);
+    }
+    void deallocate(byte* ptr, uint64_t sizeInBytes) override
+    {
+        m_heap.deallocate(ptr, sizeInBytes);
+    }
+    unsigned allocations = 0;
+private:
+    AlignedAllocator m_heap;
+};
+
+// rows x cols row major fp32 matrix filled with a pattern
+gTensor makeMatrix(uint64_t rows, uint64_t cols, std::vector<float>& data)
+{
+    gTensor tensor = test::makeMatrix(rows, cols);
+    float* values = reinterpret_cast<float*>(tensor.data());
+    for (uint64_t i = 0; i < rows * cols; ++i) values[i] = static_cast<float>((i * 7) % 13) - 6.0f;
+    data.assign(values, values + rows * cols);
+    return tensor;
+}
+
+} // anonymous namespace
+
+TEST(WorkspaceTest, bump_allocation)
+{
+    CountingAllocator heap;
+    Workspace workspace(1 << 16, heap);
+    byte* first = workspace.allocate(10);
+    byte* second = workspace.allocate(100, 256);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % kCacheLineSize, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 256, 0);
+    EXPECT_GE(second, first + 10);
+    EXPECT_EQ(workspace.getUsage(), static_cast<uint64_t>(second - first) + 100);
+
+    // reset hands out the same memory again
+    workspace.reset();
+    EXPECT_EQ(workspace.getUsage(), 0);
+    EXPECT_EQ(workspace.allocate(10), first);
+    EXPECT_EQ(heap.allocations, 1);
+    EXPECT_EQ(workspace.getPeakUsage(), static_cast<uint64_t>(second - first) + 100);
+}
+
+TEST(WorkspaceTest, growth_and_scopes)
+{
+    CountingAllocator heap;
+    Workspace workspace(1024, heap);
+    workspace.allocate(512);
+    {
+        Workspace::Scope scope(&workspace);
+        // does not fit, a second block is chained
+        workspace.allocate(4096);
+        EXPECT_EQ(heap.allocations, 2);
+        EXPECT_EQ(workspace.getUsage(), 512 + 4096);
+    }
+    EXPECT_EQ(workspace.getUsage(), 512);
+    EXPECT_EQ(workspace.getPeakUsage(), 512 + 4096);
+
+    // the chained blocks are merged into one that serves the peak
+    workspace.reset();
+    EXPECT_GE(workspace.getCapacity(), workspace.getPeakUsage());
+    const unsigned allocations = heap.allocations;
+    workspace.allocate(512);
+    workspace.allocate(4096);
+    EXPECT_EQ(heap.allocations, allocations);
+
+    workspace.reserve(1 << 20);
+    EXPECT_GE(workspace.getCapacity(), 1 << 20);
+    EXPECT_EQ(workspace.getUsage(), 0);
+}
+
+TEST(WorkspaceTest, gemm_scratch)
+{
+    std::vector<float> aData, bData, cData;
+    gTensor a = makeMatrix(67, 300, aData);
+    gTensor b = makeMatrix(300, 45, bData);
+    gTensor expected = makeMatrix(67, 45, cData);
+    gTensor c = makeMatrix(67, 45, cData);
+    Operations plain;
+    ASSERT_EQ(plain.gemm(a, b, expected), gStatus::gBLAS_PASS);
+
+    CountingAllocator heap;
+    Workspace workspace(0, heap);
+    Operations ops(&workspace);
+    ASSERT_EQ(ops.gemm(a, b, c), gStatus::gBLAS_PASS);
+    EXPECT_EQ(std::memcmp(c.data(), expected.data(), c.getMemorySizeInBytes()), 0);
+    // the scratch was handed back, and after sizing it to the peak later calls do not allocate
+    EXPECT_EQ(workspace.getUsage(), 0);
+    EXPECT_GT(workspace.getPeakUsage(), 0);
+    workspace.reserve(workspace.getPeakUsage());
+    const unsigned allocations = heap.allocations;
+    ASSERT_EQ(ops.gemm(a, b, c), gStatus::gBLAS_PASS);
+    EXPECT_EQ(heap.allocations, allocations);
+    EXPECT_EQ(std::memcmp(c.data(), expected.data(), c.getMemorySizeInBytes()), 0);
+}
+
+TEST(WorkspaceTest, grouped_gemm_scratch)
+{
+    // small products run side by side, each thread takes its panels from the attached workspace
+    std::vector<float> aData, bData, cData;
+    gTensor a = makeMatrix(67, 300, aData);
+    gTensor b = makeMatrix(300, 45, bData);
+    gTensor expected = makeMatrix(67, 45, cData);
+    Operations plain;
+    ASSERT_EQ(plain.gemm(a, b, expected), gStatus::gBLAS_PASS);
+    std::vector<gTensor> cs;
+    for (unsigned i = 0; i < 6; ++i) cs.push_back(makeMatrix(67, 45, cData));
+    std::vector<GemmGroupEntry> group;
+    for (gTensor& c : cs) group.push_back({&a, &b, &c});
+
+    CountingAllocator heap;
+    Workspace workspace(0, heap);
+    Operations ops(&workspace);
+    setThreadPoolOptions({4});
+    const gStatus status = ops.gemmGrouped(group.data(), group.size());
+    setThreadPoolOptions({});
+    ASSERT_EQ(status, gStatus::gBLAS_PASS);
+    for (const gTensor& c : cs) EXPECT_EQ(std::memcmp(c.data(), expected.data(), c.getMemorySizeInBytes()), 0);
+    EXPECT_EQ(workspace.getUsage(), 0);
+    EXPECT_GT(workspace.getPeakUsage(), 0);
+}
+
+TEST(WorkspaceTest, batched_gemm_scratch_does_not_grow_with_the_batch)
+{
+    // every product gives its panels back before the next one, both when the products are large enough to
+    // take the whole pool and when a single thread runs them all
+    const uint64_t m = 256, n = 256, k = 256;
+    const auto makeBatch = [](uint64_t rows, uint64_t cols, uint64_t batch)
+    {
+        gTensor tensor = test::makeTensor({cols, rows, batch}, DType::fp32);
+        float* values = reinterpret_cast<float*>(tensor.data());
+        for (uint64_t i = 0; i < rows * cols * batch; ++i) values[i] = static_cast<float>((i * 7) % 13) - 6.0f;
+        return tensor;
+    };
+    for (unsigned threads : {4u, 1u})
+    {
+        setThreadPoolOptions({threads});
+        uint64_t single = 0;
+        for (uint64_t batch : {1, 8})
+        {
+            gTensor a = makeBatch(m, k, batch);
+            gTensor b = makeBatch(k, n, batch);
+            gTensor c = makeBatch(m, n, batch);
+            Workspace workspace;
+            Operations ops(&workspace);
+            ASSERT_EQ(ops.gemmStridedBatched(a, b, c), gStatus::gBLAS_PASS);
+            EXPECT_EQ(workspace.getUsage(), 0);
+            EXPECT_GT(workspace.getPeakUsage(), 0);
+            if (batch == 1)
+            {
+                single = workspace.getPeakUsage();
+            }
+            else
+            {
+                EXPECT_EQ(workspace.getPeakUsage(), single) << threads << " threads";
+            }
+        }
+    }
+    setThreadPoolOptions({});
+}